@@ -0,0 +1,529 @@
+#ifndef NX_FOUNDATION_NXBATCHMATH
+#define NX_FOUNDATION_NXBATCHMATH
+/*----------------------------------------------------------------------------*\
+|
+|					Public Interface to NVIDIA PhysX Technology
+|
+|							     www.nvidia.com
+|
+\*----------------------------------------------------------------------------*/
+/** \addtogroup foundation
+  @{
+*/
+
+#include "Nxf.h"
+#include "NxVec3.h"
+#include "NxMat33.h"
+#include "NxMat34.h"
+#include "NxQuat.h"
+
+#if !defined(NX_FOUNDATION_USE_F64) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NX_BATCH_MATH_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+\brief Array of vectors stored as three separate component arrays (structure of arrays).
+
+The arrays need no particular alignment.
+*/
+class NxVec3SoA
+	{
+	public:
+	NX_INLINE NxVec3SoA() : x(NULL), y(NULL), z(NULL) {}
+	NX_INLINE NxVec3SoA(NxReal* _x, NxReal* _y, NxReal* _z) : x(_x), y(_y), z(_z) {}
+
+	NxReal* x;
+	NxReal* y;
+	NxReal* z;
+	};
+
+#ifdef NX_BATCH_MATH_SSE2
+/**
+\brief Four floats processed in lock step by the NxBatchMath kernels.
+*/
+class NxBatchFloat4
+	{
+	public:
+	NX_INLINE NxBatchFloat4() {}
+	NX_INLINE NxBatchFloat4(__m128 _v) : v(_v) {}
+	NX_INLINE NxBatchFloat4(NxF32 f) : v(_mm_set1_ps(f)) {}
+
+	NX_INLINE NxBatchFloat4 operator+(const NxBatchFloat4& b) const	{ return _mm_add_ps(v, b.v);	}
+	NX_INLINE NxBatchFloat4 operator-(const NxBatchFloat4& b) const	{ return _mm_sub_ps(v, b.v);	}
+	NX_INLINE NxBatchFloat4 operator*(const NxBatchFloat4& b) const	{ return _mm_mul_ps(v, b.v);	}
+	NX_INLINE NxBatchFloat4 operator/(const NxBatchFloat4& b) const	{ return _mm_div_ps(v, b.v);	}
+
+	__m128 v;
+	};
+
+NX_INLINE NxBatchFloat4 NxBatchSqrt(const NxBatchFloat4& a)
+	{
+	return _mm_sqrt_ps(a.v);
+	}
+
+NX_INLINE NxBatchFloat4 NxBatchSelectNonZero(const NxBatchFloat4& c, const NxBatchFloat4& a, const NxBatchFloat4& b)
+	{
+	// NaN compares not equal, like the scalar 'if(c)'
+	__m128 mask = _mm_cmpneq_ps(c.v, _mm_setzero_ps());
+	return _mm_or_ps(_mm_and_ps(mask, a.v), _mm_andnot_ps(mask, b.v));
+	}
+#endif
+
+NX_INLINE NxReal NxBatchSqrt(NxReal a)
+	{
+	return NxMath::sqrt(a);
+	}
+
+NX_INLINE NxReal NxBatchSelectNonZero(NxReal c, NxReal a, NxReal b)
+	{
+	return c ? a : b;
+	}
+
+/**
+\brief Transforms, rotates and normalizes arrays of vectors.
+
+Every function comes in an array of NxVec3 (AoS) and a #NxVec3SoA version. Source and destination
+may be the same array. With SSE2 four elements are processed at a time; the remaining elements and
+platforms without SSE2 use the scalar path. Both evaluate the same expressions in the same order as the
+corresponding NxVec3, NxMat33, NxMat34 and NxQuat members, so the results are bit identical to calling
+those one element at a time.
+*/
+class NxBatchMath
+	{
+	public:
+
+	/**
+	\brief dst[i] = m * src[i], like NxMat34::multiply(). Use for points.
+	*/
+	NX_INLINE static void transform(const NxMat34& m, const NxVec3* src, NxVec3* dst, NxU32 count);
+	NX_INLINE static void transform(const NxMat34& m, const NxVec3SoA& src, const NxVec3SoA& dst, NxU32 count);
+
+	/**
+	\brief dst[i] = m % src[i], like NxMat34::multiplyByInverseRT().
+	*/
+	NX_INLINE static void transformByInverseRT(const NxMat34& m, const NxVec3* src, NxVec3* dst, NxU32 count);
+	NX_INLINE static void transformByInverseRT(const NxMat34& m, const NxVec3SoA& src, const NxVec3SoA& dst, NxU32 count);
+
+	/**
+	\brief dst[i] = m * src[i], like NxMat33::multiply(). Use for directions, and for normals with the inverse transpose.
+	*/
+	NX_INLINE static void rotate(const NxMat33& m, const NxVec3* src, NxVec3* dst, NxU32 count);
+	NX_INLINE static void rotate(const NxMat33& m, const NxVec3SoA& src, const NxVec3SoA& dst, NxU32 count);
+
+	/**
+	\brief dst[i] = transpose(m) * src[i], like NxMat33::multiplyByTranspose().
+	*/
+	NX_INLINE static void rotateByTranspose(const NxMat33& m, const NxVec3* src, NxVec3* dst, NxU32 count);
+	NX_INLINE static void rotateByTranspose(const NxMat33& m, const NxVec3SoA& src, const NxVec3SoA& dst, NxU32 count);
+
+	/**
+	\brief dst[i] = q.rot(src[i]), q is assumed to be a unit quaternion.
+	*/
+	NX_INLINE static void rotate(const NxQuat& q, const NxVec3* src, NxVec3* dst, NxU32 count);
+	NX_INLINE static void rotate(const NxQuat& q, const NxVec3SoA& src, const NxVec3SoA& dst, NxU32 count);
+
+	/**
+	\brief Normalizes v[i] in place like NxVec3::normalize(), optionally returns the previous magnitudes.
+	*/
+	NX_INLINE static void normalize(NxVec3* v, NxU32 count, NxReal* magnitudes = NULL);
+	NX_INLINE static void normalize(const NxVec3SoA& v, NxU32 count, NxReal* magnitudes = NULL);
+
+	/**
+	\brief dst[i] = a[i].dot(b[i])
+	*/
+	NX_INLINE static void dot(const NxVec3* a, const NxVec3* b, NxReal* dst, NxU32 count);
+	NX_INLINE static void dot(const NxVec3SoA& a, const NxVec3SoA& b, NxReal* dst, NxU32 count);
+
+	/**
+	\brief dst[i].cross(a[i], b[i])
+	*/
+	NX_INLINE static void cross(const NxVec3* a, const NxVec3* b, NxVec3* dst, NxU32 count);
+	NX_INLINE static void cross(const NxVec3SoA& a, const NxVec3SoA& b, const NxVec3SoA& dst, NxU32 count);
+
+	/**
+	\brief dst[i] = left * right[i], like NxMat34::multiply(). dst may be right.
+	*/
+	NX_INLINE static void multiply(const NxMat34& left, const NxMat34* right, NxMat34* dst, NxU32 count);
+
+	/**
+	\brief dst[i] = left[i] * right[i], like NxMat34::multiply(). dst may be left or right.
+	*/
+	NX_INLINE static void multiply(const NxMat34* left, const NxMat34* right, NxMat34* dst, NxU32 count);
+
+	private:
+
+	// kernels, V is NxReal or NxBatchFloat4, c holds the broadcast constants
+
+	struct TransformOp
+		{
+		enum { NB_CONSTANTS = 12 };
+		static NX_INLINE void setup(const NxMat34& m, NxReal* c)	{ m.M.getRowMajor(c); c[9] = m.t.x; c[10] = m.t.y; c[11] = m.t.z;	}
+
+		template<class V> static NX_INLINE void apply(const V* c, V& x, V& y, V& z)
+			{
+			V rx = c[0] * x + c[1] * y + c[2] * z;
+			V ry = c[3] * x + c[4] * y + c[5] * z;
+			V rz = c[6] * x + c[7] * y + c[8] * z;
+			x = rx + c[9];
+			y = ry + c[10];
+			z = rz + c[11];
+			}
+		};
+
+	struct InverseRTOp
+		{
+		enum { NB_CONSTANTS = 12 };
+		static NX_INLINE void setup(const NxMat34& m, NxReal* c)	{ TransformOp::setup(m, c);	}
+
+		template<class V> static NX_INLINE void apply(const V* c, V& x, V& y, V& z)
+			{
+			V sx = x - c[9];
+			V sy = y - c[10];
+			V sz = z - c[11];
+			x = c[0] * sx + c[3] * sy + c[6] * sz;
+			y = c[1] * sx + c[4] * sy + c[7] * sz;
+			z = c[2] * sx + c[5] * sy + c[8] * sz;
+			}
+		};
+
+	struct RotateOp
+		{
+		enum { NB_CONSTANTS = 9 };
+		static NX_INLINE void setup(const NxMat33& m, NxReal* c)	{ m.getRowMajor(c);	}
+
+		template<class V> static NX_INLINE void apply(const V* c, V& x, V& y, V& z)
+			{
+			V rx = c[0] * x + c[1] * y + c[2] * z;
+			V ry = c[3] * x + c[4] * y + c[5] * z;
+			V rz = c[6] * x + c[7] * y + c[8] * z;
+			x = rx;
+			y = ry;
+			z = rz;
+			}
+		};
+
+	struct RotateTransposeOp
+		{
+		enum { NB_CONSTANTS = 9 };
+		static NX_INLINE void setup(const NxMat33& m, NxReal* c)	{ m.getRowMajor(c);	}
+
+		template<class V> static NX_INLINE void apply(const V* c, V& x, V& y, V& z)
+			{
+			V rx = c[0] * x + c[3] * y + c[6] * z;
+			V ry = c[1] * x + c[4] * y + c[7] * z;
+			V rz = c[2] * x + c[5] * y + c[8] * z;
+			x = rx;
+			y = ry;
+			z = rz;
+			}
+		};
+
+	struct QuatRotateOp
+		{
+		enum { NB_CONSTANTS = 6 };
+		static NX_INLINE void setup(const NxQuat& q, NxReal* c)	{ c[0] = q.x; c[1] = q.y; c[2] = q.z; c[3] = q.w; c[4] = q.w*q.w-0.5f; c[5] = 2;	}
+
+		// (v*(w*w-0.5f) + (qv^v)*w + qv*(qv|v))*2
+		template<class V> static NX_INLINE void apply(const V* c, V& x, V& y, V& z)
+			{
+			V cx = (c[1] * z) - (c[2] * y);
+			V cy = (c[2] * x) - (c[0] * z);
+			V cz = (c[0] * y) - (c[1] * x);
+			V d = c[0] * x + c[1] * y + c[2] * z;
+			V rx = (x * c[4] + cx * c[3] + c[0] * d) * c[5];
+			V ry = (y * c[4] + cy * c[3] + c[1] * d) * c[5];
+			V rz = (z * c[4] + cz * c[3] + c[2] * d) * c[5];
+			x = rx;
+			y = ry;
+			z = rz;
+			}
+		};
+
+	template<class V> static NX_INLINE V normalizeKernel(V& x, V& y, V& z)
+		{
+		V m = NxBatchSqrt(x * x + y * y + z * z);
+		V il = V(NxReal(1.0)) / m;
+		x = NxBatchSelectNonZero(m, x * il, x);
+		y = NxBatchSelectNonZero(m, y * il, y);
+		z = NxBatchSelectNonZero(m, z * il, z);
+		return m;
+		}
+
+#ifdef NX_BATCH_MATH_SSE2
+	// 4 packed NxVec3 <-> x, y, z lanes
+	static NX_INLINE void loadAoS(const NxVec3* p, NxBatchFloat4& x, NxBatchFloat4& y, NxBatchFloat4& z)
+		{
+		const NxF32* f = &p->x;
+		__m128 a = _mm_loadu_ps(f);			// x0 y0 z0 x1
+		__m128 b = _mm_loadu_ps(f + 4);		// y1 z1 x2 y2
+		__m128 c = _mm_loadu_ps(f + 8);		// z2 x3 y3 z3
+		x.v = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3,3,0,0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1,1,2,2)), _MM_SHUFFLE(2,0,2,0));
+		y.v = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0,0,1,1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2,2,3,3)), _MM_SHUFFLE(2,0,2,0));
+		z.v = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1,1,2,2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3,3,0,0)), _MM_SHUFFLE(2,0,2,0));
+		}
+
+	static NX_INLINE void storeAoS(NxVec3* p, const NxBatchFloat4& x, const NxBatchFloat4& y, const NxBatchFloat4& z)
+		{
+		NxF32* f = &p->x;
+		__m128 xyLo = _mm_unpacklo_ps(x.v, y.v);	// x0 y0 x1 y1
+		__m128 xyHi = _mm_unpackhi_ps(x.v, y.v);	// x2 y2 x3 y3
+		_mm_storeu_ps(f,     _mm_shuffle_ps(xyLo, _mm_shuffle_ps(z.v, x.v, _MM_SHUFFLE(1,1,0,0)), _MM_SHUFFLE(2,0,1,0)));
+		_mm_storeu_ps(f + 4, _mm_shuffle_ps(_mm_shuffle_ps(xyLo, z.v, _MM_SHUFFLE(1,1,3,3)), xyHi, _MM_SHUFFLE(1,0,2,0)));
+		_mm_storeu_ps(f + 8, _mm_shuffle_ps(_mm_shuffle_ps(z.v, xyHi, _MM_SHUFFLE(3,2,2,2)), _mm_shuffle_ps(xyHi, z.v, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(2,0,2,0)));
+		}
+
+	static NX_INLINE void loadSoA(const NxVec3SoA& p, NxU32 i, NxBatchFloat4& x, NxBatchFloat4& y, NxBatchFloat4& z)
+		{
+		x.v = _mm_loadu_ps(p.x + i);
+		y.v = _mm_loadu_ps(p.y + i);
+		z.v = _mm_loadu_ps(p.z + i);
+		}
+
+	static NX_INLINE void storeSoA(const NxVec3SoA& p, NxU32 i, const NxBatchFloat4& x, const NxBatchFloat4& y, const NxBatchFloat4& z)
+		{
+		_mm_storeu_ps(p.x + i, x.v);
+		_mm_storeu_ps(p.y + i, y.v);
+		_mm_storeu_ps(p.z + i, z.v);
+		}
+#endif
+
+	template<class Op, class T> static NX_INLINE void run(const T& param, const NxVec3* src, NxVec3* dst, NxU32 count)
+		{
+		NxReal c[Op::NB_CONSTANTS];
+		Op::setup(param, c);
+		NxU32 i = 0;
+#ifdef NX_BATCH_MATH_SSE2
+		NxBatchFloat4 c4[Op::NB_CONSTANTS];
+		for(NxU32 k=0; k<Op::NB_CONSTANTS; k++)
+			c4[k] = NxBatchFloat4(c[k]);
+		for(; i+4<=count; i+=4)
+			{
+			NxBatchFloat4 x, y, z;
+			loadAoS(src + i, x, y, z);
+			Op::apply(c4, x, y, z);
+			storeAoS(dst + i, x, y, z);
+			}
+#endif
+		for(; i<count; i++)
+			{
+			NxReal x = src[i].x, y = src[i].y, z = src[i].z;
+			Op::apply(c, x, y, z);
+			dst[i].set(x, y, z);
+			}
+		}
+
+	template<class Op, class T> static NX_INLINE void run(const T& param, const NxVec3SoA& src, const NxVec3SoA& dst, NxU32 count)
+		{
+		NxReal c[Op::NB_CONSTANTS];
+		Op::setup(param, c);
+		NxU32 i = 0;
+#ifdef NX_BATCH_MATH_SSE2
+		NxBatchFloat4 c4[Op::NB_CONSTANTS];
+		for(NxU32 k=0; k<Op::NB_CONSTANTS; k++)
+			c4[k] = NxBatchFloat4(c[k]);
+		for(; i+4<=count; i+=4)
+			{
+			NxBatchFloat4 x, y, z;
+			loadSoA(src, i, x, y, z);
+			Op::apply(c4, x, y, z);
+			storeSoA(dst, i, x, y, z);
+			}
+#endif
+		for(; i<count; i++)
+			{
+			NxReal x = src.x[i], y = src.y[i], z = src.z[i];
+			Op::apply(c, x, y, z);
+			dst.x[i] = x;
+			dst.y[i] = y;
+			dst.z[i] = z;
+			}
+		}
+	};
+
+NX_INLINE void NxBatchMath::transform(const NxMat34& m, const NxVec3* src, NxVec3* dst, NxU32 count)
+	{
+	run<TransformOp>(m, src, dst, count);
+	}
+
+NX_INLINE void NxBatchMath::transform(const NxMat34& m, const NxVec3SoA& src, const NxVec3SoA& dst, NxU32 count)
+	{
+	run<TransformOp>(m, src, dst, count);
+	}
+
+NX_INLINE void NxBatchMath::transformByInverseRT(const NxMat34& m, const NxVec3* src, NxVec3* dst, NxU32 count)
+	{
+	run<InverseRTOp>(m, src, dst, count);
+	}
+
+NX_INLINE void NxBatchMath::transformByInverseRT(const NxMat34& m, const NxVec3SoA& src, const NxVec3SoA& dst, NxU32 count)
+	{
+	run<InverseRTOp>(m, src, dst, count);
+	}
+
+NX_INLINE void NxBatchMath::rotate(const NxMat33& m, const NxVec3* src, NxVec3* dst, NxU32 count)
+	{
+	run<RotateOp>(m, src, dst, count);
+	}
+
+NX_INLINE void NxBatchMath::rotate(const NxMat33& m, const NxVec3SoA& src, const NxVec3SoA& dst, NxU32 count)
+	{
+	run<RotateOp>(m, src, dst, count);
+	}
+
+NX_INLINE void NxBatchMath::rotateByTranspose(const NxMat33& m, const NxVec3* src, NxVec3* dst, NxU32 count)
+	{
+	run<RotateTransposeOp>(m, src, dst, count);
+	}
+
+NX_INLINE void NxBatchMath::rotateByTranspose(const NxMat33& m, const NxVec3SoA& src, const NxVec3SoA& dst, NxU32 count)
+	{
+	run<RotateTransposeOp>(m, src, dst, count);
+	}
+
+NX_INLINE void NxBatchMath::rotate(const NxQuat& q, const NxVec3* src, NxVec3* dst, NxU32 count)
+	{
+	run<QuatRotateOp>(q, src, dst, count);
+	}
+
+NX_INLINE void NxBatchMath::rotate(const NxQuat& q, const NxVec3SoA& src, const NxVec3SoA& dst, NxU32 count)
+	{
+	run<QuatRotateOp>(q, src, dst, count);
+	}
+
+NX_INLINE void NxBatchMath::normalize(NxVec3* v, NxU32 count, NxReal* magnitudes)
+	{
+	NxU32 i = 0;
+#ifdef NX_BATCH_MATH_SSE2
+	for(; i+4<=count; i+=4)
+		{
+		NxBatchFloat4 x, y, z;
+		loadAoS(v + i, x, y, z);
+		NxBatchFloat4 m = normalizeKernel(x, y, z);
+		storeAoS(v + i, x, y, z);
+		if(magnitudes)
+			_mm_storeu_ps(magnitudes + i, m.v);
+		}
+#endif
+	for(; i<count; i++)
+		{
+		NxReal m = normalizeKernel(v[i].x, v[i].y, v[i].z);
+		if(magnitudes)
+			magnitudes[i] = m;
+		}
+	}
+
+NX_INLINE void NxBatchMath::normalize(const NxVec3SoA& v, NxU32 count, NxReal* magnitudes)
+	{
+	NxU32 i = 0;
+#ifdef NX_BATCH_MATH_SSE2
+	for(; i+4<=count; i+=4)
+		{
+		NxBatchFloat4 x, y, z;
+		loadSoA(v, i, x, y, z);
+		NxBatchFloat4 m = normalizeKernel(x, y, z);
+		storeSoA(v, i, x, y, z);
+		if(magnitudes)
+			_mm_storeu_ps(magnitudes + i, m.v);
+		}
+#endif
+	for(; i<count; i++)
+		{
+		NxReal m = normalizeKernel(v.x[i], v.y[i], v.z[i]);
+		if(magnitudes)
+			magnitudes[i] = m;
+		}
+	}
+
+NX_INLINE void NxBatchMath::dot(const NxVec3* a, const NxVec3* b, NxReal* dst, NxU32 count)
+	{
+	NxU32 i = 0;
+#ifdef NX_BATCH_MATH_SSE2
+	for(; i+4<=count; i+=4)
+		{
+		NxBatchFloat4 ax, ay, az, bx, by, bz;
+		loadAoS(a + i, ax, ay, az);
+		loadAoS(b + i, bx, by, bz);
+		_mm_storeu_ps(dst + i, (ax * bx + ay * by + az * bz).v);
+		}
+#endif
+	for(; i<count; i++)
+		dst[i] = a[i].x * b[i].x + a[i].y * b[i].y + a[i].z * b[i].z;
+	}
+
+NX_INLINE void NxBatchMath::dot(const NxVec3SoA& a, const NxVec3SoA& b, NxReal* dst, NxU32 count)
+	{
+	NxU32 i = 0;
+#ifdef NX_BATCH_MATH_SSE2
+	for(; i+4<=count; i+=4)
+		{
+		NxBatchFloat4 ax, ay, az, bx, by, bz;
+		loadSoA(a, i, ax, ay, az);
+		loadSoA(b, i, bx, by, bz);
+		_mm_storeu_ps(dst + i, (ax * bx + ay * by + az * bz).v);
+		}
+#endif
+	for(; i<count; i++)
+		dst[i] = a.x[i] * b.x[i] + a.y[i] * b.y[i] + a.z[i] * b.z[i];
+	}
+
+NX_INLINE void NxBatchMath::cross(const NxVec3* a, const NxVec3* b, NxVec3* dst, NxU32 count)
+	{
+	NxU32 i = 0;
+#ifdef NX_BATCH_MATH_SSE2
+	for(; i+4<=count; i+=4)
+		{
+		NxBatchFloat4 ax, ay, az, bx, by, bz;
+		loadAoS(a + i, ax, ay, az);
+		loadAoS(b + i, bx, by, bz);
+		storeAoS(dst + i, (ay * bz) - (az * by), (az * bx) - (ax * bz), (ax * by) - (ay * bx));
+		}
+#endif
+	for(; i<count; i++)
+		dst[i].cross(a[i], b[i]);
+	}
+
+NX_INLINE void NxBatchMath::cross(const NxVec3SoA& a, const NxVec3SoA& b, const NxVec3SoA& dst, NxU32 count)
+	{
+	NxU32 i = 0;
+#ifdef NX_BATCH_MATH_SSE2
+	for(; i+4<=count; i+=4)
+		{
+		NxBatchFloat4 ax, ay, az, bx, by, bz;
+		loadSoA(a, i, ax, ay, az);
+		loadSoA(b, i, bx, by, bz);
+		storeSoA(dst, i, (ay * bz) - (az * by), (az * bx) - (ax * bz), (ax * by) - (ay * bx));
+		}
+#endif
+	for(; i<count; i++)
+		{
+		NxReal x = (a.y[i] * b.z[i]) - (a.z[i] * b.y[i]);
+		NxReal y = (a.z[i] * b.x[i]) - (a.x[i] * b.z[i]);
+		NxReal z = (a.x[i] * b.y[i]) - (a.y[i] * b.x[i]);
+		dst.x[i] = x;
+		dst.y[i] = y;
+		dst.z[i] = z;
+		}
+	}
+
+NX_INLINE void NxBatchMath::multiply(const NxMat34& left, const NxMat34* right, NxMat34* dst, NxU32 count)
+	{
+	// scalar, NxMat34::multiply orders its temporaries so that dst may alias left or right
+	for(NxU32 i=0; i<count; i++)
+		dst[i].multiply(left, right[i]);
+	}
+
+NX_INLINE void NxBatchMath::multiply(const NxMat34* left, const NxMat34* right, NxMat34* dst, NxU32 count)
+	{
+	for(NxU32 i=0; i<count; i++)
+		dst[i].multiply(left[i], right[i]);
+	}
+
+/** @} */
+#endif
+//NVIDIACOPYRIGHTBEGIN
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010 NVIDIA Corporation
+// All rights reserved. www.nvidia.com
+///////////////////////////////////////////////////////////////////////////
+//NVIDIACOPYRIGHTEND
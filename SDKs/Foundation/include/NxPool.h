@@ -79,12 +79,82 @@ public:
         }
     }
 
+	/**
+	\brief Allocates up to n elements at once.
+
+	Grows the pool by one slab large enough for the whole request (at least the increment) if needed.
+
+	\param elements Receives the elements.
+	\param n Number of elements to allocate.
+	\return Number of elements written to elements, less than n only if the pool cannot grow.
+	*/
+    NxU32 get(Element **elements, NxU32 n)
+    {
+        if(mCount+n > mCapacity && mIncrement)
+        {
+            NxU32 missing = mCount+n-mCapacity;
+            allocSlab(missing > mIncrement ? missing : mIncrement);
+        }
+
+        if(n > mCapacity-mCount)
+            n = mCapacity-mCount;
+
+        for(NxU32 i=0;i<n;i++)
+        {
+            Element *element = mContents[mCount];
+            mIDToContents[element->hwid] = mCount++;
+            elements[i] = element;
+        }
+        return n;
+    }
+
+	/**
+	\param elements Elements to put back into the pool.
+	\param n Number of elements.
+	*/
+    void put(Element *const *elements, NxU32 n)
+    {
+        for(NxU32 i=0;i<n;i++)
+            put(elements[i]);
+    }
+
+	/**
+	\brief Borrowed, read only view of the elements in use. Invalidated by the next get() or put().
+	*/
+	class ContentsView
+	{
+	public:
+		ContentsView(Element *const *elements, NxU32 count) : mElements(elements), mSize(count) {}
+
+		NX_INLINE Element *const *begin() const		{ return mElements;					}
+		NX_INLINE Element *const *end() const		{ return mElements + mSize;			}
+		NX_INLINE NxU32 size() const				{ return mSize;						}
+		NX_INLINE Element *operator[](NxU32 i) const	{ NX_ASSERT(i < mSize); return mElements[i];	}
+
+	private:
+		Element *const *mElements;
+		NxU32 mSize;
+	};
+
+	/**
+	\brief The elements in use, without copying the pointer array.
+
+	@see contents()
+	*/
+    ContentsView contentsView() const
+    {
+        return ContentsView(mCount ? &mContents[0] : NULL, mCount);
+    }
+
+	/**
+	\brief Copy of the pointer array, elements [0, count()) are in use. Prefer contentsView().
+	*/
     const NxArray<Element *> contents() 
     {
         return mContents;
     }
     
-    NxU32 count() 
+    NxU32 count() const
     {
         return mCount;
     }
@@ -126,6 +196,199 @@ private:
                                              for 'not allocated' and thereby catch double-deletion. */
 };
 
+#if (defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))) || defined(__GNUC__)
+#define NX_POOL_CONCURRENT
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedExchange)
+#endif
+
+/**
+\brief Spin lock of #NxConcurrentPool. It is only held while a batch of elements moves between a cache and the pool.
+*/
+class NxPoolSpinLock
+{
+public:
+    NxPoolSpinLock() : mLocked(0) {}
+
+    void lock()
+    {
+#if defined(_MSC_VER)
+        while(_InterlockedExchange(&mLocked, 1))
+#else
+        while(__sync_lock_test_and_set(&mLocked, 1))
+#endif
+            while(mLocked) {}
+    }
+
+    void unlock()
+    {
+#if defined(_MSC_VER)
+        _InterlockedExchange(&mLocked, 0);
+#else
+        __sync_lock_release(&mLocked);
+#endif
+    }
+
+private:
+    volatile long mLocked;
+};
+
+/**
+\brief Thread safe variant of #NxPool.
+
+Every thread allocates through its own #Cache, a magazine of up to NX_POOL_MAGAZINE_SIZE free elements.
+get() and put() on a cache touch no shared state. Only an empty cache takes half a magazine from the pool,
+and a full one gives half a magazine back, under a spin lock. An element may be put into a different
+cache than the one it was taken from.
+
+Like NxPool, Element needs an NxU32 hwid member, which is set to a unique index when its slab is allocated.
+Unlike NxPool, the pool does not track the elements in use, so there is no contents() and no double put check.
+*/
+template<class Element, int ElementSize>
+class NxConcurrentPool
+{
+public:
+    enum { NX_POOL_MAGAZINE_SIZE = 64 };
+
+	/**
+	\brief Per thread magazine. Must only be used by one thread at a time, and be destroyed before the pool.
+	*/
+    class Cache
+    {
+    public:
+        Cache(NxConcurrentPool &pool) : mPool(pool), mCount(0) {}
+
+        ~Cache()
+        {
+            flush();
+        }
+
+        Element *get()
+        {
+            if(!mCount && !mPool.refill(*this))
+                return 0;
+            return mElements[--mCount];
+        }
+
+        void put(Element *element)
+        {
+            if(mCount == NX_POOL_MAGAZINE_SIZE)
+                mPool.drain(*this, NX_POOL_MAGAZINE_SIZE/2);
+            mElements[mCount++] = element;
+        }
+
+		/**
+		\brief Returns all cached elements to the pool.
+		*/
+        void flush()
+        {
+            if(mCount)
+                mPool.drain(*this, mCount);
+        }
+
+    private:
+        friend class NxConcurrentPool;
+
+        Cache &operator=(const Cache &);
+
+        NxConcurrentPool &mPool;
+        Element *mElements[NX_POOL_MAGAZINE_SIZE];
+        NxU32 mCount;
+    };
+
+	/**
+	\param initial Initial size of the pool.
+	\param increment Size to increase pool by when we need more memory.
+	*/
+    NxConcurrentPool(NxU32 initial, NxU32 increment = 0)
+    {
+        mIncrement = increment;
+        mCapacity = 0;
+        allocSlab(initial);
+    }
+
+    ~NxConcurrentPool()
+    {
+        for(NxU32 i=0;i<mSlabArray.size();i++)
+            nxFoundationSDKAllocator->free(mSlabArray[i]);
+    }
+
+    NxU32 capacity() const
+    {
+        return mCapacity;
+    }
+
+	/**
+	\brief Number of free elements not held by any cache. Only a snapshot while other threads use the pool.
+	*/
+    NxU32 freeCount() const
+    {
+        return mFree.size();
+    }
+
+private:
+    bool refill(Cache &cache)
+    {
+        const NxU32 want = NX_POOL_MAGAZINE_SIZE/2;
+
+        mLock.lock();
+        if(mFree.size() < want && mIncrement)
+            allocSlab(want > mIncrement ? want : mIncrement);
+
+        NxU32 n = mFree.size() < want ? mFree.size() : want;
+        for(NxU32 i=0;i<n;i++)
+        {
+            cache.mElements[i] = mFree.back();
+            mFree.popBack();
+        }
+        mLock.unlock();
+
+        cache.mCount = n;
+        return n != 0;
+    }
+
+    void drain(Cache &cache, NxU32 n)
+    {
+        mLock.lock();
+        for(NxU32 i=cache.mCount-n;i<cache.mCount;i++)
+            mFree.pushBack(cache.mElements[i]);
+        mLock.unlock();
+
+        cache.mCount -= n;
+    }
+
+    void allocSlab(NxU32 count)
+    {
+        char *mem = (char *)
+            nxFoundationSDKAllocator->malloc(count * ElementSize);
+        if(!mem)
+            return;
+
+        mSlabArray.pushBack(mem);
+        mFree.reserve(mCapacity+count);
+
+        for(NxU32 i=0;i<count;i++)
+        {
+            Element *e = (Element *)(mem + i * ElementSize);
+            e->hwid = mCapacity+i;
+            mFree.pushBack(e);
+        }
+
+        mCapacity+=count;
+    }
+
+    NxU32                 mIncrement;     /* resize quantum */
+    NxU32                 mCapacity;      /* current size */
+
+    NxArraySDK<char *>    mSlabArray;     /* array of allocated slabs */
+    NxArraySDK<Element *> mFree;          /* free elements not held by a cache */
+    NxPoolSpinLock        mLock;          /* guards mFree and the slabs */
+};
+
+#endif
+
  /** @} */
 #endif
 //NVIDIACOPYRIGHTBEGIN
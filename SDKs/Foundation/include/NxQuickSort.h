@@ -61,6 +61,11 @@ NxQuickSort<SortElem, SortElemCompareDirect>(&sortVector[0], &sortVector[sortVec
 //faster if SortElem is a large object, otherwise its about the same:
 std::vector<SortElem * > sortPtrVector;
 NxQuickSort<SortElem *, SortElemComparePtr>(&sortPtrVector[0], &sortPtrVector[sortPtrVector.size()-1]);
+
+There is no protection against the worst case of quicksort. For large or possibly presorted
+input use #NxIntroSort, #NxRadixSort or #NxParallelSort from NxSort.h and NxParallelSort.h.
+
+@see NxIntroSort NxRadixSort NxParallelSort
 */
 template<class Sortable, class Predicate>
 inline void NxQuickSort(Sortable * start, Sortable * end)
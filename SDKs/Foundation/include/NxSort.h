@@ -0,0 +1,339 @@
+#ifndef NX_FOUNDATION_NXSORT
+#define NX_FOUNDATION_NXSORT
+/*----------------------------------------------------------------------------*\
+|
+|					Public Interface to NVIDIA PhysX Technology
+|
+|							     www.nvidia.com
+|
+\*----------------------------------------------------------------------------*/
+/** \addtogroup foundation
+  @{
+*/
+
+#include "Nx.h"
+#include "NxArray.h"
+
+/**
+\brief Sorts the range [start, end] with insertion sort.
+
+Same call shape as #NxQuickSort, except that the predicate is passed in. Only worth it for
+short or nearly sorted ranges. Stable.
+
+@see NxIntroSort
+*/
+template<class Sortable, class Predicate>
+NX_INLINE void NxInsertionSort(Sortable * start, Sortable * end, Predicate & p)
+	{
+	for (Sortable * i = start + 1; i <= end; i++)
+		{
+		Sortable k = *i;
+		Sortable * j = i;
+		while (j > start && p(k, *(j - 1)))
+			{
+			*j = *(j - 1);
+			j--;
+			}
+		*j = k;
+		}
+	}
+
+/**
+\brief Moves heap[root] down to its place in the max heap heap[0, size).
+*/
+template<class Sortable, class Predicate>
+NX_INLINE void NxHeapSift(Sortable * heap, NxI32 root, NxI32 size, Predicate & p)
+	{
+	Sortable k = heap[root];
+	NxI32 child;
+	while ((child = 2 * root + 1) < size)
+		{
+		if (child + 1 < size && p(heap[child], heap[child + 1]))
+			child++;
+		if (!p(k, heap[child]))
+			break;
+		heap[root] = heap[child];
+		root = child;
+		}
+	heap[root] = k;
+	}
+
+/**
+\brief Sorts the range [start, end] with heap sort. O(n log n) in every case, but not stable.
+
+@see NxIntroSort
+*/
+template<class Sortable, class Predicate>
+NX_INLINE void NxHeapSort(Sortable * start, Sortable * end, Predicate & p)
+	{
+	const NxI32 n = NxI32(end - start) + 1;
+	for (NxI32 i = n / 2 - 1; i >= 0; i--)
+		NxHeapSift(start, i, n, p);
+	for (NxI32 i = n - 1; i > 0; i--)
+		{
+		Sortable k = start[0];
+		start[0] = start[i];
+		start[i] = k;
+		NxHeapSift(start, 0, i, p);
+		}
+	}
+
+/**
+\brief Quicksort loop of #NxIntroSort. Leaves ranges of up to 16 elements unsorted.
+*/
+template<class Sortable, class Predicate>
+NX_INLINE void NxIntroSortLoop(Sortable * start, Sortable * end, NxU32 depth, Predicate & p)
+	{
+	while (end - start >= 16)
+		{
+		if (depth-- == 0)
+			{
+			NxHeapSort(start, end, p);
+			return;
+			}
+
+		// median of three, moved to the middle
+		Sortable * mid = start + ((end - start) >> 1);
+		Sortable k;
+		if (p(*mid, *start))
+			{ k = *mid; *mid = *start; *start = k; }
+		if (p(*end, *mid))
+			{
+			k = *end; *end = *mid; *mid = k;
+			if (p(*mid, *start))
+				{ k = *mid; *mid = *start; *start = k; }
+			}
+		Sortable m = *mid;
+
+		// *start <= m <= *end, so neither scan can leave the range
+		Sortable * i = start + 1;
+		Sortable * j = end - 1;
+		while (i <= j)
+			{
+			while (p(*i, m))
+				i++;
+			while (p(m, *j))
+				j--;
+			if (i <= j)
+				{
+				k = *i; *i = *j; *j = k;
+				i++;
+				j--;
+				}
+			}
+
+		// recurse into the smaller part, iterate on the larger one
+		if (j - start < end - i)
+			{
+			NxIntroSortLoop(start, j, depth, p);
+			start = i;
+			}
+		else
+			{
+			NxIntroSortLoop(i, end, depth, p);
+			end = j;
+			}
+		}
+	}
+
+/**
+\brief Sorts the range [start, end] with introsort: a median of three quicksort that switches
+to heap sort when the recursion gets deeper than 2*log2(n), and to insertion sort for short ranges.
+
+Unlike #NxQuickSort this is O(n log n) in the worst case and never recurses deeper than log2(n),
+so it is safe on sorted, reversed and adversarial input. Not stable.
+
+Called exactly like #NxQuickSort:
+
+NxIntroSort<SortElem, SortElemCompareDirect>(&sortVector[0], &sortVector[sortVector.size()-1]);
+
+@see NxQuickSort NxRadixSort NxParallelSort
+*/
+template<class Sortable, class Predicate>
+inline void NxIntroSort(Sortable * start, Sortable * end)
+	{
+	static Predicate p;
+	if (end <= start)
+		return;
+
+	NxU32 depth = 0;
+	for (size_t n = size_t(end - start) + 1; n > 1; n >>= 1)
+		depth += 2;
+
+	NxIntroSortLoop(start, end, depth, p);
+	NxInsertionSort(start, end, p);
+	}
+
+/**
+\brief Maps a key to an unsigned integer with the same order, for #NxRadixSort.
+*/
+NX_INLINE NxU32 NxRadixKey(NxU32 key)
+	{
+	return key;
+	}
+
+/**
+\brief Maps a signed key to an unsigned integer with the same order, for #NxRadixSort.
+*/
+NX_INLINE NxU32 NxRadixKey(NxI32 key)
+	{
+	return NxU32(key) ^ 0x80000000;
+	}
+
+/**
+\brief Maps a float key to an unsigned integer with the same order, for #NxRadixSort.
+
+Negative numbers get all bits flipped, positive numbers only the sign bit. -0 sorts before +0
+and NaNs sort after +infinity (or before -infinity when their sign bit is set).
+*/
+NX_INLINE NxU32 NxRadixKey(NxF32 key)
+	{
+	union { NxF32 f; NxU32 u; } c;
+	c.f = key;
+	return c.u ^ ((c.u & 0x80000000) ? 0xffffffff : 0x80000000);
+	}
+
+/**
+\brief LSD radix sort of an index permutation.
+
+Writes to indices the permutation that sorts keys in ascending order, that is keys[indices[0]] is
+the smallest key. Equal keys keep their input order. Keys can be NxU32, NxI32 or NxF32.
+
+Sorts 8 bits per pass. The histograms of all four passes are built in a single sweep over
+the keys, and passes in which all keys share the same byte are skipped.
+
+\param[in] keys The keys to sort.
+\param[in] count Number of keys.
+\param[out] indices Receives count indices.
+\param[in] scratch Temporary memory for count indices.
+
+@see NxRadixSort
+*/
+template<class Key>
+inline void NxRadixSortIndices(const Key * keys, NxU32 count, NxU32 * indices, NxU32 * scratch)
+	{
+	NxU32 histogram[4][256];
+	for (NxU32 b = 0; b < 4; b++)
+		for (NxU32 i = 0; i < 256; i++)
+			histogram[b][i] = 0;
+
+	for (NxU32 i = 0; i < count; i++)
+		{
+		const NxU32 k = NxRadixKey(keys[i]);
+		histogram[0][k & 0xff]++;
+		histogram[1][(k >> 8) & 0xff]++;
+		histogram[2][(k >> 16) & 0xff]++;
+		histogram[3][k >> 24]++;
+		}
+
+	NxU32 * src = scratch;
+	NxU32 * dst = indices;
+	bool identity = true;
+
+	for (NxU32 b = 0; b < 4; b++)
+		{
+		const NxU32 shift = b * 8;
+		NxU32 * h = histogram[b];
+
+		// all keys in one bucket, this byte does not change the order
+		if (count && h[(NxRadixKey(keys[0]) >> shift) & 0xff] == count)
+			continue;
+
+		// bucket counts to offsets
+		NxU32 offset = 0;
+		for (NxU32 i = 0; i < 256; i++)
+			{
+			const NxU32 c = h[i];
+			h[i] = offset;
+			offset += c;
+			}
+
+		// scatter, identity permutation on the first pass that runs
+		if (identity)
+			{
+			for (NxU32 i = 0; i < count; i++)
+				dst[h[(NxRadixKey(keys[i]) >> shift) & 0xff]++] = i;
+			identity = false;
+			}
+		else
+			{
+			for (NxU32 i = 0; i < count; i++)
+				{
+				const NxU32 id = src[i];
+				dst[h[(NxRadixKey(keys[id]) >> shift) & 0xff]++] = id;
+				}
+			}
+
+		NxU32 * t = src;
+		src = dst;
+		dst = t;
+		}
+
+	// after the last swap src holds the result
+	if (identity)
+		{
+		for (NxU32 i = 0; i < count; i++)
+			indices[i] = i;
+		}
+	else if (src != indices)
+		{
+		for (NxU32 i = 0; i < count; i++)
+			indices[i] = src[i];
+		}
+	}
+
+/**
+\brief Sorts the range [start, end] with an LSD radix sort on a key extracted from each element.
+
+Same call shape as #NxQuickSort, but instead of a predicate KeyExtractor returns the key of an
+element, as an NxU32, NxI32 or NxF32:
+
+class ContactKey
+	{
+	public:
+	inline NxF32 operator () (const Contact & c)
+		{
+		return c.separation;
+		}
+	};
+
+NxRadixSort<Contact, ContactKey>(&contacts[0], &contacts[contacts.size()-1]);
+
+Each key is extracted once. The sort is stable and O(n) in every case, but needs temporary
+memory for the keys, two index arrays and a copy of the elements. Use #NxRadixSortIndices
+directly to sort a permutation without moving the elements.
+
+@see NxRadixSortIndices NxIntroSort
+*/
+template<class Sortable, class KeyExtractor>
+inline void NxRadixSort(Sortable * start, Sortable * end)
+	{
+	static KeyExtractor e;
+	if (end <= start)
+		return;
+
+	const NxU32 count = NxU32(end - start) + 1;
+	NxArray<NxU32> keys(count);
+	NxArray<NxU32> indices(count);
+	NxArray<NxU32> scratch(count);
+	for (NxU32 i = 0; i < count; i++)
+		keys[i] = NxRadixKey(e(start[i]));
+
+	NxRadixSortIndices(&keys[0], count, &indices[0], &scratch[0]);
+
+	NxArray<Sortable> sorted;
+	sorted.reserve(count);
+	for (NxU32 i = 0; i < count; i++)
+		sorted.pushBack(start[indices[i]]);
+	for (NxU32 i = 0; i < count; i++)
+		start[i] = sorted[i];
+	}
+
+ /** @} */
+#endif
+//NVIDIACOPYRIGHTBEGIN
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010 NVIDIA Corporation
+// All rights reserved. www.nvidia.com
+///////////////////////////////////////////////////////////////////////////
+//NVIDIACOPYRIGHTEND
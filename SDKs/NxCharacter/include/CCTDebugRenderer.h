@@ -12,8 +12,55 @@
 #include "CCTAllocator.h"
 #include "NxArray.h"
 
+#include "NxControllerManager.h"
+
 struct NxExtendedBounds3;
 
+	// Debug buffer. Unbounded by default, otherwise allocated once and the oldest entries are overwritten when full.
+	template<class T>
+	class CCTDebugBuffer
+	{
+		public:
+											CCTDebugBuffer() : capacity(0), next(0), overwritten(0)	{}
+
+				void						setCapacity(NxU32 c)
+											{
+												items.clear();
+												items.reserve(c);
+												capacity	= c;
+												next		= 0;
+												overwritten	= 0;
+											}
+
+				void						clear()
+											{
+												items.clear();	// Preserves the memory
+												next		= 0;
+												overwritten	= 0;
+											}
+
+				void						pushBack(const T& item)
+											{
+												if(!capacity || items.size()<capacity)
+												{
+													items.pushBack(item);
+													return;
+												}
+												items[next] = item;
+												if(++next==capacity)	next = 0;
+												overwritten++;
+											}
+
+				NxU32						size()			const	{ return items.size();	}
+				const T*					begin()			const	{ return items.begin();	}
+				NxU32						getOverwritten()	const	{ return overwritten;	}
+		private:
+				NxArray<T, CCTAllocator>	items;
+				NxU32						capacity;
+				NxU32						next;
+				NxU32						overwritten;
+	};
+
 	class CCTDebugData
 	{
 		public:
@@ -21,6 +68,9 @@ struct NxExtendedBounds3;
 											~CCTDebugData();
 
 				void						clear();
+				void						setCapture(const NxControllerDebugCaptureDesc* desc);
+				bool						isCapturing()		const	{ return capturing;		}
+				bool						wantsCategory(NxU32 category)	const	{ return (categories & category)!=0;	}
 
 				NxU32						getNbPoints()		const	{ return pointsArray.size();		}
 				const NxDebugPoint*			getPoints()			const	{ return pointsArray.begin();		}
@@ -31,16 +81,34 @@ struct NxExtendedBounds3;
 				NxU32						getNbTriangles()	const	{ return trianglesArray.size();		}
 				const NxDebugTriangle*		getTriangles()		const	{ return trianglesArray.begin();	}
 
+				NxU32						getNbShapes()		const	{ return shapesArray.size();		}
+				const NxControllerDebugShape*	getShapes()		const	{ return shapesArray.begin();		}
+
+				// Lines for NxDebugRenderable: the recorded lines, plus the expanded shapes in capture mode
+				NxU32						getNbRenderLines();
+				const NxDebugLine*			getRenderLines();
+
 				void						addPoint	(const NxVec3& p, NxU32 color);
 				void						addLine		(const NxVec3& p0, const NxVec3& p1, NxU32 color);
 				void						addTriangle	(const NxVec3& p0, const NxVec3& p1, const NxVec3& p2, NxU32 color);
 				void						addOBB		(const NxBox& box, NxU32 color, bool renderFrame);
 				void						addAABB		(const NxBounds3& bounds, NxU32 color, bool renderFrame);
-				void						addAABB		(const NxExtendedBounds3& bounds, NxU32 color);
+				void						addAABB		(const NxExtendedBounds3& bounds, NxU32 color, NxU32 category=NX_CCT_DEBUG_ALL, const NxController* controller=NULL);
+				void						addCapsule	(const NxExtendedVec3& center, NxF32 radius, NxF32 height, NxU32 upAxis, NxU32 color, NxU32 category, const NxController* controller);
+
+				bool						save(const char* filename, NxU32 nbControllers, Controller** controllers)	const;
 		private:
-				NxArray<NxDebugPoint, CCTAllocator>		pointsArray;
-				NxArray<NxDebugLine, CCTAllocator>		linesArray;
-				NxArray<NxDebugTriangle, CCTAllocator>	trianglesArray;
+				void						expandShape(const NxControllerDebugShape& shape, NxArray<NxDebugLine, CCTAllocator>& lines)	const;
+
+				CCTDebugBuffer<NxDebugPoint>			pointsArray;
+				CCTDebugBuffer<NxDebugLine>				linesArray;
+				CCTDebugBuffer<NxDebugTriangle>			trianglesArray;
+				CCTDebugBuffer<NxControllerDebugShape>	shapesArray;
+				NxArray<NxDebugLine, CCTAllocator>		renderLines;	// Lines + expanded shapes, built on demand
+				NxU32									categories;
+				bool									capturing;
+				bool									expandShapes;
+				bool									renderLinesValid;
 	};
 
 #endif
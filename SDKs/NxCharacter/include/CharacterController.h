@@ -145,6 +145,7 @@
 
 	class NxGroupsMask;
 	class CCTDebugData;
+	class NxController;
 
 	class SweepTest
 	{
@@ -184,6 +185,7 @@
 
 //		private:
 				CCTDebugData*		debugData;
+				const NxController*	debugOwner;		// Recorded with the debug shapes
 				TriArray			mWorldTriangles;
 				TriArray			mWorldEdgeNormals;
 				IntArray			mEdgeFlags;
@@ -195,6 +197,18 @@
 				NxU32				mNbCachedT;
 				NxU32				mNbCachedEN;
 				NxU32				mNbCachedF;
+				// Down sweep of the first pass, reused by the slope mode. See MoveCharacter().
+				NxExtendedVec3		mDownPassEnd;
+				NxU32				mDownPassCollisions;
+				NxU32				mNbSweepIters;			// Loop iterations of the last DoSweepTest()
+				SweptContact		mDownPassHit;			// Its hit, reported again when reused. mGeom points to mDownPassHitGeom.
+				TouchedGeom			mDownPassHitGeom;
+				NxVec3				mDownPassHitDir;
+				NxF32				mDownPassHitLength;
+				bool				mDownPassHasHit;
+				bool				mDownPassMoved;
+				bool				mDownPassValidTri;
+				bool				mDownPassReusable;
 		public:
 #ifdef USE_CONTACT_NORMAL_FOR_SLOPE_TEST
 				NxVec3				mCN;
@@ -210,6 +224,7 @@
 				NxU32				mMaxIter;
 				bool				mHitNonWalkable;
 				bool				mWalkExperiment;
+				bool				mSlopeMode;		// Walk experiment pass re-solves side & down only, see Controller::move()
 				bool				mHandleSlope;
 				bool				mValidTri;
 				bool				mValidateCallback;
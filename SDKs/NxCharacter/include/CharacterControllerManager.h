@@ -24,6 +24,10 @@ public:
 	void				release();
 	NxDebugRenderable	getDebugData();
 	void				resetDebugData();
+	bool				setDebugCapture(const NxControllerDebugCaptureDesc* desc);
+	void				setDebugRendering(NxController& controller, bool enabled);
+	const NxControllerDebugShape*	getDebugShapes(NxU32& nbShapes)	const;
+	bool				saveDebugData(const char* filename);
 
 	void				printStats();
 
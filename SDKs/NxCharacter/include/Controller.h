@@ -50,12 +50,30 @@ class Controller
 			NxScene*					scene;				// Handy scene owner
 			CharacterControllerManager*	manager;			// Owner manager
 			bool						handleSlope;		// True to handle walkable parts according to slope
+			bool						debugRendering;		// False to leave this controller out of the manager's debug data
+
+	// Idle detection, see Controller::move()
+			NxVec3						idleDisp;			// Displacement of the last move, which left the controller in place
+			NxU32						idleActiveGroups;	// Its other inputs...
+			NxGroupsMask				idleGroupsMask;
+			NxF32						idleMinDist;
+			NxU32						idleFlags;			// ...and returned collision flags
+			NxU64						idleSignature;		// Surroundings after that move, see computeIdleSignature()
+			bool						idleUseGroupsMask;
+			bool						idleClimbingMode;
+			bool						idleValid;			// True when the idle data above describes the current state
+			bool						sleeping;			// True when the last move() was skipped
+
+			void						wakeUp()									{ idleValid = false;	}
 
 	protected:
 	// Internal methods
 			bool						setPos(const NxExtendedVec3& pos);
 			void						setCollision(bool enabled);
 			void						move(SweptVolume& volume, const NxVec3& disp, NxU32 activeGroups, NxF32 minDist, NxU32& collisionFlags, NxF32 sharpness, const NxGroupsMask* groupsMask, bool constrainedClimbingMode);
+			void						addDebugVolume()	const;
+			bool						isIdleMove(const NxVec3& disp, NxU32 activeGroups, NxF32 minDist, const NxGroupsMask* groupsMask, bool constrainedClimbingMode)	const;
+			NxU64						computeIdleSignature(NxU32 nbBoxes, const NxExtendedBounds3* boxes, NxU32 nbCapsules, const NxExtendedCapsule* capsules, NxU32 activeGroups, const NxGroupsMask* groupsMask)	const;
 			void						setInteraction(NxCCTInteractionFlag flag)	{ interactionFlag = flag;	}
 			NxCCTInteractionFlag		getInteraction()					const	{ return interactionFlag;	}
 	};
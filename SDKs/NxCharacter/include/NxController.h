@@ -355,6 +355,10 @@ NX_INLINE NxU32 NxControllerDesc::checkValid() const
 	\param groupsMask Alternative mask used to filter shapes, see NxScene::overlapAABBShapes().
 
 	\note If static actors in the scene have changed, call NxCharacter::reportSceneChanged() first.
+
+	\note A move with the same inputs as a previous move that left the controller in place is skipped, as long as no
+	dynamic shape or other controller has entered, left or moved around the controller. It returns the same collision
+	flags and reports no hits. Any other displacement, setPosition() or a change to the controller's settings wakes it up.
 	*/
 	virtual		void					move(const NxVec3& disp, NxU32 activeGroups, NxF32 minDist, NxU32& collisionFlags, NxF32 sharpness=1.0f, const NxGroupsMask* groupsMask=NULL)	= 0;
 
@@ -457,7 +461,8 @@ NX_INLINE NxU32 NxControllerDesc::checkValid() const
 	/**
 	\brief The character controller uses caching in order to speed up collision testing, 
 	this caching can not detect when static objects have changed in the scene. 
-	You need to call this method when such changes have been made.
+	You need to call this method when such changes have been made, or when shapes close to an idle controller
+	changed in other ways than by moving (e.g. new dimensions or collision groups).
 	*/
 	virtual		void					reportSceneChanged()			= 0;
 
@@ -13,6 +13,7 @@
 #include "Nxp.h"
 #include "NxArray.h"
 #include "NxDebugRenderable.h"
+#include "NxExtended.h"
 
 class NxScene;
 class Controller;
@@ -22,6 +23,77 @@ class NxControllerManager;
 class ControllerArray;
 
 
+/**
+\brief Categories of controller debug data, see NxControllerDebugCaptureDesc.categories.
+*/
+enum NxControllerDebugCategory
+	{
+	NX_CCT_DEBUG_CACHED_TBV		= (1<<0),	//!< Cached temporal bounding volumes, red when rebuilt and green when reused
+	NX_CCT_DEBUG_TEMPORAL_BOX	= (1<<1),	//!< Temporal bounding box of each sweep, in yellow
+	NX_CCT_DEBUG_VOLUMES		= (1<<2),	//!< Controller volumes at the end of each move, in white. Capture mode only.
+
+	NX_CCT_DEBUG_ALL			= 0xffffffff
+	};
+
+enum NxControllerDebugShapeType
+	{
+	NX_CCT_DEBUG_BOX,
+	NX_CCT_DEBUG_CAPSULE
+	};
+
+/**
+\brief Compact record of a box or capsule recorded in debug capture mode, for instanced rendering.
+
+@see NxControllerManager.getDebugShapes()
+*/
+struct NxControllerDebugShape
+	{
+	NxExtendedVec3					center;
+	NxVec3							extents;	//!< Box half-extents. For capsules: radius, half height of the segment, unused.
+	NxControllerDebugShapeType		type;
+	NxU32							upAxis;		//!< Capsule axis
+	NxU32							color;
+	NxU32							category;	//!< One of NxControllerDebugCategory
+	const NxController*				controller;	//!< Controller which recorded the shape
+	};
+
+/**
+\brief Descriptor for the debug capture mode.
+
+In capture mode debug data goes to buffers allocated once, with the given capacities. When a buffer is full the oldest
+entries are overwritten, so the cost per frame is bounded. Boxes and capsules are recorded as NxControllerDebugShape
+instead of lines.
+
+@see NxControllerManager.setDebugCapture()
+*/
+class NxControllerDebugCaptureDesc
+	{
+	public:
+	NxU32	maxPoints;			//!< Capacity of the point buffer
+	NxU32	maxLines;			//!< Capacity of the line buffer
+	NxU32	maxTriangles;		//!< Capacity of the triangle buffer
+	NxU32	maxShapes;			//!< Capacity of the shape buffer
+	NxU32	categories;			//!< Recorded categories, combination of NxControllerDebugCategory
+	bool	expandShapes;		//!< Also return the shapes as lines from getDebugData(), for renderers without instancing
+
+	NX_INLINE	NxControllerDebugCaptureDesc()	{ setToDefault();	}
+
+	NX_INLINE	void	setToDefault()
+		{
+		maxPoints		= 1024;
+		maxLines		= 4096;
+		maxTriangles	= 1024;
+		maxShapes		= 1024;
+		categories		= NX_CCT_DEBUG_ALL;
+		expandShapes	= true;
+		}
+
+	NX_INLINE	bool	isValid()	const
+		{
+		return maxPoints && maxLines && maxTriangles && maxShapes;
+		}
+	};
+
 NX_C_EXPORT NXCHARACTER_API NxControllerManager* NX_CALL_CONV NxCreateControllerManager(NxUserAllocator* allocator);
 NX_C_EXPORT NXCHARACTER_API void NX_CALL_CONV NxReleaseControllerManager(NxControllerManager* manager);
 
@@ -87,6 +159,38 @@ public:
 	*/
 	virtual	void				resetDebugData()	= 0;
 
+	/**
+	\brief Switches debug data to capture mode, or back to the default unbounded mode when desc is NULL.
+	Recorded data is discarded. Debug rendering is enabled as with getDebugData().
+
+	\return False if the descriptor is invalid.
+
+	@see NxControllerDebugCaptureDesc
+	*/
+	virtual	bool				setDebugCapture(const NxControllerDebugCaptureDesc* desc)	= 0;
+
+	/**
+	\brief Enables or disables debug data for one controller. All controllers are enabled by default.
+	*/
+	virtual	void				setDebugRendering(NxController& controller, bool enabled)	= 0;
+
+	/**
+	\brief Retrieves the shapes recorded in capture mode.
+
+	\param[out] nbShapes The number of shapes.
+	\return The shapes, in no particular order.
+	*/
+	virtual	const NxControllerDebugShape*	getDebugShapes(NxU32& nbShapes)	const	= 0;
+
+	/**
+	\brief Writes all recorded debug data to a binary file for offline viewing, at full precision. The file also
+	records how many entries were overwritten in capture mode.
+
+	\param[in] filename Name of the file to create.
+	\return False if the file can't be written.
+	*/
+	virtual	bool				saveDebugData(const char* filename)	= 0;
+
 protected:
 	NxControllerManager() {}
 	virtual ~NxControllerManager() {}
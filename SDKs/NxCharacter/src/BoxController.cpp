@@ -72,6 +72,7 @@ BoxController::~BoxController()
 
 void BoxController::reportSceneChanged()
 	{
+	wakeUp();
 	cctModule.VoidTestCache();
 	}
 
@@ -94,6 +95,7 @@ const NxVec3& BoxController::getExtents() const
 
 bool BoxController::setExtents(const NxVec3& e)
 	{
+	wakeUp();
 	extents	= e;
 	if(kineActor)
 		{
@@ -109,6 +111,7 @@ bool BoxController::setExtents(const NxVec3& e)
 
 void BoxController::setStepOffset(const float offset)
 	{
+	wakeUp();
     stepOffset = offset;
 	}
 
@@ -8,8 +8,13 @@
 
 #include "CCTDebugRenderer.h"
 #include "NxExtended.h"
+#include "Controller.h"
+#include <stdio.h>
 
-CCTDebugData::CCTDebugData()
+// Controller volumes are drawn by every move, so the default unbounded mode leaves them out. Only a capture asks for them.
+static const NxU32 gDefaultCategories = NX_CCT_DEBUG_ALL & ~NX_CCT_DEBUG_VOLUMES;
+
+CCTDebugData::CCTDebugData() : categories(gDefaultCategories), capturing(false), expandShapes(true), renderLinesValid(false)
 {
 }
 
@@ -22,6 +27,23 @@ void CCTDebugData::clear()
 	pointsArray.clear();
 	linesArray.clear();
 	trianglesArray.clear();
+	shapesArray.clear();
+	renderLinesValid = false;
+}
+
+void CCTDebugData::setCapture(const NxControllerDebugCaptureDesc* desc)
+{
+	capturing			= desc!=NULL;
+	renderLinesValid	= false;
+	renderLines.clear();
+
+	// The default mode has no capacity limit
+	pointsArray.setCapacity(desc ? desc->maxPoints : 0);
+	linesArray.setCapacity(desc ? desc->maxLines : 0);
+	trianglesArray.setCapacity(desc ? desc->maxTriangles : 0);
+	shapesArray.setCapacity(desc ? desc->maxShapes : 0);
+	categories			= desc ? desc->categories : gDefaultCategories;
+	expandShapes		= desc ? desc->expandShapes : true;
 }
 
 void CCTDebugData::addPoint(const NxVec3& p, NxU32 color)
@@ -30,6 +52,7 @@ void CCTDebugData::addPoint(const NxVec3& p, NxU32 color)
 	tmp.p		= p;
 	tmp.color	= color;
 	pointsArray.pushBack(tmp);
+	renderLinesValid = false;
 }
 
 void CCTDebugData::addLine(const NxVec3& p0, const NxVec3& p1, NxU32 color)
@@ -39,6 +62,7 @@ void CCTDebugData::addLine(const NxVec3& p0, const NxVec3& p1, NxU32 color)
 	tmp.p1		= p1;
 	tmp.color	= color;
 	linesArray.pushBack(tmp);
+	renderLinesValid = false;
 }
 
 void CCTDebugData::addTriangle(const NxVec3& p0, const NxVec3& p1, const NxVec3& p2, NxU32 color)
@@ -161,15 +185,205 @@ void CCTDebugData::addAABB(const NxBounds3& bounds, NxU32 color, bool renderFram
 	addOBB(NxBox(center, extents, id), color, renderFrame);
 }
 
-void CCTDebugData::addAABB(const NxExtendedBounds3& bounds, NxU32 color)
+void CCTDebugData::addAABB(const NxExtendedBounds3& bounds, NxU32 color, NxU32 category, const NxController* controller)
 {
+	if(!wantsCategory(category))
+		return;
+
 	NxExtendedVec3 center;
 	NxVec3 extents;
 	bounds.getCenter(center);
 	bounds.getExtents(extents);
 
+	if(capturing)
+	{
+		NxControllerDebugShape tmp;
+		tmp.center		= center;
+		tmp.extents		= extents;
+		tmp.type		= NX_CCT_DEBUG_BOX;
+		tmp.upAxis		= 0;
+		tmp.color		= color;
+		tmp.category	= category;
+		tmp.controller	= controller;
+		shapesArray.pushBack(tmp);
+		renderLinesValid = false;
+		return;
+	}
+
 	NxBounds3 tmp;
 	tmp.setCenterExtents(NxVec3((float)center.x, (float)center.y, (float)center.z), extents);
 
 	addAABB(tmp, color, false);
 }
+
+void CCTDebugData::addCapsule(const NxExtendedVec3& center, NxF32 radius, NxF32 height, NxU32 upAxis, NxU32 color, NxU32 category, const NxController* controller)
+{
+	if(!wantsCategory(category))
+		return;
+
+	NxControllerDebugShape tmp;
+	tmp.center		= center;
+	tmp.extents		= NxVec3(radius, height*0.5f, 0.0f);
+	tmp.type		= NX_CCT_DEBUG_CAPSULE;
+	tmp.upAxis		= upAxis;
+	tmp.color		= color;
+	tmp.category	= category;
+	tmp.controller	= controller;
+
+	if(capturing)
+	{
+		shapesArray.pushBack(tmp);
+		renderLinesValid = false;
+		return;
+	}
+
+	// Default mode: lines right away. The render line array is unused in this mode and serves as scratch memory.
+	renderLines.clear();
+	expandShape(tmp, renderLines);
+	for(NxU32 i=0;i<renderLines.size();i++)
+		linesArray.pushBack(renderLines[i]);
+	renderLinesValid = false;
+}
+
+#define CAPSULE_SEGMENTS	16
+
+void CCTDebugData::expandShape(const NxControllerDebugShape& shape, NxArray<NxDebugLine, CCTAllocator>& lines) const
+{
+	NxDebugLine line;
+	line.color = shape.color;
+
+	const NxVec3 center((float)shape.center.x, (float)shape.center.y, (float)shape.center.z);	// LOSS OF ACCURACY
+
+	if(shape.type==NX_CCT_DEBUG_BOX)
+	{
+		NxVec3 pp[8];
+		NxMat33 id;	id.id();
+		computeBoxPoints(NxBox(center, shape.extents, id), pp);
+
+		const NxU32* Indices = getBoxEdges();
+		for(NxU32 i=0;i<12;i++)
+		{
+			line.p0 = pp[*Indices++];
+			line.p1 = pp[*Indices++];
+			lines.pushBack(line);
+		}
+		return;
+	}
+
+	// Capsule: a circle around each end of the segment, four lines joining them, and two arcs over each cap
+	const NxF32 radius = shape.extents.x;
+	NxVec3 up(0.0f, 0.0f, 0.0f);	up[shape.upAxis] = shape.extents.y;
+	NxVec3 axis0(0.0f, 0.0f, 0.0f);	axis0[(shape.upAxis+1)%3] = radius;
+	NxVec3 axis1(0.0f, 0.0f, 0.0f);	axis1[(shape.upAxis+2)%3] = radius;
+	NxVec3 capUp(0.0f, 0.0f, 0.0f);	capUp[shape.upAxis] = radius;
+
+	const NxF32 step = NxTwoPiF32 / NxF32(CAPSULE_SEGMENTS);
+	for(NxU32 i=0;i<CAPSULE_SEGMENTS;i++)
+	{
+		const NxF32 a0 = step * NxF32(i);
+		const NxF32 a1 = step * NxF32(i+1);
+		const NxVec3 r0 = axis0 * NxMath::cos(a0) + axis1 * NxMath::sin(a0);
+		const NxVec3 r1 = axis0 * NxMath::cos(a1) + axis1 * NxMath::sin(a1);
+
+		line.p0 = center + up + r0;	line.p1 = center + up + r1;	lines.pushBack(line);
+		line.p0 = center - up + r0;	line.p1 = center - up + r1;	lines.pushBack(line);
+		if((i % (CAPSULE_SEGMENTS/4))==0)
+		{
+			line.p0 = center + up + r0;	line.p1 = center - up + r0;	lines.pushBack(line);
+		}
+
+		// Arcs: half circles in the two vertical planes, over the top and under the bottom
+		if(i<CAPSULE_SEGMENTS/2)
+		{
+			const NxF32 c0 = NxMath::cos(a0), s0 = NxMath::sin(a0);
+			const NxF32 c1 = NxMath::cos(a1), s1 = NxMath::sin(a1);
+			line.p0 = center + up + axis0*c0 + capUp*s0;	line.p1 = center + up + axis0*c1 + capUp*s1;	lines.pushBack(line);
+			line.p0 = center + up + axis1*c0 + capUp*s0;	line.p1 = center + up + axis1*c1 + capUp*s1;	lines.pushBack(line);
+			line.p0 = center - up + axis0*c0 - capUp*s0;	line.p1 = center - up + axis0*c1 - capUp*s1;	lines.pushBack(line);
+			line.p0 = center - up + axis1*c0 - capUp*s0;	line.p1 = center - up + axis1*c1 - capUp*s1;	lines.pushBack(line);
+		}
+	}
+}
+
+NxU32 CCTDebugData::getNbRenderLines()
+{
+	if(!capturing || !expandShapes)
+		return linesArray.size();
+	return getRenderLines() ? renderLines.size() : 0;
+}
+
+const NxDebugLine* CCTDebugData::getRenderLines()
+{
+	if(!capturing || !expandShapes)
+		return linesArray.begin();
+
+	// Shapes are expanded once per frame here, rather than every time one is recorded
+	if(!renderLinesValid)
+	{
+		renderLines.clear();
+		const NxDebugLine* lines = linesArray.begin();
+		for(NxU32 i=0;i<linesArray.size();i++)
+			renderLines.pushBack(lines[i]);
+
+		const NxControllerDebugShape* shapes = shapesArray.begin();
+		for(NxU32 i=0;i<shapesArray.size();i++)
+			expandShape(shapes[i], renderLines);
+		renderLinesValid = true;
+	}
+	return renderLines.begin();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Dump format, native endianness:
+//	header:		'CCTD', version, sizeof(Extended)
+//				nb points, lines, triangles, shapes
+//				nb overwritten points, lines, triangles, shapes (capture mode)
+//	data:		NxDebugPoint[], NxDebugLine[], NxDebugTriangle[] as in memory
+//				shapes field by field: center (Extended x3), extents (float x3), type, upAxis, color, category,
+//				controller index in the manager (0xffffffff if unknown)
+#define CCT_DEBUG_DUMP_VERSION	1
+
+bool CCTDebugData::save(const char* filename, NxU32 nbControllers, Controller** controllers) const
+{
+	FILE* fp = fopen(filename, "wb");
+	if(!fp)
+		return false;
+
+	const NxU32 header[] = {
+		('C'<<24)|('C'<<16)|('T'<<8)|'D', CCT_DEBUG_DUMP_VERSION, sizeof(Extended),
+		pointsArray.size(), linesArray.size(), trianglesArray.size(), shapesArray.size(),
+		pointsArray.getOverwritten(), linesArray.getOverwritten(), trianglesArray.getOverwritten(), shapesArray.getOverwritten()
+	};
+	bool ok = fwrite(header, sizeof(header), 1, fp)==1;
+
+	if(ok && pointsArray.size())	ok = fwrite(pointsArray.begin(), sizeof(NxDebugPoint), pointsArray.size(), fp)==pointsArray.size();
+	if(ok && linesArray.size())		ok = fwrite(linesArray.begin(), sizeof(NxDebugLine), linesArray.size(), fp)==linesArray.size();
+	if(ok && trianglesArray.size())	ok = fwrite(trianglesArray.begin(), sizeof(NxDebugTriangle), trianglesArray.size(), fp)==trianglesArray.size();
+
+	const NxControllerDebugShape* shapes = shapesArray.begin();
+	for(NxU32 i=0;ok && i<shapesArray.size();i++)
+	{
+		const NxControllerDebugShape& S = shapes[i];
+		NxU32 index = 0xffffffff;
+		for(NxU32 j=0;j<nbControllers;j++)
+		{
+			if(controllers[j]->getNxController()==S.controller)
+			{
+				index = j;
+				break;
+			}
+		}
+
+		const Extended center[3] = { S.center.x, S.center.y, S.center.z };
+		const NxF32 extents[3] = { S.extents.x, S.extents.y, S.extents.z };
+		const NxU32 data[5] = { NxU32(S.type), S.upAxis, S.color, S.category, index };
+		ok =	fwrite(center, sizeof(center), 1, fp)==1
+			&&	fwrite(extents, sizeof(extents), 1, fp)==1
+			&&	fwrite(data, sizeof(data), 1, fp)==1;
+	}
+
+	if(fclose(fp)!=0)
+		ok = false;
+	return ok;
+}
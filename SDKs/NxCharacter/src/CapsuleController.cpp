@@ -67,6 +67,7 @@ CapsuleController::~CapsuleController()
 
 void CapsuleController::reportSceneChanged()
 	{
+	wakeUp();
 	cctModule.VoidTestCache();
 	}
 
@@ -97,6 +98,7 @@ NxF32 CapsuleController::getHeight() const
 
 bool CapsuleController::setRadius(NxF32 r)
 	{
+	wakeUp();
 	radius	= r;
 	if(kineActor)
 		{
@@ -112,6 +114,7 @@ bool CapsuleController::setRadius(NxF32 r)
 
 bool CapsuleController::setHeight(NxF32 h)
 	{
+	wakeUp();
 	height	= h;
 	if(kineActor)
 		{
@@ -127,6 +130,7 @@ bool CapsuleController::setHeight(NxF32 h)
 
 void CapsuleController::setStepOffset(const float offset)
 	{
+	wakeUp();
     stepOffset = offset;
 	}
 
@@ -139,6 +143,7 @@ NxCapsuleClimbingMode CapsuleController::getClimbingMode() const
 
 bool CapsuleController::setClimbingMode(NxCapsuleClimbingMode mode)
 	{
+	wakeUp();
 	if(mode>=CLIMB_LAST)
 		return false;
 	climbingMode = mode;
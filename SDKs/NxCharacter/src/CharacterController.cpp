@@ -23,6 +23,14 @@ static NxUtilLib* gUtilLib = NULL;
 
 #define	MAX_ITER	10
 
+// Regression harness for the slope mode of Controller::move(): every second pass is redone the former way
+// and compared. Mismatches assert, and are counted in CharacterControllerManager::printStats().
+//#define CHECK_SLOPE_MODE
+
+// Idle controllers: a move which repeats the inputs of a previous move that left the controller in place is skipped, as
+// long as nothing dynamic has changed around the controller. Comment out to always run the full move.
+#define USE_IDLE_DETECTION
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	NX_INLINE void CollisionResponse(NxExtendedVec3& target_position, const NxExtendedVec3& current_position, const NxVec3& current_dir, const NxVec3& hit_normal, NxF32 bump, NxF32 friction, bool normalize=false)
@@ -621,6 +629,7 @@ static bool CollideGeoms(const SweepTest* sweep_test, const SweptVolume& volume,
 
 SweepTest::SweepTest() :
 	debugData			(NULL),
+	debugOwner			(NULL),
 	mValidTri			(false),
 	mValidateCallback	(false),
 	mNormalizeResponse	(false)
@@ -632,6 +641,14 @@ SweepTest::SweepTest() :
 	mNbCachedT		= 0;
 	mNbCachedEN		= 0;
 	mNbCachedF		= 0;
+	mDownPassEnd.zero();
+	mDownPassCollisions	= 0;
+	mNbSweepIters		= 0;
+	mDownPassHitLength	= 0.0f;
+	mDownPassHasHit		= false;
+	mDownPassMoved		= false;
+	mDownPassValidTri	= false;
+	mDownPassReusable	= false;
 	mHandleSlope	= false;
 	mSlopeLimit		= 0.0f;
 	mSkinWidth		= 0.0f;
@@ -642,6 +659,7 @@ SweepTest::SweepTest() :
 //	mVolumeGrowth	= 2.0f;	// Must be >1.0f and not too big
 	mHitNonWalkable	= false;
 	mWalkExperiment	= false;
+	mSlopeMode		= false;
 	mMaxIter		= MAX_ITER;
 	mFirstUpdate	= false;
 }
@@ -711,6 +729,11 @@ void SweepTest::FindTouchedCCTs(	NxU32 nb_boxes, const NxExtendedBounds3* boxes,
 static NxU32 gNbIters = 0;
 static NxU32 gNbFullUpdates = 0;
 static NxU32 gNbPartialUpdates = 0;
+static NxU32 gNbSlopePasses = 0;
+static NxU32 gNbSlopeReusedDownPasses = 0;
+static NxU32 gNbSlopeMismatches = 0;
+static NxU32 gNbIdleMoves = 0;
+static NxU32 gNbIdleWakeUps = 0;
 
 void SweepTest::UpdateTouchedGeoms(	void* user_data, const SweptVolume& swept_volume,
 									NxU32 nb_boxes, const NxExtendedBounds3* boxes, const void** box_user_data,
@@ -813,8 +836,8 @@ void SweepTest::UpdateTouchedGeoms(	void* user_data, const SweptVolume& swept_vo
 
 	if(debugData)
 	{
-		debugData->addAABB(mCachedTBV, NewCachedBox ? NX_ARGB_RED : NX_ARGB_GREEN);
-		debugData->addAABB(world_box, NX_ARGB_YELLOW);
+		debugData->addAABB(mCachedTBV, NewCachedBox ? NX_ARGB_RED : NX_ARGB_GREEN, NX_CCT_DEBUG_CACHED_TBV, debugOwner);
+		debugData->addAABB(world_box, NX_ARGB_YELLOW, NX_CCT_DEBUG_TEMPORAL_BOX, debugOwner);
 	}
 }
 
@@ -829,6 +852,7 @@ bool SweepTest::DoSweepTest(void* user_data,
 {
 	// Early exit when motion is zero. Since the motion is decomposed into several vectors
 	// and this function is called for each of them, it actually happens quite often.
+	mNbSweepIters = 0;
 	if(direction.isZero())
 		return false;
 
@@ -843,6 +867,7 @@ bool SweepTest::DoSweepTest(void* user_data,
 	while(max_iter--)
 	{
 		gNbIters++;
+		mNbSweepIters++;
 		// Compute current direction
 		NxVec3 CurrentDirection = TargetPosition - CurrentPosition;
 
@@ -919,6 +944,18 @@ bool SweepTest::DoSweepTest(void* user_data,
 			}
 		}
 
+		// Keep the first pass' down hit, the slope mode reports it again if it reuses that sweep. The geom is copied,
+		// the second pass' side sweep may gather the geoms again.
+		if(down_pass && !mWalkExperiment)
+		{
+			mDownPassHitGeom	= *C.mGeom;
+			mDownPassHit		= C;
+			mDownPassHit.mGeom	= &mDownPassHitGeom;
+			mDownPassHitDir		= CurrentDirection;
+			mDownPassHitLength	= Length;
+			mDownPassHasHit		= true;
+		}
+
 		NbCollisions++;
 		mContactPointHeight = (float)C.mWorldPos[mUpDirection];	// UBI
 
@@ -1006,7 +1043,10 @@ void SweepTest::MoveCharacter(
 		UpVector[mUpDirection] += StepOffset;
 
 	// ==========[ Initial volume query ]===========================
-	if(1)
+	// In slope mode the first pass already gathered the geometry around the same start position.
+	if(!mWalkExperiment)
+		mDownPassReusable = false;
+	if(!(mWalkExperiment && mSlopeMode))
 	{
 		NxVec3 MotionExtents = UpVector;
 		MotionExtents.max(SideVector);
@@ -1096,11 +1136,46 @@ void SweepTest::MoveCharacter(
 
 		// min_dist actually makes a big difference :(
 		// AAARRRGGH: if we get culled because of min_dist here, mValidTri never becomes valid!
-		if(DoSweepTest(user_data,
-			user_data2,
-			nb_boxes, boxes, box_user_data,
-			nb_capsules, capsules, capsule_user_data,
-			volume, DownVector, MaxIterDown, &NbCollisions, groups, min_dist, groupsMask, true))
+		bool DownMoved;
+		if(mWalkExperiment && mSlopeMode && mDownPassReusable)
+		{
+			// Slope mode: the first pass did this very sweep. Up and side motions were zero, so it started from the
+			// same position, and it stopped after one iteration, so the walk experiment's flattened normals could not
+			// have changed it. Its hit is reported again, as the full second pass would.
+			volume.mCenter	= mDownPassEnd;
+			NbCollisions	= mDownPassCollisions;
+			DownMoved		= mDownPassMoved;
+			mValidTri		= mDownPassValidTri;	// mTouched & mContactPointHeight are still the first pass' ones
+			if(mDownPassHasHit && mValidateCallback)
+			{
+				if(mDownPassHitGeom.mType==TOUCHED_USER_BOX || mDownPassHitGeom.mType==TOUCHED_USER_CAPSULE)
+					UserHitCallback(user_data2, mDownPassHit, mDownPassHitDir, mDownPassHitLength);
+				else
+					ShapeHitCallback(user_data2, mDownPassHit, mDownPassHitDir, mDownPassHitLength);
+			}
+			gNbSlopeReusedDownPasses++;
+		}
+		else
+		{
+			if(!mWalkExperiment)
+				mDownPassHasHit = false;
+			DownMoved = DoSweepTest(user_data,
+				user_data2,
+				nb_boxes, boxes, box_user_data,
+				nb_capsules, capsules, capsule_user_data,
+				volume, DownVector, MaxIterDown, &NbCollisions, groups, min_dist, groupsMask, true);
+
+			if(!mWalkExperiment)
+			{
+				mDownPassEnd		= volume.mCenter;
+				mDownPassCollisions	= NbCollisions;
+				mDownPassMoved		= DownMoved;
+				mDownPassValidTri	= mValidTri;
+				mDownPassReusable	= UpVector.isZero() && SideVector.isZero() && mNbSweepIters<=1;
+			}
+		}
+
+		if(DownMoved)
 		{
 			if(NbCollisions)
 			{
@@ -1213,7 +1288,8 @@ void Controller::move(SweptVolume& volume, const NxVec3& disp, NxU32 activeGroup
 	SweepTest* ST = &cctModule;
 
 	// Init CCT with per-controller settings
-	ST->debugData		= manager->debugData;
+	ST->debugData		= debugRendering ? manager->debugData : NULL;
+	ST->debugOwner		= getNxController();
 	ST->mSkinWidth		= skinWidth;
 	ST->mStepOffset		= stepOffset;
 	ST->mUpDirection	= upDirection;
@@ -1287,6 +1363,32 @@ void Controller::move(SweptVolume& volume, const NxVec3& disp, NxU32 activeGroup
 
 	///////////
 
+#ifdef USE_IDLE_DETECTION
+	// Skip the move if it would leave the controller in place again. Negative sharpness (query mode) always runs.
+	const bool idleCandidate = sharpness>=0.0f && isIdleMove(disp, activeGroups, minDist, groupsMask, constrainedClimbingMode);
+	if(idleCandidate)
+		{
+		NxExtendedBounds3 worldBox;
+		getWorldBox(worldBox);
+		if(worldBox.isInside(ST->mCachedTBV) && computeIdleSignature(nbBoxes, boxes, nbCapsules, capsules, activeGroups, groupsMask)==idleSignature)
+			{
+			gNbIdleMoves++;
+			sleeping = true;
+			collisionFlags = idleFlags;
+
+			// The filter still has to converge, since the controller may have just stepped up or down
+			filteredPosition = position;
+			if(sharpness<1.0f)
+				filteredPosition[upDirection] = feedbackFilter(position[upDirection], memory, sharpness);
+			addDebugVolume();
+			return;
+			}
+		gNbIdleWakeUps++;
+		}
+	sleeping = false;
+	idleValid = false;
+#endif
+
 	ST->mWalkExperiment = false;
 
 	NxExtendedVec3 Backup = volume.mCenter;
@@ -1299,8 +1401,26 @@ void Controller::move(SweptVolume& volume, const NxVec3& disp, NxU32 activeGroup
 
 	if(ST->mHitNonWalkable)
 		{
-		// A bit slow, but everything else I tried was less convincing...
+		// Second pass in slope mode: the walk experiment skips the up motion, so only the side and down motions are
+		// re-solved, against the geometry gathered by the first pass. For a pure down motion (e.g. standing on a steep
+		// slope under gravity) the first pass' down sweep is reused as well. Final positions are meant to be the same
+		// as with a full second pass, see CHECK_SLOPE_MODE.
+		gNbSlopePasses++;
 		ST->mWalkExperiment = true;
+		ST->mSlopeMode = true;
+		volume.mCenter = Backup;
+		ST->MoveCharacter(scene,
+			(Controller*)this,
+			volume, disp,
+			nbBoxes, nbBoxes ? boxes : NULL, nbBoxes ? (const void**)boxUserData : NULL,
+			nbCapsules, nbCapsules ? capsules : NULL, nbCapsules ? (const void**)capsuleUserData : NULL,
+			activeGroups, minDist, collisionFlags, groupsMask, constrainedClimbingMode);
+		ST->mSlopeMode = false;
+
+#ifdef CHECK_SLOPE_MODE
+		// Regression check: redo the full second pass and compare. Hits get reported twice in this mode.
+		const NxExtendedVec3 SlopeCenter = volume.mCenter;
+		const NxU32 SlopeFlags = collisionFlags;
 		volume.mCenter = Backup;
 		ST->MoveCharacter(scene,
 			(Controller*)this,
@@ -1308,6 +1428,14 @@ void Controller::move(SweptVolume& volume, const NxVec3& disp, NxU32 activeGroup
 			nbBoxes, nbBoxes ? boxes : NULL, nbBoxes ? (const void**)boxUserData : NULL,
 			nbCapsules, nbCapsules ? capsules : NULL, nbCapsules ? (const void**)capsuleUserData : NULL,
 			activeGroups, minDist, collisionFlags, groupsMask, constrainedClimbingMode);
+		if(volume.mCenter[0]!=SlopeCenter[0] || volume.mCenter[1]!=SlopeCenter[1] || volume.mCenter[2]!=SlopeCenter[2] || collisionFlags!=SlopeFlags)
+			{
+			NX_ASSERT(!"Slope mode diverged from the full second pass");
+			gNbSlopeMismatches++;
+			}
+		volume.mCenter = SlopeCenter;
+		collisionFlags = SlopeFlags;
+#endif
 		ST->mWalkExperiment = false;
 		}
 
@@ -1326,6 +1454,24 @@ volume.mCenter = Backup;
 			kineActor->moveGlobalPosition(NxVec3((float)position.x, (float)position.y, (float)position.z));
 		}
 
+#ifdef USE_IDLE_DETECTION
+	// Record the move if it left the controller exactly in place (fully blocked, or below minDist), so that the next
+	// identical one can be skipped. A move which crept by any amount isn't recorded, the next one has to creep as well.
+	if(sharpness>=0.0f && deltaM2==0.0f)
+		{
+		idleDisp			= disp;
+		idleActiveGroups	= activeGroups;
+		idleMinDist			= minDist;
+		idleUseGroupsMask	= groupsMask!=NULL;
+		if(groupsMask)
+			idleGroupsMask	= *groupsMask;
+		idleClimbingMode	= constrainedClimbingMode;
+		idleFlags			= collisionFlags;
+		idleSignature		= computeIdleSignature(nbBoxes, boxes, nbCapsules, capsules, activeGroups, groupsMask);
+		idleValid			= true;
+		}
+#endif
+
 	filteredPosition = position;
 
 sharpness = fabsf(sharpness);
@@ -1334,10 +1480,31 @@ sharpness = fabsf(sharpness);
 	if(sharpness<1.0f)
 		filteredPosition[upDirection] = feedbackFilter(position[upDirection], memory, sharpness);
 
+	addDebugVolume();
+
 //	if(manager->debugData)
 //		manager->debugData->addAABB(cctModule.mCachedTBV, NX_ARGB_YELLOW);
 	}
 
+void Controller::addDebugVolume() const
+	{
+	CCTDebugData* debugData = cctModule.debugData;
+	if(!debugData || !debugData->wantsCategory(NX_CCT_DEBUG_VOLUMES))
+		return;
+
+	if(type==NX_CONTROLLER_CAPSULE)
+		{
+		const CapsuleController* CC = static_cast<const CapsuleController*>(this);
+		debugData->addCapsule(position, CC->radius, CC->height, upDirection, NX_ARGB_WHITE, NX_CCT_DEBUG_VOLUMES, cctModule.debugOwner);
+		}
+	else
+		{
+		NxExtendedBounds3 worldBox;
+		getWorldBox(worldBox);
+		debugData->addAABB(worldBox, NX_ARGB_WHITE, NX_CCT_DEBUG_VOLUMES, cctModule.debugOwner);
+		}
+	}
+
 void BoxController::move(const NxVec3& disp, NxU32 activeGroups, NxF32 minDist, NxU32& collisionFlags, NxF32 sharpness, const NxGroupsMask* groupsMask)
 	{
 	// Create internal swept box
@@ -1369,11 +1536,17 @@ void CharacterControllerManager::printStats()
     if ( bPrintThis )
     {
         char buffer[256];
-        sprintf(buffer, "%d - %d - %d\n", gNbIters, gNbFullUpdates, gNbPartialUpdates);
+        sprintf(buffer, "%d - %d - %d - slope %d (%d reused, %d mismatches) - idle %d (%d wake-ups)\n", gNbIters, gNbFullUpdates, gNbPartialUpdates,
+			gNbSlopePasses, gNbSlopeReusedDownPasses, gNbSlopeMismatches, gNbIdleMoves, gNbIdleWakeUps);
 //      OutputDebugString(buffer);
         printf(buffer);
     }
     gNbIters = 0;
     gNbFullUpdates = 0;
     gNbPartialUpdates = 0;
+    gNbSlopePasses = 0;
+    gNbSlopeReusedDownPasses = 0;
+    gNbSlopeMismatches = 0;
+    gNbIdleMoves = 0;
+    gNbIdleWakeUps = 0;
 }
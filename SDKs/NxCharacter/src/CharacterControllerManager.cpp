@@ -122,7 +122,7 @@ NxDebugRenderable CharacterControllerManager::getDebugData()
 		debugData = new CCTDebugData;	// ###
 
 	return NxDebugRenderable(	debugData->getNbPoints(), debugData->getPoints(),
-								debugData->getNbLines(), debugData->getLines(),
+								debugData->getNbRenderLines(), debugData->getRenderLines(),
 								debugData->getNbTriangles(), debugData->getTriangles());
 	}
 
@@ -132,6 +132,44 @@ void CharacterControllerManager::resetDebugData()
 		debugData->clear();	// Preserves the pointers, so it's fine
 	}
 
+bool CharacterControllerManager::setDebugCapture(const NxControllerDebugCaptureDesc* desc)
+	{
+	if(desc && !desc->isValid())
+		return false;
+
+	if(!debugData)
+		debugData = new CCTDebugData;	// ###
+
+	debugData->setCapture(desc);
+	return true;
+	}
+
+void CharacterControllerManager::setDebugRendering(NxController& controller, bool enabled)
+	{
+	Controller** c = getControllers();
+	for(NxU32 i=0;i<getNbControllers();i++)
+		{
+		if(c[i]->getNxController()==&controller)
+			{
+			c[i]->debugRendering = enabled;
+			return;
+			}
+		}
+	}
+
+const NxControllerDebugShape* CharacterControllerManager::getDebugShapes(NxU32& nbShapes) const
+	{
+	nbShapes = debugData ? debugData->getNbShapes() : 0;
+	return debugData ? debugData->getShapes() : NULL;
+	}
+
+bool CharacterControllerManager::saveDebugData(const char* filename)
+	{
+	if(!debugData || !filename)
+		return false;
+	return debugData->save(filename, getNbControllers(), getControllers());
+	}
+
 NxU32 CharacterControllerManager::getNbControllers() const { return controllers->size(); }
 
 Controller** CharacterControllerManager::getControllers() 
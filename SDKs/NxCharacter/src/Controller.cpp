@@ -12,6 +12,7 @@
 #include "NxScene.h"
 #include "NxActor.h"
 #include "NxBoxShapeDesc.h"
+#include "NxShape.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -33,6 +34,11 @@ Controller::Controller(const NxControllerDesc& desc, NxScene* s) : manager(NULL)
 	exposedPosition		= desc.position;
 	memory				= desc.position[upDirection];
 	handleSlope			= desc.slopeLimit!=0.0f; 
+
+	debugRendering		= true;
+
+	idleValid			= false;
+	sleeping			= false;
 	}
 
 Controller::~Controller()
@@ -47,6 +53,7 @@ bool Controller::setPos(const NxExtendedVec3& pos)
 	{
 	position = filteredPosition = exposedPosition = pos;
 	memory = pos[upDirection];
+	wakeUp();
 
 	// Update kinematic actor
 	if(kineActor)
@@ -66,3 +73,107 @@ void Controller::setCollision(bool enabled)
 	}
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Controller::isIdleMove(const NxVec3& disp, NxU32 activeGroups, NxF32 minDist, const NxGroupsMask* groupsMask, bool constrainedClimbingMode) const
+	{
+	if(!idleValid)										return false;
+	if(activeGroups!=idleActiveGroups)					return false;
+	if(minDist!=idleMinDist)							return false;
+	if(constrainedClimbingMode!=idleClimbingMode)		return false;
+	if((groupsMask!=NULL)!=idleUseGroupsMask)			return false;
+	if(groupsMask && (groupsMask->bits0!=idleGroupsMask.bits0 || groupsMask->bits1!=idleGroupsMask.bits1
+					|| groupsMask->bits2!=idleGroupsMask.bits2 || groupsMask->bits3!=idleGroupsMask.bits3))
+		return false;
+
+	// Same displacement. Exact: a slightly different one may well move the controller.
+	if(disp==idleDisp)
+		return true;
+
+	// PT: gravity alone gives a slightly different displacement each frame (variable timestep). A pure down motion
+	// which didn't move the controller because it hit the ground means it rests on something, and any other pure down
+	// motion stops there as well. Without the down collision it only didn't move because it was too small (jump apex,
+	// below minDist), and a larger one has to fall.
+	if(!(idleFlags & NXCC_COLLISION_DOWN))
+		return false;
+	const NxU32 axis1 = (upDirection+1)%3;
+	const NxU32 axis2 = (upDirection+2)%3;
+	return disp[upDirection]<0.0f && idleDisp[upDirection]<0.0f
+		&& disp[axis1]==0.0f && disp[axis2]==0.0f && idleDisp[axis1]==0.0f && idleDisp[axis2]==0.0f;
+	}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static NX_INLINE NxU64 HashIdleData(NxU64 h, const void* data, NxU32 size)
+	{
+	// FNV-1a
+	const NxU8* bytes = (const NxU8*)data;
+	while(size--)
+		{
+		h ^= *bytes++;
+		h *= 1099511628211ULL;
+		}
+	return h;
+	}
+
+// Signature of what can change around the controller without reportSceneChanged() being called: the dynamic shapes and
+// the other controllers touching the cached TBV. Each item is hashed on its own and the hashes are summed, so that the
+// result doesn't depend on the order in which the scene reports shapes.
+NxU64 Controller::computeIdleSignature(NxU32 nbBoxes, const NxExtendedBounds3* boxes, NxU32 nbCapsules, const NxExtendedCapsule* capsules, NxU32 activeGroups, const NxGroupsMask* groupsMask) const
+	{
+	const NxU64 seed = 14695981039346656037ULL;
+	const NxExtendedBounds3& TBV = cctModule.mCachedTBV;
+	NxU64 signature = 0;
+	NxU32 nbItems = 0;
+
+	NxBounds3 tmpBounds;	// LOSS OF ACCURACY
+	tmpBounds.min.x = (float)TBV.min.x;
+	tmpBounds.min.y = (float)TBV.min.y;
+	tmpBounds.min.z = (float)TBV.min.z;
+	tmpBounds.max.x = (float)TBV.max.x;
+	tmpBounds.max.y = (float)TBV.max.y;
+	tmpBounds.max.z = (float)TBV.max.z;
+
+	// Same filtering as FindTouchedGeometry(). A shape entering, leaving or moving inside the TBV changes the signature.
+	NxU32 total = scene->getNbDynamicShapes();
+	NxShape** buffer = (NxShape**)NxAlloca(total*sizeof(NxShape*));
+	NxU32 nbShapes = scene->overlapAABBShapes(tmpBounds, NX_DYNAMIC_SHAPES, total, buffer, NULL, activeGroups, groupsMask);
+	NX_ASSERT(nbShapes<=total);
+	for(NxU32 i=0;i<nbShapes;i++)
+		{
+		NxShape* shape = buffer[i];
+		if(size_t(shape->userData)=='CCTS')											continue;
+		if(shape->getFlag(NX_SF_DISABLE_COLLISION) || shape->getFlag(NX_TRIGGER_ENABLE))	continue;
+
+		const NxMat34 pose = shape->getGlobalPose();
+		NxU64 h = HashIdleData(seed, &shape, sizeof(NxShape*));
+		signature += HashIdleData(h, &pose, sizeof(NxMat34));
+		nbItems++;
+		}
+
+	// Other controllers, as collected by move()
+	for(NxU32 i=0;i<nbBoxes;i++)
+		{
+		if(!boxes[i].intersect(TBV))	continue;
+		signature += HashIdleData(seed, &boxes[i], sizeof(NxExtendedBounds3));
+		nbItems++;
+		}
+	for(NxU32 i=0;i<nbCapsules;i++)
+		{
+		const NxExtendedCapsule& C = capsules[i];
+		NxExtendedBounds3 box;
+		box.set(NxMath::min(C.p0.x, C.p1.x) - C.radius, NxMath::min(C.p0.y, C.p1.y) - C.radius, NxMath::min(C.p0.z, C.p1.z) - C.radius,
+				NxMath::max(C.p0.x, C.p1.x) + C.radius, NxMath::max(C.p0.y, C.p1.y) + C.radius, NxMath::max(C.p0.z, C.p1.z) + C.radius);
+		if(!box.intersect(TBV))	continue;
+		NxU64 h = HashIdleData(seed, &C.p0, sizeof(NxExtendedVec3));	// Field by field, the struct may be padded
+		h = HashIdleData(h, &C.p1, sizeof(NxExtendedVec3));
+		signature += HashIdleData(h, &C.radius, sizeof(NxF32));
+		nbItems++;
+		}
+
+	// Our own position and the TBV itself, so that setPos() or a new TBV can't go unnoticed
+	signature += HashIdleData(seed, &position, sizeof(NxExtendedVec3));
+	signature += HashIdleData(seed, &TBV, sizeof(NxExtendedBounds3));
+	return HashIdleData(signature, &nbItems, sizeof(NxU32));
+	}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,234 @@
+#ifndef NX_PHYSICS_NXPARALLELSORT
+#define NX_PHYSICS_NXPARALLELSORT
+/*----------------------------------------------------------------------------*\
+|
+|					Public Interface to NVIDIA PhysX Technology
+|
+|							     www.nvidia.com
+|
+\*----------------------------------------------------------------------------*/
+/** \addtogroup physics
+  @{
+*/
+
+#include "Nxp.h"
+#include "NxArray.h"
+#include "NxSort.h"
+#include "NxScheduler.h"
+
+/**
+\brief Sorts a range with tasks executed by a #NxUserScheduler.
+
+The range is cut into one run per task and each run is sorted with #NxIntroSort. The runs are then
+merged pairwise, log2(nbTasks) times, through a temporary copy of the range. Every merge round is split
+into nbTasks slices of equal output size, so all tasks stay busy until the end even though the number
+of runs halves each round. Without a scheduler, or for ranges below #NX_PS_MIN_PER_TASK elements per
+task, the range is sorted on the calling thread.
+
+The merges are stable, the per run sorts are not.
+
+Use #NxParallelSort rather than this class directly.
+
+@see NxParallelSort NxIntroSort NxUserScheduler
+*/
+template<class Sortable, class Predicate>
+class NxParallelSorter
+	{
+	public:
+
+	enum
+		{
+		NX_PS_MAX_TASKS = 16,
+		NX_PS_MIN_PER_TASK = 1024
+		};
+
+	NX_INLINE NxParallelSorter() : mData(NULL), mTemp(NULL), mCount(0), mRunLength(0)
+		{
+		}
+
+	/**
+	\brief Sorts the range [start, end]. Same range convention as #NxQuickSort.
+
+	\param[in] start First element.
+	\param[in] end Last element.
+	\param[in] scheduler Scheduler which executes the tasks, or NULL to sort on the calling thread.
+	\param[in] nbTasks Number of tasks per round, at most #NX_PS_MAX_TASKS.
+	*/
+	NX_INLINE void sort(Sortable * start, Sortable * end, NxUserScheduler * scheduler, NxU32 nbTasks = 4)
+		{
+		if (end <= start)
+			return;
+
+		mCount = NxU32(end - start) + 1;
+		if (nbTasks > NX_PS_MAX_TASKS)
+			nbTasks = NX_PS_MAX_TASKS;
+		if (nbTasks > mCount / NX_PS_MIN_PER_TASK)
+			nbTasks = mCount / NX_PS_MIN_PER_TASK;
+		if (!scheduler || nbTasks < 2)
+			{
+			NxIntroSort<Sortable, Predicate>(start, end);
+			return;
+			}
+
+		NxArray<Sortable> temp(mCount);
+		mData = start;
+		mTemp = &temp[0];
+
+		// sort one run per task
+		mRunLength = (mCount + nbTasks - 1) / nbTasks;
+		runPass(scheduler, nbTasks, Task::SORT);
+
+		// merge pairs of runs until one is left, ping-ponging between the range and temp
+		while (mRunLength < mCount)
+			{
+			runPass(scheduler, nbTasks, Task::MERGE);
+			Sortable * t = mData;
+			mData = mTemp;
+			mTemp = t;
+			mRunLength *= 2;
+			}
+
+		if (mData != start)
+			{
+			for (NxU32 i = 0; i < mCount; i++)
+				start[i] = mData[i];
+			}
+		mData = mTemp = NULL;
+		}
+
+	private:
+
+	class Task : public NxTask
+		{
+		public:
+		enum Pass { SORT, MERGE };
+
+		Task() : sorter(NULL), pass(SORT), begin(0), end(0) {}
+
+		virtual void execute()
+			{
+			if (pass == SORT)
+				{
+				if (begin + 1 < end)
+					NxIntroSort<Sortable, Predicate>(sorter->mData + begin, sorter->mData + end - 1);
+				}
+			else
+				sorter->mergeSlice(begin, end);
+			}
+
+		NxParallelSorter* sorter;
+		Pass pass;
+		NxU32 begin;
+		NxU32 end;
+		};
+
+	NX_INLINE void runPass(NxUserScheduler * scheduler, NxU32 nbTasks, typename Task::Pass pass)
+		{
+		// the sort pass is cut along the runs, the merge pass into equal slices of output
+		NxU32 perTask = pass == Task::SORT ? mRunLength : (mCount + nbTasks - 1) / nbTasks;
+		for (NxU32 i = 0; i < nbTasks; i++)
+			{
+			Task & t = mTasks[i];
+			t.sorter = this;
+			t.pass = pass;
+			t.begin = NxMath::min(i * perTask, mCount);
+			t.end = NxMath::min(t.begin + perTask, mCount);
+			if (t.begin < t.end)
+				scheduler->addTask(&t);
+			}
+		scheduler->waitTasksComplete();
+		}
+
+	/**
+	\brief Number of elements of a that precede output position d of the stable merge of a and b.
+	*/
+	static NX_INLINE NxU32 coRank(NxU32 d, const Sortable * a, NxU32 na, const Sortable * b, NxU32 nb)
+		{
+		static Predicate p;
+		NxU32 lo = d > nb ? d - nb : 0;
+		NxU32 hi = d < na ? d : na;
+		while (lo < hi)
+			{
+			NxU32 i = (lo + hi) >> 1;
+			NxU32 j = d - i;
+			// on ties a goes first, so a[i] belongs to the first d outputs unless b[j-1] is less
+			if (j > 0 && !p(b[j - 1], a[i]))
+				lo = i + 1;
+			else
+				hi = i;
+			}
+		return lo;
+		}
+
+	/**
+	\brief Writes the elements [begin, end) of the current merge round to mTemp.
+	*/
+	NX_INLINE void mergeSlice(NxU32 begin, NxU32 end)
+		{
+		static Predicate p;
+		const NxU32 pairLength = mRunLength * 2;
+		NxU32 pairStart = begin - begin % pairLength;
+		for (; pairStart < end; pairStart += pairLength)
+			{
+			const NxU32 mid = NxMath::min(pairStart + mRunLength, mCount);
+			const NxU32 pairEnd = NxMath::min(pairStart + pairLength, mCount);
+			const Sortable * a = mData + pairStart;
+			const Sortable * b = mData + mid;
+			const NxU32 na = mid - pairStart;
+			const NxU32 nb = pairEnd - mid;
+
+			// the part of this pair's output inside the slice
+			const NxU32 d0 = NxMath::max(begin, pairStart) - pairStart;
+			const NxU32 d1 = NxMath::min(end, pairEnd) - pairStart;
+
+			NxU32 i = coRank(d0, a, na, b, nb);
+			NxU32 j = d0 - i;
+			Sortable * out = mTemp + pairStart + d0;
+			for (NxU32 d = d0; d < d1; d++)
+				{
+				if (j < nb && (i == na || p(b[j], a[i])))
+					*out++ = b[j++];
+				else
+					*out++ = a[i++];
+				}
+			}
+		}
+
+	Sortable *	mData;
+	Sortable *	mTemp;
+	NxU32		mCount;
+	NxU32		mRunLength;
+	Task		mTasks[NX_PS_MAX_TASKS];	// not an NxArray, it does not construct polymorphic elements
+	};
+
+/**
+\brief Sorts the range [start, end] on a #NxUserScheduler.
+
+Same call shape as #NxQuickSort, with the scheduler and the number of tasks added:
+
+NxParallelSort<SortElem, SortElemCompareDirect>(&sortVector[0], &sortVector[sortVector.size()-1], scheduler);
+
+Blocks until the range is sorted. See #NxParallelSorter for details.
+
+\param[in] start First element.
+\param[in] end Last element.
+\param[in] scheduler Scheduler which executes the tasks, or NULL to sort on the calling thread.
+\param[in] nbTasks Number of tasks per round, at most #NxParallelSorter::NX_PS_MAX_TASKS.
+
+@see NxParallelSorter NxIntroSort NxQuickSort
+*/
+template<class Sortable, class Predicate>
+inline void NxParallelSort(Sortable * start, Sortable * end, NxUserScheduler * scheduler, NxU32 nbTasks = 4)
+	{
+	NxParallelSorter<Sortable, Predicate> sorter;
+	sorter.sort(start, end, scheduler, nbTasks);
+	}
+
+ /** @} */
+#endif
+//NVIDIACOPYRIGHTBEGIN
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010 NVIDIA Corporation
+// All rights reserved. www.nvidia.com
+///////////////////////////////////////////////////////////////////////////
+//NVIDIACOPYRIGHTEND
@@ -186,6 +186,8 @@ Alternatively, one can instead directly #include a subset of the below files.
 #include "NxIntersectionSweptSpheres.h"
 #include "NxPMap.h"
 #include "NxSmoothNormals.h"
+#include "NxVertexNormals.h"
+#include "NxParallelSort.h"
 #include "NxExportedUtils.h"
 
 #include "PhysXLoader.h"
@@ -0,0 +1,303 @@
+#ifndef NX_COLLISION_NXVERTEXNORMALS
+#define NX_COLLISION_NXVERTEXNORMALS
+/*----------------------------------------------------------------------------*\
+|
+|					Public Interface to NVIDIA PhysX Technology
+|
+|							     www.nvidia.com
+|
+\*----------------------------------------------------------------------------*/
+/** \addtogroup physics
+  @{
+*/
+
+#include "Nxp.h"
+#include "NxArray.h"
+#include "NxScheduler.h"
+
+/**
+\brief Flags for NxVertexNormalBuilder::compute().
+*/
+enum NxVertexNormalFlag
+	{
+	/**
+	\brief Weights face normals with the corner angle instead of the triangle area.
+
+	Gives correct normals for meshes with irregular triangulations, e.g. cube corners.
+	*/
+	NX_VNF_ANGLE_WEIGHTED	= (1<<0),
+
+	/**
+	\brief Flips the normals.
+	*/
+	NX_VNF_FLIP				= (1<<1),
+
+	/**
+	\brief Skips the final normalization, the sums of the weighted face normals are returned.
+	*/
+	NX_VNF_NO_NORMALIZE		= (1<<2),
+	};
+
+/**
+\brief Recomputes vertex normals of a mesh with fixed topology, e.g. a deforming cloth or soft body.
+
+Unlike #NxBuildSmoothNormals() the vertex to triangle adjacency is computed once in init() and stored
+in compressed row form. compute() then runs in two passes which never write to shared memory:
+
+- the weighted normal of every triangle corner is computed per triangle
+- every vertex gathers the corner normals of its adjacent triangles
+
+Both passes can be split into tasks and executed by a #NxUserScheduler. The result does not depend on the
+number of tasks since every vertex sums its corners in triangle order.
+
+The builder is implemented inline so that it can be used without the utility library.
+
+@see NxBuildSmoothNormals NxVertexNormalFlag
+*/
+class NxVertexNormalBuilder
+	{
+	public:
+
+	enum { NX_VNB_MAX_TASKS = 16 };
+
+	NX_INLINE NxVertexNormalBuilder() : mNbTris(0), mNbVerts(0), mVerts(NULL), mVertStride(0), mNormals(NULL), mNormalStride(0), mFlags(0)
+		{
+		}
+
+	/**
+	\brief Builds the vertex to triangle adjacency.
+
+	To use 32bit indices pass a pointer in dFaces and set wFaces to zero. Alternatively pass a pointer to
+	wFaces and set dFaces to zero. The indices are copied.
+
+	\param[in] nbTris Number of triangles
+	\param[in] nbVerts Number of vertices
+	\param[in] dFaces Array of dword triangle indices, or null
+	\param[in] wFaces Array of word triangle indices, or null
+
+	\return False if an index is out of range, the builder is empty in this case.
+	*/
+	NX_INLINE bool init(NxU32 nbTris, NxU32 nbVerts, const NxU32* dFaces, const NxU16* wFaces)
+		{
+		release();
+		if(!dFaces && !wFaces && nbTris)
+			return false;
+
+		mIndices.resize(nbTris*3);
+		for(NxU32 i=0; i<nbTris*3; i++)
+			{
+			NxU32 v = dFaces ? dFaces[i] : wFaces[i];
+			if(v >= nbVerts)
+				{
+				release();
+				return false;
+				}
+			mIndices[i] = v;
+			}
+
+		// count, prefix sum, fill. Filling in triangle order keeps every row sorted.
+		mOffsets.resize(nbVerts+1, 0);
+		for(NxU32 i=0; i<nbTris*3; i++)
+			mOffsets[mIndices[i]+1]++;
+		for(NxU32 i=0; i<nbVerts; i++)
+			mOffsets[i+1] += mOffsets[i];
+
+		NxArray<NxU32> fill(nbVerts, 0);
+		mCorners.resize(nbTris*3);
+		for(NxU32 i=0; i<nbTris*3; i++)
+			{
+			NxU32 v = mIndices[i];
+			mCorners[mOffsets[v] + fill[v]++] = i;
+			}
+
+		mCornerNormals.resize(nbTris*3);
+		mNbTris = nbTris;
+		mNbVerts = nbVerts;
+		return true;
+		}
+
+	/**
+	\brief Releases the adjacency.
+	*/
+	NX_INLINE void release()
+		{
+		mIndices.clear();
+		mOffsets.clear();
+		mCorners.clear();
+		mCornerNormals.clear();
+		mNbTris = 0;
+		mNbVerts = 0;
+		}
+
+	NX_INLINE NxU32 getNbTris() const	{ return mNbTris;	}
+	NX_INLINE NxU32 getNbVerts() const	{ return mNbVerts;	}
+
+	/**
+	\brief Computes the normals of all vertices.
+
+	\param[in] verts Vertex positions, the first 3 floats at every stride
+	\param[in] vertStride Distance between two positions in bytes
+	\param[out] normals Vertex normals, the first 3 floats at every stride are written
+	\param[in] normalStride Distance between two normals in bytes
+	\param[in] flags Combination of #NxVertexNormalFlag
+	\param[in] scheduler Optional scheduler which executes the tasks, null computes on the calling thread
+	\param[in] nbTasks Number of tasks per pass, at most #NX_VNB_MAX_TASKS, ignored without a scheduler
+
+	\return False if init() has not been called.
+	*/
+	NX_INLINE bool compute(const void* verts, NxU32 vertStride, void* normals, NxU32 normalStride, NxU32 flags=0, NxUserScheduler* scheduler=NULL, NxU32 nbTasks=4)
+		{
+		if(!mNbVerts)
+			return false;
+
+		mVerts = (const NxU8*)verts;
+		mVertStride = vertStride;
+		mNormals = (NxU8*)normals;
+		mNormalStride = normalStride;
+		mFlags = flags;
+
+		if(!scheduler || nbTasks < 2)
+			{
+			computeCorners(0, mNbTris);
+			gatherNormals(0, mNbVerts);
+			return true;
+			}
+
+		if(nbTasks > NX_VNB_MAX_TASKS)
+			nbTasks = NX_VNB_MAX_TASKS;
+		runPass(scheduler, nbTasks, Task::CORNERS, mNbTris);
+		runPass(scheduler, nbTasks, Task::GATHER, mNbVerts);
+		return true;
+		}
+
+	/**
+	\brief Computes the normals of a tightly packed vertex array.
+	*/
+	NX_INLINE bool compute(const NxVec3* verts, NxVec3* normals, NxU32 flags=0, NxUserScheduler* scheduler=NULL, NxU32 nbTasks=4)
+		{
+		return compute(verts, sizeof(NxVec3), normals, sizeof(NxVec3), flags, scheduler, nbTasks);
+		}
+
+	private:
+
+	class Task : public NxTask
+		{
+		public:
+		enum Pass { CORNERS, GATHER };
+
+		Task() : builder(NULL), pass(CORNERS), begin(0), end(0) {}
+
+		virtual void execute()
+			{
+			if(pass == CORNERS)
+				builder->computeCorners(begin, end);
+			else
+				builder->gatherNormals(begin, end);
+			}
+
+		NxVertexNormalBuilder*	builder;
+		Pass					pass;
+		NxU32					begin;
+		NxU32					end;
+		};
+
+	NX_INLINE void runPass(NxUserScheduler* scheduler, NxU32 nbTasks, Task::Pass pass, NxU32 count)
+		{
+		NxU32 perTask = (count + nbTasks - 1) / nbTasks;
+		for(NxU32 i=0; i<nbTasks; i++)
+			{
+			Task& t = mTasks[i];
+			t.builder = this;
+			t.pass = pass;
+			t.begin = NxMath::min(i*perTask, count);
+			t.end = NxMath::min(t.begin + perTask, count);
+			if(t.begin < t.end)
+				scheduler->addTask(&t);
+			}
+		scheduler->waitTasksComplete();
+		}
+
+	NX_INLINE const NxVec3& position(NxU32 v) const
+		{
+		return *(const NxVec3*)(mVerts + v*mVertStride);
+		}
+
+	NX_INLINE void computeCorners(NxU32 firstTri, NxU32 lastTri)
+		{
+		const bool angleWeighted = (mFlags & NX_VNF_ANGLE_WEIGHTED) != 0;
+		for(NxU32 t=firstTri; t<lastTri; t++)
+			{
+			const NxU32* idx = &mIndices[t*3];
+			const NxVec3& p0 = position(idx[0]);
+			const NxVec3& p1 = position(idx[1]);
+			const NxVec3& p2 = position(idx[2]);
+			NxVec3* out = &mCornerNormals[t*3];
+
+			NxVec3 e01 = p1 - p0;
+			NxVec3 e02 = p2 - p0;
+			NxVec3 n = e01.cross(e02);		// length is twice the area
+
+			if(!angleWeighted)
+				{
+				out[0] = out[1] = out[2] = n;
+				continue;
+				}
+
+			if(n.normalize() == 0.0f)
+				{
+				out[0].zero(); out[1].zero(); out[2].zero();
+				continue;
+				}
+
+			NxVec3 e12 = p2 - p1;
+			NxReal l01 = e01.magnitude();
+			NxReal l02 = e02.magnitude();
+			NxReal l12 = e12.magnitude();
+			NxReal a0 = NxMath::acos(e01.dot(e02) / (l01*l02));
+			NxReal a1 = NxMath::acos(-e01.dot(e12) / (l01*l12));
+			out[0] = n * a0;
+			out[1] = n * a1;
+			out[2] = n * (NxPiF32 - a0 - a1);
+			}
+		}
+
+	NX_INLINE void gatherNormals(NxU32 firstVert, NxU32 lastVert)
+		{
+		const bool flip = (mFlags & NX_VNF_FLIP) != 0;
+		const bool normalize = (mFlags & NX_VNF_NO_NORMALIZE) == 0;
+		for(NxU32 v=firstVert; v<lastVert; v++)
+			{
+			NxVec3 n(0.0f, 0.0f, 0.0f);
+			for(NxU32 i=mOffsets[v]; i<mOffsets[v+1]; i++)
+				n += mCornerNormals[mCorners[i]];
+			if(normalize)
+				n.normalize();
+			if(flip)
+				n = -n;
+			*(NxVec3*)(mNormals + v*mNormalStride) = n;
+			}
+		}
+
+	NxU32			mNbTris;
+	NxU32			mNbVerts;
+	NxArray<NxU32>	mIndices;		// 3 per triangle
+	NxArray<NxU32>	mOffsets;		// nbVerts+1, row v of mCorners is [mOffsets[v], mOffsets[v+1])
+	NxArray<NxU32>	mCorners;		// triangle*3 + corner, grouped by vertex
+	NxArray<NxVec3>	mCornerNormals;	// weighted normal per triangle corner
+	Task			mTasks[NX_VNB_MAX_TASKS];	// not an NxArray, it does not construct polymorphic elements
+
+	const NxU8*		mVerts;
+	NxU32			mVertStride;
+	NxU8*			mNormals;
+	NxU32			mNormalStride;
+	NxU32			mFlags;
+	};
+
+/** @} */
+#endif
+//NVIDIACOPYRIGHTBEGIN
+///////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2010 NVIDIA Corporation
+// All rights reserved. www.nvidia.com
+///////////////////////////////////////////////////////////////////////////
+//NVIDIACOPYRIGHTEND
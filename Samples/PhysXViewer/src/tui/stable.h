@@ -35,6 +35,7 @@
 #pragma warning(disable:4786)
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 #include <string>
 #include <set>
@@ -57,56 +58,187 @@ typedef std::set< const char *, CharPtrLess > CharPtrSet;
 typedef std::set< const char *, CharPtrLess > CharPtrSet;
 #endif
 
+// Interns strings: every distinct string is stored once, so two interned strings are equal exactly when their
+// pointers are. Lookups go through an open addressed hash table and the strings are copied into large arena
+// blocks, which Clear() frees all at once.
 class StringTable
 {
 public:
 	StringTable(void)
 	{
+		mSlots     = 0;
+		mCapacity  = 0;
+		mCount     = 0;
+		mBlock     = 0;
+		mBlockUsed = 0;
+		mBlockSize = 0;
 	};
 
 	~StringTable(void)
 	{
-		CharPtrSet::iterator i;
-		for (i=mStrings.begin(); i!=mStrings.end(); i++)
+		Clear();
+	}
+
+	// FNV-1a, also returning the length.
+	static unsigned int Hash(const char *str,unsigned int &len)
+	{
+		unsigned int hash = 2166136261u;
+		const unsigned char *scan = (const unsigned char *) str;
+		while ( *scan )
 		{
-			char *str = (char *)(*i);
-			free(str);
+			hash = (hash ^ *scan++) * 16777619u;
 		}
+		len = (unsigned int)(scan - (const unsigned char *) str);
+		return hash;
+	}
+
+	static unsigned int Hash(const char *str)
+	{
+		unsigned int len;
+		return Hash(str,len);
 	}
 
 	const char * Get(const char *str)
 	{
-		CharPtrSet::iterator found;
-		found = mStrings.find( str );
-		if ( found != mStrings.end() ) return (*found);
-		unsigned int l = (unsigned int)strlen(str);
-		char *mem = (char *) malloc(sizeof(char)*(l+1));
-		strcpy(mem,str);
-		mStrings.insert( mem );
-		return mem;
+		bool first;
+		unsigned int hash;
+		return Get(str,first,hash);
 	};
 
 	const char * Get(const char *str,bool &first)
 	{
-		CharPtrSet::iterator found;
-		found = mStrings.find( str );
-		if ( found != mStrings.end() )
+		unsigned int hash;
+		return Get(str,first,hash);
+	};
+
+	// Also returns the hash of the string.
+	const char * Get(const char *str,bool &first,unsigned int &hash)
+	{
+		unsigned int len;
+		hash = Hash(str,len);
+
+		if ( mCapacity )
 		{
-			first = false;
-			return (*found);
+			unsigned int mask = mCapacity-1;
+			for (unsigned int i=hash&mask; mSlots[i].mString; i=(i+1)&mask)
+			{
+				const Slot &slot = mSlots[i];
+				if ( slot.mHash == hash && slot.mLength == len && memcmp(slot.mString,str,len) == 0 )
+				{
+					first = false;
+					return slot.mString;
+				}
+			}
+		}
+
+		if ( (mCount+1)*2 > mCapacity )
+		{
+			Grow();
 		}
+
+		char *mem = Alloc(len+1);
+		memcpy(mem,str,len+1);
+
+		unsigned int mask = mCapacity-1;
+		unsigned int i = hash&mask;
+		while ( mSlots[i].mString ) i = (i+1)&mask;
+		mSlots[i].mString = mem;
+		mSlots[i].mHash   = hash;
+		mSlots[i].mLength = len;
+		mCount++;
+
 		first = true;
-		unsigned int l = (unsigned int)strlen(str);
-		char *mem = (char *) malloc(sizeof(char)*(l+1));
-		strcpy(mem,str);
-		mStrings.insert( mem );
 		return mem;
 	};
 
-	CharPtrSet& GetSet(void) { return mStrings; };
+	unsigned int GetCount(void) const { return mCount; };
+
+	// Frees every string at once. The pointers handed out before are invalid afterwards.
+	void Clear(void)
+	{
+		while ( mBlock )
+		{
+			char *prev = *(char **)mBlock;
+			free(mBlock);
+			mBlock = prev;
+		}
+		free(mSlots);
+		mSlots     = 0;
+		mCapacity  = 0;
+		mCount     = 0;
+		mBlockUsed = 0;
+		mBlockSize = 0;
+		mSet.clear();
+	}
+
+	// The interned strings in alphabetical order, gathered on every call.
+	CharPtrSet& GetSet(void)
+	{
+		mSet.clear();
+		for (unsigned int i=0; i<mCapacity; i++)
+		{
+			if ( mSlots[i].mString ) mSet.insert( mSlots[i].mString );
+		}
+		return mSet;
+	};
 
 private:
-	CharPtrSet mStrings;
+	StringTable(const StringTable &);
+	StringTable & operator=(const StringTable &);
+
+	struct Slot
+	{
+		const char   *mString;
+		unsigned int  mHash;
+		unsigned int  mLength;
+	};
+
+	enum { BLOCK_SIZE = 65536 };
+
+	// Each arena block starts with a pointer to the one before it.
+	char * Alloc(unsigned int size)
+	{
+		if ( mBlockUsed+size > mBlockSize )
+		{
+			unsigned int bsize = sizeof(char *)+size;
+			if ( bsize < BLOCK_SIZE ) bsize = BLOCK_SIZE;
+			char *block = (char *) malloc(bsize);
+			*(char **)block = mBlock;
+			mBlock     = block;
+			mBlockUsed = sizeof(char *);
+			mBlockSize = bsize;
+		}
+		char *ret = mBlock+mBlockUsed;
+		mBlockUsed+=size;
+		return ret;
+	}
+
+	void Grow(void)
+	{
+		unsigned int capacity = mCapacity ? mCapacity*2 : 256;
+		Slot *slots = (Slot *) calloc(capacity,sizeof(Slot));
+		unsigned int mask = capacity-1;
+		for (unsigned int i=0; i<mCapacity; i++)
+		{
+			if ( mSlots[i].mString )
+			{
+				unsigned int j = mSlots[i].mHash&mask;
+				while ( slots[j].mString ) j = (j+1)&mask;
+				slots[j] = mSlots[i];
+			}
+		}
+		free(mSlots);
+		mSlots    = slots;
+		mCapacity = capacity;
+	}
+
+	Slot        *mSlots;
+	unsigned int mCapacity;   // a power of two, kept at least half empty
+	unsigned int mCount;
+	char        *mBlock;      // the newest arena block
+	unsigned int mBlockUsed;
+	unsigned int mBlockSize;
+	CharPtrSet   mSet;        // filled by GetSet
 };
 
 
@@ -46,13 +46,16 @@
 
 extern const char *emptystring;
 
+// A string interned by gStringDict, so equal strings have equal pointers and compare in constant time. The hash
+// comes along from the dictionary, for hashed containers.
 class StringRef
 {
 public:
 public:
 	StringRef(void)
 	{
-		mString = "";
+		mString = emptystring;
+		mHash   = 2166136261u; // the hash of the empty string
 	}
 
 	inline StringRef(const char *str);
@@ -65,14 +68,24 @@ public:
 
 	const char * Get(void) const { return mString; };
 
+	unsigned int GetHash(void) const { return mHash; };
+
 	void Set(const char *str)
 	{
 		mString = str;
+		mHash   = StringTable::Hash(str);
+	}
+
+	void Set(const char *str,unsigned int hash)
+	{
+		mString = str;
+		mHash   = hash;
 	}
 
 	const StringRef &operator= (const StringRef& rhs )
 	{
-		mString = rhs.Get();
+		mString = rhs.mString;
+		mHash   = rhs.mHash;
 		return *this;
 	}
 
@@ -126,7 +139,8 @@ public:
 	}
 
 private:
-	const char *mString; // the actual char ptr
+	const char   *mString; // the actual char ptr
+	unsigned int  mHash;
 };
 
 
@@ -145,24 +159,12 @@ public:
 	StringRef Get(const char *text)
 	{
 		StringRef ref;
-		if ( text )
+		if ( text && *text )
 		{
-			if ( strcmp(text,emptystring) == 0 )
-			{
-				ref.Set(emptystring);
-			}
-			else
-			{
-				if ( strcmp(text,emptystring) == 0 )
-				{
-					ref.Set(emptystring);
-				}
-				else
-				{
-					const char *foo = mStringTable.Get(text);
-					ref.Set(foo);
-				}
-			}
+			bool first;
+			unsigned int hash;
+			const char *foo = mStringTable.Get(text,first,hash);
+			ref.Set(foo,hash);
 		}
 		return ref;
 	}
@@ -171,11 +173,18 @@ public:
 	{
 		assert(text); // no null string support for this version!
 		StringRef ref;
-		const char *foo = mStringTable.Get(text,first);
-		ref.Set(foo);
+		unsigned int hash;
+		const char *foo = mStringTable.Get(text,first,hash);
+		ref.Set(foo,hash);
 		return ref;
 	}
 
+	// Frees all the strings at once. Every StringRef handed out before is left dangling.
+	void Clear(void)
+	{
+		mStringTable.Clear();
+	}
+
 private:
 	StringTable mStringTable;
 };
@@ -194,13 +203,26 @@ inline StringRef::StringRef(const char *str)
 {
 	StringRef ref = SGET(str);
 	mString = ref.mString;
+	mHash   = ref.mHash;
 }
 
 inline StringRef::StringRef(const StringRef &str)
 {
-	mString = str.Get();
+	mString = str.mString;
+	mHash   = str.mHash;
 }
 
+// Hashes a StringRef by its precomputed hash, for hashed containers.
+class StringRefHash
+{
+	public:
+
+	 size_t operator()(const StringRef &a) const
+	 {
+		 return a.GetHash();
+	 }
+};
+
 // This is a helper class so you can easily do an alphabetical sort on an STL vector of StringRefs.
 // Usage: std::sort( list.begin(), list.end(), StringSortRef() );
 class StringSortRef
@@ -211,6 +233,7 @@ class StringSortRef
 	 {
 		 const char *str1 = a.Get();
 		 const char *str2 = b.Get();
+		 if ( str1 == str2 ) return false;
 		 int r = stricmp(str1,str2);
 		 return r < 0;
 	 }
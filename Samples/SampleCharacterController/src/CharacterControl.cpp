@@ -220,6 +220,41 @@ NxU32 MoveCharacter(NxU32 characterIndex, NxScene& scene, const NxVec3& dispVect
 }
 
 
+// Self-test for idle move detection: a controller at the top of a jump gets a down motion too small to move it (below
+// minDist), which is recorded as an idle move. It didn't touch the ground, so the gravity moves that follow must not be
+// skipped as idle and the controller has to fall.
+bool TestApexFall(NxScene& scene, const NxVec3& apexPos)
+{
+	NxCapsuleControllerDesc desc;
+	desc.position.x		= apexPos.x;
+	desc.position.y		= apexPos.y;
+	desc.position.z		= apexPos.z;
+	desc.radius			= gInitialRadius;
+	desc.height			= gInitialHeight;
+	desc.upDirection	= NX_Y;
+	desc.slopeLimit		= 0;
+	desc.skinWidth		= SKINWIDTH;
+	desc.stepOffset		= gInitialRadius * 0.5f;
+	NxController* c = gManager->createController(&scene, desc);
+	if(!c)
+		return false;
+
+	const NxF32 minDist = 0.001f;
+	NxU32 collisionFlags;
+	c->move(NxVec3(0.0f, -minDist*0.1f, 0.0f), COLLIDABLE_MASK, minDist, collisionFlags);
+	const NxF64 apexY = c->getPosition().y;
+
+	for(NxU32 i=0;i<4;i++)
+		c->move(NxVec3(0.0f, -0.05f*NxF32(i+1), 0.0f), COLLIDABLE_MASK, minDist, collisionFlags);
+	const NxF64 fallY = c->getPosition().y;
+
+	gManager->releaseController(*c);
+
+	const bool passed = fallY < apexY - 0.4;
+	printf("Apex fall test: %s (%.4f -> %.4f)\n", passed ? "PASS" : "FAIL", apexY, fallY);
+	return passed;
+}
+
 static NxExtendedVec3 zero(0,0,0);
 const NxExtendedVec3& GetCharacterPos(NxU32 characterIndex)
 {
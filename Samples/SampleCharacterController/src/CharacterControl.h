@@ -29,4 +29,6 @@ bool UpdateCharacterExtents(NxU32 index, bool& increase);
 
 void RenderCharacters();
 
+bool TestApexFall(NxScene& scene, const NxVec3& apexPos);
+
 #endif
@@ -633,6 +633,10 @@ static void KeyboardCallback(unsigned char key, int x, int y)
 				printf("Character's Position: %.4f, %.4f, %.4f\n", tmp.x, tmp.y, tmp.z);
 			}
 			break;
+		case 'a':
+		case 'A':
+			TestApexFall(*gScene, NxVec3(gStartPos[gControlledCharacterIndex].x, 50.0f, gStartPos[gControlledCharacterIndex].z));
+			break;
 		case 'w':
 		case 'W':
 			{
@@ -2,151 +2,379 @@
 
 #include <NxPhysics.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <vector>
+
+#if defined(WIN32)
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#	include <pthread.h>
+#	include <unistd.h>
+#	define COOK_ASE_PTHREADS
+#endif
 
 #include "Stream.h"
 #include "cooking.h"
 #include "MediaPath.h"
+#include "Timing.h"
+
+// ----------------------------------------------------------------------
+// tokenizer, works on the whole file in memory, a line ends at '\n' or at the end of the range
+
+static inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+static inline const char* skipSpaces(const char* p, const char* end) {
+	while (p < end && isSpace(*p))
+		p++;
+	return p;
+}
+
+static inline const char* skipToken(const char* p, const char* end) {
+	while (p < end && !isSpace(*p))
+		p++;
+	return p;
+}
 
-NxVec3 _offset;
+static inline const char* lineEnd(const char* p, const char* end) {
+	const char* e = (const char*)memchr(p, '\n', end - p);
+	return e ? e : end;
+}
+
+static inline bool isKeyword(const char* token, const char* tokenEnd, const char* keyword) {
+	size_t len = strlen(keyword);
+	return (size_t)(tokenEnd - token) == len && !strncmp(token, keyword, len);
+}
+
+static const char* readInt(const char* p, const char* end, int& value, bool& ok) {
+	p = skipSpaces(p, end);
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+	if (p >= end || *p < '0' || *p > '9') {
+		ok = false;
+		return p;
+	}
+	int i = 0;
+	while (p < end && *p >= '0' && *p <= '9')
+		i = i * 10 + (*p++ - '0');
+	value = negative ? -i : i;
+	return p;
+}
 
-static char* trimFront(char* c) {
-	while(*c == ' ' || *c == '\t')
-		c++;
-	return c;
+static const char* readFloat(const char* p, const char* end, float& value, bool& ok) {
+	p = skipSpaces(p, end);
+	if (p >= end) {
+		ok = false;
+		return p;
+	}
+	// the buffer is zero terminated and p is not on a line break, strtod stays in the line
+	char* e;
+	value = (float)strtod(p, &e);
+	if (e == p)
+		ok = false;
+	return e;
 }
 
-void readVertices(FILE* f, NxArray<NxVec3>& vertices, NxVec3 scale) {
-	char line[512];
-
-	while(true) {
-		fgets(line, 512, f);
-		char* l = trimFront(line);
-		if (*l == '}') {
-			return;
-		} else if (strstr(l, "*MESH_VERTEX")) {
-			float a,b,c;
-			int i;
-			sscanf(l, "*MESH_VERTEX %d %f %f %f", &i, &a, &b, &c);
-			NxVec3 newV(a,c,-b);
-			newV.x *= scale.x;
-			newV.y *= scale.y;
-			newV.z *= scale.z;
-			vertices[i] = newV;
-			vertices[i] += _offset;
+// ----------------------------------------------------------------------
+// one *GEOMOBJECT block
+
+struct ASEObject {
+	ASEObject() : begin(NULL), end(NULL), valid(false) {}
+	void parse(const NxVec3& offset, const NxVec3& scale);
+
+	const char* begin;
+	const char* end;
+	NxArray<NxVec3> vertices;
+	NxArray<NxU32> faces;
+	bool valid;
+};
+
+void ASEObject::parse(const NxVec3& offset, const NxVec3& scale) {
+	const char* p = begin;
+	bool ok = true;
+	while (p < end) {
+		const char* e = lineEnd(p, end);
+		p = skipSpaces(p, e);
+		if (p < e && *p == '*') {
+			const char* token = p;
+			p = skipToken(p, e);
+			if (isKeyword(token, p, "*MESH_VERTEX")) {
+				int i = -1;
+				float a = 0.0f, b = 0.0f, c = 0.0f;
+				p = readInt(p, e, i, ok);
+				p = readFloat(p, e, a, ok);
+				p = readFloat(p, e, b, ok);
+				p = readFloat(p, e, c, ok);
+				if (i < 0 || i >= (int)vertices.size())
+					ok = false;
+				else {
+					NxVec3 newV(a*scale.x, c*scale.y, -b*scale.z);
+					vertices[i] = newV + offset;
+				}
+			} else if (isKeyword(token, p, "*MESH_FACE")) {
+				// *MESH_FACE i: A: a B: b C: c AB: ...
+				int i = -1;
+				int abc[3] = { 0, 0, 0 };
+				p = readInt(p, e, i, ok);
+				for (int j = 0; j < 3; j++) {
+					p = skipToken(skipSpaces(skipToken(p, e), e), e);
+					p = readInt(p, e, abc[j], ok);
+					if (abc[j] < 0)
+						ok = false;
+				}
+				if (i < 0 || 3*i >= (int)faces.size())
+					ok = false;
+				else {
+					faces[3*i+0] = abc[0];
+					faces[3*i+1] = abc[1];
+					faces[3*i+2] = abc[2];
+				}
+			} else if (isKeyword(token, p, "*MESH_NUMVERTEX")) {
+				int n = 0;
+				readInt(p, e, n, ok);
+				vertices.resize(n > 0 ? n : 0, NxVec3(0,0,0));
+			} else if (isKeyword(token, p, "*MESH_NUMFACES")) {
+				int n = 0;
+				readInt(p, e, n, ok);
+				faces.resize(n > 0 ? 3*n : 0, 0);
+			}
 		}
+		p = e + 1;
+	}
+
+	for (NxU32 i = 0; ok && i < faces.size(); i++)
+		ok = faces[i] < vertices.size();
+	valid = ok && vertices.size() > 0 && faces.size() > 0;
+}
+
+// ----------------------------------------------------------------------
+// the objects are independent, each thread parses every numThreads-th one
+
+struct ASEParseJob {
+	std::vector<ASEObject>* objects;
+	int first;
+	int numThreads;
+	NxVec3 offset;
+	NxVec3 scale;
+
+	void run() {
+		for (int i = first; i < (int)objects->size(); i += numThreads)
+			(*objects)[i].parse(offset, scale);
 	}
+};
+
+#if defined(WIN32)
+static DWORD WINAPI aseParseThreadFunc(LPVOID arg) {
+	((ASEParseJob*)arg)->run();
+	return 0;
+}
+#elif defined(COOK_ASE_PTHREADS)
+static void* aseParseThreadFunc(void* arg) {
+	((ASEParseJob*)arg)->run();
+	return NULL;
 }
+#endif
 
-void readFaces(FILE* f, NxArray<NxU32>& faces) {
-	char line[512];
-
-	while(true) {
-		fgets(line, 512, f);
-		char* l = trimFront(line);
-		if (*l == '}') {
-			return;
-		} else if (strstr(l, "*MESH_FACE")) {
-			int a,b,c;
-			int i;
-			sscanf(l, "*MESH_FACE %d: A: %d B: %d C: %d ", &i, &a, &b, &c);
-			faces[3*i+0] = a;
-			faces[3*i+1] = b;
-			faces[3*i+2] = c;
+static int getNumProcessors() {
+#if defined(WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+#elif defined(COOK_ASE_PTHREADS)
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (int)n : 1;
+#else
+	return 1;
+#endif
+}
+
+static void parseObjects(std::vector<ASEObject>& objects, const NxVec3& offset, const NxVec3& scale) {
+	int numThreads = getNumProcessors();
+	if (numThreads > (int)objects.size())
+		numThreads = (int)objects.size();
+	if (numThreads < 1)
+		numThreads = 1;
+
+	std::vector<ASEParseJob> jobs(numThreads);
+	for (int i = 0; i < numThreads; i++) {
+		jobs[i].objects = &objects;
+		jobs[i].first = i;
+		jobs[i].numThreads = numThreads;
+		jobs[i].offset = offset;
+		jobs[i].scale = scale;
+	}
+
+#if defined(WIN32)
+	std::vector<HANDLE> threads(numThreads, (HANDLE)NULL);
+	for (int i = 1; i < numThreads; i++)
+		threads[i] = CreateThread(NULL, 0, aseParseThreadFunc, &jobs[i], 0, NULL);
+	jobs[0].run();
+	for (int i = 1; i < numThreads; i++) {
+		if (threads[i] == NULL) {
+			jobs[i].run();
+			continue;
 		}
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+	}
+#elif defined(COOK_ASE_PTHREADS)
+	std::vector<pthread_t> threads(numThreads);
+	std::vector<bool> started(numThreads, false);
+	for (int i = 1; i < numThreads; i++)
+		started[i] = pthread_create(&threads[i], NULL, aseParseThreadFunc, &jobs[i]) == 0;
+	jobs[0].run();
+	for (int i = 1; i < numThreads; i++) {
+		if (started[i])
+			pthread_join(threads[i], NULL);
+		else
+			jobs[i].run();
 	}
+#else
+	for (int i = 0; i < numThreads; i++)
+		jobs[i].run();
+#endif
 }
 
-void readMesh(FILE* f, NxArray<NxVec3>& vertices, NxArray<NxU32>& faces, NxVec3 scale) {
-	char line[512];
-	int nbVertices;
-	int nbFaces;
-	while(true) {
-		fgets(line, 512, f);
-		char* l = trimFront(line);
-		if (*l == '}') {
-			return;
-		} else if (strstr(l, "*MESH_NUMVERTEX")) {
-			sscanf(l, "*MESH_NUMVERTEX %d", &nbVertices);
-			vertices.resize(nbVertices);
-		} else if (strstr(l, "*MESH_NUMFACES")) {
-			sscanf(l, "*MESH_NUMFACES %d", &nbFaces);
-			faces.resize(nbFaces*3);
-		} else if (strstr(l, "*MESH_VERTEX_LIST {")) {
-			readVertices(f, vertices, scale);
-		} else if (strstr(l, "*MESH_FACE_LIST {")) {
-			readFaces(f, faces);
+// ----------------------------------------------------------------------
+// splits the file at the *GEOMOBJECT lines, a file without any is a single object
+
+static void splitObjects(const char* data, const char* end, std::vector<ASEObject>& objects) {
+	const char* p = data;
+	while (p < end) {
+		const char* e = lineEnd(p, end);
+		const char* token = skipSpaces(p, e);
+		if (isKeyword(token, skipToken(token, e), "*GEOMOBJECT")) {
+			if (!objects.empty())
+				objects.back().end = p;
+			objects.push_back(ASEObject());
+			objects.back().begin = p;
 		}
+		p = e + 1;
 	}
+	if (objects.empty()) {
+		objects.push_back(ASEObject());
+		objects.back().begin = data;
+	}
+	objects.back().end = end;
+}
+
+static char* readFile(const char* filename, size_t& size) {
+	FILE* f = fopen(filename, "rb");
+	if (f == NULL)
+		return NULL;
+	fseek(f, 0, SEEK_END);
+	long len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (len < 0) {
+		fclose(f);
+		return NULL;
+	}
+	char* data = (char*)malloc(len + 1);
+	size = data ? fread(data, 1, len, f) : 0;
+	fclose(f);
+	if (data)
+		data[size] = 0;
+	return data;
 }
 
-NxActor* CookASE(const std::string& filename, NxScene* scene, NxVec3 offset, NxVec3 scale) {
-	_offset = offset;
+NxActor* CookASE(const std::string& filename, NxScene* scene, NxVec3 offset, NxVec3 scale, CookASEStats* stats) {
+	float time = getCurrentTime();
+	CookASEStats s;
+	memset(&s, 0, sizeof(s));
+
 	char buff[1024];
-	//FILE *f = 0;
-	FILE* f = fopen(FindMediaFile(filename.c_str(),buff), "rb");
-	if (f == NULL) {
+	size_t size = 0;
+	char* data = readFile(FindMediaFile(filename.c_str(),buff), size);
+	if (data == NULL) {
 		printf("File not found: %s\n", filename.c_str());
 		return NULL;
 	}
+	float t = getCurrentTime();
+	s.readTime = t - time;
+	time = t;
 
-	NxArray<NxVec3> vertices;
-	NxArray<NxU32> faces;
+	std::vector<ASEObject> objects;
+	splitObjects(data, data + size, objects);
+	parseObjects(objects, offset, scale);
+	free(data);
+
+	t = getCurrentTime();
+	s.parseTime = t - time;
+	time = t;
 
-	char line[512];
-	int linenbr = 0;
-	while (!feof(f)) {
-		fgets(line, 512, f);
-		char* l = trimFront(line);
-		if (!strncmp(l, "*MESH {", 7)) {
-			readMesh(f, vertices, faces, scale);
-		} else {
-			//printf("Line %4d: %s\n", linenbr++, l);
+	// Build physical model, the cooking library is shared and cooks one mesh at a time
+	std::vector<NxTriangleMeshShapeDesc> shapeDescs;
+	shapeDescs.reserve(objects.size());
+	for (int i = 0; i < (int)objects.size(); i++) {
+		ASEObject& o = objects[i];
+		if (!o.valid) {
+			printf("%s: skipping invalid object %d\n", filename.c_str(), i);
+			continue;
 		}
 
+		NxTriangleMeshDesc terrainDesc;
+		terrainDesc.numVertices					= o.vertices.size();
+		terrainDesc.numTriangles				= o.faces.size()/3;
+		terrainDesc.pointStrideBytes			= sizeof(NxVec3);
+		terrainDesc.triangleStrideBytes			= 3*sizeof(NxU32);
+		terrainDesc.points						= &o.vertices[0].x;
+		terrainDesc.triangles					= &o.faces[0];
+		terrainDesc.flags						= NX_MF_HARDWARE_MESH;
+
+		MemoryWriteBuffer buf;
+		if (!CookTriangleMesh(terrainDesc, buf))
+			continue;
+		NxTriangleMesh* terrainMesh	= scene->getPhysicsSDK().createTriangleMesh(MemoryReadBuffer(buf.data));
+		//
+		// Please note about the created Triangle Mesh, user needs to release it when no one uses it to save memory. It can be detected
+		// by API "meshData->getReferenceCount() == 0". And, the release API is "gPhysicsSDK->releaseTriangleMesh(*meshData);"
+		//
+		if (terrainMesh == NULL)
+			continue;
+
+		shapeDescs.push_back(NxTriangleMeshShapeDesc());
+		shapeDescs.back().meshData = terrainMesh;
+
+		s.numObjects++;
+		s.numVertices += terrainDesc.numVertices;
+		s.numTriangles += terrainDesc.numTriangles;
 	}
 
-	fclose(f);
+	t = getCurrentTime();
+	s.cookTime = t - time;
+	time = t;
+
+	NxActor* a = NULL;
+	if (!shapeDescs.empty()) {
+		NxActorDesc ActorDesc;
+		for (NxU32 i = 0; i < shapeDescs.size(); i++)
+			ActorDesc.shapes.pushBack(&shapeDescs[i]);
 
-	// Build physical model
-	NxTriangleMeshDesc terrainDesc;
-	terrainDesc.numVertices					= vertices.size();
-	terrainDesc.numTriangles				= faces.size()/3;
-	terrainDesc.pointStrideBytes			= sizeof(NxVec3);
-	terrainDesc.triangleStrideBytes			= 3*sizeof(NxU32);
-	terrainDesc.points						= &vertices[0].x;
-	terrainDesc.triangles					= &faces[0];
-	terrainDesc.flags						= NX_MF_HARDWARE_MESH;
-
-	//terrainDesc.heightFieldVerticalAxis		= NX_Y;
-	//terrainDesc.heightFieldVerticalExtent	= -1000.0f;
-	MemoryWriteBuffer buf;
-	bool status = CookTriangleMesh(terrainDesc, buf);
-	NxTriangleMesh* terrainMesh	= scene->getPhysicsSDK().createTriangleMesh(MemoryReadBuffer(buf.data));
-	//
-	// Please note about the created Triangle Mesh, user needs to release it when no one uses it to save memory. It can be detected
-	// by API "meshData->getReferenceCount() == 0". And, the release API is "gPhysicsSDK->releaseTriangleMesh(*meshData);"
-	//
-
-
-	NxTriangleMeshShapeDesc terrainMeshDesc;
-	terrainMeshDesc.meshData = terrainMesh;
-
-
-	NxActorDesc ActorDesc;
-	ActorDesc.shapes.pushBack(&terrainMeshDesc);
-	
-	NxActor* a = scene->createActor(ActorDesc);
-	
-	assert(a != NULL);
-	assert(a->getNbShapes() == 1);
-	NxShape* s = a->getShapes()[0];
-	assert(s != NULL);
-	NxTriangleMeshShape* ts = s->isTriangleMesh();
-	assert(ts != NULL);
-	NxTriangleMeshDesc* tmd= new NxTriangleMeshDesc();
-	ts->getTriangleMesh().saveToDesc(*tmd);
-	ts->userData = tmd;
+		a = scene->createActor(ActorDesc);
+
+		assert(a != NULL);
+		assert(a->getNbShapes() == shapeDescs.size());
+		for (NxU32 i = 0; a && i < a->getNbShapes(); i++) {
+			NxShape* shape = a->getShapes()[i];
+			assert(shape != NULL);
+			NxTriangleMeshShape* ts = shape->isTriangleMesh();
+			assert(ts != NULL);
+			NxTriangleMeshDesc* tmd= new NxTriangleMeshDesc();
+			ts->getTriangleMesh().saveToDesc(*tmd);
+			ts->userData = tmd;
+		}
+	}
+
+	s.createTime = getCurrentTime() - time;
+	if (stats)
+		*stats = s;
 
 	return a;
 }
-
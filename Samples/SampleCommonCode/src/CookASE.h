@@ -3,4 +3,16 @@ class NxScene;
 #include <string>
 #include <NxVec3.h>
 
-NxActor* CookASE(const std::string& filename, NxScene* scene, NxVec3 offset = NxVec3(0,0,0), NxVec3 scale = NxVec3(1,1,1));
+// per stage timing of CookASE, times are in seconds
+struct CookASEStats {
+	int numObjects;
+	int numVertices;
+	int numTriangles;
+	float readTime;
+	float parseTime;
+	float cookTime;
+	float createTime;
+};
+
+// every *GEOMOBJECT of the file becomes a triangle mesh shape of the returned static actor
+NxActor* CookASE(const std::string& filename, NxScene* scene, NxVec3 offset = NxVec3(0,0,0), NxVec3 scale = NxVec3(1,1,1), CookASEStats* stats = NULL);
@@ -1,4 +1,7 @@
 #include "ObjMesh.h"
+#include "Timing.h"
+#include "ObjReader.h"
+#include "NxBatchMath.h"
 #if defined(__APPLE__)
 #include <GLUT/glut.h>
 #else
@@ -36,6 +39,10 @@ void ObjMesh::clear()
 	mBounds.setEmpty();
 	mHasTextureCoords = false;
 	mHasNormals = false;
+	mBVH.clear();
+	mBVHNeedsRefit = false;
+	mNormalBuilder.release();
+	mNormalTopologyDirty = true;
 
 	strcpy(mPath, "");
 	strcpy(mName, "");
@@ -174,6 +181,7 @@ void ObjMesh::setDiagonal(NxReal diagonal)
 	for (int i = 0; i < (int)mVertices.size(); i++) 
 		mVertices[i] *= s;
 	updateBounds();
+	mBVHNeedsRefit = true;
 }
 
 // ----------------------------------------------------------------------
@@ -183,17 +191,17 @@ void ObjMesh::setCenter(const NxVec3 &center)
 	for (int i = 0; i < (int)mVertices.size(); i++) 
 		mVertices[i] += d;
 	updateBounds();
+	mBVHNeedsRefit = true;
 }
 
 // ----------------------------------------------------------------------
 void ObjMesh::transform(const NxMat34 &a)
 {
-	for (int i = 0; i < (int)mVertices.size(); i++) {
-		NxVec3 &v = mVertices[i];
-		v = a * v;
-	}
+	if (!mVertices.empty())
+		NxBatchMath::transform(a, &mVertices[0], &mVertices[0], (NxU32)mVertices.size());
 	updateBounds();
 	updateNormals();
+	mBVHNeedsRefit = true;
 }
 
 // ----------------------------------------------------------------------
@@ -209,24 +217,27 @@ void ObjMesh::getTriangleBounds(int i, NxBounds3 &bounds) const
 // ----------------------------------------------------------------------
 void ObjMesh::updateNormals()
 {
-	mNormals.resize(mVertices.size());
-	int i;
-	for (i = 0; i < (int)mNormals.size(); i++) 
-		mNormals[i].zero();
-	NxVec3 n;
-	for (i = 0; i < (int)mTriangles.size(); i++) {
-		ObjMeshTriangle &mt = mTriangles[i];
-		mt.normalNr[0] = mt.vertexNr[0];
-		mt.normalNr[1] = mt.vertexNr[1];
-		mt.normalNr[2] = mt.vertexNr[2];
-		n.cross(mVertices[mt.vertexNr[1]] - mVertices[mt.vertexNr[0]], 
-			mVertices[mt.vertexNr[2]] - mVertices[mt.vertexNr[0]]);
-		mNormals[mt.normalNr[0]] += n;
-		mNormals[mt.normalNr[1]] += n;
-		mNormals[mt.normalNr[2]] += n;
+	if (mVertices.empty()) {
+		mNormals.clear();
+		return;
 	}
-	for (i = 0; i < (int)mNormals.size(); i++) 
-		mNormals[i].normalize();
+	if (mNormalTopologyDirty) {
+		// normals are stored per vertex, the adjacency only changes with the triangles
+		NxArray<NxU32> indices;
+		indices.reserve((NxU32)mTriangles.size() * 3);
+		for (int i = 0; i < (int)mTriangles.size(); i++) {
+			ObjMeshTriangle &mt = mTriangles[i];
+			for (int j = 0; j < 3; j++) {
+				mt.normalNr[j] = mt.vertexNr[j];
+				indices.pushBack((NxU32)mt.vertexNr[j]);
+			}
+		}
+		mNormalBuilder.init((NxU32)mTriangles.size(), (NxU32)mVertices.size(), 
+			indices.empty() ? NULL : &indices[0], NULL);
+		mNormalTopologyDirty = false;
+	}
+	mNormals.resize(mVertices.size());
+	mNormalBuilder.compute(&mVertices[0], &mNormals[0]);
 }
 
 // ----------------------------------------------------------------------
@@ -242,52 +253,71 @@ bool ObjMesh::rayTriangleIntersection(const NxVec3 &orig, const NxVec3 &dir,
 	 									 const ObjMeshTriangle &triangle,
 	 									 NxReal &t, NxReal &u, NxReal &v) const
 {
-	const NxVec3 &a = mVertices[triangle.vertexNr[0]];
-	const NxVec3 &b = mVertices[triangle.vertexNr[0]];
-	const NxVec3 &c = mVertices[triangle.vertexNr[0]];
-
-	NxVec3 edge1, edge2, tvec, pvec, qvec;
-	NxReal det,inv_det;
+	return ObjMeshBVH::rayTriangleIntersection(orig, dir, mVertices[triangle.vertexNr[0]],
+		mVertices[triangle.vertexNr[1]], mVertices[triangle.vertexNr[2]], t, u, v);
+}
 
-	edge1 = b - a;
-	edge2 = c - a;
-	pvec.cross(dir, edge2);
+// ----------------------------------------------------------------------
+void ObjMesh::updateBVH()
+{
+	if (mTriangles.empty())
+		return;
+	if (mBVH.isEmpty()) {
+		mBVH.build(&mVertices[0], &mTriangles[0], (int)mTriangles.size());
+		mBVHNeedsRefit = false;
+	}
+	else if (mBVHNeedsRefit) {
+		mBVH.refit(&mVertices[0], &mTriangles[0]);
+		mBVHNeedsRefit = false;
+	}
+}
 
-	/* if determinant is near zero, ray lies in plane of triangle */
-	det = edge1.dot(pvec);
+// ----------------------------------------------------------------------
+bool ObjMesh::rayCast(const NxVec3 &orig, const NxVec3 &dir, NxReal &t)
+{
+	int triNr;
+	return rayCast(orig, dir, t, triNr);
+}
 
-	if (det == 0.0f)
+// ----------------------------------------------------------------------
+bool ObjMesh::rayCast(const NxVec3 &orig, const NxVec3 &dir, NxReal &t, int &triNr)
+{
+	t = -1.0f;
+	triNr = -1;
+	updateBVH();
+	if (mBVH.isEmpty())
 		return false;
-	inv_det = 1.0f / det;
-
-	/* calculate distance from vert0 to ray origin */
-	tvec = orig - a;
-
-	/* calculate U parameter and test bounds */
-	u = tvec.dot(pvec) * inv_det;
-	if (u < 0.0f || u > 1.0f)
-	return false;
-
-	/* prepare to test V parameter */
-	qvec.cross(tvec, edge1);
-
-	/* calculate V parameter and test bounds */
-	v = dir.dot(qvec) * inv_det;
-	if (v < 0.0f || u + v > 1.0f)
-	return false;
+	return mBVH.rayCast(&mVertices[0], &mTriangles[0], orig, dir, t, triNr);
+}
 
-	/* calculate t, ray intersects triangle */
-	t = edge2.dot(qvec) * inv_det;
+// ----------------------------------------------------------------------
+int ObjMesh::rayCast4(const NxVec3 origs[4], const NxVec3 dirs[4], NxReal t[4], int triNrs[4])
+{
+	updateBVH();
+	if (mBVH.isEmpty()) {
+		for (int i = 0; i < 4; i++) { t[i] = -1.0f; triNrs[i] = -1; }
+		return 0;
+	}
+	return mBVH.rayCast4(&mVertices[0], &mTriangles[0], origs, dirs, t, triNrs);
+}
 
-	return true;
+// ----------------------------------------------------------------------
+int ObjMesh::rayCast8(const NxVec3 origs[8], const NxVec3 dirs[8], NxReal t[8], int triNrs[8])
+{
+	updateBVH();
+	if (mBVH.isEmpty()) {
+		for (int i = 0; i < 8; i++) { t[i] = -1.0f; triNrs[i] = -1; }
+		return 0;
+	}
+	return mBVH.rayCast8(&mVertices[0], &mTriangles[0], origs, dirs, t, triNrs);
 }
 
 // ----------------------------------------------------------------------
-bool ObjMesh::rayCast(const NxVec3 &orig, const NxVec3 &dir, NxReal &t)
+bool ObjMesh::rayCastBruteForce(const NxVec3 &orig, const NxVec3 &dir, NxReal &t) const
 {
 	t = -1.0f;
 	for (int i = 0; i < (int)mTriangles.size(); i++) {
-		ObjMeshTriangle &mt = mTriangles[i];
+		const ObjMeshTriangle &mt = mTriangles[i];
 		NxReal ti, u,v;
 		if (!rayTriangleIntersection(orig, dir, mt, ti, u,v))
 			continue;
@@ -297,6 +327,49 @@ bool ObjMesh::rayCast(const NxVec3 &orig, const NxVec3 &dir, NxReal &t)
 	return t >= 0.0f;
 }
 
+// ----------------------------------------------------------------------
+void ObjMesh::benchmarkRayCast(int numRays, float &bruteForceTime, float &bvhTime, float &packetTime)
+{
+	bruteForceTime = bvhTime = packetTime = 0.0f;
+	numRays = (numRays + 7) & ~7;
+	if (numRays <= 0 || mTriangles.empty())
+		return;
+
+	// rays from random points on a sphere around the mesh towards random points inside
+	std::vector<NxVec3> origs(numRays), dirs(numRays);
+	std::vector<NxReal> t(numRays);
+	std::vector<int> triNrs(numRays);
+	NxVec3 center = (mBounds.min + mBounds.max) * 0.5f;
+	NxVec3 extents = (mBounds.max - mBounds.min) * 0.5f;
+	NxReal radius = extents.magnitude() * 2.0f;
+	int i;
+	for (i = 0; i < numRays; i++) {
+		NxVec3 d(NxMath::rand(-1.0f, 1.0f), NxMath::rand(-1.0f, 1.0f), NxMath::rand(-1.0f, 1.0f));
+		if (d.normalize() == 0.0f) d.set(0.0f, 1.0f, 0.0f);
+		origs[i] = center + d * radius;
+		NxVec3 target(center.x + NxMath::rand(-extents.x, extents.x),
+			center.y + NxMath::rand(-extents.y, extents.y), center.z + NxMath::rand(-extents.z, extents.z));
+		dirs[i] = target - origs[i];
+	}
+
+	updateBVH();	// building is not part of the measurement
+
+	float startTime = getCurrentTime();
+	for (i = 0; i < numRays; i++)
+		rayCastBruteForce(origs[i], dirs[i], t[i]);
+	bruteForceTime = getCurrentTime() - startTime;
+
+	startTime = getCurrentTime();
+	for (i = 0; i < numRays; i++)
+		rayCast(origs[i], dirs[i], t[i], triNrs[i]);
+	bvhTime = getCurrentTime() - startTime;
+
+	startTime = getCurrentTime();
+	for (i = 0; i < numRays; i += 8)
+		rayCast8(&origs[i], &dirs[i], &t[i], &triNrs[i]);
+	packetTime = getCurrentTime() - startTime;
+}
+
 // --------------------------------------------------------------------------
 void ObjMesh::extractPath(char *filename)
 {
@@ -315,221 +388,169 @@ void ObjMesh::extractPath(char *filename)
 
 #if !defined(__PPCGEKKO__)
 //-----------------------------------------------------------------------------
-bool ObjMesh::importMtlFile(char *mtllib)
+bool ObjMesh::importMtlFile(const char *mtllib)
 {
 	ObjMeshString fname;
 	sprintf(fname, "%s\\%s", mPath, mtllib);
-	
-	FILE *f = fopen(fname, "r");
-	if (!f) return false;
-	mMaterials.clear();
-	ObjMeshString s;
-	ObjMeshMaterial mat;
-	mat.init();
-	while (!feof(f)) {
-		fgets(s, OBJ_MESH_STRING_LEN, f);
-		if (strncasecmp(s, "newmtl", 6) == 0) {
-			if (strlen(mat.name) > 0)
-				mMaterials.push_back(mat);
-			mat.init();
-			sscanf(&s[7], "%s", mat.name);
-		}
-		else if (strncasecmp(s, "Ka", 2) == 0) {
-			sscanf(&s[3], "%f %f %f", &mat.ambient[0], &mat.ambient[1], &mat.ambient[2]);
-		}
-		else if (strncasecmp(s, "Kd", 2) == 0) {
-			sscanf(&s[3], "%f %f %f", &mat.diffuse[0], &mat.diffuse[1], &mat.diffuse[2]);
-		}
-		else if (strncasecmp(s, "Ks", 2) == 0) {
-			sscanf(&s[3], "%f %f %f", &mat.specular[0], &mat.specular[1], &mat.specular[2]);
-		}
-		else if (strncasecmp(s, "Ns", 2) == 0) {
-			sscanf(&s[3], "%f", &mat.shininess);
-		}
-		else if (strncasecmp(s, "Tr", 2) == 0) {
-			sscanf(&s[3], "%f", &mat.alpha);
-		}
-		else if (strncasecmp(s, "d ", 2) == 0) {
-			sscanf(&s[2], "%f", &mat.alpha);
-		}
-		else if (strncasecmp(s, "map_K ", 5) == 0) {
-			sscanf(&s[7], "%s", mat.texFilename);
-		}
-	}
-	if (strlen(mat.name) > 0)
-		mMaterials.push_back(mat);
-	fclose(f);
-
-	return true;
-}
 
+	std::vector<ObjReaderMaterial> materials;
+	if (!ObjReader::loadMtl(fname, materials))
+		return false;
 
-//-----------------------------------------------------------------------------
-void parseRef(char *s, int nr[])
-{
-	int i,j,k;
-	for (k = 0; k < 3; k++)
-		nr[k] = -1;
-
-	int len = (int) strlen(s);
-	char is[256]; i = 0;
-
-	for (k = 0; k < 3; k++) {
-		j = 0;
-		while (i < len && s[i] != '/') {
-			is[j] = s[i]; i++; j++;
-		}
-		i++;
-		if (j > 0) {
-			is[j] = 0;
-			sscanf(is, "%i", &nr[k]);
+	mMaterials.clear();
+	for (int i = 0; i < (int)materials.size(); i++) {
+		const ObjReaderMaterial &src = materials[i];
+		ObjMeshMaterial mat;
+		mat.init();
+		strncpy(mat.name, src.name.c_str(), OBJ_MESH_STRING_LEN-1);
+		strncpy(mat.texFilename, src.texFilename.c_str(), OBJ_MESH_STRING_LEN-1);
+		for (int j = 0; j < 3; j++) {
+			mat.ambient[j] = src.ambient[j];
+			mat.diffuse[j] = src.diffuse[j];
+			mat.specular[j] = src.specular[j];
 		}
+		mat.alpha = src.alpha;
+		mat.shininess = src.shininess;
+		mMaterials.push_back(mat);
 	}
+	return true;
 }
 
 // ----------------------------------------------------------------------
 bool ObjMesh::loadFromObjFile(char *filename)
 {
-	FILE *f = fopen(filename, "r");
-	if (!f) return false;
+	ObjReader reader;
+	if (!reader.load(filename))
+		return false;
 	clear();
-	ObjMeshString s, subs[maxVerticesPerFace];
-	ObjMeshString mtllib, matName;
 
-	mHasTextureCoords = false;
-	mHasNormals = false;
-
-	strcpy(mtllib, "");
-	int materialNr = -1;
+	extractPath(filename);
 	int i,j;
-	NxVec3 v;
-	ObjMeshTriangle t;
-	TexCoord tc;
+	for (i = 0; i < (int)reader.mMaterialLibs.size(); i++)
+		importMtlFile(reader.mMaterialLibs[i].c_str());
+
+	// usemtl names -> material numbers
+	std::vector<int> materialNrs(reader.mMaterialNames.size());
+	for (i = 0; i < (int)reader.mMaterialNames.size(); i++) {
+		int materialNr = 0;
+		int numMaterials = (int)mMaterials.size();
+		while (materialNr < numMaterials &&
+			   strcasecmp(mMaterials[materialNr].name, reader.mMaterialNames[i].c_str()) != 0)
+			materialNr++;
+		materialNrs[i] = materialNr < numMaterials ? materialNr : -1;
+	}
+
+	int numVertices = reader.getNumPositions();
+	int numNormals = reader.getNumNormals();
+	int numTexCoords = reader.getNumTexCoords();
+	mVertices.resize(numVertices);
+	for (i = 0; i < numVertices; i++)
+		mVertices[i].set(&reader.mPositions[3*i]);
+	mNormals.resize(numNormals);
+	for (i = 0; i < numNormals; i++)
+		mNormals[i].set(&reader.mNormals[3*i]);
+	mTexCoords.resize(numTexCoords);
+	for (i = 0; i < numTexCoords; i++) {
+		mTexCoords[i].u = reader.mTexCoords[2*i];
+		mTexCoords[i].v = reader.mTexCoords[2*i+1];
+	}
 
 	std::vector<NxVec3> centermVertices;
 	std::vector<TexCoord> centermTexCoords;
 	std::vector<NxVec3> centerNormals;
+	std::vector<int> vertNr, texNr, normalNr;
+	ObjMeshTriangle t;
 
-	extractPath(filename);
-
-	while (!feof(f)) {
-		if (fgets(s, OBJ_MESH_STRING_LEN, f) == NULL) break;
-
-		if (strncmp(s, "mtllib", 6) == 0) {  // material library
-			sscanf(&s[7], "%s", mtllib);
-			importMtlFile(mtllib);
-		}
-		else if (strncmp(s, "usemtl", 6) == 0) {  // use material
-			sscanf(&s[7], "%s", matName);
-			materialNr = 0;
-			int numMaterials = (int)mMaterials.size();
-			while (materialNr < numMaterials &&
-				   strcasecmp(mMaterials[materialNr].name, matName) != 0)
-				materialNr++;
-			if (materialNr >= numMaterials) 
-				materialNr = -1;
-		}
-		else if (strncmp(s, "v ", 2) == 0) {	// vertex
-			sscanf(s, "v %f %f %f", &v.x, &v.y, &v.z);
-			mVertices.push_back(v);
-		}
-		else if (strncmp(s, "vn ", 3) == 0) {	// normal
-			sscanf(s, "vn %f %f %f", &v.x, &v.y, &v.z);
-			mNormals.push_back(v);
+	mTriangles.reserve(reader.getNumFaces());
+	for (int f = 0; f < reader.getNumFaces(); f++) {
+		const ObjReaderFace &face = reader.mFaces[f];
+		int nr = face.numCorners;
+		if (nr < 3) continue;
+		int materialNr = face.material >= 0 ? materialNrs[face.material] : -1;
+
+		vertNr.resize(nr); texNr.resize(nr); normalNr.resize(nr);
+		bool valid = true;
+		for (i = 0; i < nr; i++) {
+			const ObjReaderCorner &c = reader.mCorners[face.firstCorner + i];
+			vertNr[i] = c.v;
+			texNr[i] = c.t < numTexCoords ? c.t : -1;
+			normalNr[i] = c.n < numNormals ? c.n : -1;
+			if (c.v < 0 || c.v >= numVertices) valid = false;
 		}
-		else if (strncmp(s, "vt ", 3) == 0) {	// texture coords
-			sscanf(s, "vt %f %f", &tc.u, &tc.v);
-			mTexCoords.push_back(tc);
-		}
-		else if (strncmp(s, "f ", 2) == 0) {	// face
-			int nr;
-			nr = sscanf(s, "f %s %s %s %s %s %s %s %s %s %s %s %s %s %s %s",
-			subs[0], subs[1], subs[2], subs[3], subs[4],
-			subs[5], subs[6], subs[7], subs[8], subs[9],
-			subs[10], subs[11], subs[12],subs[13], subs[14]);
-			int vertNr[maxVerticesPerFace], texNr[maxVerticesPerFace];
-			int normalNr[maxVerticesPerFace];
-			for (i = 0; i < nr; i++) {
-				int refs[3];
-				parseRef(subs[i], refs);
-				vertNr[i] = refs[0]-1;
-				texNr[i] = refs[1]-1;
-				normalNr[i] = refs[2]-1;
+		if (!valid) continue;
+
+		if (nr <= 4) {	// simple non-singular triangle or quad
+			if (vertNr[0] != vertNr[1] && vertNr[1] != vertNr[2] && vertNr[2] != vertNr[0]) {
+				t.init();
+				t.vertexNr[0] = vertNr[0];
+				t.vertexNr[1] = vertNr[1];
+				t.vertexNr[2] = vertNr[2];
+				t.normalNr[0] = normalNr[0];
+				t.normalNr[1] = normalNr[1];
+				t.normalNr[2] = normalNr[2];
+				t.texCoordNr[0] = texNr[0];
+				t.texCoordNr[1] = texNr[1];
+				t.texCoordNr[2] = texNr[2];
+				t.materialNr = materialNr;
+				mTriangles.push_back(t);
 			}
-			if (nr <= 4) {	// simple non-singular triangle or quad
-				if (vertNr[0] != vertNr[1] && vertNr[1] != vertNr[2] && vertNr[2] != vertNr[0]) {
+			if (nr == 4) {	// non-singular quad -> generate a second triangle
+				if (vertNr[2] != vertNr[3] && vertNr[3] != vertNr[0] && vertNr[0] != vertNr[2]) {
 					t.init();
-					t.vertexNr[0] = vertNr[0];
-					t.vertexNr[1] = vertNr[1];
-					t.vertexNr[2] = vertNr[2];
-					t.normalNr[0] = normalNr[0];
-					t.normalNr[1] = normalNr[1];
-					t.normalNr[2] = normalNr[2];
-					t.texCoordNr[0] = texNr[0];
-					t.texCoordNr[1] = texNr[1];
-					t.texCoordNr[2] = texNr[2];
+					t.vertexNr[0] = vertNr[2];
+					t.vertexNr[1] = vertNr[3];
+					t.vertexNr[2] = vertNr[0];
+					t.normalNr[0] = normalNr[2];
+					t.normalNr[1] = normalNr[3];
+					t.normalNr[2] = normalNr[0];
+					t.texCoordNr[0] = texNr[2];
+					t.texCoordNr[1] = texNr[3];
+					t.texCoordNr[2] = texNr[0];
 					t.materialNr = materialNr;
 					mTriangles.push_back(t);
 				}
-				if (nr == 4) {	// non-singular quad -> generate a second triangle
-					if (vertNr[2] != vertNr[3] && vertNr[3] != vertNr[0] && vertNr[0] != vertNr[2]) {
-						t.init();
-						t.vertexNr[0] = vertNr[2];
-						t.vertexNr[1] = vertNr[3];
-						t.vertexNr[2] = vertNr[0];
-						t.normalNr[0] = normalNr[2];
-						t.normalNr[1] = normalNr[3];
-						t.normalNr[2] = normalNr[0];
-						t.texCoordNr[0] = texNr[0];
-						t.texCoordNr[1] = texNr[1];
-						t.texCoordNr[2] = texNr[2];
-						t.materialNr = materialNr;
-						mTriangles.push_back(t);
-					}
-				}
 			}
-			else {	// polygonal face
-
-				// compute center properties
-				NxVec3 centerPos(0.0f, 0.0f, 0.0f);
-				TexCoord centerTex; centerTex.zero();
-				for (i = 0; i < nr; i++) {
-					centerPos += mVertices[vertNr[i]];
-					if (texNr[i] >= 0) centerTex += mTexCoords[texNr[i]];
-				}
-				centerPos /= (float)nr;
-				centerTex /= (float)nr;
-				NxVec3 d1 = centerPos - mVertices[vertNr[0]];
-				NxVec3 d2 = centerPos - mVertices[vertNr[1]];
-				NxVec3 centerNormal = d1.cross(d2); centerNormal.normalize();
-
-				// add center vertex
-				centermVertices.push_back(centerPos);
-				centermTexCoords.push_back(centerTex);
-				centerNormals.push_back(centerNormal);
-
-				// add surrounding elements
-				for (i = 0; i < nr; i++) {
-					j = i+1; if (j >= nr) j = 0;
-					t.init();
-					t.vertexNr[0] = (int) mVertices.size() + (int) centermVertices.size()-1;
-					t.vertexNr[1] = vertNr[i];
-					t.vertexNr[2] = vertNr[j];
-
-					t.normalNr[0] = (int) mNormals.size() + (int) centerNormals.size()-1;
-					t.normalNr[1] = normalNr[i];
-					t.normalNr[2] = normalNr[j];
+		}
+		else {	// polygonal face
 
-					t.texCoordNr[0] = (int) mTexCoords.size() + (int) centermTexCoords.size()-1;
-					t.texCoordNr[1] = texNr[i];
-					t.texCoordNr[2] = texNr[j];
-					t.materialNr = materialNr;
-					mTriangles.push_back(t);
-				}
+			// compute center properties
+			NxVec3 centerPos(0.0f, 0.0f, 0.0f);
+			TexCoord centerTex; centerTex.zero();
+			for (i = 0; i < nr; i++) {
+				centerPos += mVertices[vertNr[i]];
+				if (texNr[i] >= 0) centerTex += mTexCoords[texNr[i]];
+			}
+			centerPos /= (float)nr;
+			centerTex /= (float)nr;
+			NxVec3 d1 = centerPos - mVertices[vertNr[0]];
+			NxVec3 d2 = centerPos - mVertices[vertNr[1]];
+			NxVec3 centerNormal = d1.cross(d2); centerNormal.normalize();
+
+			// add center vertex
+			centermVertices.push_back(centerPos);
+			centermTexCoords.push_back(centerTex);
+			centerNormals.push_back(centerNormal);
+
+			// add surrounding elements
+			for (i = 0; i < nr; i++) {
+				j = i+1; if (j >= nr) j = 0;
+				t.init();
+				t.vertexNr[0] = numVertices + (int) centermVertices.size()-1;
+				t.vertexNr[1] = vertNr[i];
+				t.vertexNr[2] = vertNr[j];
+
+				t.normalNr[0] = numNormals + (int) centerNormals.size()-1;
+				t.normalNr[1] = normalNr[i];
+				t.normalNr[2] = normalNr[j];
+
+				t.texCoordNr[0] = numTexCoords + (int) centermTexCoords.size()-1;
+				t.texCoordNr[1] = texNr[i];
+				t.texCoordNr[2] = texNr[j];
+				t.materialNr = materialNr;
+				mTriangles.push_back(t);
 			}
 		}
 	}
-	fclose(f);
 
 	// new center mVertices are inserted here.
 	// If they were inserted when generated, the vertex numbering would be corrupted
@@ -759,6 +780,7 @@ void ObjMesh::removeTrisRelatedToVertex(const int vertexIndex) {
 			// set all 3 vertices to vertex[0]
 			mTriangles[currentTri].vertexNr[1] = mTriangles[currentTri].vertexNr[0];
 			mTriangles[currentTri].vertexNr[2] = mTriangles[currentTri].vertexNr[0];
+			mNormalTopologyDirty = true;
 		}
 	}
 }
@@ -797,6 +819,7 @@ bool ObjMesh::updateTetraLinks(const NxMeshData &tetraMeshData)
 		}
 	}
 	updateNormals();
+	mBVHNeedsRefit = true;
 
 	return true;
 }
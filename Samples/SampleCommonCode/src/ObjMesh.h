@@ -3,6 +3,8 @@
 
 #include "glRenderer.h"
 #include "MeshHash.h"
+#include "ObjMeshBVH.h"
+#include "NxVertexNormals.h"
 
 #ifndef __PPCGEKKO__
 #include <iostream>
@@ -99,15 +101,24 @@ public:
 	 									 const ObjMeshTriangle &triangle, 
 										 NxReal &t, NxReal &u, NxReal &v) const;
 
+	// ray casts go through a lazily built bounding volume hierarchy
 	bool rayCast(const NxVec3 &orig, const NxVec3 &dir, NxReal &t);
+	bool rayCast(const NxVec3 &orig, const NxVec3 &dir, NxReal &t, int &triNr);
+	int  rayCast4(const NxVec3 origs[4], const NxVec3 dirs[4], NxReal t[4], int triNrs[4]);
+	int  rayCast8(const NxVec3 origs[8], const NxVec3 dirs[8], NxReal t[8], int triNrs[8]);
+	bool rayCastBruteForce(const NxVec3 &orig, const NxVec3 &dir, NxReal &t) const;
+
+	// casts numRays random rays through the bounds, times are in seconds
+	void benchmarkRayCast(int numRays, float &bruteForceTime, float &bvhTime, float &packetTime);
 
 	const char* getName() const { return mName; }
 
 protected:
-	bool importMtlFile(char *mtllib);
+	bool importMtlFile(const char *mtllib);
 	void extractPath(char *filename);
 	void updateNormals();
 	void updateBounds();
+	void updateBVH();
 
 	bool updateTetraLinks(const NxMeshData &tetraMeshData);
 
@@ -147,6 +158,12 @@ protected:
 	NxBounds3 mBounds;
 	bool mHasTextureCoords;
 	bool mHasNormals;
+
+	ObjMeshBVH mBVH;
+	bool mBVHNeedsRefit;
+
+	NxVertexNormalBuilder mNormalBuilder;
+	bool mNormalTopologyDirty;
 };
 
 
@@ -0,0 +1,345 @@
+#include "ObjMeshBVH.h"
+#include "ObjMesh.h"
+#include <algorithm>
+
+// -------------------------------------------------------------------------------------
+struct ObjMeshBVHCentroidLess {
+	ObjMeshBVHCentroidLess(const NxVec3 *centroids, int axis) : mCentroids(centroids), mAxis(axis) {}
+	bool operator()(int i0, int i1) const { return mCentroids[i0][mAxis] < mCentroids[i1][mAxis]; }
+	const NxVec3 *mCentroids;
+	int mAxis;
+};
+
+// -------------------------------------------------------------------------------------
+static inline void computeInvDir(const NxVec3 &dir, NxVec3 &invDir)
+{
+	// a huge value instead of infinity avoids 0 * inf for rays starting on a slab
+	invDir.x = dir.x != 0.0f ? 1.0f / dir.x : NX_MAX_REAL;
+	invDir.y = dir.y != 0.0f ? 1.0f / dir.y : NX_MAX_REAL;
+	invDir.z = dir.z != 0.0f ? 1.0f / dir.z : NX_MAX_REAL;
+}
+
+// -------------------------------------------------------------------------------------
+static inline bool rayBoxOverlap(const NxBounds3 &bounds, const NxVec3 &orig, const NxVec3 &invDir, NxReal maxT)
+{
+	NxReal t0 = (bounds.min.x - orig.x) * invDir.x;
+	NxReal t1 = (bounds.max.x - orig.x) * invDir.x;
+	NxReal tmin = NxMath::min(t0, t1);
+	NxReal tmax = NxMath::max(t0, t1);
+
+	t0 = (bounds.min.y - orig.y) * invDir.y;
+	t1 = (bounds.max.y - orig.y) * invDir.y;
+	tmin = NxMath::max(tmin, NxMath::min(t0, t1));
+	tmax = NxMath::min(tmax, NxMath::max(t0, t1));
+
+	t0 = (bounds.min.z - orig.z) * invDir.z;
+	t1 = (bounds.max.z - orig.z) * invDir.z;
+	tmin = NxMath::max(tmin, NxMath::min(t0, t1));
+	tmax = NxMath::min(tmax, NxMath::max(t0, t1));
+
+	return tmax >= NxMath::max(tmin, 0.0f) && tmin <= maxT;
+}
+
+// -------------------------------------------------------------------------------------
+ObjMeshBVH::ObjMeshBVH()
+{
+}
+
+// -------------------------------------------------------------------------------------
+ObjMeshBVH::~ObjMeshBVH()
+{
+}
+
+// -------------------------------------------------------------------------------------
+void ObjMeshBVH::clear()
+{
+	mNodes.clear();
+	mTriIndices.clear();
+	mCentroids.clear();
+}
+
+// -------------------------------------------------------------------------------------
+void ObjMeshBVH::build(const NxVec3 *vertices, const ObjMeshTriangle *triangles, int numTriangles)
+{
+	clear();
+	if (numTriangles <= 0)
+		return;
+
+	mTriIndices.resize(numTriangles);
+	mCentroids.resize(numTriangles);
+	for (int i = 0; i < numTriangles; i++) {
+		const ObjMeshTriangle &mt = triangles[i];
+		mTriIndices[i] = i;
+		mCentroids[i] = (vertices[mt.vertexNr[0]] + vertices[mt.vertexNr[1]] + vertices[mt.vertexNr[2]]) * (1.0f / 3.0f);
+	}
+
+	// a median split creates at most 2n/maxTrianglesPerLeaf nodes
+	mNodes.reserve(2 * (numTriangles / maxTrianglesPerLeaf + 1));
+	ObjMeshBVHNode root;
+	root.first = 0;
+	root.count = numTriangles;
+	mNodes.push_back(root);
+
+	// the leaves first store their triangle range, the bounds are computed by the refit
+	std::vector<int> stack;
+	stack.push_back(0);
+	while (!stack.empty()) {
+		int nodeNr = stack.back();
+		stack.pop_back();
+		int left = subdivide(nodeNr, mNodes[nodeNr].first, mNodes[nodeNr].count);
+		if (left >= 0) {
+			stack.push_back(left + 1);
+			stack.push_back(left);
+		}
+	}
+
+	mCentroids.clear();
+	refit(vertices, triangles);
+}
+
+// -------------------------------------------------------------------------------------
+int ObjMeshBVH::subdivide(int nodeNr, int first, int count)
+{
+	if (count <= maxTrianglesPerLeaf)
+		return -1;
+
+	NxBounds3 centroidBounds;
+	centroidBounds.setEmpty();
+	for (int i = first; i < first + count; i++)
+		centroidBounds.include(mCentroids[mTriIndices[i]]);
+
+	NxVec3 extents = centroidBounds.max - centroidBounds.min;
+	int axis = 0;
+	if (extents.y > extents[axis]) axis = 1;
+	if (extents.z > extents[axis]) axis = 2;
+	if (extents[axis] <= 0.0f)		// all centroids coincide, splitting does not help
+		return -1;
+
+	int half = count / 2;
+	std::nth_element(mTriIndices.begin() + first, mTriIndices.begin() + first + half,
+		mTriIndices.begin() + first + count, ObjMeshBVHCentroidLess(&mCentroids[0], axis));
+
+	int left = (int)mNodes.size();
+	ObjMeshBVHNode child;
+	child.first = first;
+	child.count = half;
+	mNodes.push_back(child);
+	child.first = first + half;
+	child.count = count - half;
+	mNodes.push_back(child);
+
+	ObjMeshBVHNode &node = mNodes[nodeNr];
+	node.first = left;
+	node.count = 0;
+	return left;
+}
+
+// -------------------------------------------------------------------------------------
+void ObjMeshBVH::refit(const NxVec3 *vertices, const ObjMeshTriangle *triangles)
+{
+	// children are always stored after their parent
+	for (int i = (int)mNodes.size()-1; i >= 0; i--) {
+		ObjMeshBVHNode &node = mNodes[i];
+		if (node.count > 0) {
+			node.bounds.setEmpty();
+			for (int j = node.first; j < node.first + node.count; j++) {
+				const ObjMeshTriangle &mt = triangles[mTriIndices[j]];
+				node.bounds.include(vertices[mt.vertexNr[0]]);
+				node.bounds.include(vertices[mt.vertexNr[1]]);
+				node.bounds.include(vertices[mt.vertexNr[2]]);
+			}
+		}
+		else {
+			node.bounds = mNodes[node.first].bounds;
+			node.bounds.combine(mNodes[node.first+1].bounds);
+		}
+	}
+}
+
+// -------------------------------------------------------------------------------------
+bool ObjMeshBVH::rayTriangleIntersection(const NxVec3 &orig, const NxVec3 &dir,
+	const NxVec3 &a, const NxVec3 &b, const NxVec3 &c, NxReal &t, NxReal &u, NxReal &v)
+{
+	NxVec3 edge1, edge2, tvec, pvec, qvec;
+	NxReal det,inv_det;
+
+	edge1 = b - a;
+	edge2 = c - a;
+	pvec.cross(dir, edge2);
+
+	/* if determinant is near zero, ray lies in plane of triangle */
+	det = edge1.dot(pvec);
+
+	if (det == 0.0f)
+		return false;
+	inv_det = 1.0f / det;
+
+	/* calculate distance from vert0 to ray origin */
+	tvec = orig - a;
+
+	/* calculate U parameter and test bounds */
+	u = tvec.dot(pvec) * inv_det;
+	if (u < 0.0f || u > 1.0f)
+		return false;
+
+	/* prepare to test V parameter */
+	qvec.cross(tvec, edge1);
+
+	/* calculate V parameter and test bounds */
+	v = dir.dot(qvec) * inv_det;
+	if (v < 0.0f || u + v > 1.0f)
+		return false;
+
+	/* calculate t, ray intersects triangle */
+	t = edge2.dot(qvec) * inv_det;
+
+	return true;
+}
+
+// -------------------------------------------------------------------------------------
+bool ObjMeshBVH::rayCast(const NxVec3 *vertices, const ObjMeshTriangle *triangles,
+	const NxVec3 &orig, const NxVec3 &dir, NxReal &t, int &triNr) const
+{
+	t = -1.0f;
+	triNr = -1;
+	if (mNodes.empty())
+		return false;
+
+	NxVec3 invDir;
+	computeInvDir(dir, invDir);
+	NxReal best = NX_MAX_REAL;
+
+	int stack[maxStackSize];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0) {
+		const ObjMeshBVHNode &node = mNodes[stack[--stackSize]];
+		if (!rayBoxOverlap(node.bounds, orig, invDir, best))
+			continue;
+
+		if (node.count > 0) {
+			for (int i = node.first; i < node.first + node.count; i++) {
+				const ObjMeshTriangle &mt = triangles[mTriIndices[i]];
+				NxReal ti, u, v;
+				if (!rayTriangleIntersection(orig, dir, vertices[mt.vertexNr[0]], vertices[mt.vertexNr[1]],
+						vertices[mt.vertexNr[2]], ti, u, v))
+					continue;
+				if (ti < 0.0f || ti >= best) continue;
+				best = ti;
+				triNr = mTriIndices[i];
+			}
+		}
+		else {
+			// visit the child closer to the ray origin first
+			const NxBounds3 &b0 = mNodes[node.first].bounds;
+			const NxBounds3 &b1 = mNodes[node.first+1].bounds;
+			NxVec3 d = (b1.min + b1.max) - (b0.min + b0.max);
+			if (d.dot(dir) < 0.0f) {
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = node.first+1;
+			}
+			else {
+				stack[stackSize++] = node.first+1;
+				stack[stackSize++] = node.first;
+			}
+		}
+	}
+
+	if (triNr < 0)
+		return false;
+	t = best;
+	return true;
+}
+
+// -------------------------------------------------------------------------------------
+template <int N>
+int ObjMeshBVH::rayCastPacket(const NxVec3 *vertices, const ObjMeshTriangle *triangles,
+	const NxVec3 *origs, const NxVec3 *dirs, NxReal *t, int *triNrs) const
+{
+	NxVec3 invDirs[N];
+	NxReal best[N];
+	int k;
+	for (k = 0; k < N; k++) {
+		computeInvDir(dirs[k], invDirs[k]);
+		best[k] = NX_MAX_REAL;
+		triNrs[k] = -1;
+	}
+
+	if (!mNodes.empty()) {
+		int stack[maxStackSize];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0) {
+			const ObjMeshBVHNode &node = mNodes[stack[--stackSize]];
+
+			// the node is visited if any ray of the packet overlaps it
+			bool active[N];
+			bool anyActive = false;
+			for (k = 0; k < N; k++) {
+				active[k] = rayBoxOverlap(node.bounds, origs[k], invDirs[k], best[k]);
+				anyActive |= active[k];
+			}
+			if (!anyActive)
+				continue;
+
+			if (node.count > 0) {
+				for (int i = node.first; i < node.first + node.count; i++) {
+					const ObjMeshTriangle &mt = triangles[mTriIndices[i]];
+					const NxVec3 &a = vertices[mt.vertexNr[0]];
+					const NxVec3 &b = vertices[mt.vertexNr[1]];
+					const NxVec3 &c = vertices[mt.vertexNr[2]];
+					for (k = 0; k < N; k++) {
+						if (!active[k]) continue;
+						NxReal ti, u, v;
+						if (!rayTriangleIntersection(origs[k], dirs[k], a, b, c, ti, u, v))
+							continue;
+						if (ti < 0.0f || ti >= best[k]) continue;
+						best[k] = ti;
+						triNrs[k] = mTriIndices[i];
+					}
+				}
+			}
+			else {
+				// coherent packets are ordered by the direction of the first ray
+				const NxBounds3 &b0 = mNodes[node.first].bounds;
+				const NxBounds3 &b1 = mNodes[node.first+1].bounds;
+				NxVec3 d = (b1.min + b1.max) - (b0.min + b0.max);
+				if (d.dot(dirs[0]) < 0.0f) {
+					stack[stackSize++] = node.first;
+					stack[stackSize++] = node.first+1;
+				}
+				else {
+					stack[stackSize++] = node.first+1;
+					stack[stackSize++] = node.first;
+				}
+			}
+		}
+	}
+
+	int numHits = 0;
+	for (k = 0; k < N; k++) {
+		if (triNrs[k] >= 0) {
+			t[k] = best[k];
+			numHits++;
+		}
+		else
+			t[k] = -1.0f;
+	}
+	return numHits;
+}
+
+// -------------------------------------------------------------------------------------
+int ObjMeshBVH::rayCast4(const NxVec3 *vertices, const ObjMeshTriangle *triangles,
+	const NxVec3 *origs, const NxVec3 *dirs, NxReal *t, int *triNrs) const
+{
+	return rayCastPacket<4>(vertices, triangles, origs, dirs, t, triNrs);
+}
+
+// -------------------------------------------------------------------------------------
+int ObjMeshBVH::rayCast8(const NxVec3 *vertices, const ObjMeshTriangle *triangles,
+	const NxVec3 *origs, const NxVec3 *dirs, NxReal *t, int *triNrs) const
+{
+	return rayCastPacket<8>(vertices, triangles, origs, dirs, t, triNrs);
+}
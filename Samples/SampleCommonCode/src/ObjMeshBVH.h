@@ -0,0 +1,62 @@
+#ifndef OBJ_MESH_BVH_H
+#define OBJ_MESH_BVH_H
+
+#include "NxPhysics.h"
+#include <vector>
+
+struct ObjMeshTriangle;
+
+// ------------------------------------------------------------------------------
+// Bounding volume hierarchy over the triangles of an ObjMesh.
+// The topology is built once, vertex updates only require a refit of the bounds.
+
+struct ObjMeshBVHNode {
+	NxBounds3 bounds;
+	int first;		// inner node: index of the left child, the right one follows it
+					// leaf: first entry in the triangle index list
+	int count;		// number of triangles of a leaf, 0 for inner nodes
+};
+
+// ------------------------------------------------------------------------------
+
+class ObjMeshBVH {
+public:
+	ObjMeshBVH();
+	~ObjMeshBVH();
+
+	void build(const NxVec3 *vertices, const ObjMeshTriangle *triangles, int numTriangles);
+	void refit(const NxVec3 *vertices, const ObjMeshTriangle *triangles);
+	void clear();
+
+	bool isEmpty() const { return mNodes.empty(); }
+	int  getNumNodes() const { return (int)mNodes.size(); }
+
+	// closest hit with t >= 0, t is set to -1 if nothing was hit
+	bool rayCast(const NxVec3 *vertices, const ObjMeshTriangle *triangles,
+		const NxVec3 &orig, const NxVec3 &dir, NxReal &t, int &triNr) const;
+
+	// packet traversal, the rays share one walk through the tree
+	// returns the number of rays that hit, misses get t = -1
+	int rayCast4(const NxVec3 *vertices, const ObjMeshTriangle *triangles,
+		const NxVec3 *origs, const NxVec3 *dirs, NxReal *t, int *triNrs) const;
+	int rayCast8(const NxVec3 *vertices, const ObjMeshTriangle *triangles,
+		const NxVec3 *origs, const NxVec3 *dirs, NxReal *t, int *triNrs) const;
+
+	static bool rayTriangleIntersection(const NxVec3 &orig, const NxVec3 &dir,
+		const NxVec3 &a, const NxVec3 &b, const NxVec3 &c,
+		NxReal &t, NxReal &u, NxReal &v);
+
+private:
+	int  subdivide(int nodeNr, int first, int count);
+	template <int N> int rayCastPacket(const NxVec3 *vertices, const ObjMeshTriangle *triangles,
+		const NxVec3 *origs, const NxVec3 *dirs, NxReal *t, int *triNrs) const;
+
+	static const int maxTrianglesPerLeaf = 4;
+	static const int maxStackSize = 64;
+
+	std::vector<ObjMeshBVHNode> mNodes;
+	std::vector<int> mTriIndices;
+	std::vector<NxVec3> mCentroids;		// only used during the build
+};
+
+#endif
@@ -0,0 +1,716 @@
+#include "ObjReader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(WIN32)
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#	include <pthread.h>
+#	include <unistd.h>
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	define OBJ_READER_MMAP
+#endif
+
+// ----------------------------------------------------------------------
+// read only view of a whole file, memory mapped where the platform supports it
+
+class ObjReaderFile {
+public:
+	ObjReaderFile() : mData(NULL), mSize(0), mAllocated(false)
+	{
+#if defined(WIN32)
+		mFile = INVALID_HANDLE_VALUE;
+		mMapping = NULL;
+#endif
+	}
+	~ObjReaderFile() { close(); }
+
+	bool open(const char *filename);
+	void close();
+
+	const char *mData;
+	size_t mSize;
+
+private:
+	bool mAllocated;
+#if defined(WIN32)
+	HANDLE mFile;
+	HANDLE mMapping;
+#endif
+};
+
+// ----------------------------------------------------------------------
+bool ObjReaderFile::open(const char *filename)
+{
+	close();
+#if defined(WIN32)
+	mFile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (mFile == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(mFile, &size)) {
+		close();
+		return false;
+	}
+	mSize = (size_t)size.QuadPart;
+	if (mSize == 0)
+		return true;
+	mMapping = CreateFileMappingA(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mMapping != NULL)
+		mData = (const char*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+	if (mData == NULL) {
+		close();
+		return false;
+	}
+	return true;
+#else
+#	if defined(OBJ_READER_MMAP)
+	int fd = ::open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		return false;
+	}
+	mSize = (size_t)st.st_size;
+	if (mSize > 0) {
+		void *p = mmap(NULL, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED) {
+			madvise(p, mSize, MADV_SEQUENTIAL);
+			mData = (const char*)p;
+		}
+	}
+	::close(fd);
+	if (mData != NULL || mSize == 0)
+		return true;
+#	endif
+	// no mapping available, read the whole file
+	FILE *f = fopen(filename, "rb");
+	if (!f) return false;
+	fseek(f, 0, SEEK_END);
+	mSize = (size_t)ftell(f);
+	fseek(f, 0, SEEK_SET);
+	char *buffer = (char*)malloc(mSize + 1);
+	if (buffer == NULL || fread(buffer, 1, mSize, f) != mSize) {
+		free(buffer);
+		fclose(f);
+		mSize = 0;
+		return false;
+	}
+	fclose(f);
+	mData = buffer;
+	mAllocated = true;
+	return true;
+#endif
+}
+
+// ----------------------------------------------------------------------
+void ObjReaderFile::close()
+{
+	if (mAllocated)
+		free((void*)mData);
+#if defined(WIN32)
+	else if (mData != NULL)
+		UnmapViewOfFile(mData);
+	if (mMapping != NULL)
+		CloseHandle(mMapping);
+	if (mFile != INVALID_HANDLE_VALUE)
+		CloseHandle(mFile);
+	mMapping = NULL;
+	mFile = INVALID_HANDLE_VALUE;
+#elif defined(OBJ_READER_MMAP)
+	else if (mData != NULL)
+		munmap((void*)mData, mSize);
+#endif
+	mData = NULL;
+	mSize = 0;
+	mAllocated = false;
+}
+
+// ----------------------------------------------------------------------
+// number parsing, the input is not zero terminated so every step checks the end
+
+static inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+static inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+static inline const char *skipSpaces(const char *p, const char *end)
+{
+	while (p < end && isSpace(*p)) p++;
+	return p;
+}
+
+static inline const char *skipToken(const char *p, const char *end)
+{
+	while (p < end && !isSpace(*p)) p++;
+	return p;
+}
+
+static const double powersOf10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// ----------------------------------------------------------------------
+static const char *parseFloat(const char *p, const char *end, float &value)
+{
+	const char *start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+
+	// up to 19 significant digits fit into the mantissa exactly
+	unsigned long long mantissa = 0;
+	int numDigits = 0;
+	int exponent = 0;
+	bool anyDigits = false;
+	while (p < end && isDigit(*p)) {
+		if (numDigits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			if (mantissa != 0) numDigits++;
+		}
+		else
+			exponent++;
+		anyDigits = true;
+		p++;
+	}
+	if (p < end && *p == '.') {
+		p++;
+		while (p < end && isDigit(*p)) {
+			if (numDigits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa != 0) numDigits++;
+				exponent--;
+			}
+			anyDigits = true;
+			p++;
+		}
+	}
+
+	if (!anyDigits) {
+		// nan, inf and other oddities go through the C library
+		const char *tokenEnd = skipToken(start, end);
+		char buffer[64];
+		size_t len = (size_t)(tokenEnd - start);
+		if (len >= sizeof(buffer)) len = sizeof(buffer) - 1;
+		memcpy(buffer, start, len);
+		buffer[len] = 0;
+		value = (float)strtod(buffer, NULL);
+		return tokenEnd;
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char *q = p + 1;
+		bool negativeExponent = false;
+		if (q < end && (*q == '-' || *q == '+')) {
+			negativeExponent = *q == '-';
+			q++;
+		}
+		if (q < end && isDigit(*q)) {
+			int e = 0;
+			while (q < end && isDigit(*q)) {
+				if (e < 10000) e = e * 10 + (*q - '0');
+				q++;
+			}
+			exponent += negativeExponent ? -e : e;
+			p = q;
+		}
+	}
+
+	double d = (double)mantissa;
+	if (mantissa != 0) {
+		if (exponent < 0) {
+			if (exponent >= -22)
+				d /= powersOf10[-exponent];
+			else
+				d *= pow(10.0, exponent);
+		}
+		else if (exponent > 0) {
+			if (exponent <= 22)
+				d *= powersOf10[exponent];
+			else
+				d *= pow(10.0, exponent);
+		}
+	}
+	value = (float)(negative ? -d : d);
+	return p;
+}
+
+// ----------------------------------------------------------------------
+static inline const char *parseInt(const char *p, const char *end, int &value, bool &valid)
+{
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+	int i = 0;
+	valid = false;
+	while (p < end && isDigit(*p)) {
+		i = i * 10 + (*p - '0');
+		valid = true;
+		p++;
+	}
+	value = negative ? -i : i;
+	return p;
+}
+
+// ----------------------------------------------------------------------
+static inline bool matchKeyword(const char *p, const char *end, const char *keyword)
+{
+	while (*keyword) {
+		if (p >= end) return false;
+		char c = *p++;
+		if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+		if (c != *keyword++) return false;
+	}
+	return p == end || isSpace(*p);
+}
+
+// ----------------------------------------------------------------------
+static const char *parseName(const char *p, const char *end, std::string &name)
+{
+	p = skipSpaces(p, end);
+	const char *nameEnd = end;
+	while (nameEnd > p && isSpace(nameEnd[-1])) nameEnd--;
+	name.assign(p, nameEnd);
+	return end;
+}
+
+// ----------------------------------------------------------------------
+// parse result of one line aligned part of the file
+
+enum ObjReaderRelativeFlags {
+	ORF_RELATIVE_V = 1,
+	ORF_RELATIVE_T = 2,
+	ORF_RELATIVE_N = 4
+};
+
+struct ObjReaderChunk {
+	const char *begin;
+	const char *end;
+
+	std::vector<float> positions;
+	std::vector<float> texCoords;
+	std::vector<float> normals;
+	std::vector<ObjReaderCorner> corners;
+	std::vector<unsigned char> relative;	// ObjReaderRelativeFlags per corner
+	std::vector<ObjReaderFace> faces;		// material indexes usemtls, -1 inherits from the previous chunk
+	std::vector<int> tetrahedra;
+	std::vector<std::string> usemtls;
+	std::vector<std::string> mtllibs;
+
+	void parse();
+	void parseCorner(const char *p, const char *end, ObjReaderCorner &c, unsigned char &flags) const;
+};
+
+// ----------------------------------------------------------------------
+static inline int resolveIndex(int index, int count, unsigned char flag, unsigned char &flags)
+{
+	if (index > 0)
+		return index - 1;
+	if (index < 0) {
+		// relative to the elements read so far, the chunk offset is added when merging
+		flags |= flag;
+		return count + index;
+	}
+	return -1;
+}
+
+// ----------------------------------------------------------------------
+void ObjReaderChunk::parseCorner(const char *p, const char *end, ObjReaderCorner &c, unsigned char &flags) const
+{
+	int index;
+	bool valid;
+	flags = 0;
+	c.v = c.t = c.n = -1;
+
+	p = parseInt(p, end, index, valid);
+	if (valid) c.v = resolveIndex(index, (int)positions.size() / 3, ORF_RELATIVE_V, flags);
+	if (p >= end || *p != '/') return;
+	p = parseInt(p + 1, end, index, valid);
+	if (valid) c.t = resolveIndex(index, (int)texCoords.size() / 2, ORF_RELATIVE_T, flags);
+	if (p >= end || *p != '/') return;
+	p = parseInt(p + 1, end, index, valid);
+	if (valid) c.n = resolveIndex(index, (int)normals.size() / 3, ORF_RELATIVE_N, flags);
+}
+
+// ----------------------------------------------------------------------
+void ObjReaderChunk::parse()
+{
+	int material = -1;
+	const char *p = begin;
+	while (p < end) {
+		const char *lineEnd = (const char*)memchr(p, '\n', (size_t)(end - p));
+		if (lineEnd == NULL) lineEnd = end;
+		const char *s = skipSpaces(p, lineEnd);
+		p = lineEnd + 1;
+		if (s >= lineEnd) continue;
+
+		char c0 = *s;
+		char c1 = s + 1 < lineEnd ? s[1] : 0;
+		if (c0 == 'v' || c0 == 'V') {
+			float f[3] = { 0.0f, 0.0f, 0.0f };
+			int numFloats;
+			if (isSpace(c1)) {
+				s += 1;
+				numFloats = 3;
+			}
+			else if ((c1 == 't' || c1 == 'T') && (s + 2 >= lineEnd || isSpace(s[2]))) {
+				s += 2;
+				numFloats = 2;
+			}
+			else if ((c1 == 'n' || c1 == 'N') && (s + 2 >= lineEnd || isSpace(s[2]))) {
+				s += 2;
+				numFloats = 3;
+			}
+			else
+				continue;
+
+			for (int i = 0; i < numFloats; i++) {
+				s = skipSpaces(s, lineEnd);
+				if (s >= lineEnd) break;
+				s = parseFloat(s, lineEnd, f[i]);
+			}
+			if (numFloats == 2) {
+				texCoords.push_back(f[0]);
+				texCoords.push_back(f[1]);
+			}
+			else {
+				std::vector<float> &dst = isSpace(c1) ? positions : normals;
+				dst.push_back(f[0]);
+				dst.push_back(f[1]);
+				dst.push_back(f[2]);
+			}
+		}
+		else if ((c0 == 'f' || c0 == 'F') && isSpace(c1)) {
+			ObjReaderFace face;
+			face.firstCorner = (int)corners.size();
+			face.numCorners = 0;
+			face.material = material;
+			s += 1;
+			while (true) {
+				s = skipSpaces(s, lineEnd);
+				if (s >= lineEnd) break;
+				const char *tokenEnd = skipToken(s, lineEnd);
+				ObjReaderCorner corner;
+				unsigned char flags;
+				parseCorner(s, tokenEnd, corner, flags);
+				corners.push_back(corner);
+				relative.push_back(flags);
+				face.numCorners++;
+				s = tokenEnd;
+			}
+			if (face.numCorners > 0)
+				faces.push_back(face);
+		}
+		else if ((c0 == 't' || c0 == 'T') && isSpace(c1)) {
+			int idx[4] = { 0, 0, 0, 0 };
+			bool valid = true;
+			s += 1;
+			for (int i = 0; i < 4 && valid; i++) {
+				s = skipSpaces(s, lineEnd);
+				s = parseInt(s, lineEnd, idx[i], valid);
+			}
+			if (valid)
+				tetrahedra.insert(tetrahedra.end(), idx, idx + 4);
+		}
+		else if (matchKeyword(s, lineEnd, "usemtl")) {
+			usemtls.push_back(std::string());
+			parseName(s + 6, lineEnd, usemtls.back());
+			material = (int)usemtls.size() - 1;
+		}
+		else if (matchKeyword(s, lineEnd, "mtllib")) {
+			mtllibs.push_back(std::string());
+			parseName(s + 6, lineEnd, mtllibs.back());
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+// minimal portable fork / join for the chunk parsers
+
+#if defined(WIN32)
+static DWORD WINAPI objReaderThreadFunc(LPVOID arg)
+{
+	((ObjReaderChunk*)arg)->parse();
+	return 0;
+}
+#elif defined(OBJ_READER_MMAP)
+static void *objReaderThreadFunc(void *arg)
+{
+	((ObjReaderChunk*)arg)->parse();
+	return NULL;
+}
+#endif
+
+static void parseChunks(std::vector<ObjReaderChunk> &chunks)
+{
+	int numChunks = (int)chunks.size();
+#if defined(WIN32)
+	std::vector<HANDLE> threads(numChunks, (HANDLE)NULL);
+	for (int i = 1; i < numChunks; i++)
+		threads[i] = CreateThread(NULL, 0, objReaderThreadFunc, &chunks[i], 0, NULL);
+	chunks[0].parse();
+	for (int i = 1; i < numChunks; i++) {
+		if (threads[i] == NULL) {
+			chunks[i].parse();
+			continue;
+		}
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+	}
+#elif defined(OBJ_READER_MMAP)
+	std::vector<pthread_t> threads(numChunks);
+	std::vector<bool> started(numChunks, false);
+	for (int i = 1; i < numChunks; i++)
+		started[i] = pthread_create(&threads[i], NULL, objReaderThreadFunc, &chunks[i]) == 0;
+	chunks[0].parse();
+	for (int i = 1; i < numChunks; i++) {
+		if (started[i])
+			pthread_join(threads[i], NULL);
+		else
+			chunks[i].parse();
+	}
+#else
+	for (int i = 0; i < numChunks; i++)
+		chunks[i].parse();
+#endif
+}
+
+// ----------------------------------------------------------------------
+int ObjReader::getNumProcessors()
+{
+#if defined(WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+#elif defined(OBJ_READER_MMAP)
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (int)n : 1;
+#else
+	return 1;
+#endif
+}
+
+// ----------------------------------------------------------------------
+ObjReader::ObjReader()
+{
+}
+
+// ----------------------------------------------------------------------
+void ObjReader::clear()
+{
+	mPositions.clear();
+	mTexCoords.clear();
+	mNormals.clear();
+	mCorners.clear();
+	mFaces.clear();
+	mTetrahedra.clear();
+	mMaterialNames.clear();
+	mMaterialLibs.clear();
+}
+
+// ----------------------------------------------------------------------
+bool ObjReader::load(const char *filename, int numThreads)
+{
+	clear();
+	ObjReaderFile file;
+	if (!file.open(filename))
+		return false;
+	parse(file.mData, file.mSize, numThreads);
+	return true;
+}
+
+// ----------------------------------------------------------------------
+template <class T>
+static void appendArray(std::vector<T> &dst, const std::vector<T> &src)
+{
+	if (!src.empty())
+		dst.insert(dst.end(), src.begin(), src.end());
+}
+
+// ----------------------------------------------------------------------
+void ObjReader::parse(const char *data, size_t size, int numThreads)
+{
+	clear();
+	if (data == NULL || size == 0)
+		return;
+
+	if (numThreads <= 0)
+		numThreads = getNumProcessors();
+	size_t maxChunks = size / minChunkSize + 1;
+	if ((size_t)numThreads > maxChunks)
+		numThreads = (int)maxChunks;
+	if (numThreads < 1)
+		numThreads = 1;
+
+	// split at line boundaries
+	std::vector<ObjReaderChunk> chunks(numThreads);
+	const char *end = data + size;
+	const char *p = data;
+	int numChunks = 0;
+	for (int i = 0; i < numThreads && p < end; i++) {
+		const char *chunkEnd = end;
+		if (i < numThreads - 1) {
+			chunkEnd = data + (size / numThreads) * (i + 1);
+			if (chunkEnd < p) chunkEnd = p;
+			const char *nl = (const char*)memchr(chunkEnd, '\n', (size_t)(end - chunkEnd));
+			chunkEnd = nl ? nl + 1 : end;
+		}
+		chunks[numChunks].begin = p;
+		chunks[numChunks].end = chunkEnd;
+		numChunks++;
+		p = chunkEnd;
+	}
+	chunks.resize(numChunks);
+
+	parseChunks(chunks);
+
+	// merge in file order
+	size_t numPositions = 0, numTexCoords = 0, numNormals = 0, numCorners = 0, numFaces = 0, numTetrahedra = 0;
+	int i;
+	for (i = 0; i < numChunks; i++) {
+		numPositions += chunks[i].positions.size();
+		numTexCoords += chunks[i].texCoords.size();
+		numNormals += chunks[i].normals.size();
+		numCorners += chunks[i].corners.size();
+		numFaces += chunks[i].faces.size();
+		numTetrahedra += chunks[i].tetrahedra.size();
+	}
+	mPositions.reserve(numPositions);
+	mTexCoords.reserve(numTexCoords);
+	mNormals.reserve(numNormals);
+	mCorners.reserve(numCorners);
+	mFaces.reserve(numFaces);
+	mTetrahedra.reserve(numTetrahedra);
+
+	int material = -1;
+	std::vector<int> materialMap;
+	for (i = 0; i < numChunks; i++) {
+		ObjReaderChunk &chunk = chunks[i];
+		int positionBase = (int)mPositions.size() / 3;
+		int texCoordBase = (int)mTexCoords.size() / 2;
+		int normalBase = (int)mNormals.size() / 3;
+		int cornerBase = (int)mCorners.size();
+
+		for (int j = 0; j < (int)chunk.corners.size(); j++) {
+			ObjReaderCorner c = chunk.corners[j];
+			unsigned char flags = chunk.relative[j];
+			if (flags & ORF_RELATIVE_V) c.v += positionBase;
+			if (flags & ORF_RELATIVE_T) c.t += texCoordBase;
+			if (flags & ORF_RELATIVE_N) c.n += normalBase;
+			mCorners.push_back(c);
+		}
+
+		materialMap.resize(chunk.usemtls.size());
+		for (int j = 0; j < (int)chunk.usemtls.size(); j++) {
+			int k = 0;
+			while (k < (int)mMaterialNames.size() && mMaterialNames[k] != chunk.usemtls[j]) k++;
+			if (k == (int)mMaterialNames.size())
+				mMaterialNames.push_back(chunk.usemtls[j]);
+			materialMap[j] = k;
+		}
+
+		for (int j = 0; j < (int)chunk.faces.size(); j++) {
+			ObjReaderFace f = chunk.faces[j];
+			f.firstCorner += cornerBase;
+			f.material = f.material < 0 ? material : materialMap[f.material];
+			mFaces.push_back(f);
+		}
+		if (!chunk.usemtls.empty())
+			material = materialMap.back();
+
+		appendArray(mPositions, chunk.positions);
+		appendArray(mTexCoords, chunk.texCoords);
+		appendArray(mNormals, chunk.normals);
+		appendArray(mTetrahedra, chunk.tetrahedra);
+		appendArray(mMaterialLibs, chunk.mtllibs);
+	}
+}
+
+// ----------------------------------------------------------------------
+void ObjReaderMaterial::init()
+{
+	name = "";
+	texFilename = "";
+	for (int i = 0; i < 3; i++) {
+		ambient[i] = 0.0f;
+		diffuse[i] = 0.0f;
+		specular[i] = 0.0f;
+	}
+	alpha = 0.0f;
+	shininess = 0.0f;
+}
+
+// ----------------------------------------------------------------------
+static void parseFloats(const char *p, const char *end, float *f, int num)
+{
+	for (int i = 0; i < num; i++) {
+		p = skipSpaces(p, end);
+		if (p >= end) return;
+		p = parseFloat(p, end, f[i]);
+	}
+}
+
+// ----------------------------------------------------------------------
+bool ObjReader::loadMtl(const char *filename, std::vector<ObjReaderMaterial> &materials)
+{
+	materials.clear();
+	ObjReaderFile file;
+	if (!file.open(filename))
+		return false;
+	parseMtl(file.mData, file.mSize, materials);
+	return true;
+}
+
+// ----------------------------------------------------------------------
+void ObjReader::parseMtl(const char *data, size_t size, std::vector<ObjReaderMaterial> &materials)
+{
+	materials.clear();
+	if (data == NULL) return;
+
+	ObjReaderMaterial mat;
+	mat.init();
+	const char *end = data + size;
+	const char *p = data;
+	while (p < end) {
+		const char *lineEnd = (const char*)memchr(p, '\n', (size_t)(end - p));
+		if (lineEnd == NULL) lineEnd = end;
+		const char *s = skipSpaces(p, lineEnd);
+		p = lineEnd + 1;
+
+		if (matchKeyword(s, lineEnd, "newmtl")) {
+			if (!mat.name.empty())
+				materials.push_back(mat);
+			mat.init();
+			parseName(s + 6, lineEnd, mat.name);
+		}
+		else if (matchKeyword(s, lineEnd, "ka"))
+			parseFloats(s + 2, lineEnd, mat.ambient, 3);
+		else if (matchKeyword(s, lineEnd, "kd"))
+			parseFloats(s + 2, lineEnd, mat.diffuse, 3);
+		else if (matchKeyword(s, lineEnd, "ks"))
+			parseFloats(s + 2, lineEnd, mat.specular, 3);
+		else if (matchKeyword(s, lineEnd, "ns"))
+			parseFloats(s + 2, lineEnd, &mat.shininess, 1);
+		else if (matchKeyword(s, lineEnd, "tr"))
+			parseFloats(s + 2, lineEnd, &mat.alpha, 1);
+		else if (matchKeyword(s, lineEnd, "d"))
+			parseFloats(s + 1, lineEnd, &mat.alpha, 1);
+		else if (matchKeyword(s, lineEnd, "map_kd"))
+			parseName(s + 6, lineEnd, mat.texFilename);
+	}
+	if (!mat.name.empty())
+		materials.push_back(mat);
+}
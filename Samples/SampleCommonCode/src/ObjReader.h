@@ -0,0 +1,71 @@
+#ifndef OBJ_READER_H
+#define OBJ_READER_H
+
+#include <vector>
+#include <string>
+
+// ------------------------------------------------------------------------------
+// Fast Wavefront OBJ / MTL reader shared by ObjMesh, WavefrontObj and the
+// SoftBody obj loader.
+// The file is memory mapped, split at line boundaries and the chunks are parsed
+// in parallel with a hand written number parser. The per chunk arrays are merged
+// in file order, so the result does not depend on the number of threads.
+
+struct ObjReaderCorner {
+	int v, t, n;			// zero based, relative indices are resolved, -1 if missing
+};
+
+// ------------------------------------------------------------------------------
+struct ObjReaderFace {
+	int firstCorner;
+	int numCorners;
+	int material;			// index into ObjReader::mMaterialNames, -1 before the first usemtl
+};
+
+// ------------------------------------------------------------------------------
+struct ObjReaderMaterial {
+	void init();
+	std::string name;
+	std::string texFilename;	// map_Kd
+	float ambient[3];
+	float diffuse[3];
+	float specular[3];
+	float alpha;
+	float shininess;
+};
+
+// ------------------------------------------------------------------------------
+class ObjReader {
+public:
+	ObjReader();
+
+	// numThreads = 0 uses one thread per processor, small files are always parsed serially
+	bool load(const char *filename, int numThreads = 0);
+	void parse(const char *data, size_t size, int numThreads = 0);
+	void clear();
+
+	static bool loadMtl(const char *filename, std::vector<ObjReaderMaterial> &materials);
+	static void parseMtl(const char *data, size_t size, std::vector<ObjReaderMaterial> &materials);
+
+	int getNumPositions() const { return (int)mPositions.size() / 3; }
+	int getNumTexCoords() const { return (int)mTexCoords.size() / 2; }
+	int getNumNormals() const { return (int)mNormals.size() / 3; }
+	int getNumFaces() const { return (int)mFaces.size(); }
+	int getNumTetrahedra() const { return (int)mTetrahedra.size() / 4; }
+
+	static int getNumProcessors();
+
+	std::vector<float> mPositions;			// v, xyz
+	std::vector<float> mTexCoords;			// vt, uv
+	std::vector<float> mNormals;			// vn, xyz
+	std::vector<ObjReaderCorner> mCorners;
+	std::vector<ObjReaderFace> mFaces;		// f, polygons are not triangulated
+	std::vector<int> mTetrahedra;			// t, 4 indices as written in the file
+	std::vector<std::string> mMaterialNames;	// usemtl, each name once
+	std::vector<std::string> mMaterialLibs;	// mtllib, in file order
+
+private:
+	static const size_t minChunkSize = 1 << 20;
+};
+
+#endif
@@ -6,9 +6,20 @@
 // ===============================================================================
 
 #include <stdio.h>
+#include <string.h>
 #include "NxPhysics.h"
 #include "UserAllocator.h"
 
+#if defined(WIN32)
+#	include <windows.h>
+#	include <intrin.h>
+#	pragma intrinsic(_InterlockedCompareExchange64)
+#	define USE_THREAD_CACHE
+#elif defined(__linux__) || defined(__APPLE__)
+#	include <pthread.h>
+#	define USE_THREAD_CACHE
+#endif
+
 #define MEMBLOCKSTART		64
 
 #define USE_MUTEX
@@ -21,12 +32,25 @@
 	#define	UNLOCK()
 #endif
 
-struct BlockHeader
+#define CHUNK_SIZE			(64 * 1024)
+#define LARGE_BLOCK			0xffff
+#define MAX_CACHED_BYTES	(32 * 1024)		// per thread and size class, half of it goes back to the shared list when exceeded
+
+// block sizes, header included, all multiples of 16 so that blocks carved from a 16-byte aligned start stay aligned
+static const NxU32 gClassSizes[UserAllocator::NB_SIZE_CLASSES] =
+{
+	32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024, 1280, 1536, 1792, 2048
+};
+
+struct UserAllocator::BlockHeader
 {
 	static const size_t marker;
 
 	size_t		sign;
 	size_t		size;
+	NxU32		type;
+	NxU16		sizeClass;		// LARGE_BLOCK for blocks from the system allocator
+	NxU16		fileSlot;
 #if defined(_DEBUG)
 	const char*	file;
 	size_t		line;
@@ -35,9 +59,135 @@ struct BlockHeader
 #endif
 };
 
-const size_t BlockHeader::marker = (size_t)0xbadbad00deadbabeLL;
+const size_t UserAllocator::BlockHeader::marker = (size_t)0xbadbad00deadbabeLL;
+
+// user memory starts at the next multiple of 16 after the header. Small blocks are 16-byte aligned, large blocks only
+// have the alignment of the system malloc (8 bytes on Win32).
+#define HEADER_SIZE			((sizeof(BlockHeader) + 15) & ~15)
+#define USER_MEMORY(ptr)	reinterpret_cast<void*>(reinterpret_cast<char*>(ptr) + HEADER_SIZE)
+#define BLOCK_HEADER(mem)	reinterpret_cast<BlockHeader*>(reinterpret_cast<char*>(mem) - HEADER_SIZE)
+
+struct UserAllocator::FreeBlock
+{
+	FreeBlock*	next;
+};
+
+// statistics of one thread, only written by that thread and summed up by gather().
+// Byte counts are pending until they exceed STATS_BATCH and are published to the shared Stats.
+struct UserAllocator::Counters
+{
+	NxI64	nbAllocs;
+	NxI64	nbReallocs;
+	NxI64	liveBlocks;
+	NxI64	pendingBytes;
+
+	NxI64	typeAllocs[NB_TYPE_SLOTS];
+	NxI64	typeLiveBlocks[NB_TYPE_SLOTS];
+	NxI64	typePendingBytes[NB_TYPE_SLOTS];
+
+	NxI64	fileAllocs[NB_FILE_SLOTS];
+	NxI64	fileLiveBlocks[NB_FILE_SLOTS];
+	NxI64	filePendingBytes[NB_FILE_SLOTS];
+
+	NxI64	histogramAllocs[NB_HISTOGRAM_BINS];
+	NxI64	histogramLiveBlocks[NB_HISTOGRAM_BINS];
+};
+
+struct UserAllocator::ThreadCache
+{
+	FreeBlock*		head[NB_SIZE_CLASSES];
+	NxU32			count[NB_SIZE_CLASSES];
+	Counters		counters;
+	ThreadCache*	next;
+	UserAllocator*	owner;
+	bool			inUse;		// false once its thread exited, the next new thread takes it over
+};
+
+// ----------------------------------------------------------------------
+// shared counters, atomic where there are thread caches and otherwise
+// only touched under mSharedCacheLock
+
+#if defined(WIN32)
+static NX_INLINE NxI64 compareExchange(volatile NxI64* dst, NxI64 value, NxI64 comparand)
+{
+	return _InterlockedCompareExchange64(dst, value, comparand);
+}
+#elif defined(USE_THREAD_CACHE)
+static NX_INLINE NxI64 compareExchange(volatile NxI64* dst, NxI64 value, NxI64 comparand)
+{
+	return __sync_val_compare_and_swap(dst, comparand, value);
+}
+#else
+static NX_INLINE NxI64 compareExchange(volatile NxI64* dst, NxI64 value, NxI64 comparand)
+{
+	NxI64 old = *dst;
+	if (old == comparand)
+		*dst = value;
+	return old;
+}
+#endif
+
+#if defined(WIN32)
+// fiber local storage calls back when a thread exits, like a pthread key destructor. It only exists
+// from Windows Server 2003 on, so it is looked up at run time and plain TLS is the fallback.
+#ifndef FLS_OUT_OF_INDEXES
+#	define FLS_OUT_OF_INDEXES	((DWORD)0xFFFFFFFF)
+#endif
+
+typedef DWORD	(WINAPI *FlsAllocFunction)(void (WINAPI *callback)(void*));
+typedef void*	(WINAPI *FlsGetValueFunction)(DWORD index);
+typedef BOOL	(WINAPI *FlsSetValueFunction)(DWORD index, void* value);
+typedef BOOL	(WINAPI *FlsFreeFunction)(DWORD index);
+
+static FlsAllocFunction		gFlsAlloc		= NULL;
+static FlsGetValueFunction	gFlsGetValue	= NULL;
+static FlsSetValueFunction	gFlsSetValue	= NULL;
+static FlsFreeFunction		gFlsFree		= NULL;
+
+static bool loadFls()
+{
+	HMODULE kernel = GetModuleHandleA("kernel32.dll");
+	if (!kernel)
+		return false;
+	gFlsAlloc		= (FlsAllocFunction)GetProcAddress(kernel, "FlsAlloc");
+	gFlsGetValue	= (FlsGetValueFunction)GetProcAddress(kernel, "FlsGetValue");
+	gFlsSetValue	= (FlsSetValueFunction)GetProcAddress(kernel, "FlsSetValue");
+	gFlsFree		= (FlsFreeFunction)GetProcAddress(kernel, "FlsFree");
+	return gFlsAlloc && gFlsGetValue && gFlsSetValue && gFlsFree;
+}
+#endif
+
+static NX_INLINE NxI64 atomicAdd(volatile NxI64* dst, NxI64 delta)
+{
+	NxI64 old;
+	do
+	{
+		old = *dst;
+	} while (compareExchange(dst, old + delta, old) != old);
+	return old + delta;
+}
+
+static NX_INLINE void atomicMax(volatile NxI64* dst, NxI64 value)
+{
+	NxI64 old;
+	while ((old = *dst) < value && compareExchange(dst, value, old) != old)
+		;
+}
 
-UserAllocator::UserAllocator() : mNbAllocatedBytes(0), mHighWaterMark(0), mTotalNbAllocs(0), mNbAllocs(0), mNbReallocs(0)
+static NX_INLINE NxU32 getHistogramBin(size_t size)
+{
+	NxU32 bin = 0;
+	while (size > 1 && bin < UserAllocator::NB_HISTOGRAM_BINS - 1)
+	{
+		size >>= 1;
+		++bin;
+	}
+	return bin;
+}
+
+// ----------------------------------------------------------------------
+
+UserAllocator::UserAllocator() : mThreadCaches(NULL), mSharedCache(NULL), mTlsIndex(0), mUseTls(false), mUseFls(false)
 {
 #if defined(_DEBUG)
 	// Initialize the Memory blocks list (DEBUG mode only)
@@ -47,17 +197,71 @@ UserAllocator::UserAllocator() : mNbAllocatedBytes(0), mHighWaterMark(0), mTotal
 	mMemBlockFirstFree	= 0;
 	mMemBlockUsed		= 0;
 #endif
+
+	memset((void*)&mTotalStats, 0, sizeof(mTotalStats));
+	memset((void*)mTypeStats, 0, sizeof(mTypeStats));
+	memset((void*)mFileStats, 0, sizeof(mFileStats));
+	memset((void*)mFileNames, 0, sizeof(mFileNames));
+
+	for (NxU32 i = 0; i < NB_SIZE_CLASSES; ++i)
+	{
+		mSizeClasses[i].head = NULL;
+		mSizeClasses[i].count = 0;
+		mSizeClasses[i].chunks = NULL;
+	}
+
+	// block size rounded up to 16 bytes -> size class
+	NxU32 c = 0;
+	for (NxU32 i = 0; i <= 2048 / 16; ++i)
+	{
+		while (gClassSizes[c] < i * 16)
+			++c;
+		mClassOfSize[i] = (NxU8)c;
+	}
+
+	mSharedCache = createCache();
+
+#if defined(WIN32)
+	if (loadFls())
+	{
+		DWORD index = gFlsAlloc(threadExit);
+		mUseFls = index != FLS_OUT_OF_INDEXES;
+		mUseTls = mUseFls;
+		mTlsIndex = index;
+	}
+	if (!mUseTls)
+	{
+		DWORD index = TlsAlloc();
+		mUseTls = index != TLS_OUT_OF_INDEXES;
+		mTlsIndex = index;
+	}
+#elif defined(USE_THREAD_CACHE)
+	pthread_key_t key;
+	mUseTls = pthread_key_create(&key, threadExit) == 0;
+	mTlsIndex = (size_t)key;
+#endif
 }
 
 UserAllocator::~UserAllocator()
 {
+#if defined(WIN32)
+	// calls back for the threads still holding a cache, while the shared lists can take their blocks
+	if (mUseFls)
+		gFlsFree((DWORD)mTlsIndex);
+#endif
+
+	Counters* total = reinterpret_cast<Counters*>(::malloc(sizeof(Counters)));
+	gather(*total);
+
 	LOCK();
 
-	if (mNbAllocatedBytes)	printf("Memory leak detected: %d bytes non released\n", mNbAllocatedBytes);
-	if (mNbAllocs)		printf("Remaining allocs: %d\n", mNbAllocs);
-	printf("Nb alloc: %d\n", mTotalNbAllocs);
-	printf("Nb realloc: %d\n", mNbReallocs);
-	printf("High water mark: %d Kb\n", mHighWaterMark/1024);
+	const NxI64 liveBytes = mTotalStats.liveBytes + total->pendingBytes;
+	if (liveBytes)			printf("Memory leak detected: %d bytes non released\n", (int)liveBytes);
+	if (total->liveBlocks)	printf("Remaining allocs: %d\n", (int)total->liveBlocks);
+	printf("Nb alloc: %d\n", (int)total->nbAllocs);
+	printf("Nb realloc: %d\n", (int)total->nbReallocs);
+	printf("High water mark: %d Kb\n", (int)(mTotalStats.peakBytes/1024));
+	::free(total);
 
 #if defined(_DEBUG)
 	// Scanning for memory leaks
@@ -69,7 +273,7 @@ UserAllocator::~UserAllocator()
 		{
 			if (NULL == mMemBlockList[i]) continue;
 			BlockHeader *ptr = reinterpret_cast<BlockHeader *>(mMemBlockList[i]);
-			printf(" Address 0x%08x, %u bytes (%s), allocated in: %s(%d):\n\n", &ptr[1], ptr->size, ptr->name, ptr->file, ptr->line);
+			printf(" Address 0x%p, %u bytes (%s), allocated in: %s(%d):\n\n", USER_MEMORY(ptr), (unsigned)ptr->size, ptr->name, ptr->file, (int)ptr->line);
 			++NbLeaks;
 		}
 		printf("\n  Dump complete (%d leaks)\n\n", NbLeaks);
@@ -80,51 +284,428 @@ UserAllocator::~UserAllocator()
 	mMemBlockList = NULL;
 #endif
 
+	// Leaked small blocks go away with their chunks
+	for (NxU32 i = 0; i < NB_SIZE_CLASSES; ++i)
+	{
+		while (mSizeClasses[i].chunks)
+		{
+			void* next = *reinterpret_cast<void**>(mSizeClasses[i].chunks);
+			::free(mSizeClasses[i].chunks);
+			mSizeClasses[i].chunks = next;
+		}
+	}
+	while (mThreadCaches)
+	{
+		ThreadCache* next = mThreadCaches->next;
+		::free(mThreadCaches);
+		mThreadCaches = next;
+	}
+
+#if defined(WIN32)
+	if (mUseTls && !mUseFls)
+		TlsFree((DWORD)mTlsIndex);
+#elif defined(USE_THREAD_CACHE)
+	if (mUseTls)
+		pthread_key_delete((pthread_key_t)mTlsIndex);
+#endif
+
 	UNLOCK();
 }
 
+// restarts peak tracking at the current live byte counts
 void UserAllocator::reset()
 {
 	LOCK();
 
-	mNbAllocatedBytes	= 0;
-	mHighWaterMark		= 0;
-	mNbAllocs			= 0;
+	mTotalStats.peakBytes = mTotalStats.liveBytes;
+	for (NxU32 i = 0; i < NB_TYPE_SLOTS; ++i)
+		mTypeStats[i].peakBytes = mTypeStats[i].liveBytes;
+	for (NxU32 i = 0; i < NB_FILE_SLOTS; ++i)
+		mFileStats[i].peakBytes = mFileStats[i].liveBytes;
 
 	UNLOCK();
 }
 
-void* UserAllocator::malloc(size_t size)
+// sums the counters of all threads, a snapshot while other threads allocate
+void UserAllocator::gather(Counters& total)
 {
-	printf("Obsolete code called!\n");
-	return NULL;
+	memset(&total, 0, sizeof(Counters));
+	const NxI64* end = reinterpret_cast<const NxI64*>(&total + 1);
+
+	LOCK();
+	for (ThreadCache* cache = mThreadCaches; cache; cache = cache->next)
+	{
+		NxI64* dst = reinterpret_cast<NxI64*>(&total);
+		const volatile NxI64* src = reinterpret_cast<const volatile NxI64*>(&cache->counters);
+		while (dst < end)
+			*dst++ += *src++;
+	}
+	UNLOCK();
 }
 
-void* UserAllocator::malloc(size_t size, NxMemoryType type)
+void UserAllocator::dumpStatistics()
 {
-#if defined(_DEBUG)
-	return mallocDEBUG(size, NULL, 0, "Undefined", type);
-#else
-	if (0 == size)
+	Counters* total = reinterpret_cast<Counters*>(::malloc(sizeof(Counters)));
+	if (!total)
+		return;
+	gather(*total);
+
+	const NxI64 liveBytes = mTotalStats.liveBytes + total->pendingBytes;
+	printf("UserAllocator: %d Kb live, %d Kb peak, %d live blocks, %d allocs, %d reallocs\n",
+		(int)(liveBytes/1024), (int)((mTotalStats.peakBytes > liveBytes ? mTotalStats.peakBytes : liveBytes)/1024), (int)total->liveBlocks, (int)total->nbAllocs, (int)total->nbReallocs);
+
+	printf(" By NxMemoryType (index: live / peak bytes, live blocks, allocs):\n");
+	for (NxU32 i = 0; i < NB_TYPE_SLOTS; ++i)
 	{
-		printf("Warning: trying to allocate 0 bytes\n");
+		if (!total->typeAllocs[i])
+			continue;
+		const NxI64 live = mTypeStats[i].liveBytes + total->typePendingBytes[i];
+		printf("  %3u: %10d / %10d, %7d, %9d\n", i, (int)live, (int)(mTypeStats[i].peakBytes > live ? mTypeStats[i].peakBytes : live),
+			(int)total->typeLiveBlocks[i], (int)total->typeAllocs[i]);
+	}
+
+	printf(" By source file (live / peak bytes, live blocks, allocs):\n");
+	for (NxU32 i = 0; i < NB_FILE_SLOTS; ++i)
+	{
+		if (!total->fileAllocs[i])
+			continue;
+		const NxI64 live = mFileStats[i].liveBytes + total->filePendingBytes[i];
+		printf("  %10d / %10d, %7d, %9d  %s\n", (int)live, (int)(mFileStats[i].peakBytes > live ? mFileStats[i].peakBytes : live),
+			(int)total->fileLiveBlocks[i], (int)total->fileAllocs[i], i ? mFileNames[i] : "(no file or table full)");
+	}
+
+	printf(" Request size histogram (live blocks, allocs):\n");
+	for (NxU32 i = 0; i < NB_HISTOGRAM_BINS; ++i)
+	{
+		if (total->histogramAllocs[i])
+			printf("  %10u - %10u: %7d, %9d\n", 1u << i, i < 31 ? (2u << i) - 1 : 0xffffffff,
+				(int)total->histogramLiveBlocks[i], (int)total->histogramAllocs[i]);
+	}
+
+	::free(total);
+}
+
+// ----------------------------------------------------------------------
+// small block caches
+
+UserAllocator::ThreadCache* UserAllocator::createCache()
+{
+	// reuse the cache of a thread which exited. Its counters keep their values, they are only ever summed up.
+	LOCK();
+	for (ThreadCache* cache = mThreadCaches; cache; cache = cache->next)
+	{
+		if (!cache->inUse)
+		{
+			cache->inUse = true;
+			UNLOCK();
+			return cache;
+		}
+	}
+	UNLOCK();
+
+	ThreadCache* cache = reinterpret_cast<ThreadCache*>(::malloc(sizeof(ThreadCache)));
+	if (!cache)
 		return NULL;
+	memset(cache, 0, sizeof(ThreadCache));
+	cache->owner = this;
+	cache->inUse = true;
+
+	LOCK();
+	cache->next = mThreadCaches;
+	mThreadCaches = cache;
+	UNLOCK();
+
+	return cache;
+}
+
+// gives the free blocks of the cache back to the shared lists and leaves the cache to the next new thread
+void UserAllocator::retireCache(ThreadCache* cache)
+{
+	for (NxU32 i = 0; i < NB_SIZE_CLASSES; ++i)
+	{
+		if (cache->count[i])
+			release(cache, i, cache->count[i]);
 	}
 
 	LOCK();
+	cache->inUse = false;
+	UNLOCK();
+}
+
+// pthread key destructor or FLS callback, called with the cache of an exiting thread
+#if defined(WIN32)
+void __stdcall UserAllocator::threadExit(void* cache)
+#else
+void UserAllocator::threadExit(void* cache)
+#endif
+{
+	ThreadCache* c = reinterpret_cast<ThreadCache*>(cache);
+	c->owner->retireCache(c);
+}
+
+#if defined(USE_THREAD_CACHE)
+UserAllocator::ThreadCache* UserAllocator::getTlsCache() const
+{
+#if defined(WIN32)
+	return reinterpret_cast<ThreadCache*>(mUseFls ? gFlsGetValue((DWORD)mTlsIndex) : TlsGetValue((DWORD)mTlsIndex));
+#else
+	return reinterpret_cast<ThreadCache*>(pthread_getspecific((pthread_key_t)mTlsIndex));
+#endif
+}
+
+void UserAllocator::setTlsCache(ThreadCache* cache)
+{
+#if defined(WIN32)
+	if (mUseFls)
+		gFlsSetValue((DWORD)mTlsIndex, cache);
+	else
+		TlsSetValue((DWORD)mTlsIndex, cache);
+#else
+	pthread_setspecific((pthread_key_t)mTlsIndex, cache);
+#endif
+}
+#endif
+
+void UserAllocator::releaseThreadCache()
+{
+#if defined(USE_THREAD_CACHE)
+	if (!mUseTls)
+		return;
+
+	ThreadCache* cache = getTlsCache();
+	setTlsCache(NULL);
+	if (cache)
+		retireCache(cache);
+#endif
+}
+
+// the cache of the calling thread, or the locked shared cache
+UserAllocator::ThreadCache* UserAllocator::lockCache()
+{
+#if defined(USE_THREAD_CACHE)
+	if (mUseTls)
+	{
+		ThreadCache* cache = getTlsCache();
+		if (cache)
+			return cache;
+
+		cache = createCache();
+		if (cache)
+		{
+			setTlsCache(cache);
+			return cache;
+		}
+	}
+#endif
+
+	mSharedCacheLock.lock();
+	return mSharedCache;
+}
+
+void UserAllocator::unlockCache(ThreadCache* cache)
+{
+	if (cache == mSharedCache)
+		mSharedCacheLock.unlock();
+}
+
+NxU32 UserAllocator::getSizeClass(size_t blockSize) const
+{
+	return blockSize <= 2048 ? mClassOfSize[(blockSize + 15) >> 4] : LARGE_BLOCK;
+}
+
+// moves a batch of blocks from the shared list of the class to the cache, carving a new chunk if needed
+void UserAllocator::refill(ThreadCache* cache, NxU32 sizeClass)
+{
+	const NxU32 blockSize = gClassSizes[sizeClass];
+	const NxU32 batch = (MAX_CACHED_BYTES / 2) / blockSize;
+	SizeClass& sc = mSizeClasses[sizeClass];
+
+	sc.lock.lock();
+	if (sc.count == 0)
+	{
+		// the start of a chunk links it into the chunk list of the class, blocks follow from the next 16-byte boundary
+		char* chunk = reinterpret_cast<char*>(::malloc(CHUNK_SIZE));
+		if (chunk)
+		{
+			*reinterpret_cast<void**>(chunk) = sc.chunks;
+			sc.chunks = chunk;
+
+			char* first = reinterpret_cast<char*>((reinterpret_cast<size_t>(chunk) + sizeof(void*) + 15) & ~(size_t)15);
+			for (char* b = first; b + blockSize <= chunk + CHUNK_SIZE; b += blockSize)
+			{
+				FreeBlock* block = reinterpret_cast<FreeBlock*>(b);
+				block->next = sc.head;
+				sc.head = block;
+				++sc.count;
+			}
+		}
+	}
+
+	NxU32 n = sc.count < batch ? sc.count : batch;
+	for (NxU32 i = 0; i < n; ++i)
+	{
+		FreeBlock* block = sc.head;
+		sc.head = block->next;
+		block->next = cache->head[sizeClass];
+		cache->head[sizeClass] = block;
+	}
+	sc.count -= n;
+	sc.lock.unlock();
+
+	cache->count[sizeClass] += n;
+}
+
+// moves count blocks from the cache back to the shared list of the class
+void UserAllocator::release(ThreadCache* cache, NxU32 sizeClass, NxU32 count)
+{
+	FreeBlock* first = cache->head[sizeClass];
+	FreeBlock* last = first;
+	for (NxU32 i = 1; i < count; ++i)
+		last = last->next;
+	cache->head[sizeClass] = last->next;
+	cache->count[sizeClass] -= count;
+
+	SizeClass& sc = mSizeClasses[sizeClass];
+	sc.lock.lock();
+	last->next = sc.head;
+	sc.head = first;
+	sc.count += count;
+	sc.lock.unlock();
+}
+
+void* UserAllocator::allocateBlock(ThreadCache* cache, NxU32 sizeClass, size_t size)
+{
+	if (sizeClass == LARGE_BLOCK)
+		return ::malloc(size + HEADER_SIZE);
+
+	if (!cache->count[sizeClass])
+		refill(cache, sizeClass);
+
+	FreeBlock* block = cache->head[sizeClass];
+	if (block)
+	{
+		cache->head[sizeClass] = block->next;
+		--cache->count[sizeClass];
+	}
+	return block;
+}
+
+void UserAllocator::freeBlock(ThreadCache* cache, BlockHeader* ptr)
+{
+	const NxU32 sizeClass = ptr->sizeClass;
+	ptr->sign = 0;
+	if (sizeClass == LARGE_BLOCK)
+	{
+		::free(ptr);
+		return;
+	}
 
-	BlockHeader *ptr = reinterpret_cast<BlockHeader *>(::malloc(size + sizeof (BlockHeader)));
-	ptr->sign = BlockHeader::marker;
-	ptr->size = size;
+	FreeBlock* block = reinterpret_cast<FreeBlock*>(ptr);
+	block->next = cache->head[sizeClass];
+	cache->head[sizeClass] = block;
+	++cache->count[sizeClass];
 
-	++mTotalNbAllocs;
-	++mNbAllocs;
-	mNbAllocatedBytes += size;
-	if (mNbAllocatedBytes > mHighWaterMark)	mHighWaterMark = mNbAllocatedBytes;
+	if (cache->count[sizeClass] * gClassSizes[sizeClass] > MAX_CACHED_BYTES)
+		release(cache, sizeClass, cache->count[sizeClass] / 2);
+}
 
+// ----------------------------------------------------------------------
+// statistics
+
+NxU16 UserAllocator::getFileSlot(const char* file)
+{
+	if (!file)
+		return 0;
+
+	const NxU32 nbSlots = NB_FILE_SLOTS - 1;
+	const NxU32 start = (NxU32)(((size_t)file >> 3) * 2654435761u) % nbSlots;
+
+	// lookups take no lock, only inserting a new file does
+	for (NxU32 i = 0; i < nbSlots; ++i)
+	{
+		const NxU32 slot = 1 + (start + i) % nbSlots;
+		const char* name = mFileNames[slot];
+		if (name == file)
+			return (NxU16)slot;
+		if (name == NULL)
+			break;
+	}
+
+	NxU16 result = 0;
+	LOCK();
+	for (NxU32 i = 0; i < nbSlots; ++i)
+	{
+		const NxU32 slot = 1 + (start + i) % nbSlots;
+		if (mFileNames[slot] == file)
+		{
+			result = (NxU16)slot;
+			break;
+		}
+		if (mFileNames[slot] == NULL)
+		{
+			mFileNames[slot] = file;
+			result = (NxU16)slot;
+			break;
+		}
+	}
 	UNLOCK();
+	return result;
+}
 
-	return &ptr[1];
+void UserAllocator::publish(NxI64& pending, Stats& stats)
+{
+	const NxI64 live = atomicAdd(&stats.liveBytes, pending);
+	if (pending > 0)
+		atomicMax(&stats.peakBytes, live);
+	pending = 0;
+}
+
+// adds (blocks = 1) or removes (blocks = -1) the block from the statistics of the calling thread,
+// allocs is 1 for a new block and 0 for both halves of a realloc
+void UserAllocator::account(ThreadCache* cache, BlockHeader* ptr, NxI64 blocks, NxI64 allocs)
+{
+	Counters& c = cache->counters;
+	const NxI64 bytes = blocks * (NxI64)ptr->size;
+	const NxU32 bin = getHistogramBin(ptr->size);
+
+	c.nbAllocs += allocs;
+	c.liveBlocks += blocks;
+	c.typeAllocs[ptr->type] += allocs;
+	c.typeLiveBlocks[ptr->type] += blocks;
+	c.fileAllocs[ptr->fileSlot] += allocs;
+	c.fileLiveBlocks[ptr->fileSlot] += blocks;
+	c.histogramAllocs[bin] += allocs;
+	c.histogramLiveBlocks[bin] += blocks;
+
+	c.pendingBytes += bytes;
+	if (c.pendingBytes > STATS_BATCH || c.pendingBytes < -STATS_BATCH)
+		publish(c.pendingBytes, mTotalStats);
+
+	NxI64& typeBytes = c.typePendingBytes[ptr->type];
+	typeBytes += bytes;
+	if (typeBytes > STATS_BATCH || typeBytes < -STATS_BATCH)
+		publish(typeBytes, mTypeStats[ptr->type]);
+
+	NxI64& fileBytes = c.filePendingBytes[ptr->fileSlot];
+	fileBytes += bytes;
+	if (fileBytes > STATS_BATCH || fileBytes < -STATS_BATCH)
+		publish(fileBytes, mFileStats[ptr->fileSlot]);
+}
+
+// ----------------------------------------------------------------------
+
+void* UserAllocator::malloc(size_t size)
+{
+	printf("Obsolete code called!\n");
+	return NULL;
+}
+
+void* UserAllocator::malloc(size_t size, NxMemoryType type)
+{
+#if defined(_DEBUG)
+	return mallocDEBUG(size, NULL, 0, "Undefined", type);
+#else
+	return allocate(size, type, NULL, 0, NULL);
 #endif
 }
 
@@ -136,29 +717,43 @@ void* UserAllocator::mallocDEBUG(size_t size, const char* file, int line)
 
 void* UserAllocator::mallocDEBUG(size_t size, const char* file, int line, const char* className, NxMemoryType type)
 {
-#if !defined(_DEBUG)
-	return malloc(size, type);
-#else
+	return allocate(size, type, file, line, className);
+}
+
+void* UserAllocator::allocate(size_t size, NxMemoryType type, const char* file, int line, const char* className)
+{
 	if (0 == size)
 	{
 		printf("Warning: trying to allocate 0 bytes\n");
 		return NULL;
 	}
 
-	LOCK();
+	const NxU32 sizeClass = getSizeClass(size + HEADER_SIZE);
+	const NxU16 fileSlot = getFileSlot(file);
+
+	ThreadCache* cache = lockCache();
+	BlockHeader *ptr = reinterpret_cast<BlockHeader *>(allocateBlock(cache, sizeClass, size));
+	if (ptr)
+	{
+		ptr->sign = BlockHeader::marker;
+		ptr->size = size;
+		ptr->type = (NxU32)type < NB_TYPE_SLOTS ? (NxU32)type : NB_TYPE_SLOTS - 1;
+		ptr->sizeClass = (NxU16)sizeClass;
+		ptr->fileSlot = fileSlot;
+		account(cache, ptr, 1, 1);
+	}
+	unlockCache(cache);
+
+	if (!ptr)
+		return NULL;
 
-	BlockHeader *ptr = reinterpret_cast<BlockHeader *>(::malloc(size + sizeof (BlockHeader)));
-	ptr->sign = BlockHeader::marker;
-	ptr->size = size;
+#if defined(_DEBUG)
 	ptr->file = file;
 	ptr->line = line;
 	ptr->name = className;
 	ptr->indx = ~0;
 
-	++mTotalNbAllocs;
-	++mNbAllocs;
-	mNbAllocatedBytes += size;
-	if (mNbAllocatedBytes > mHighWaterMark)	mHighWaterMark = mNbAllocatedBytes;
+	LOCK();
 
 	// Insert the allocated block in the debug memory block list
 	if (NULL != mMemBlockList)
@@ -169,12 +764,14 @@ void* UserAllocator::mallocDEBUG(size_t size, const char* file, int line, const
 		++mMemBlockUsed;
 		if (mMemBlockUsed >= mMemBlockListSize)
 		{
-			NxPtr *tps = reinterpret_cast<NxPtr *>(::malloc((mMemBlockListSize + MEMBLOCKSTART) * sizeof (NxPtr)));
+			// grow geometrically, the SDK keeps tens of thousands of blocks alive
+			NxPtr *tps = reinterpret_cast<NxPtr *>(::malloc(mMemBlockListSize * 2 * sizeof (NxPtr)));
 			memcpy(tps, mMemBlockList, mMemBlockListSize * sizeof (NxPtr));
-			memset(&tps[mMemBlockListSize], 0, MEMBLOCKSTART * sizeof (NxPtr));
+			memset(&tps[mMemBlockListSize], 0, mMemBlockListSize * sizeof (NxPtr));
 			::free(mMemBlockList);
 			mMemBlockList = tps;
-			mMemBlockListSize += MEMBLOCKSTART;
+			mMemBlockFirstFree = mMemBlockListSize;
+			mMemBlockListSize *= 2;
 		}
 
 		while (mMemBlockFirstFree < mMemBlockListSize && mMemBlockList[mMemBlockFirstFree]) ++mMemBlockFirstFree;
@@ -192,9 +789,12 @@ void* UserAllocator::mallocDEBUG(size_t size, const char* file, int line, const
 	}
 
 	UNLOCK();
-
-	return &ptr[1];
+#else
+	NX_UNREFERENCED_PARAMETER(line);
+	NX_UNREFERENCED_PARAMETER(className);
 #endif
+
+	return USER_MEMORY(ptr);
 }
 
 void* UserAllocator::realloc(void* memory, size_t size)
@@ -210,42 +810,58 @@ void* UserAllocator::realloc(void* memory, size_t size)
 		printf("Warning: trying to realloc 0 bytes\n");
 	}
 
-	LOCK();
-
-	BlockHeader *ptr = reinterpret_cast<BlockHeader *>(memory) - 1;
+	BlockHeader *ptr = BLOCK_HEADER(memory);
 	if (BlockHeader::marker != ptr->sign)
 	{
 		fprintf(stderr, "Error: realloc unknown memory!!\n");
 		fflush(stderr);
 	}
 
-	++mNbReallocs;
-	mNbAllocatedBytes -= ptr->size;
-	mNbAllocatedBytes += size;
-	if (mNbAllocatedBytes > mHighWaterMark)	mHighWaterMark = mNbAllocatedBytes;
+	const size_t oldSize = ptr->size;
+	const NxU32 sizeClass = getSizeClass(size + HEADER_SIZE);
 
-#if defined(_DEBUG)
-	//need to store this for removal later
-	size_t oldMemBlockIndex = ptr->indx;
-#endif
+	ThreadCache* cache = lockCache();
+	BlockHeader *ptr2 = ptr;
+	if (ptr->sizeClass == LARGE_BLOCK && sizeClass == LARGE_BLOCK)
+	{
+		ptr2 = reinterpret_cast<BlockHeader *>(::realloc(ptr, size + HEADER_SIZE));
+	}
+	else if (ptr->sizeClass == LARGE_BLOCK || sizeClass > ptr->sizeClass)
+	{
+		// move to a block of another class, small blocks never shrink
+		ptr2 = reinterpret_cast<BlockHeader *>(allocateBlock(cache, sizeClass, size));
+		if (ptr2)
+		{
+			memcpy(ptr2, ptr, HEADER_SIZE + (oldSize < size ? oldSize : size));
+			freeBlock(cache, ptr);
+			ptr2->sizeClass = (NxU16)sizeClass;
+		}
+	}
 
-	ptr->sign = 0;
-	ptr->size = 0;
-	BlockHeader *ptr2 = reinterpret_cast<BlockHeader *>(::realloc(ptr, size + sizeof (BlockHeader)));
-	ptr2->sign = BlockHeader::marker;
-	ptr2->size = size;
+	if (ptr2)
+	{
+		ptr2->sign = BlockHeader::marker;
+		account(cache, ptr2, -1, 0);
+		ptr2->size = size;
+		account(cache, ptr2, 1, 0);
+		++cache->counters.nbReallocs;
+	}
+	unlockCache(cache);
+
+	if (!ptr2)
+		return NULL;
 
 #if defined(_DEBUG)
 	ptr2->file = NULL;
 	ptr2->line = 0;
 	ptr2->name = NULL;
-	ptr2->indx = oldMemBlockIndex;
 
+	LOCK();
 	if (NULL != mMemBlockList)
 	{
 		if (ptr2->indx >= mMemBlockListSize)
 		{
-			fprintf(stderr, "Oops: index (%u) >= list size (%u)\n", ptr2->indx, mMemBlockListSize);
+			fprintf(stderr, "Oops: index (%u) >= list size (%u)\n", (unsigned)ptr2->indx, mMemBlockListSize);
 			fflush(stderr);
 		}
 		else
@@ -253,11 +869,10 @@ void* UserAllocator::realloc(void* memory, size_t size)
 			mMemBlockList[ptr2->indx] = ptr2;
 		}
 	}
-#endif
-
 	UNLOCK();
+#endif
 
-	return &ptr2[1];
+	return USER_MEMORY(ptr2);
 }
 
 void UserAllocator::free(void* memory)
@@ -268,50 +883,35 @@ void UserAllocator::free(void* memory)
 		return;
 	}
 
-	LOCK();
-
-	do
+	BlockHeader *ptr = BLOCK_HEADER(memory);
+	if (BlockHeader::marker != ptr->sign)
 	{
-		BlockHeader *ptr = reinterpret_cast<BlockHeader *>(memory) - 1;
-		if (BlockHeader::marker != ptr->sign)
-		{
-			fprintf(stderr, "Oops: free unknown memory!!\n");
-			fflush(stderr);
-			break;
-		}
+		fprintf(stderr, "Oops: free unknown memory!!\n");
+		fflush(stderr);
+		return;
+	}
 
-		if (mNbAllocatedBytes < ptr->size)
+#if defined(_DEBUG)
+	// Remove the block from the Memory block list
+	LOCK();
+	if (NULL != mMemBlockList)
+	{
+		if (ptr->indx >= mMemBlockListSize)
 		{
-			fprintf(stderr, "Oops: size = %u\n", ptr->size);
+			fprintf(stderr, "Oops: index = %u (>= %u)\n", (unsigned)ptr->indx, mMemBlockListSize);
 			fflush(stderr);
-			break;
+			UNLOCK();
+			return;
 		}
 
-		mNbAllocatedBytes -= ptr->size;
-		--mNbAllocs;
-
-#if defined(_DEBUG)
-
-		// Remove the block from the Memory block list
-		if (NULL != mMemBlockList)
-		{
-			if (ptr->indx >= mMemBlockListSize)
-			{
-				fprintf(stderr, "Oops: index = %u (>= %u)\n", ptr->indx, mMemBlockListSize);
-				fflush(stderr);
-				break;
-			}
-
-			mMemBlockList[ptr->indx] = NULL;
-			--mMemBlockUsed;
-		}
+		mMemBlockList[ptr->indx] = NULL;
+		--mMemBlockUsed;
+	}
+	UNLOCK();
 #endif
 
-		ptr->sign = 0;
-		ptr->size = 0;
-		::free(ptr);
-	} while (false);
-
-	UNLOCK();
+	ThreadCache* cache = lockCache();
+	account(cache, ptr, -1, 0);
+	freeBlock(cache, ptr);
+	unlockCache(cache);
 }
-
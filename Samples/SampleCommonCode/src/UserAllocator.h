@@ -10,6 +10,21 @@
 
 #include "SampleMutex.h"
 
+// Blocks up to 2 KB (header included) are carved from 64 KB chunks and recycled
+// through per-thread caches of free blocks, one list per size class. A cache
+// that runs dry or overflows exchanges a batch with the shared list of the
+// class, so the common malloc / free takes no lock. Larger blocks go straight
+// to the system allocator. When a thread exits its cache returns its blocks to
+// the shared lists and is reused by the next new thread, through a pthread key
+// destructor or a Win32 FLS callback. Where FLS is missing (before Windows
+// Server 2003) a thread has to call releaseThreadCache() before it exits, or
+// its cache stays with it until the allocator is destroyed.
+//
+// Live and peak bytes are tracked per NxMemoryType and, for mallocDEBUG calls,
+// per source file, together with a power of two histogram of request sizes.
+// Counters are kept per thread and byte counts are published in batches, so
+// peaks are exact to within STATS_BATCH bytes per thread. dumpStatistics()
+// prints everything at any time.
 class UserAllocator : public NxUserAllocator
 {
 public:
@@ -26,7 +41,61 @@ public:
 	void*	realloc(void* memory, size_t size);
 	void	free(void* memory);
 
+	void	dumpStatistics();
+	void	releaseThreadCache();
+
+	enum
+	{
+		NB_SIZE_CLASSES		= 23,
+		NB_TYPE_SLOTS		= NX_MEMORY_LAST + 1,	// the last one takes out of range types
+		NB_FILE_SLOTS		= 256,					// slot 0 takes allocations without a file and the overflow
+		NB_HISTOGRAM_BINS	= 32,
+		STATS_BATCH			= 16 * 1024
+	};
+
+	struct Stats
+	{
+		volatile NxI64	liveBytes;
+		volatile NxI64	peakBytes;
+	};
+
+	struct BlockHeader;
+
 private:
+	struct FreeBlock;
+	struct Counters;
+	struct ThreadCache;
+	struct SizeClass
+	{
+		FreeBlock*	head;
+		NxU32		count;
+		void*		chunks;		// singly linked list of the chunks carved for this class
+		SampleMutex	lock;
+	};
+
+	void*			allocate(size_t size, NxMemoryType type, const char* file, int line, const char* className);
+	void*			allocateBlock(ThreadCache* cache, NxU32 sizeClass, size_t size);
+	void			freeBlock(ThreadCache* cache, BlockHeader* ptr);
+	void			account(ThreadCache* cache, BlockHeader* ptr, NxI64 blocks, NxI64 allocs);
+	void			publish(NxI64& pending, Stats& stats);
+	NxU16			getFileSlot(const char* file);
+	NxU32			getSizeClass(size_t blockSize) const;
+
+	ThreadCache*	lockCache();
+	void			unlockCache(ThreadCache* cache);
+	ThreadCache*	createCache();
+	void			retireCache(ThreadCache* cache);
+	ThreadCache*	getTlsCache() const;
+	void			setTlsCache(ThreadCache* cache);
+#if defined(WIN32)
+	static void __stdcall	threadExit(void* cache);
+#else
+	static void		threadExit(void* cache);
+#endif
+	void			refill(ThreadCache* cache, NxU32 sizeClass);
+	void			release(ThreadCache* cache, NxU32 sizeClass, NxU32 count);
+	void			gather(Counters& total);
+
 #if defined(_DEBUG)
 	NxPtr*	mMemBlockList;
 	NxU32	mMemBlockListSize;
@@ -34,15 +103,22 @@ private:
 	NxU32	mMemBlockUsed;
 #endif
 
-	size_t	mNbAllocatedBytes;
-	size_t	mHighWaterMark;
-	NxI32	mTotalNbAllocs;
-	NxI32	mNbAllocs;
-	NxI32	mNbReallocs;
+	Stats			mTotalStats;
+	Stats			mTypeStats[NB_TYPE_SLOTS];
+	Stats			mFileStats[NB_FILE_SLOTS];
+	const char*	volatile mFileNames[NB_FILE_SLOTS];
 
-	// to protect the mMemBlockList & the statistics data
+	SizeClass		mSizeClasses[NB_SIZE_CLASSES];
+	NxU8			mClassOfSize[2048 / 16 + 1];
+	ThreadCache*	mThreadCaches;		// every cache created, in use or not, released in the destructor
+	ThreadCache*	mSharedCache;		// for threads without a cache of their own, under mSharedCacheLock
+	size_t			mTlsIndex;
+	bool			mUseTls;
+	bool			mUseFls;			// Win32, mTlsIndex is an FLS index
+
+	// to protect the mMemBlockList, the cache list and the file table
 	SampleMutex	mAllocatorLock;
+	SampleMutex	mSharedCacheLock;
 };
 
 #endif  // USERALLOCATOR_H
-
@@ -0,0 +1,351 @@
+// ===============================================================================
+//						  NVIDIA PhysX SDK Sample ProgramS
+//					        PARTICLE FLUID
+//
+//		Batched particle generation into persistent SoA staging buffers
+// ===============================================================================
+
+#include "ParticleBatch.h"
+
+#include <stdlib.h>
+#include <vector>
+
+#if defined(WIN32)
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#	include <pthread.h>
+#	include <unistd.h>
+#	define PARTICLE_BATCH_PTHREADS
+#endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#	include <xmmintrin.h>
+#	define PARTICLE_BATCH_SSE
+#endif
+
+// ----------------------------------------------------------------------
+// fork / join over index ranges
+
+struct ParticleBatchJob
+{
+	ParticleBatch* batch;
+	void (ParticleBatch::*method)(unsigned, unsigned);
+	unsigned begin;
+	unsigned end;
+
+	void run() { (batch->*method)(begin, end); }
+};
+
+#if defined(WIN32)
+static DWORD WINAPI particleBatchThreadFunc(LPVOID arg)
+{
+	((ParticleBatchJob*)arg)->run();
+	return 0;
+}
+#elif defined(PARTICLE_BATCH_PTHREADS)
+static void* particleBatchThreadFunc(void* arg)
+{
+	((ParticleBatchJob*)arg)->run();
+	return NULL;
+}
+#endif
+
+static unsigned getNumProcessors()
+{
+#if defined(WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (unsigned)info.dwNumberOfProcessors;
+#elif defined(PARTICLE_BATCH_PTHREADS)
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (unsigned)n : 1;
+#else
+	return 1;
+#endif
+}
+
+void ParticleBatch::runParallel(void (ParticleBatch::*method)(unsigned, unsigned), unsigned count)
+{
+	unsigned numThreads = NxMath::min(getNumProcessors(), count / (parallelThreshold / 4) + 1);
+	if(count <= parallelThreshold || numThreads < 2)
+	{
+		(this->*method)(0, count);
+		return;
+	}
+
+	std::vector<ParticleBatchJob> jobs(numThreads);
+	unsigned perThread = (count + numThreads - 1) / numThreads;
+	for(unsigned i=0; i<numThreads; i++)
+	{
+		jobs[i].batch = this;
+		jobs[i].method = method;
+		jobs[i].begin = NxMath::min(i*perThread, count);
+		jobs[i].end = NxMath::min(jobs[i].begin + perThread, count);
+	}
+
+#if defined(WIN32)
+	std::vector<HANDLE> threads(numThreads, (HANDLE)NULL);
+	for(unsigned i=1; i<numThreads; i++)
+		threads[i] = CreateThread(NULL, 0, particleBatchThreadFunc, &jobs[i], 0, NULL);
+	jobs[0].run();
+	for(unsigned i=1; i<numThreads; i++)
+	{
+		if(threads[i] == NULL)
+		{
+			jobs[i].run();
+			continue;
+		}
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+	}
+#elif defined(PARTICLE_BATCH_PTHREADS)
+	std::vector<pthread_t> threads(numThreads);
+	std::vector<bool> started(numThreads, false);
+	for(unsigned i=1; i<numThreads; i++)
+		started[i] = pthread_create(&threads[i], NULL, particleBatchThreadFunc, &jobs[i]) == 0;
+	jobs[0].run();
+	for(unsigned i=1; i<numThreads; i++)
+	{
+		if(started[i])
+			pthread_join(threads[i], NULL);
+		else
+			jobs[i].run();
+	}
+#else
+	for(unsigned i=0; i<numThreads; i++)
+		jobs[i].run();
+#endif
+}
+
+// ----------------------------------------------------------------------
+ParticleBatch::ParticleBatch() : mPosX(NULL), mPosY(NULL), mPosZ(NULL), mMemory(NULL), mCapacity(0), mNumParticles(0)
+{
+}
+
+ParticleBatch::~ParticleBatch()
+{
+	release();
+}
+
+void ParticleBatch::release()
+{
+	free(mMemory);
+	mMemory = NULL;
+	mPosX = mPosY = mPosZ = NULL;
+	mCapacity = 0;
+	mNumParticles = 0;
+}
+
+void ParticleBatch::reserve(unsigned numParticles)
+{
+	if(numParticles <= mCapacity)
+		return;
+
+	// three 16 byte aligned arrays padded to whole SSE vectors
+	unsigned capacity = (numParticles + 3) & ~3u;
+	free(mMemory);
+	mMemory = malloc(3 * capacity * sizeof(float) + 15);
+	if(mMemory == NULL)
+	{
+		mPosX = mPosY = mPosZ = NULL;
+		mCapacity = 0;
+		return;
+	}
+	mPosX = (float*)(((size_t)mMemory + 15) & ~(size_t)15);
+	mPosY = mPosX + capacity;
+	mPosZ = mPosY + capacity;
+	mCapacity = capacity;
+}
+
+// ----------------------------------------------------------------------
+unsigned ParticleBatch::generateAABB(const NxBounds3& aabb, float distance, unsigned maxParticles)
+{
+	NxVec3 aabbDim;
+	aabb.getExtents(aabbDim);
+	aabbDim *= 2.0f;
+
+	unsigned sideNumX = (unsigned)NxMath::max(1.0f, NxMath::floor(aabbDim.x / distance));
+	unsigned sideNumY = (unsigned)NxMath::max(1.0f, NxMath::floor(aabbDim.y / distance));
+	unsigned sideNumZ = (unsigned)NxMath::max(1.0f, NxMath::floor(aabbDim.z / distance));
+
+	NxF64 total = (NxF64)sideNumX * sideNumY * sideNumZ;
+	unsigned count = total < maxParticles ? (unsigned)total : maxParticles;
+
+	reserve(count);
+	if(count > mCapacity)
+		count = mCapacity;
+
+	mGridMin = aabb.min;
+	mGridDistance = distance;
+	mGridSideY = sideNumY;
+	mGridSideZ = sideNumZ;
+	mNumParticles = count;
+	runParallel(&ParticleBatch::fillAABB, count);
+	return count;
+}
+
+void ParticleBatch::fillAABB(unsigned begin, unsigned end)
+{
+	// walk the z rows of the grid, particle n is at (i, j, k) with n = (i*sideY + j)*sideZ + k
+	unsigned row = begin / mGridSideZ;
+	unsigned k = begin % mGridSideZ;
+	unsigned n = begin;
+	while(n < end)
+	{
+		unsigned i = row / mGridSideY;
+		unsigned j = row % mGridSideY;
+		unsigned rowEnd = NxMath::min(end, n + (mGridSideZ - k));
+		float x = i*mGridDistance + mGridMin.x;
+		float y = j*mGridDistance + mGridMin.y;
+
+#ifdef PARTICLE_BATCH_SSE
+		const __m128 vx = _mm_set1_ps(x);
+		const __m128 vy = _mm_set1_ps(y);
+		const __m128 vd = _mm_set1_ps(mGridDistance);
+		const __m128 vmin = _mm_set1_ps(mGridMin.z);
+		const __m128 four = _mm_set1_ps(4.0f);
+		__m128 vk = _mm_setr_ps((float)k, (float)(k+1), (float)(k+2), (float)(k+3));
+		for(; n + 4 <= rowEnd; n += 4, k += 4)
+		{
+			_mm_storeu_ps(mPosX + n, vx);
+			_mm_storeu_ps(mPosY + n, vy);
+			_mm_storeu_ps(mPosZ + n, _mm_add_ps(_mm_mul_ps(vk, vd), vmin));
+			vk = _mm_add_ps(vk, four);
+		}
+#endif
+		for(; n < rowEnd; n++, k++)
+		{
+			mPosX[n] = x;
+			mPosY[n] = y;
+			mPosZ[n] = k*mGridDistance + mGridMin.z;
+		}
+		row++;
+		k = 0;
+	}
+}
+
+// ----------------------------------------------------------------------
+unsigned ParticleBatch::generateSphere(const NxVec3& pos, float distance, unsigned sideNum, unsigned maxParticles)
+{
+	float rad = sideNum*distance*0.5f;
+
+	// the sphere holds about pi/6 of the block, the bound avoids growing while filling
+	NxF64 total = (NxF64)sideNum * sideNum * sideNum;
+	reserve(total < maxParticles ? (unsigned)total : maxParticles);
+	maxParticles = NxMath::min(maxParticles, mCapacity);
+
+	unsigned n = 0;
+	for(unsigned i=0; i<sideNum && n<maxParticles; i++)
+	{
+		float dx = i*distance - rad;
+		for(unsigned j=0; j<sideNum && n<maxParticles; j++)
+		{
+			float dy = j*distance - rad;
+			float dxy = dx*dx + dy*dy;
+			unsigned k = 0;
+#ifdef PARTICLE_BATCH_SSE
+			const __m128 vd = _mm_set1_ps(distance);
+			const __m128 vrad = _mm_set1_ps(rad);
+			const __m128 vdxy = _mm_set1_ps(dxy);
+			const __m128 four = _mm_set1_ps(4.0f);
+			__m128 vk = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+			for(; k + 4 <= sideNum && n<maxParticles; k += 4)
+			{
+				__m128 dz = _mm_sub_ps(_mm_mul_ps(vk, vd), vrad);
+				__m128 dist = _mm_sqrt_ps(_mm_add_ps(vdxy, _mm_mul_ps(dz, dz)));
+				int mask = _mm_movemask_ps(_mm_cmplt_ps(dist, vrad));
+				vk = _mm_add_ps(vk, four);
+				for(unsigned l=0; l<4 && mask; l++, mask >>= 1)
+				{
+					if(!(mask & 1) || n >= maxParticles)
+						continue;
+					mPosX[n] = i*distance + pos.x;
+					mPosY[n] = j*distance + pos.y;
+					mPosZ[n] = (k+l)*distance + pos.z;
+					n++;
+				}
+			}
+#endif
+			for(; k<sideNum && n<maxParticles; k++)
+			{
+				float dz = k*distance - rad;
+				if(NxMath::sqrt(dxy + dz*dz) < rad)
+				{
+					mPosX[n] = i*distance + pos.x;
+					mPosY[n] = j*distance + pos.y;
+					mPosZ[n] = k*distance + pos.z;
+					n++;
+				}
+			}
+		}
+	}
+
+	mNumParticles = n;
+	return n;
+}
+
+// ----------------------------------------------------------------------
+unsigned ParticleBatch::emit(NxParticleData& pd, unsigned maxParticlesTotal, bool append, const NxVec3& vel, float lifetime)
+{
+	mDstPos = reinterpret_cast<char*>(pd.bufferPos);
+	mDstVel = reinterpret_cast<char*>(pd.bufferVel);
+	mDstLife = reinterpret_cast<char*>(pd.bufferLife);
+
+	if(mDstPos == NULL && mDstVel == NULL && mDstLife == NULL)
+		return 0;
+
+	if(!append)
+		(*pd.numParticlesPtr) = 0;
+
+	unsigned first = *pd.numParticlesPtr;
+	if(first >= maxParticlesTotal)
+		return 0;
+	unsigned count = NxMath::min(mNumParticles, maxParticlesTotal - first);
+
+	mDstPosStride = pd.bufferPosByteStride;
+	mDstVelStride = pd.bufferVelByteStride;
+	mDstLifeStride = pd.bufferLifeByteStride;
+	if(mDstPos)
+		mDstPos += mDstPosStride * first;
+	if(mDstVel)
+		mDstVel += mDstVelStride * first;
+	if(mDstLife)
+		mDstLife += mDstLifeStride * first;
+	mVel = vel;
+	mLifetime = lifetime;
+
+	runParallel(&ParticleBatch::copyToParticleData, count);
+
+	(*pd.numParticlesPtr) += count;
+	return count;
+}
+
+void ParticleBatch::copyToParticleData(unsigned begin, unsigned end)
+{
+	if(mDstPos)
+	{
+		char* dst = mDstPos + mDstPosStride * begin;
+		for(unsigned n=begin; n<end; n++, dst += mDstPosStride)
+		{
+			NxVec3& position = *reinterpret_cast<NxVec3*>(dst);
+			position.set(mPosX[n], mPosY[n], mPosZ[n]);
+		}
+	}
+
+	if(mDstVel)
+	{
+		char* dst = mDstVel + mDstVelStride * begin;
+		for(unsigned n=begin; n<end; n++, dst += mDstVelStride)
+			*reinterpret_cast<NxVec3*>(dst) = mVel;
+	}
+
+	if(mDstLife)
+	{
+		char* dst = mDstLife + mDstLifeStride * begin;
+		for(unsigned n=begin; n<end; n++, dst += mDstLifeStride)
+			*reinterpret_cast<NxReal*>(dst) = mLifetime;
+	}
+}
@@ -0,0 +1,72 @@
+// ===============================================================================
+//						  NVIDIA PhysX SDK Sample ProgramS
+//					        PARTICLE FLUID
+//
+//		Batched particle generation into persistent SoA staging buffers
+// ===============================================================================
+
+#ifndef PARTICLE_BATCH_H
+#define PARTICLE_BATCH_H
+
+#include "NxPhysics.h"
+
+// Generates particle positions into separate x, y and z arrays with SSE where available
+// and copies them into strided NxParticleData buffers. The staging buffers only grow, so
+// repeated emissions of the same size do not allocate. Blocks with more than
+// parallelThreshold particles are split across one thread per processor.
+class ParticleBatch
+{
+public:
+	ParticleBatch();
+	~ParticleBatch();
+
+	// grid with spacing distance starting at aabb.min, in x, y, z loop order
+	unsigned generateAABB(const NxBounds3& aabb, float distance, unsigned maxParticles);
+	// grid points of a sideNum^3 block at pos which lie inside the inscribed sphere
+	unsigned generateSphere(const NxVec3& pos, float distance, unsigned sideNum, unsigned maxParticles);
+
+	// writes the staged positions and the constant velocity and lifetime into pd,
+	// never exceeding maxParticlesTotal particles in pd, returns the number written
+	unsigned emit(NxParticleData& pd, unsigned maxParticlesTotal, bool append, const NxVec3& vel, float lifetime);
+
+	void release();
+
+	unsigned getNumParticles() const { return mNumParticles; }
+	unsigned getCapacity() const { return mCapacity; }
+	const float* getPositionsX() const { return mPosX; }
+	const float* getPositionsY() const { return mPosY; }
+	const float* getPositionsZ() const { return mPosZ; }
+
+	static const unsigned parallelThreshold = 1 << 16;
+
+private:
+	void reserve(unsigned numParticles);
+
+	void fillAABB(unsigned begin, unsigned end);
+	void copyToParticleData(unsigned begin, unsigned end);
+	void runParallel(void (ParticleBatch::*method)(unsigned, unsigned), unsigned count);
+
+	float* mPosX;
+	float* mPosY;
+	float* mPosZ;
+	void* mMemory;
+	unsigned mCapacity;
+	unsigned mNumParticles;
+
+	// parameters of the running fill / copy
+	NxVec3 mGridMin;
+	float mGridDistance;
+	unsigned mGridSideY;
+	unsigned mGridSideZ;
+
+	char* mDstPos;
+	char* mDstVel;
+	char* mDstLife;
+	NxU32 mDstPosStride;
+	NxU32 mDstVelStride;
+	NxU32 mDstLifeStride;
+	NxVec3 mVel;
+	float mLifetime;
+};
+
+#endif
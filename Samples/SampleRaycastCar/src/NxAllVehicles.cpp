@@ -3,6 +3,9 @@
 std::set<NxVehicle*>	NxAllVehicles::_allVehicles;
 NxArray<NxVehicle*>		NxAllVehicles::_allVehiclesSequential;
 std::set<NxVehicle*>	NxAllVehicles::_allChildVehicles;
+NxArray<NxVehicle*>		NxAllVehicles::_fleet;
+NxArray<NxU32>			NxAllVehicles::_fleetFirstWheels;
+NxWheelBatch			NxAllVehicles::_fleetWheels;
 NxI32					NxAllVehicles::_activeVehicle = -1;
 NxVehicle*				NxAllVehicles::_activeVehicleP;
 
@@ -33,12 +36,27 @@ void NxAllVehicles::RemoveVehicle(NxVehicle* v) {
 }
 */
 void NxAllVehicles::updateAllVehicles(NxReal lastTimeStep) {
+	// Fleet update: the wheel state of every vehicle is read from the SDK first, into one
+	// batch, then each vehicle is updated from its part of the batch. Updating a vehicle
+	// doesn't change what the others read, so results are the same as updating the vehicles
+	// one after the other.
+	_fleet.clear();
 	std::set<NxVehicle*>::iterator it = _allVehicles.begin();
 	for (;it != _allVehicles.end(); ++it) {
-		(*it)->updateVehicle(lastTimeStep);
+		_fleet.pushBack(*it);
 	}
 	for (it = _allChildVehicles.begin(); it != _allChildVehicles.end(); ++it) {
-		(*it)->updateVehicle(lastTimeStep);
+		_fleet.pushBack(*it);
+	}
+
+	_fleetWheels.clear();
+	_fleetFirstWheels.clear();
+	for (NxU32 i = 0; i < _fleet.size(); i++) {
+		_fleetFirstWheels.pushBack(_fleet[i]->gatherWheels(_fleetWheels));
+	}
+
+	for (NxU32 i = 0; i < _fleet.size(); i++) {
+		_fleet[i]->updateVehicle(lastTimeStep, _fleetWheels, _fleetFirstWheels[i]);
 	}
 	//printf("\n");
 }
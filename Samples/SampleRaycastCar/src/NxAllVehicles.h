@@ -9,6 +9,9 @@ private:
 	static std::set<NxVehicle*> _allVehicles;
 	static NxArray<NxVehicle*> _allVehiclesSequential;
 	static std::set<NxVehicle*> _allChildVehicles;
+	static NxArray<NxVehicle*> _fleet;			// Vehicles and children in update order, see updateAllVehicles()
+	static NxArray<NxU32> _fleetFirstWheels;
+	static NxWheelBatch _fleetWheels;
 	
 	static NxI32 _activeVehicle;
 	static NxVehicle* _activeVehicleP;
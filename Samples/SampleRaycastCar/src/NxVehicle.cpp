@@ -240,6 +240,21 @@ void NxVehicle::handleContactPair(NxContactPair& pair, NxU32 carIndex)
 }
 
 void NxVehicle::updateVehicle(NxReal lastTimeStepSize)
+{
+	_ownWheels.clear();
+	NxU32 firstWheel = gatherWheels(_ownWheels);
+	updateVehicle(lastTimeStepSize, _ownWheels, firstWheel);
+}
+
+NxU32 NxVehicle::gatherWheels(NxWheelBatch& batch)
+{
+	NxU32 firstWheel = batch.size();
+	for(NxU32 i = 0; i < _wheels.size(); i++)
+		batch.add(_wheels[i]);
+	return firstWheel;
+}
+
+void NxVehicle::updateVehicle(NxReal lastTimeStepSize, const NxWheelBatch& batch, NxU32 firstWheel)
 {
 	//printf("updating %x\n", this);
 	
@@ -261,29 +276,40 @@ void NxVehicle::updateVehicle(NxReal lastTimeStepSize)
 		_lastTrailTime = 0.0f;
 	}
 
+	NX_ASSERT(firstWheel + _wheels.size() <= batch.size());
+	NxWheel* const* wheels = batch.wheels.begin() + firstWheel;
+	NxActor* const* touchedActors = batch.touchedActors.begin() + firstWheel;
+	const NxVec3* positions = batch.positions.begin() + firstWheel;
+	const NxU32* flags = batch.flags.begin() + firstWheel;
+
+	// Only needed by auto-steered wheels, fetched once for all of them
+	bool local2GlobalValid = false;
+	NxQuat local2Global;
+
 	NxU32 nbTouching = 0;
 	NxU32 nbNotTouching = 0;
 	NxU32 nbHandBrake = 0;
 	for(NxU32 i = 0; i < _wheels.size(); i++)
 	{
-		NxWheel* wheel = _wheels[i];
+		NxWheel* wheel = wheels[i];
+		NX_ASSERT(wheel == _wheels[i]);
 
 		if (_lastTrailTime  == 0.0f)
 		{
-			if(_wheels[i]->hasGroundContact())
+			if(touchedActors[i] != NULL)
 			{
 				if (++_nextTrailSlot >= NUM_TRAIL_POINTS)
 					_nextTrailSlot = 0;
-				_trailBuffer[_nextTrailSlot] = _bodyActor->getGlobalPose() * _wheels[i]->getGroundContactPos();
+				_trailBuffer[_nextTrailSlot] = _bodyActor->getGlobalPose() * wheel->getGroundContactPos();
 			}
 		}
 
-		if(wheel->getWheelFlag(NX_WF_STEERABLE_INPUT))
+		if(flags[i] & NX_WF_STEERABLE_INPUT)
 		{
 			if(distance2 != 0)
 			{
-				NxReal xPos = wheel->getWheelPos().x;
-				NxReal zPos = wheel->getWheelPos().z;
+				NxReal xPos = positions[i].x;
+				NxReal zPos = positions[i].z;
 				NxReal dz = -zPos + distance2;
 				NxReal dx = xPos - _steeringTurnPoint.x;
 				wheel->setAngle(NxMath::atan(dx/dz));
@@ -292,12 +318,16 @@ void NxVehicle::updateVehicle(NxReal lastTimeStepSize)
 			}
 			//printf("%2.3f\n", wheel->getAngle());
 
-		} else if(wheel->getWheelFlag(NX_WF_STEERABLE_AUTO))
+		} else if(flags[i] & NX_WF_STEERABLE_AUTO)
 			{
-			NxVec3 localVelocity = _bodyActor->getLocalPointVelocity(wheel->getWheelPos());
-			NxQuat local2Global = _bodyActor->getGlobalOrientationQuat();
+			NxVec3 localVelocity = _bodyActor->getLocalPointVelocity(positions[i]);
+			if(!local2GlobalValid)
+			{
+				local2Global = _bodyActor->getGlobalOrientationQuat();
+				local2GlobalValid = true;
+			}
 			local2Global.inverseRotate(localVelocity);
-//			printf("%2.3f %2.3f %2.3f\n", wheel->getWheelPos().x,wheel->getWheelPos().y,wheel->getWheelPos().z);
+//			printf("%2.3f %2.3f %2.3f\n", positions[i].x,positions[i].y,positions[i].z);
 			localVelocity.y = 0;
 			if(localVelocity.magnitudeSquared() < 0.01f)
 			{
@@ -313,14 +343,14 @@ void NxVehicle::updateVehicle(NxReal lastTimeStepSize)
 		}
 
 		// now the acceleration part
-		if(!wheel->getWheelFlag(NX_WF_ACCELERATED))
+		if(!(flags[i] & NX_WF_ACCELERATED))
 			continue;
 
-		if(_handBrake && wheel->getWheelFlag(NX_WF_AFFECTED_BY_HANDBRAKE))
+		if(_handBrake && (flags[i] & NX_WF_AFFECTED_BY_HANDBRAKE))
 		{
 			nbHandBrake++;
 		} else {
-			if (!wheel->hasGroundContact())
+			if (touchedActors[i] == NULL)
 			{
 				nbNotTouching++;
 			} else {
@@ -343,7 +373,7 @@ void NxVehicle::updateVehicle(NxReal lastTimeStepSize)
 //printf("wt: %f %f\n", motorTorque, _brakePedal);
 	for(NxU32 i = 0; i < _wheels.size(); i++) 
 	{
-		NxWheel* wheel = _wheels[i];
+		NxWheel* wheel = wheels[i];
 		wheel->tick(_handBrake, motorTorque, _brakePedal, lastTimeStepSize);
 	}
 
@@ -49,6 +49,8 @@ private:
 	NxU32					_nextTrailSlot;
 	NxReal					_lastTrailTime;
 
+	NxWheelBatch			_ownWheels;		// Scratch for updateVehicle() outside of a fleet update
+
 	NxActor*				_mostTouchedActor;
 	void					_computeMostTouchedActor();
 	void					_computeLocalVelocity();
@@ -73,6 +75,10 @@ public:
 
 	void					handleContactPair(NxContactPair& pair, NxU32 carIndex);
 	void					updateVehicle(NxReal lastTimeStepSize);
+	// Fleet update: gatherWheels() appends the vehicle's wheels to a batch shared by all vehicles, then
+	// updateVehicle() runs on the batch entries starting at firstWheel.
+	NxU32					gatherWheels(NxWheelBatch& batch);
+	void					updateVehicle(NxReal lastTimeStepSize, const NxWheelBatch& batch, NxU32 firstWheel);
 	void					control (NxReal steering, bool analogSteering, NxReal acceleration, bool analogAcceleration, bool handBrake);
 	void					gearUp();
 	void					gearDown();
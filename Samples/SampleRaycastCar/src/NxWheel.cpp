@@ -180,6 +180,8 @@ NxWheel* NxWheel::createWheel(NxActor* actor, NxWheelDesc* wheelDesc)
 
 NxWheel1::NxWheel1(NxScene * s)  : scene(s)
 { 
+	// Nothing written yet: the first tick sets all of them
+	_materialState[0] = _materialState[1] = _materialState[2] = _materialState[3] = -1.0f;
 }
 
 NxWheel1::~NxWheel1() 
@@ -212,23 +214,29 @@ void NxWheel1::tick(bool handBrake, NxReal motorTorque, NxReal brakeTorque, NxRe
 	}
 
 	NxReal OneMinusBreakPedal = 1-brakeTorque;
+	NxReal dynamicFrictionV, staticFrictionV, dynamicFriction, staticFriction;
 	if(handBrake && getWheelFlag(NX_WF_AFFECTED_BY_HANDBRAKE)) 
 	{
-		material->setDynamicFrictionV(1);
-		material->setStaticFrictionV(4);
-		material->setDynamicFriction(0.4f);
-		material->setStaticFriction(1.0f);
+		dynamicFrictionV	= 1;
+		staticFrictionV		= 4;
+		dynamicFriction		= 0.4f;
+		staticFriction		= 1.0f;
 	} 
 	else 
 	{
 		NxReal newv = OneMinusBreakPedal * _frictionToFront + brakeTorque;
-		NxReal newv4= OneMinusBreakPedal * _frictionToFront + brakeTorque*4;
-		material->setDynamicFrictionV(newv);
-		material->setDynamicFriction(_frictionToSide);
-		material->setStaticFrictionV(newv*4);
-		material->setStaticFriction(2);
+		dynamicFrictionV	= newv;
+		dynamicFriction		= _frictionToSide;
+		staticFrictionV		= newv*4;
+		staticFriction		= 2;
 	}
 
+	// Pedals rarely change from one frame to the next, only write the material when they do
+	if(dynamicFrictionV != _materialState[0])	{ material->setDynamicFrictionV(dynamicFrictionV);	_materialState[0] = dynamicFrictionV; }
+	if(staticFrictionV != _materialState[1])	{ material->setStaticFrictionV(staticFrictionV);	_materialState[1] = staticFrictionV; }
+	if(dynamicFriction != _materialState[2])	{ material->setDynamicFriction(dynamicFriction);	_materialState[2] = dynamicFriction; }
+	if(staticFriction != _materialState[3])		{ material->setStaticFriction(staticFriction);		_materialState[3] = staticFriction; }
+
 	if(!hasGroundContact())
 		updateContactPosition();
 	updateAngularVelocity(dt, handBrake);
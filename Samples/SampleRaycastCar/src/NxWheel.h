@@ -39,6 +39,7 @@ class NxWheel
 
 	NX_INLINE bool			hasGroundContact() const { return getTouchedActor() != NULL; }
 	NX_INLINE bool			getWheelFlag(NxWheelFlags flag) const { return (wheelFlags & flag) != 0; }
+	NX_INLINE NxU32			getWheelFlags() const { return wheelFlags; }
 
 	void*					userData;
 	protected:
@@ -47,6 +48,34 @@ class NxWheel
 
 
 
+// Per-wheel state read from the SDK once per frame, one array entry per wheel. Filled by
+// NxVehicle::gatherWheels(), for one vehicle or for the whole fleet at once.
+struct NxWheelBatch
+	{
+	NxArray<NxWheel*>		wheels;
+	NxArray<NxActor*>		touchedActors;	// NULL when the wheel has no ground contact
+	NxArray<NxVec3>			positions;		// Local wheel positions
+	NxArray<NxU32>			flags;
+
+	void clear()
+		{
+		wheels.clear();
+		touchedActors.clear();
+		positions.clear();
+		flags.clear();
+		}
+
+	void add(NxWheel* wheel)
+		{
+		wheels.pushBack(wheel);
+		touchedActors.pushBack(wheel->getTouchedActor());
+		positions.pushBack(wheel->getWheelPos());
+		flags.pushBack(wheel->getWheelFlags());
+		}
+
+	NxU32 size() const { return wheels.size(); }
+	};
+
 class NxWheel1 : public NxWheel
 	{
 public:
@@ -81,6 +110,7 @@ private:
 	NxMaterial*				material;
 	NxReal					_frictionToSide;
 	NxReal					_frictionToFront;
+	NxReal					_materialState[4];	// Friction values last written to the material, see tick()
 	
 	NxReal					_turnAngle;
 	NxReal					_turnVelocity;
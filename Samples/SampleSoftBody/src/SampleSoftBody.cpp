@@ -234,6 +234,7 @@ void SetHelpString(const char *demoKeyString)
 #endif
 
 	strcat(gHelpString, "    v: toggle volume preservation\n");
+	strcat(gHelpString, "    k: benchmark mesh ray casts\n");
 	strcat(gHelpString, "    w,a,s,d: move/strafe\n");
 	strcat(gHelpString, "    q,e: move up/down\n");
 	strcat(gHelpString, "    mouse right: pick and drag\n");
@@ -473,6 +474,15 @@ void KeyboardCallback(unsigned char key, int x, int y)
 		gShowSoftBodies = !gShowSoftBodies;
 		break;
 			   }
+	case 'k' : {
+		for (ObjMesh **objMesh = gObjMeshes.begin(); objMesh != gObjMeshes.end(); objMesh++) {
+			float bruteForceTime, bvhTime, packetTime;
+			(*objMesh)->benchmarkRayCast(10000, bruteForceTime, bvhTime, packetTime);
+			printf("%s: %d triangles, 10000 rays: brute force %.3fs, bvh %.3fs, 8-ray packets %.3fs\n",
+				(*objMesh)->getName(), (*objMesh)->getNumTriangles(), bruteForceTime, bvhTime, packetTime);
+		}
+		break;
+			   }
 	case 27 : { exit(0); break; }
 	default : { break; }
 	}
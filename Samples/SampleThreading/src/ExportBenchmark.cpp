@@ -0,0 +1,76 @@
+#include <stdio.h>
+
+#include "NxPhysics.h"
+#include "Timing.h"
+#include "NXU_schema.h"
+#include "NXU_customcopy.h"
+#include "NXU_string.h"
+#include "ExportBenchmark.h"
+
+// ----------------------------------------------------------------------
+// the actors get fake instance pointers, nothing dereferences them
+
+static NxActor* fakeActor(NxU32 index)
+{
+	return reinterpret_cast<NxActor*>((size_t)(index + 1) * 16);
+}
+
+// after every append a joint refers to an earlier actor, found by instance, and to another one, found by id
+static NxU32 earlierActor(NxU32 appended, NxU32 salt)
+{
+	return (NxU32)(((NxU64)appended * 2654435761u + salt) % (appended + 1));
+}
+
+static float runExport(NxU32 actorCount, const char** ids, bool indexed, NxU32& found)
+{
+	NXU::NxSceneDesc* scene = new NXU::NxSceneDesc;
+	NXU::NxuExportIndex index;
+	NXU::CustomCopy cc(0, scene, indexed ? &index : 0);
+
+	found = 0;
+	float start = getCurrentTime();
+	for (NxU32 i = 0; i < actorCount; i++)
+		{
+		NXU::NxActorDesc* a = new NXU::NxActorDesc;
+		a->mId = ids[i];
+		a->mInstance = fakeActor(i);
+		scene->mActors.push_back(a);
+
+		if (cc.getNameFromActor(fakeActor(earlierActor(i, 1))))
+			found++;
+		if (cc.getActorFromName(ids[earlierActor(i, 7)]))
+			found++;
+		}
+	float seconds = getCurrentTime() - start;
+
+	delete scene;
+	return seconds;
+}
+
+void RunExportBenchmark(unsigned int actorCount)
+{
+	if (actorCount < 1)
+		actorCount = 1;
+
+	printf("Export benchmark, %u actors, one lookup by instance and one by id per actor\n", actorCount);
+	printf("  (the linear scans are quadratic, this takes a while)\n");
+
+	const char** ids = new const char*[actorCount];
+	for (NxU32 i = 0; i < actorCount; i++)
+		{
+		char id[32];
+		sprintf(id, "Actor_%u", i);
+		ids[i] = NXU::getGlobalString(id);
+		}
+
+	NxU32 indexedFound;
+	NxU32 linearFound;
+	float indexedTime = runExport(actorCount, ids, true, indexedFound);
+	float linearTime = runExport(actorCount, ids, false, linearFound);
+
+	printf("  NxuExportIndex  %10.1f ms\n", indexedTime * 1000.0f);
+	printf("  linear scans    %10.1f ms%s\n", linearTime * 1000.0f,
+		indexedFound != linearFound || indexedFound != actorCount * 2 ? " (lookups disagree)" : "");
+
+	delete [] ids;
+}
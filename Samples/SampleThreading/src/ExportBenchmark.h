@@ -0,0 +1,9 @@
+#ifndef __EXPORT_BENCHMARK__
+#define __EXPORT_BENCHMARK__
+
+// Builds a synthetic scene of actorCount actor descriptors the way NxuPhysicsExport appends them, looks up
+// earlier actors by instance and by id after every append, once through NxuExportIndex and once with the
+// linear scans, and prints the results.
+void RunExportBenchmark(unsigned int actorCount);
+
+#endif
@@ -68,6 +68,10 @@
 #ifdef THREAD_POLLING
 #include "PollingThreads.h"
 #endif
+#include "PoolBenchmark.h"
+#include "ExportBenchmark.h"
+#include "SnapshotTest.h"
+#include "PollingTest.h"
 
 // Physics
 static NxPhysicsSDK*	gPhysicsSDK = NULL;
@@ -336,6 +340,14 @@ static void KeyboardCallback(unsigned char key, int x, int y)
 		case '0':	gPerfRenderer.toggleEnable(); break;
 		case 'w':	CreateCubeFromEye(0.2f); break;
 		case 't':	gRendering=!gRendering; break;
+		case 'p':	RunPoolBenchmark(4); break;
+		case 'x':	RunExportBenchmark(100000); break;
+		case 'm':	if (gAllocator) gAllocator->dumpStatistics(); break;
+		case 's':	RunSnapshotTest(); break;
+		case 'o':	RunPollingTest(); break;
+#ifdef THREAD_POLLING
+		case 'u':	gPollingThreads.PrintThreadStats(); gPollingThreads.ResetThreadStats(); break;
+#endif
 	
 		case GLUT_KEY_UP:	case '8':	gEye += gDir*2.0f; break;
 		case GLUT_KEY_DOWN: case '2':	gEye -= gDir*2.0f; break;
@@ -559,6 +571,14 @@ int main(int argc, char** argv)
 	printf("Press w to throw a box into the scene\n");
 	printf("      t to toggle rendering\n");
 	printf("      0 to toggle performance information\n");
+	printf("      p to run the NxPool benchmark\n");
+	printf("      x to run the export lookup benchmark (blocks the sample for about 40 s)\n");
+	printf("      m to dump allocator statistics\n");
+	printf("      s to run the snapshot round trip test\n");
+	printf("      o to run the polling thread test\n");
+#ifdef THREAD_POLLING
+	printf("      u to print polling thread utilization\n");
+#endif
 #endif
 
 	// Initialize glut
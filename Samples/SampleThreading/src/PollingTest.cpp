@@ -0,0 +1,206 @@
+#include <stdio.h>
+
+#ifdef WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "NxPhysics.h"
+#include "PollingThreads.h"
+#include "PollingTest.h"
+
+static const NxU32 gTestFrames = 200;
+static const NxU32 gTestTasks = 64;			// per scene and frame
+static const NxU32 gTestPauseEvery = 10;	// frames between pauses
+static const NxU32 gTestPauseMs = 20;		// long enough for the threads to park
+static const NxU32 gTestTimeoutMs = 5000;	// a frame taking longer than that is a hang
+
+#ifdef WIN32
+static inline long atomicIncrement(volatile long *v)		{ return InterlockedIncrement(v); }
+static inline long atomicDecrement(volatile long *v)		{ return InterlockedDecrement(v); }
+static inline long atomicExchange(volatile long *v, long x)	{ return InterlockedExchange(v, x); }
+static inline long atomicLoad(volatile long *v)				{ return InterlockedCompareExchange(v, 0, 0); }
+static inline void threadYield()							{ SwitchToThread(); }
+static inline void sleepMs(NxU32 ms)						{ Sleep(ms); }
+static inline NxU32 getMs()									{ return GetTickCount(); }
+#else
+static inline long atomicIncrement(volatile long *v)		{ return __sync_add_and_fetch(v, 1); }
+static inline long atomicDecrement(volatile long *v)		{ return __sync_sub_and_fetch(v, 1); }
+static inline long atomicExchange(volatile long *v, long x)	{ __sync_synchronize(); return __sync_lock_test_and_set(v, x); }
+static inline long atomicLoad(volatile long *v)				{ return __sync_add_and_fetch(v, 0); }
+static inline void threadYield()							{ sched_yield(); }
+static inline void sleepMs(NxU32 ms)						{ usleep(ms * 1000); }
+
+static NxU32 getMs()
+	{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (NxU32)(t.tv_sec * 1000 + t.tv_nsec / 1000000);
+	}
+#endif
+
+// ----------------------------------------------------------------------
+// stand-in for an NxScene: each frame is gTestTasks tasks, handed out by
+// pollForWork() and ended by the first poll after the last one completed
+
+class PollingTestScene : public PollingScene
+	{
+	public:
+		PollingTestScene() : remaining(0), finished(gTestTasks), inside(0), overlaps(0), shutdown(0), backgroundPolls(0)
+			{
+			for (NxU32 i = 0; i < gTestTasks; i++)
+				runs[i] = 0;
+			}
+
+		virtual NxThreadPollResult pollForWork(NxThreadWait waitType)
+			{
+			atomicIncrement(&inside);
+			NxThreadPollResult result = poll(waitType);
+			atomicDecrement(&inside);
+			return result;
+			}
+
+		virtual NxThreadPollResult pollForBackgroundWork(NxThreadWait waitType)
+			{
+			atomicIncrement(&backgroundPolls);
+			return NX_THREAD_NOWORK;
+			}
+
+		virtual void resetPollForWork()
+			{
+			// PollingThreads keeps the threads out of a scene while it is reset
+			if (atomicLoad(&inside) != 0)
+				atomicIncrement(&overlaps);
+			atomicExchange(&finished, 0);
+			atomicExchange(&remaining, gTestTasks);
+			}
+
+		virtual void shutdownWorkerThreads()
+			{
+			atomicExchange(&shutdown, 1);
+			}
+
+		bool frameDone()	{ return atomicLoad(&finished) == gTestTasks; }
+
+		volatile long runs[gTestTasks];		// times each task ran
+		volatile long remaining;
+		volatile long finished;
+		volatile long inside;
+		volatile long overlaps;
+		volatile long shutdown;
+		volatile long backgroundPolls;
+
+	private:
+		NxThreadPollResult poll(NxThreadWait waitType)
+			{
+			if (atomicLoad(&shutdown))
+				return NX_THREAD_SHUTDOWN;
+
+			long task = atomicDecrement(&remaining);
+			if (task >= 0)
+				{
+				// a little work, so that the threads overlap
+				volatile NxF32 x = 1.0f;
+				for (NxU32 i = 0; i < 500; i++)
+					x = x * 1.0001f + 0.5f;
+				atomicIncrement(&runs[task]);
+				atomicIncrement(&finished);
+				return NX_THREAD_MOREWORK;
+				}
+
+			if (frameDone())
+				return NX_THREAD_SIMULATION_END;
+
+			// other threads are running the last tasks, the SDK would block here with NX_WAIT_SIMULATION_END
+			if (waitType == NX_WAIT_SIMULATION_END)
+				threadYield();
+			return NX_THREAD_NOWORK;
+			}
+	};
+
+// ----------------------------------------------------------------------
+
+static bool runPoolTest(const char* name, int threadCount, int sceneCount, bool background)
+{
+	PollingTestScene* scenes = new PollingTestScene[sceneCount];
+	PollingThreads pool;
+	for (int i = 0; i < sceneCount; i++)
+		pool.AddScene(&scenes[i], background && i == 0);
+	pool.CreateThreads(threadCount);
+
+	bool hung = false;
+	NxU32 lost = 0;
+	NxU32 frame;
+	for (frame = 0; frame < gTestFrames && !hung; frame++)
+		{
+		pool.ResetPollForWork();
+
+		// stands in for fetchResults(), the pool alone has to finish the frame
+		NxU32 start = getMs();
+		for (int i = 0; i < sceneCount && !hung; i++)
+			{
+			while (!scenes[i].frameDone() && !hung)
+				{
+				threadYield();
+				hung = getMs() - start > gTestTimeoutMs;
+				}
+			}
+
+		for (int i = 0; i < sceneCount; i++)
+			{
+			for (NxU32 t = 0; t < gTestTasks; t++)
+				{
+				if (scenes[i].runs[t] != (long)frame + 1)
+					lost++;
+				}
+			}
+
+		if (frame % gTestPauseEvery == gTestPauseEvery - 1)
+			sleepMs(gTestPauseMs);
+		}
+
+	NxU32 tasks = 0;
+	NxU32 parks = 0;
+	for (int t = 0; t < pool.GetThreadCount(); t++)
+		{
+		PollingThreads::ThreadStats stats;
+		pool.GetThreadStats(t, stats);
+		tasks += stats.tasks;
+		parks += stats.parks;
+		}
+
+	// returns once every thread left its waits
+	pool.KillThreads();
+
+	NxU32 overlaps = 0;
+	NxU32 notShutDown = 0;
+	NxU32 backgroundPolls = 0;
+	for (int i = 0; i < sceneCount; i++)
+		{
+		overlaps += scenes[i].overlaps;
+		notShutDown += scenes[i].shutdown ? 0 : 1;
+		backgroundPolls += scenes[i].backgroundPolls;
+		}
+	delete [] scenes;
+
+	const bool ok = !hung && !lost && !overlaps && !notShutDown && parks && (!background || backgroundPolls)
+		&& tasks == gTestFrames * gTestTasks * sceneCount;
+	printf("  %-22s %s: %u frames%s, %u tasks, %u lost, %u resets overlapped, %u parks, %u background polls\n", name,
+		ok ? "PASS" : "FAIL", frame, hung ? " (hung)" : "", tasks, lost, overlaps, parks, backgroundPolls);
+	return ok;
+}
+
+bool RunPollingTest()
+{
+	printf("Polling threads, %u frames of %u tasks per scene, a %u ms pause every %u frames\n",
+		gTestFrames, gTestTasks, gTestPauseMs, gTestPauseEvery);
+
+	bool ok = runPoolTest("1 scene, 4 threads", 4, 1, false);
+	ok = runPoolTest("3 scenes, 4 threads", 4, 3, false) && ok;
+	ok = runPoolTest("3 scenes, background", 2, 3, true) && ok;
+	return ok;
+}
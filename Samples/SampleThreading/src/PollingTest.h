@@ -0,0 +1,10 @@
+#ifndef __POLLING_TEST__
+#define __POLLING_TEST__
+
+// Drives PollingThreads with stub scenes, one and several at a time, for a number of frames with pauses
+// long enough for the threads to park, then shuts the pool down. Checks that every task of every frame
+// runs exactly once and that no thread is inside a scene while it is reset. Prints the results, returns
+// false on a failure or a hang.
+bool RunPollingTest();
+
+#endif
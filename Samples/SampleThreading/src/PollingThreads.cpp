@@ -1,138 +1,611 @@
 #include <stdio.h>
-#include <deque>
+#include <string.h>
 
 #ifdef WIN32
 #define NOMINMAX
 #include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
 #endif
 
 #include "NxPhysics.h"
 #include "PollingThreads.h"
 
+// spin budget between frames, in pause iterations
+static const NxU32 gMinSpin = 64;
+static const NxU32 gMaxSpin = 64 * 1024;
 
-void PollingThreads::CreateThreads(int count,NxScene *newScene)
+// how long parked threads sleep between background polls, in milliseconds
+static const NxU32 gBackgroundPollMs = 1;
+
+// ----------------------------------------------------------------------
+// platform layer: atomics, ticks, yield, threads and the gate
+
+#ifdef WIN32
+static inline long atomicIncrement(volatile long *v)	{ return InterlockedIncrement(v); }
+static inline long atomicDecrement(volatile long *v)	{ return InterlockedDecrement(v); }
+static inline long atomicExchange(volatile long *v, long x)	{ return InterlockedExchange(v, x); }
+static inline long atomicLoad(volatile long *v)			{ return InterlockedCompareExchange(v, 0, 0); }
+static inline void cpuPause()							{ YieldProcessor(); }
+static inline void threadYield()						{ SwitchToThread(); }
+
+static NxU64 getTicks()
 	{
-	KillThreads();
+	LARGE_INTEGER t;
+	QueryPerformanceCounter(&t);
+	return (NxU64)t.QuadPart;
+	}
 
-	quitEvent=CreateEvent(NULL,TRUE,FALSE,NULL);
-	assert(quitEvent!=NULL);
+static double getTicksPerSecond()
+	{
+	LARGE_INTEGER f;
+	QueryPerformanceFrequency(&f);
+	return (double)f.QuadPart;
+	}
 
-	simRunningEvent=CreateEvent(NULL,TRUE,FALSE,NULL);
-	assert(simRunningEvent!=NULL);
+static int getCoreCount()
+	{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+	}
 
-	workingCounter = -1;
-	InitializeCriticalSection(&shieldCS);
-	workingMutexEvent = CreateEvent(NULL, FALSE, TRUE, NULL);
+static void pinCurrentThread(int core)
+	{
+	SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core);
+	}
+#else
+static inline long atomicIncrement(volatile long *v)	{ return __sync_add_and_fetch(v, 1); }
+static inline long atomicDecrement(volatile long *v)	{ return __sync_sub_and_fetch(v, 1); }
+static inline long atomicExchange(volatile long *v, long x)	{ __sync_synchronize(); return __sync_lock_test_and_set(v, x); }
+static inline long atomicLoad(volatile long *v)			{ return __sync_add_and_fetch(v, 0); }
+#if defined(__i386__) || defined(__x86_64__)
+static inline void cpuPause()							{ __asm__ __volatile__("pause"); }
+#else
+static inline void cpuPause()							{}
+#endif
+static inline void threadYield()						{ sched_yield(); }
 
-	threadCount=count;
-	threadArray=new HANDLE[threadCount];
+static NxU64 getTicks()
+	{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (NxU64)t.tv_sec * 1000000000ULL + (NxU64)t.tv_nsec;
+	}
 
-	for(int i=0;i<threadCount;i++)
-		{
-		threadArray[i]=CreateThread(NULL,0,threadFuncStatic,this,0,NULL);
-		assert(threadArray[i]!=NULL);
-		}
+static double getTicksPerSecond()
+	{
+	return 1.0e9;
+	}
 
-	scene=newScene;
+static int getCoreCount()
+	{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
 	}
 
-void PollingThreads::ResetPollForWork()
+static void pinCurrentThread(int core)
+	{
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+	}
+#endif
+
+/*
+A manual reset event: open() releases every waiter until close(). close() only
+takes effect if nothing opened the gate since the caller read generation(), so
+a frame started in between is never slept through.
+*/
+class PollingGate
+	{
+	public:
+#ifdef WIN32
+		PollingGate() : gen(0)
+			{
+			InitializeCriticalSection(&cs);
+			event = CreateEvent(NULL, TRUE, FALSE, NULL);
+			assert(event != NULL);
+			}
+
+		~PollingGate()
+			{
+			CloseHandle(event);
+			DeleteCriticalSection(&cs);
+			}
+
+		void open()
+			{
+			EnterCriticalSection(&cs);
+			gen++;
+			SetEvent(event);
+			LeaveCriticalSection(&cs);
+			}
+
+		void close(long seen)
+			{
+			EnterCriticalSection(&cs);
+			if (gen == seen)
+				ResetEvent(event);
+			LeaveCriticalSection(&cs);
+			}
+
+		void wait(NxU32 timeoutMs)
+			{
+			WaitForSingleObject(event, timeoutMs == 0xffffffff ? INFINITE : timeoutMs);
+			}
+#else
+		PollingGate() : gen(0), isOpen(false)
+			{
+			pthread_mutex_init(&mutex, NULL);
+			pthread_cond_init(&cond, NULL);
+			}
+
+		~PollingGate()
+			{
+			pthread_cond_destroy(&cond);
+			pthread_mutex_destroy(&mutex);
+			}
+
+		void open()
+			{
+			pthread_mutex_lock(&mutex);
+			gen++;
+			isOpen = true;
+			pthread_cond_broadcast(&cond);
+			pthread_mutex_unlock(&mutex);
+			}
+
+		void close(long seen)
+			{
+			pthread_mutex_lock(&mutex);
+			if (gen == seen)
+				isOpen = false;
+			pthread_mutex_unlock(&mutex);
+			}
+
+		void wait(NxU32 timeoutMs)
+			{
+			pthread_mutex_lock(&mutex);
+			if (timeoutMs == 0xffffffff)
+				{
+				while (!isOpen)
+					pthread_cond_wait(&cond, &mutex);
+				}
+			else if (!isOpen)
+				{
+				timespec until;
+				clock_gettime(CLOCK_REALTIME, &until);
+				until.tv_nsec += (long)timeoutMs * 1000000;
+				until.tv_sec += until.tv_nsec / 1000000000;
+				until.tv_nsec %= 1000000000;
+				pthread_cond_timedwait(&cond, &mutex, &until);
+				}
+			pthread_mutex_unlock(&mutex);
+			}
+#endif
+
+		long generation()
+			{
+			return atomicLoad(&gen);
+			}
+
+	private:
+		volatile long gen;
+#ifdef WIN32
+		CRITICAL_SECTION cs;
+		HANDLE event;
+#else
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+		bool isOpen;
+#endif
+	};
+
+struct PollingWorker
+	{
+	PollingThreads *owner;
+	int index;
+	int core;					// -1 when not pinned
+	NxU32 spinBudget;
+	NxU32 nextScene;			// round robin start, so threads spread over the scenes
+
+	NxU64 startTicks;
+	NxU64 busyTicks;
+	NxU64 waitTicks;
+	NxU64 spinTicks;
+	NxU64 parkedTicks;
+	NxU32 tasks;
+	NxU32 parks;
+
+#ifdef WIN32
+	HANDLE thread;
+#else
+	pthread_t thread;
+	bool started;
+#endif
+	};
+
+/*
+Adapts NxScene to PollingScene.
+*/
+class PollingNxScene : public PollingScene
+	{
+	public:
+		PollingNxScene(NxScene *s) : scene(s) {}
+
+		virtual NxThreadPollResult pollForWork(NxThreadWait waitType)			{ return scene->pollForWork(waitType); }
+		virtual NxThreadPollResult pollForBackgroundWork(NxThreadWait waitType)	{ return scene->pollForBackgroundWork(waitType); }
+		virtual void resetPollForWork()											{ scene->resetPollForWork(); }
+		virtual void shutdownWorkerThreads()									{ scene->shutdownWorkerThreads(); }
+
+	private:
+		NxScene *scene;
+	};
+
+// ----------------------------------------------------------------------
+
+PollingThreads::PollingThreads()
 	{
-	if(threadArray==NULL)
+	threadCount = 0;
+	workers = NULL;
+	gate = NULL;
+	quit = 0;
+	sceneCount = 0;
+	anyBackground = false;
+	}
+
+PollingThreads::~PollingThreads()
+	{
+	KillThreads();
+	}
+
+void PollingThreads::CreateThreads(int count, NxScene *newScene, bool pinThreads, int firstCore)
+	{
+	KillThreads();
+	AddScene(newScene);
+	CreateThreads(count, pinThreads, firstCore);
+	}
+
+void PollingThreads::CreateThreads(int count, bool pinThreads, int firstCore)
+	{
+	if (workers != NULL)
 		return;
 
-	// wait for all threads to stop working.
-	WaitForSingleObject(workingMutexEvent, INFINITE);
+	quit = 0;
+	gate = new PollingGate();
 
-	scene->resetPollForWork();
+	int cores = getCoreCount();
+	threadCount = count;
+	workers = new PollingWorker[threadCount];
 
-	// release threads to start working again.
-	SetEvent(simRunningEvent);
-	SetEvent(workingMutexEvent);
-	
+	NxU64 now = getTicks();
+	for (int i = 0; i < threadCount; i++)
+		{
+		PollingWorker &w = workers[i];
+		w.owner = this;
+		w.index = i;
+		w.core = pinThreads ? (firstCore + i) % cores : -1;
+		w.spinBudget = gMinSpin;
+		w.nextScene = i;
+		w.startTicks = now;
+		w.busyTicks = w.waitTicks = w.spinTicks = w.parkedTicks = 0;
+		w.tasks = w.parks = 0;
+		}
+
+	for (int i = 0; i < threadCount; i++)
+		{
+#ifdef WIN32
+		workers[i].thread = CreateThread(NULL, 0, threadFuncStatic, &workers[i], 0, NULL);
+		assert(workers[i].thread != NULL);
+#else
+		workers[i].started = pthread_create(&workers[i].thread, NULL, threadFuncStatic, &workers[i]) == 0;
+		assert(workers[i].started);
+#endif
+		}
 	}
 
 void PollingThreads::KillThreads()
 	{
-	if(scene!=NULL)
-		scene->shutdownWorkerThreads();
+	for (int i = 0; i < sceneCount; i++)
+		scenes[i].scene->shutdownWorkerThreads();
 
-	if(quitEvent!=NULL)
-		SetEvent(quitEvent);
-
-	if(threadArray!=NULL)
+	if (workers != NULL)
 		{
-		for(int i=0;i<threadCount;i++)
+		atomicExchange(&quit, 1);
+		gate->open();
+
+		for (int i = 0; i < threadCount; i++)
 			{
-			if(threadArray[i]!=NULL)
+#ifdef WIN32
+			if (workers[i].thread != NULL)
 				{
-				WaitForSingleObject(threadArray[i],INFINITE);
-				CloseHandle(threadArray[i]);
+				WaitForSingleObject(workers[i].thread, INFINITE);
+				CloseHandle(workers[i].thread);
 				}
+#else
+			if (workers[i].started)
+				pthread_join(workers[i].thread, NULL);
+#endif
 			}
 
-		delete[] threadArray;
-		threadArray=NULL;
-		scene=NULL;
+		delete[] workers;
+		workers = NULL;
+		threadCount = 0;
+
+		delete gate;
+		gate = NULL;
 		}
 
-	if(simRunningEvent!=NULL)
+	for (int i = 0; i < sceneCount; i++)
 		{
-		CloseHandle(simRunningEvent);
-		simRunningEvent=NULL;
+		if (scenes[i].owned)
+			delete scenes[i].scene;
 		}
+	sceneCount = 0;
+	anyBackground = false;
+	}
+
+int PollingThreads::AddScene(NxScene *newScene, bool pollBackground)
+	{
+	if (newScene == NULL || sceneCount == MAX_SCENES)
+		return -1;
+
+	int index = AddScene(new PollingNxScene(newScene), pollBackground);
+	scenes[index].owned = true;
+	return index;
+	}
+
+int PollingThreads::AddScene(PollingScene *newScene, bool pollBackground)
+	{
+	if (newScene == NULL || sceneCount == MAX_SCENES)
+		return -1;
+
+	SceneSlot &slot = scenes[sceneCount];
+	slot.scene = newScene;
+	slot.owned = false;
+	slot.background = pollBackground;
+	slot.running = 0;
+	slot.inside = 0;
+	anyBackground |= pollBackground;
+
+	// publish the slot after it is filled in
+	return atomicIncrement(&sceneCount) - 1;
+	}
+
+void PollingThreads::ResetPollForWork()
+	{
+	if (workers == NULL)
+		return;
+
+	for (int i = 0; i < sceneCount; i++)
+		ResetPollForWork(i);
+	}
 
-	if(workingMutexEvent!=NULL)
+void PollingThreads::ResetPollForWork(int sceneIndex)
 	{
-		CloseHandle(workingMutexEvent);
-		workingMutexEvent = NULL;
+	if (workers == NULL || sceneIndex < 0 || sceneIndex >= sceneCount)
+		return;
+
+	SceneSlot &slot = scenes[sceneIndex];
 
-		DeleteCriticalSection(&shieldCS);
+	// Wait for all threads to leave the last frame. Threads register in
+	// 'inside' before they check 'running', so none can enter from now on.
+	atomicExchange(&slot.running, 0);
+	while (atomicLoad(&slot.inside) != 0)
+		threadYield();
+
+	slot.scene->resetPollForWork();
+
+	// release threads to start working again.
+	atomicExchange(&slot.running, 1);
+	gate->open();
 	}
 
-	if(quitEvent!=NULL)
+bool PollingThreads::anySceneRunning() const
+	{
+	for (int i = 0; i < sceneCount; i++)
 		{
-		CloseHandle(quitEvent);
-		quitEvent=NULL;
+		if (scenes[i].running)
+			return true;
 		}
+	return false;
 	}
 
-
+#ifdef WIN32
 DWORD __stdcall PollingThreads::threadFuncStatic(LPVOID userParam)
 	{
-	return ((PollingThreads *)userParam)->threadFunc();
+	PollingWorker *worker = (PollingWorker *)userParam;
+	worker->owner->threadFunc(*worker);
+	return 0;
+	}
+#else
+void *PollingThreads::threadFuncStatic(void *userParam)
+	{
+	PollingWorker *worker = (PollingWorker *)userParam;
+	worker->owner->threadFunc(*worker);
+	return NULL;
 	}
+#endif
 
-DWORD PollingThreads::threadFunc()
+void PollingThreads::threadFunc(PollingWorker &worker)
 	{
-	while(true)
+	if (worker.core >= 0)
+		pinCurrentThread(worker.core);
+
+	while (!atomicLoad(&quit))
 		{
-		HANDLE handles[]={quitEvent,simRunningEvent};
-		if(WaitForMultipleObjects(2,handles,FALSE,INFINITE)==WAIT_OBJECT_0)
-			break;//quit event
+		long seen = gate->generation();
 
-		// The first thread to enter obtains the working mutex(actually an event).
-		EnterCriticalSection(&shieldCS);
-		if(InterlockedIncrement(&workingCounter) == 0)
-			WaitForSingleObject(workingMutexEvent, INFINITE);
-		LeaveCriticalSection(&shieldCS);
+		PollState state = pollScenes(worker);
+		if (state == POLL_WORKED)
+			continue;
 
-		NxThreadPollResult pollResult;
+		if (state == POLL_RUNNING)
+			{
+			// other threads are finishing the frame
+			threadYield();
+			continue;
+			}
+
+		// Between frames: spin for a while in case the next one comes
+		// quickly, then park.
+		NxU64 spinStart = getTicks();
+		NxU32 spins = 0;
+		while (spins < worker.spinBudget && gate->generation() == seen && !quit)
+			{
+			cpuPause();
+			spins++;
+			}
+		NxU64 spinEnd = getTicks();
+		worker.spinTicks += spinEnd - spinStart;
 
+		if (spins < worker.spinBudget)
+			{
+			// a frame arrived while spinning, spinning longer pays off
+			worker.spinBudget = NxMath::min(worker.spinBudget * 2, gMaxSpin);
+			continue;
+			}
+		worker.spinBudget = NxMath::max(worker.spinBudget / 2, gMinSpin);
+
+		// a frame started after 'seen' keeps the gate open
+		if (!anySceneRunning())
+			gate->close(seen);
+
+		gate->wait(anyBackground ? gBackgroundPollMs : 0xffffffff);
+		worker.parkedTicks += getTicks() - spinEnd;
+		worker.parks++;
+		}
+	}
+
+PollingThreads::PollState PollingThreads::pollScenes(PollingWorker &worker)
+	{
+	int count = atomicLoad(&sceneCount);
+	if (count == 0)
+		return POLL_IDLE;
+
+	// a single scene lets the SDK block the thread until the frame is over
+	NxThreadWait waitType = count == 1 ? NX_WAIT_SIMULATION_END : NX_WAIT_NONE;
+
+	bool running = false;
+	bool worked = false;
+	for (int n = 0; n < count; n++)
+		{
+		SceneSlot &slot = scenes[(worker.nextScene + n) % count];
+		if (!slot.running)
+			continue;
+
+		atomicIncrement(&slot.inside);
+		if (!atomicLoad(&slot.running))
+			{
+			atomicDecrement(&slot.inside);
+			continue;
+			}
+		running = true;
+
+		NxThreadPollResult pollResult;
 		do
 			{
-			pollResult=scene->pollForWork(NX_WAIT_SIMULATION_END);
-			}while((pollResult==NX_THREAD_MOREWORK)||(pollResult==NX_THREAD_NOWORK));
+			NxU64 start = getTicks();
+			pollResult = slot.scene->pollForWork(waitType);
+			NxU64 elapsed = getTicks() - start;
+			if (pollResult == NX_THREAD_MOREWORK)
+				{
+				worker.busyTicks += elapsed;
+				worker.tasks++;
+				worked = true;
+				}
+			else
+				worker.waitTicks += elapsed;
+			}
+		while ((pollResult == NX_THREAD_MOREWORK) || (waitType == NX_WAIT_SIMULATION_END && pollResult == NX_THREAD_NOWORK));
+
+		if ((pollResult == NX_THREAD_SIMULATION_END) || (pollResult == NX_THREAD_SHUTDOWN))
+			atomicExchange(&slot.running, 0);
+
+		atomicDecrement(&slot.inside);
+		}
+	worker.nextScene++;
+
+	if (worked)
+		return POLL_WORKED;
+
+	// no frame work for us, help with background work before going idle
+	if (anyBackground)
+		{
+		for (int n = 0; n < count; n++)
+			{
+			SceneSlot &slot = scenes[(worker.nextScene + n) % count];
+			if (!slot.background)
+				continue;
 
-		ResetEvent(simRunningEvent);//block the first time pollForWork() says the sim ended.
+			NxU64 start = getTicks();
+			if (slot.scene->pollForBackgroundWork(NX_WAIT_NONE) == NX_THREAD_MOREWORK)
+				{
+				worker.busyTicks += getTicks() - start;
+				worker.tasks++;
+				worked = true;
+				}
+			else
+				worker.waitTicks += getTicks() - start;
+			}
+		if (worked)
+			return POLL_WORKED;
+		}
 
-		// The last thread to leave releases the working mutex
-		EnterCriticalSection(&shieldCS);
-		if(InterlockedDecrement(&workingCounter) < 0)
-			SetEvent(workingMutexEvent);
-		LeaveCriticalSection(&shieldCS);
+	return running ? POLL_RUNNING : POLL_IDLE;
+	}
 
-		
+void PollingThreads::GetThreadStats(int thread, ThreadStats &stats) const
+	{
+	if (thread < 0 || thread >= threadCount)
+		{
+		memset(&stats, 0, sizeof(stats));
+		return;
+		}
+
+	// read without locking, the counters only grow
+	const PollingWorker &w = workers[thread];
+	double toSeconds = 1.0 / getTicksPerSecond();
+	stats.elapsedSeconds = (getTicks() - w.startTicks) * toSeconds;
+	stats.busySeconds = w.busyTicks * toSeconds;
+	stats.waitSeconds = w.waitTicks * toSeconds;
+	stats.spinSeconds = w.spinTicks * toSeconds;
+	stats.parkedSeconds = w.parkedTicks * toSeconds;
+	stats.tasks = w.tasks;
+	stats.parks = w.parks;
+	}
+
+void PollingThreads::ResetThreadStats()
+	{
+	// racy against the workers, good enough for statistics
+	NxU64 now = getTicks();
+	for (int i = 0; i < threadCount; i++)
+		{
+		PollingWorker &w = workers[i];
+		w.startTicks = now;
+		w.busyTicks = w.waitTicks = w.spinTicks = w.parkedTicks = 0;
+		w.tasks = w.parks = 0;
+		}
+	}
+
+void PollingThreads::PrintThreadStats() const
+	{
+	printf("Polling threads: %d thread(s), %d scene(s)\n", threadCount, (int)sceneCount);
+	for (int i = 0; i < threadCount; i++)
+		{
+		ThreadStats s;
+		GetThreadStats(i, s);
+		double scale = s.elapsedSeconds > 0.0 ? 100.0 / s.elapsedSeconds : 0.0;
+		printf("  thread %d%s: busy %5.1f%%  wait %5.1f%%  spin %5.1f%%  parked %5.1f%%  %u tasks  %u parks\n",
+			i, workers[i].core >= 0 ? " (pinned)" : "",
+			s.busySeconds * scale, s.waitSeconds * scale, s.spinSeconds * scale, s.parkedSeconds * scale,
+			s.tasks, s.parks);
 		}
-	return 0;
 	}
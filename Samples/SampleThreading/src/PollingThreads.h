@@ -1,47 +1,112 @@
 #ifndef __POLLING_THREADS__
 #define __POLLING_THREADS__
 
+/*
+What the polling threads drive. PollingThreads wraps an NxScene in one of these,
+tests can hand it a stub instead.
+*/
+class PollingScene
+	{
+	public:
+		virtual ~PollingScene() {}
+
+		virtual NxThreadPollResult pollForWork(NxThreadWait waitType)=0;
+		virtual NxThreadPollResult pollForBackgroundWork(NxThreadWait waitType)=0;
+		virtual void resetPollForWork()=0;
+		virtual void shutdownWorkerThreads()=0;
+	};
+
+class PollingGate;
+struct PollingWorker;
+
+/*
+A pool of threads calling pollForWork() (and optionally pollForBackgroundWork())
+on one or more scenes.
+
+Between frames the threads spin briefly, then park until the next
+ResetPollForWork(), so they do not hold cores while the application is busy
+elsewhere. The spin length adapts per thread: it grows while new frames keep
+arriving during the spin and shrinks when the thread ends up parking anyway.
+
+With a single scene the threads block inside pollForWork(NX_WAIT_SIMULATION_END)
+as before. With several scenes they poll every running scene with NX_WAIT_NONE
+in turn, so one pool serves all of them.
+*/
 class PollingThreads
 	{
 	public:
 
-		PollingThreads()
+		enum
 			{
-			threadCount = 0;
-			threadArray = NULL;
-			quitEvent = NULL;
-			simRunningEvent = NULL;
-			workingCounter = -1;
-			workingMutexEvent = NULL;
-			scene=NULL;
-			}
-
-		~PollingThreads()
+			MAX_SCENES = 8
+			};
+
+		struct ThreadStats
 			{
-			KillThreads();
-			}
+			double	elapsedSeconds;		// since the threads were created or the stats reset
+			double	busySeconds;		// in poll calls which executed work
+			double	waitSeconds;		// in poll calls which found no work or ended the simulation
+			double	spinSeconds;		// spinning between frames
+			double	parkedSeconds;		// asleep between frames
+			NxU32	tasks;				// poll calls which executed work
+			NxU32	parks;				// times the thread went to sleep
+			};
 
-		void CreateThreads(int count,NxScene *newScene);
+		PollingThreads();
+		~PollingThreads();
+
+		// pinThreads binds thread i to core (firstCore + i) modulo the number of cores
+		void CreateThreads(int count, bool pinThreads=false, int firstCore=0);
+		void CreateThreads(int count, NxScene *newScene, bool pinThreads=false, int firstCore=0);
 		void KillThreads();
 
+		// Scenes can only be added between frames. Returns the scene index, or -1 when full.
+		int AddScene(NxScene *newScene, bool pollBackground=false);
+		int AddScene(PollingScene *newScene, bool pollBackground=false);
+
+		// Starts a frame for every scene, or for one scene. Call before simulate().
 		void ResetPollForWork();
+		void ResetPollForWork(int sceneIndex);
 
-	private:
-		static DWORD __stdcall threadFuncStatic(LPVOID userParam);
-		DWORD threadFunc();
+		int GetThreadCount() const { return threadCount; }
+		void GetThreadStats(int thread, ThreadStats &stats) const;
+		void ResetThreadStats();
+		void PrintThreadStats() const;
 
-		int threadCount;
-		HANDLE *threadArray;
+	private:
+		struct SceneSlot
+			{
+			PollingScene *scene;
+			bool owned;
+			bool background;
+			volatile long running;		// frame in progress, cleared by the first thread to see it end
+			volatile long inside;		// threads inside pollForWork() on this scene
+			};
 
-		HANDLE quitEvent;
-		HANDLE simRunningEvent;
+		enum PollState
+			{
+			POLL_WORKED,				// some poll executed work
+			POLL_RUNNING,				// scenes are running but had no work for us
+			POLL_IDLE					// between frames
+			};
 
-		LONG workingCounter;
-		CRITICAL_SECTION shieldCS;
-		HANDLE workingMutexEvent;
+#ifdef WIN32
+		static unsigned long __stdcall threadFuncStatic(void *userParam);
+#else
+		static void *threadFuncStatic(void *userParam);
+#endif
+		void threadFunc(PollingWorker &worker);
+		PollState pollScenes(PollingWorker &worker);
+		bool anySceneRunning() const;
 
-		NxScene *scene;
+		int threadCount;
+		PollingWorker *workers;
+		PollingGate *gate;
+		volatile long quit;
 
+		SceneSlot scenes[MAX_SCENES];
+		volatile long sceneCount;
+		bool anyBackground;
 	};
 
 #endif
@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "NxPhysics.h"
+#include "Timing.h"
+#include "SampleMutex.h"
+#include "PoolBenchmark.h"
+
+#if defined(WIN32)
+#	include <windows.h>
+#else
+#	include <pthread.h>
+#endif
+
+// NxPool.h is shared with the SDK sources, which provide these two names
+template<class T> class NxArraySDK : public NxArray<T> {};
+
+class PoolBenchmarkAllocator : public NxUserAllocator
+	{
+	public:
+	void* mallocDEBUG(size_t size, const char*, int)	{ return ::malloc(size);		}
+	void* malloc(size_t size)							{ return ::malloc(size);		}
+	void* realloc(void* memory, size_t size)			{ return ::realloc(memory, size);	}
+	void free(void* memory)								{ ::free(memory);				}
+	};
+
+static PoolBenchmarkAllocator gPoolBenchmarkAllocator;
+static NxUserAllocator* nxFoundationSDKAllocator = &gPoolBenchmarkAllocator;
+
+#include "NxPool.h"
+
+struct PoolBenchmarkElement
+	{
+	NxU32 hwid;
+	NxU32 payload[7];
+	};
+
+typedef NxPool<PoolBenchmarkElement, sizeof(PoolBenchmarkElement)> BenchPool;
+#ifdef NX_POOL_CONCURRENT
+typedef NxConcurrentPool<PoolBenchmarkElement, sizeof(PoolBenchmarkElement)> BenchConcurrentPool;
+#endif
+
+static const NxU32 gLiveObjects = 256;	// objects each thread holds at a time
+static const NxU32 gRounds = 4000;		// times each thread releases and reacquires them
+
+// ----------------------------------------------------------------------
+// one worker: gRounds times take gLiveObjects objects and give them back,
+// through whichever pool the worker was set up with
+
+struct PoolBenchmarkWorker
+	{
+	enum Mode { LOCKED_POOL, BULK_LOCKED_POOL, CONCURRENT_POOL };
+
+	Mode mode;
+	BenchPool* pool;
+	SampleMutex* mutex;
+#ifdef NX_POOL_CONCURRENT
+	BenchConcurrentPool* concurrentPool;
+	BenchConcurrentPool::Cache* concurrentCache;
+#endif
+	PoolBenchmarkElement* held[gLiveObjects];
+	NxU32 checksum;
+
+	void run()
+		{
+		checksum = 0;
+		for (NxU32 r = 0; r < gRounds; r++)
+			{
+			NxU32 n = 0;
+			if (mode == LOCKED_POOL)
+				{
+				for (NxU32 i = 0; i < gLiveObjects; i++)
+					{
+					mutex->lock();
+					PoolBenchmarkElement* e = pool->get();
+					mutex->unlock();
+					if (e)
+						held[n++] = e;
+					}
+				}
+			else if (mode == BULK_LOCKED_POOL)
+				{
+				mutex->lock();
+				n = pool->get(held, gLiveObjects);
+				mutex->unlock();
+				}
+#ifdef NX_POOL_CONCURRENT
+			else
+				{
+				BenchConcurrentPool::Cache& cache = *concurrentCache;
+				for (NxU32 i = 0; i < gLiveObjects; i++)
+					{
+					PoolBenchmarkElement* e = cache.get();
+					if (e)
+						held[n++] = e;
+					}
+				}
+#endif
+
+			// touch the objects like a real user would
+			for (NxU32 i = 0; i < n; i++)
+				{
+				held[i]->payload[0] = r;
+				checksum += held[i]->hwid;
+				}
+
+			if (mode == LOCKED_POOL)
+				{
+				for (NxU32 i = 0; i < n; i++)
+					{
+					mutex->lock();
+					pool->put(held[i]);
+					mutex->unlock();
+					}
+				}
+			else if (mode == BULK_LOCKED_POOL)
+				{
+				mutex->lock();
+				pool->put(held, n);
+				mutex->unlock();
+				}
+#ifdef NX_POOL_CONCURRENT
+			else
+				{
+				for (NxU32 i = 0; i < n; i++)
+					concurrentCache->put(held[i]);
+				}
+#endif
+			}
+		}
+
+#ifdef NX_POOL_CONCURRENT
+	void runConcurrent()
+		{
+		// each thread owns its cache for the whole run
+		BenchConcurrentPool::Cache cache(*concurrentPool);
+		concurrentCache = &cache;
+		run();
+		concurrentCache = NULL;
+		}
+#endif
+
+	void execute()
+		{
+#ifdef NX_POOL_CONCURRENT
+		if (mode == CONCURRENT_POOL)
+			{
+			runConcurrent();
+			return;
+			}
+#endif
+		run();
+		}
+	};
+
+// ----------------------------------------------------------------------
+// minimal portable fork / join for the workers
+
+#if defined(WIN32)
+static DWORD WINAPI poolBenchmarkThreadFunc(LPVOID arg)
+{
+	((PoolBenchmarkWorker*)arg)->execute();
+	return 0;
+}
+#else
+static void *poolBenchmarkThreadFunc(void *arg)
+{
+	((PoolBenchmarkWorker*)arg)->execute();
+	return NULL;
+}
+#endif
+
+static float runWorkers(std::vector<PoolBenchmarkWorker>& workers)
+{
+	int numWorkers = (int)workers.size();
+	float start = getCurrentTime();
+#if defined(WIN32)
+	std::vector<HANDLE> threads(numWorkers, (HANDLE)NULL);
+	for (int i = 1; i < numWorkers; i++)
+		threads[i] = CreateThread(NULL, 0, poolBenchmarkThreadFunc, &workers[i], 0, NULL);
+	workers[0].execute();
+	for (int i = 1; i < numWorkers; i++) {
+		if (threads[i] == NULL) {
+			workers[i].execute();
+			continue;
+		}
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+	}
+#else
+	std::vector<pthread_t> threads(numWorkers);
+	std::vector<bool> started(numWorkers, false);
+	for (int i = 1; i < numWorkers; i++)
+		started[i] = pthread_create(&threads[i], NULL, poolBenchmarkThreadFunc, &workers[i]) == 0;
+	workers[0].execute();
+	for (int i = 1; i < numWorkers; i++) {
+		if (started[i])
+			pthread_join(threads[i], NULL);
+		else
+			workers[i].execute();
+	}
+#endif
+	return getCurrentTime() - start;
+}
+
+static void runMode(const char* name, PoolBenchmarkWorker::Mode mode, int threadCount)
+{
+	BenchPool pool(gLiveObjects * threadCount, gLiveObjects);
+#ifdef NX_POOL_CONCURRENT
+	BenchConcurrentPool concurrentPool(gLiveObjects * threadCount, gLiveObjects);
+#endif
+	SampleMutex mutex;
+
+	std::vector<PoolBenchmarkWorker> workers(threadCount);
+	for (int i = 0; i < threadCount; i++)
+		{
+		workers[i].mode = mode;
+		workers[i].pool = &pool;
+		workers[i].mutex = &mutex;
+#ifdef NX_POOL_CONCURRENT
+		workers[i].concurrentPool = &concurrentPool;
+		workers[i].concurrentCache = NULL;
+#endif
+		}
+
+	float seconds = runWorkers(workers);
+	float operations = 2.0f * gLiveObjects * gRounds * threadCount;
+	printf("  %-28s %8.1f ms  %8.2f M get+put/s\n", name, seconds * 1000.0f,
+		seconds > 0.0f ? operations / seconds / 1.0e6f : 0.0f);
+}
+
+static void runContents()
+{
+	const NxU32 live = 100000;
+	const NxU32 passes = 200;
+	BenchPool pool(live);
+	for (NxU32 i = 0; i < live; i++)
+		pool.get();
+
+	NxU32 checksum = 0;
+	float start = getCurrentTime();
+	for (NxU32 p = 0; p < passes; p++)
+		{
+		const NxArray<PoolBenchmarkElement*> contents = pool.contents();
+		for (NxU32 i = 0; i < pool.count(); i++)
+			checksum += contents[i]->hwid;
+		}
+	float copyTime = getCurrentTime() - start;
+
+	start = getCurrentTime();
+	for (NxU32 p = 0; p < passes; p++)
+		{
+		BenchPool::ContentsView view = pool.contentsView();
+		for (NxU32 i = 0; i < view.size(); i++)
+			checksum -= view[i]->hwid;
+		}
+	float viewTime = getCurrentTime() - start;
+
+	printf("  iterate %u live objects:    contents() %.1f ms, contentsView() %.1f ms%s\n",
+		live, copyTime * 1000.0f / passes, viewTime * 1000.0f / passes, checksum ? " (mismatch)" : "");
+}
+
+void RunPoolBenchmark(int threadCount)
+{
+	if (threadCount < 1)
+		threadCount = 1;
+
+	printf("NxPool benchmark, %u objects per thread, %u rounds\n", gLiveObjects, gRounds);
+	runContents();
+
+	int counts[2] = { 1, threadCount };
+	for (int c = 0; c < (threadCount > 1 ? 2 : 1); c++)
+		{
+		printf(" %d thread(s):\n", counts[c]);
+		runMode("NxPool get/put + mutex", PoolBenchmarkWorker::LOCKED_POOL, counts[c]);
+		runMode("NxPool bulk get/put + mutex", PoolBenchmarkWorker::BULK_LOCKED_POOL, counts[c]);
+#ifdef NX_POOL_CONCURRENT
+		runMode("NxConcurrentPool caches", PoolBenchmarkWorker::CONCURRENT_POOL, counts[c]);
+#endif
+		}
+}
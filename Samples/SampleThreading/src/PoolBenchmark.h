@@ -0,0 +1,8 @@
+#ifndef __POOL_BENCHMARK__
+#define __POOL_BENCHMARK__
+
+// Compares NxPool with its bulk operations and NxConcurrentPool, single threaded and
+// with threadCount worker threads churning objects, and prints the results.
+void RunPoolBenchmark(int threadCount);
+
+#endif
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "NxPhysics.h"
+#include "NXU_Snapshot.h"
+#include "SnapshotTest.h"
+
+using namespace NXU;
+
+static const NxU32 gTestActors = 1000;
+static const NxU32 gTestJoints = 50;
+static const NxU32 gTestFrames = 120;
+static const NxU32 gTestKeyframeInterval = 30;
+
+// ----------------------------------------------------------------------
+// stand-in for NxuSnapshotPhysicsScene: the states live in plain arrays,
+// so that the round trip can be checked without an SDK
+
+class SnapshotTestScene : public NxuSnapshotScene
+	{
+	public:
+	NxU32 getActorCount()										{ return mActors.size();	}
+	void getActorState(NxU32 index, NxuActorState& state)		{ state = mActors[index];	}
+	void setActorState(NxU32 index, const NxuActorState& state)	{ mActors[index] = state;	}
+
+	NxU32 getJointCount()										{ return mJoints.size();	}
+	void getJointState(NxU32 index, NxuJointState& state)		{ state = mJoints[index];	}
+	void setJointState(NxU32 index, const NxuJointState& state)	{ mJoints[index] = state;	}
+
+	NxArray<NxuActorState> mActors;
+	NxArray<NxuJointState> mJoints;
+	};
+
+// same sequence on every platform
+static NxU32 gTestSeed;
+
+static NxF32 testRandom()
+{
+	gTestSeed = gTestSeed * 1664525u + 1013904223u;
+	return NxF32(gTestSeed >> 8) / NxF32(1 << 23) - 1.0f;
+}
+
+static void initTestScene(SnapshotTestScene& scene)
+{
+	gTestSeed = 3;
+	scene.mActors.resize(gTestActors);
+	for (NxU32 i = 0; i < gTestActors; i++)
+		{
+		NxuActorState& a = scene.mActors[i];
+		a.mPosition.set(testRandom() * 100.0f, testRandom() * 100.0f, testRandom() * 100.0f);
+		a.mOrientation.setXYZW(testRandom(), testRandom(), testRandom(), 1.0f);
+		a.mOrientation.normalize();
+		a.mLinearVelocity.set(testRandom(), testRandom(), testRandom());
+		a.mAngularVelocity.set(testRandom(), testRandom(), testRandom());
+		a.mSleeping = i % 3 == 0;
+		}
+
+	scene.mJoints.resize(gTestJoints);
+	for (NxU32 i = 0; i < gTestJoints; i++)
+		{
+		NxuJointState& j = scene.mJoints[i];
+		j.mState = NX_JS_SIMULATING;
+		j.mDrivePosition.zero();
+		j.mDriveOrientation.id();
+		j.mDriveLinearVelocity.zero();
+		j.mDriveAngularVelocity.zero();
+		j.mMotorVelocity = 0.0f;
+		}
+}
+
+// falling bodies slowing their spin, some asleep, a joint breaking and a motor speeding up
+static void stepTestScene(SnapshotTestScene& scene, NxU32 frame)
+{
+	const NxF32 dt = 1.0f / 60.0f;
+	for (NxU32 i = 0; i < gTestActors; i++)
+		{
+		NxuActorState& a = scene.mActors[i];
+		if (testRandom() > 0.98f)
+			a.mSleeping = !a.mSleeping;
+		if (a.mSleeping)
+			continue;
+
+		a.mPosition += a.mLinearVelocity * dt;
+		a.mLinearVelocity.y -= 9.81f * dt;
+		a.mAngularVelocity *= 0.995f;
+		NxQuat spin;
+		spin.setXYZW(a.mAngularVelocity.x * dt * 0.5f, a.mAngularVelocity.y * dt * 0.5f, a.mAngularVelocity.z * dt * 0.5f, 1.0f);
+		a.mOrientation = spin * a.mOrientation;
+		a.mOrientation.normalize();
+		}
+
+	if (frame == gTestFrames / 2)
+		scene.mJoints[3].mState = NX_JS_BROKEN;
+	scene.mJoints[5].mMotorVelocity = NxF32(frame) * 0.5f;
+	scene.mJoints[7].mDrivePosition.y = NxF32(frame) * 0.01f;
+}
+
+// ----------------------------------------------------------------------
+
+static bool sameBits(const void* a, const void* b, NxU32 size)
+{
+	return memcmp(a, b, size) == 0;
+}
+
+// error of each float against the bound, plus the rounding of the decoded float itself
+static bool withinBound(const NxF32* decoded, const NxF32* expected, NxU32 count, NxF32 bound, NxF32& maxError)
+{
+	bool ok = true;
+	for (NxU32 i = 0; i < count; i++)
+		{
+		const NxF32 error = NxMath::abs(decoded[i] - expected[i]);
+		if (error > maxError)
+			maxError = error;
+		if (error > bound + NxMath::abs(expected[i]) * 2.0f * NX_EPS_F32)
+			ok = false;
+		}
+	return ok;
+}
+
+static bool runRoundTrip(const char* name, NxF32 linearQuantum, NxF32 angularQuantum)
+{
+	SnapshotTestScene scene;
+	initTestScene(scene);
+	SnapshotTestScene replica = scene;
+
+	NxuSnapshotEncoder encoder(gTestKeyframeInterval, linearQuantum, angularQuantum);
+	NxuSnapshotDecoder decoder;
+	const bool lossless = linearQuantum == 0.0f && angularQuantum == 0.0f;
+
+	NxU32 bytes = 0;
+	NxU32 keyframeBytes = 0;
+	NxU32 keyframes = 0;
+	NxU32 mismatches = 0;
+	NxF32 maxLinearError = 0.0f;
+	NxF32 maxAngularError = 0.0f;
+	NxF32 maxOrientationError = 0.0f;
+
+	for (NxU32 frame = 0; frame < gTestFrames; frame++)
+		{
+		stepTestScene(scene, frame);
+
+		NxuSnapshot captured;
+		captured.capture(scene, frame);
+		NxArray<NxU8> data;
+		if (encoder.encode(captured, data))
+			{
+			keyframeBytes += data.size();
+			keyframes++;
+			}
+		bytes += data.size();
+
+		NxuSnapshot decoded;
+		if (!decoder.decode(data.begin(), data.size(), decoded) || decoded.mFrame != frame)
+			{
+			printf("  %-10s frame %u does not decode\n", name, frame);
+			return false;
+			}
+		decoded.restore(replica);
+
+		for (NxU32 i = 0; i < gTestActors; i++)
+			{
+			const NxuActorState& a = scene.mActors[i];
+			const NxuActorState& b = replica.mActors[i];
+			bool ok = a.mSleeping == b.mSleeping;
+			if (lossless)
+				{
+				ok = ok && sameBits(&a.mPosition, &b.mPosition, sizeof(NxVec3)) && sameBits(&a.mOrientation, &b.mOrientation, sizeof(NxQuat))
+					&& sameBits(&a.mLinearVelocity, &b.mLinearVelocity, sizeof(NxVec3)) && sameBits(&a.mAngularVelocity, &b.mAngularVelocity, sizeof(NxVec3));
+				}
+			else
+				{
+				NxF32 qa[4] = { a.mOrientation.x, a.mOrientation.y, a.mOrientation.z, a.mOrientation.w };
+				NxF32 qb[4] = { b.mOrientation.x, b.mOrientation.y, b.mOrientation.z, b.mOrientation.w };
+				// half a quantum, and one more for orientations, which are renormalized after decoding
+				ok = withinBound(&b.mPosition.x, &a.mPosition.x, 3, linearQuantum * 0.5f, maxLinearError) && ok;
+				ok = withinBound(&b.mLinearVelocity.x, &a.mLinearVelocity.x, 3, linearQuantum * 0.5f, maxLinearError) && ok;
+				ok = withinBound(qb, qa, 4, angularQuantum * 1.5f, maxOrientationError) && ok;
+				ok = withinBound(&b.mAngularVelocity.x, &a.mAngularVelocity.x, 3, angularQuantum * 0.5f, maxAngularError) && ok;
+				}
+			if (!ok)
+				mismatches++;
+			}
+
+		for (NxU32 i = 0; i < gTestJoints; i++)
+			{
+			const NxuJointState& a = scene.mJoints[i];
+			const NxuJointState& b = replica.mJoints[i];
+			bool ok = a.mState == b.mState;
+			if (lossless)
+				{
+				ok = ok && sameBits(&a.mDrivePosition, &b.mDrivePosition, sizeof(NxVec3)) && sameBits(&a.mMotorVelocity, &b.mMotorVelocity, sizeof(NxF32));
+				}
+			else
+				{
+				ok = withinBound(&b.mDrivePosition.x, &a.mDrivePosition.x, 3, linearQuantum * 0.5f, maxLinearError) && ok;
+				ok = withinBound(&b.mMotorVelocity, &a.mMotorVelocity, 1, angularQuantum * 0.5f, maxAngularError) && ok;
+				}
+			if (!ok)
+				mismatches++;
+			}
+		}
+
+	const NxU32 fullBytes = keyframes ? keyframeBytes / keyframes * gTestFrames : 0;
+	printf("  %-10s %s: %u bytes, %.0f%% of keyframes only", name, mismatches ? "FAIL" : "PASS", bytes,
+		fullBytes ? 100.0f * bytes / fullBytes : 0.0f);
+	if (lossless)
+		printf(", %u mismatches\n", mismatches);
+	else
+		printf(", max error in quanta: linear %.2f, angular %.2f, orientation %.2f, %u mismatches\n",
+			maxLinearError / linearQuantum, maxAngularError / angularQuantum, maxOrientationError / angularQuantum, mismatches);
+	return mismatches == 0;
+}
+
+bool RunSnapshotTest()
+{
+	printf("Snapshot round trip, %u actors, %u joints, %u frames, keyframe every %u\n",
+		gTestActors, gTestJoints, gTestFrames, gTestKeyframeInterval);
+
+	bool ok = runRoundTrip("lossless", 0.0f, 0.0f);
+	ok = runRoundTrip("quantized", 0.001f, 0.0001f) && ok;
+	return ok;
+}
@@ -0,0 +1,9 @@
+#ifndef __SNAPSHOT_TEST__
+#define __SNAPSHOT_TEST__
+
+// Records a synthetic scene through NxuSnapshotEncoder / NxuSnapshotDecoder and checks the round trip:
+// bit exact in lossless mode, within half a quantum in quantized mode (a quantum and a half for the
+// renormalized orientations). Prints the results, returns false on a mismatch.
+bool RunSnapshotTest();
+
+#endif
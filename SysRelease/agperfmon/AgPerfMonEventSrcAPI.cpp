@@ -1,9 +1,21 @@
+#if defined(WIN32)
 #define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
 #define NOMINMAX
 #include <windows.h>
+#else
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 #include <stdio.h>
 #include "AgPerfMonEventSrcAPI.h"
 
+#if defined(WIN32)
+
+/** The event source API below forwards to the AgPerfMon DLL.  Other
+    platforms record events themselves, see AgPerfMonEventSrcNative.cpp. */
+
 static HMODULE AgPmDllHandle=0;
 
 static AgPmCreateSourceConnection_FUNC  *createFunc;
@@ -110,6 +122,34 @@ bool AgPmEventLoggingEnabled(AgPmHANDLE hconn)
     return eventLoggingEnabledFunc(hconn);
 }
 
+bool AgPmWriteChromeTrace(AgPmHANDLE hconn, const char *fileName)
+{
+    return false;
+}
+
+bool AgPmWriteBinaryLog(AgPmHANDLE hconn, const char *fileName)
+{
+    return false;
+}
+
+static AgU32 AgPmCurrentThreadId()
+{
+    return GetCurrentThreadId();
+}
+
+#else
+
+/** the kernel thread id, which is also what the trace viewers show */
+static AgU32 AgPmCurrentThreadId()
+{
+    static __thread AgU32 threadId = 0;
+    if (!threadId)
+        threadId = (AgU32)syscall(SYS_gettid);
+    return threadId;
+}
+
+#endif
+
 //** AgPerfUtils */
 
 
@@ -123,6 +163,7 @@ const char *AgPerfUtils::mEventNames[] = {
 
 AgPmHANDLE	AgPerfUtils::mhAgPm = 0;
 
+#if defined(WIN32)
 AgPerfUtils::AgPerfUtils():
    mNtQueryThreadInfo(0),
 #ifdef UNICODE
@@ -133,23 +174,31 @@ AgPerfUtils::AgPerfUtils():
 {
     if(mhNTDLL)
         mNtQueryThreadInfo = (tinfo_FUNC *)GetProcAddress((HMODULE)mhNTDLL, "NtQueryInformationThread");
+#else
+AgPerfUtils::AgPerfUtils()
+{
+#endif
+
+	for (int i = 0; i <= AgPerfEventNumEvents; i++)
+		mEventIds[i] = AG_INVALID_EVENT_ID;
 
 	if (!mhAgPm)
-	{
 		mhAgPm = AgPmCreateSourceConnection();
-		
-		if (mhAgPm)
-		{
-			for (int i = 0; i < AgPerfEventNumEvents; i++)
-				mEventIds[i] = AgPmRegisterEvent(mhAgPm, mEventNames[i]);
-		}
+
+	/** events are registered by name, so every instance gets the same ids */
+	if (mhAgPm)
+	{
+		for (int i = 0; i < AgPerfEventNumEvents; i++)
+			mEventIds[i] = AgPmRegisterEvent(mhAgPm, mEventNames[i]);
 	}
 }
 
 AgPerfUtils::~AgPerfUtils()
 {
+#if defined(WIN32)
     if(mhNTDLL)
         FreeLibrary((HMODULE)mhNTDLL);
+#endif
 
 	if (mhAgPm)
 	{
@@ -158,6 +207,7 @@ AgPerfUtils::~AgPerfUtils()
 	}
 }
 
+#if defined(WIN32)
 AgU32 AgPerfUtils::GetThreadPriority()
 {
     AgU32 retVal = 0;
@@ -184,6 +234,23 @@ unsigned char AgPerfUtils::GetProcID()
 
     return CPUInfo[1] >> 24; // APIC Physical ID
 }
+#else
+AgU32 AgPerfUtils::GetThreadPriority()
+{
+    /** nice value mapped so that higher means more important, like on
+        Windows.  Read once per thread, it is a system call. */
+    static __thread AgU32 priority = 0;
+    if (!priority)
+        priority = 20 - getpriority(PRIO_PROCESS, AgPmCurrentThreadId());
+    return priority;
+}
+
+unsigned char AgPerfUtils::GetProcID()
+{
+    int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : (unsigned char)cpu;
+}
+#endif
 
 AgEventID AgPerfUtils::registerEvent(const char *name)
 {
@@ -203,7 +270,7 @@ void AgPerfUtils::startEvent(AgEventID id, AgU16 data)
 		((AgU8*)(&threadCpuData))[0] = GetThreadPriority();
 		((AgU8*)(&threadCpuData))[1] = GetProcID();
 		((AgU16*)(&threadCpuData))[1] = data;
-		AgPmSubmitEvent(mhAgPm, id, GetCurrentThreadId(), threadCpuData, AG_PERFMON_EV_START);
+		AgPmSubmitEvent(mhAgPm, id, AgPmCurrentThreadId(), threadCpuData, AG_PERFMON_EV_START);
 	}
 }
 
@@ -215,13 +282,13 @@ void AgPerfUtils::stopEvent(AgEventID id, AgU16 data)
 		((AgU8*)(&threadCpuData))[0] = GetThreadPriority();
 		((AgU8*)(&threadCpuData))[1] = GetProcID();
 		((AgU16*)(&threadCpuData))[1] = data;
-		AgPmSubmitEvent(mhAgPm, id, GetCurrentThreadId(), threadCpuData, AG_PERFMON_EV_STOP);
+		AgPmSubmitEvent(mhAgPm, id, AgPmCurrentThreadId(), threadCpuData, AG_PERFMON_EV_STOP);
 	}
 }
 
 void AgPerfUtils::statEvent(AgEventID id, AgU32 stat)
 {
-	AgPmSubmitEvent(mhAgPm, id, stat, GetCurrentThreadId(), AG_PERFMON_EV_STAT);
+	AgPmSubmitEvent(mhAgPm, id, stat, AgPmCurrentThreadId(), AG_PERFMON_EV_STAT);
 }
 
 void AgPerfUtils::statEvent(AgEventID id, AgU32 stat, AgU32 ident)
@@ -234,6 +301,16 @@ void AgPerfUtils::debugEvent(AgEventID id, AgU32 data0, AgU32 data1)
 	AgPmSubmitEvent(mhAgPm, id, data0, data1, AG_PERFMON_EV_DEBUG);
 }
 
+bool AgPerfUtils::writeChromeTrace(const char *fileName)
+{
+	return AgPmWriteChromeTrace(mhAgPm, fileName);
+}
+
+bool AgPerfUtils::writeBinaryLog(const char *fileName)
+{
+	return AgPmWriteBinaryLog(mhAgPm, fileName);
+}
+
 bool AgPerfUtils::isEventEnabled(AgEventID id)
 {
 	return AgPmEventEnabled(mhAgPm, id);
@@ -241,8 +318,6 @@ bool AgPerfUtils::isEventEnabled(AgEventID id)
 
 bool AgPerfUtils::isLibraryLoaded()
 {
-	if(!AgPmLibLoaded())
-        return false;
-	else
-		return true;
+	/** a connection only exists while the DLL is loaded, and the native backend is "loaded" while one is open */
+	return 0 != mhAgPm;
 }
@@ -36,6 +36,11 @@ bool        AgPmRegisterEventAsPassive(AgPmHANDLE hconn, AgEventID id, void *con
 bool        AgPmEventEnabled(AgPmHANDLE hconn, AgEventID id);
 bool        AgPmEventLoggingEnabled(AgPmHANDLE hconn);
 
+/** Timeline export, native backend only (AgPerfMonEventSrcNative.cpp).
+    With the DLL the event sink owns the log and these return false. */
+bool        AgPmWriteChromeTrace(AgPmHANDLE hconn, const char *fileName);
+bool        AgPmWriteBinaryLog(AgPmHANDLE hconn, const char *fileName);
+
 #define AG_PERFMON_EV_START				0x00
 #define AG_PERFMON_EV_STOP				0x01
 #define AG_PERFMON_EV_STAT  			0x02
@@ -67,6 +72,8 @@ public:
 	void statEvent(AgEventID id, AgU32 stat);
 	void statEvent(AgEventID id, AgU32 stat, AgU32 ident);
 	void debugEvent(AgEventID id, AgU32 data0, AgU32 data1);
+	bool writeChromeTrace(const char *fileName);
+	bool writeBinaryLog(const char *fileName);
 
 	inline AgEventID getEventId(int index) { return mEventIds[index]; };
 
@@ -75,6 +82,7 @@ public:
 	inline AgPmHANDLE getHAgPm() {return mhAgPm; };
 
 private:
+#if defined(WIN32)
     typedef struct _THREAD_BASIC_INFORMATION {
         AgU32               ExitStatus;
         void               *TebBaseAddress;
@@ -93,6 +101,7 @@ private:
 
     tinfo_FUNC			*mNtQueryThreadInfo;
     void				*mhNTDLL;
+#endif
 	static AgPmHANDLE	mhAgPm;
 
 	AgEventID			mEventIds[AgPerfEventNumEvents+1];
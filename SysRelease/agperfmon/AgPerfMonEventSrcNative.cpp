@@ -0,0 +1,440 @@
+/*----------------------------------------------------------------------
+    This Software and Related Documentation are Proprietary to NVIDIA
+    Corporation
+
+    Copyright 2010 NVIDIA Corporation
+    Unpublished -
+    All Rights Reserved Under the Copyright Laws of the United States.
+
+    Restricted Rights Legend:  Use, Duplication, or Disclosure by
+    the Government is Subject to Restrictions as Set Forth in
+    Paragraph (c)(1)(ii) of the Rights in Technical Data and
+    Computer Software Clause at DFARS 252.227-7013.  NVIDIA
+    Corporation
+-----------------------------------------------------------------------*/
+
+/*
+ * Native event source backend, for platforms without the AgPerfMon DLL.
+ *
+ * Every thread that submits an event gets a ring buffer of its own.  Only
+ * that thread writes to it and it publishes each record with a release
+ * store of the ring head, so submitting an event takes no lock and makes
+ * no system call.  A full ring overwrites its oldest records: the rings
+ * always hold the most recent part of the timeline.
+ *
+ * The connection is only created when the AG_PERFMON_TRACE environment
+ * variable is set.  Its value is a file name prefix, and when the
+ * connection is destroyed the timeline is written to <prefix>.json in the
+ * Chrome trace event format (chrome://tracing, Perfetto) and to
+ * <prefix>.agpm as a binary log.  AgPmWriteChromeTrace() and
+ * AgPmWriteBinaryLog() write a snapshot at any time.  AG_PERFMON_RING
+ * sets the number of records per thread, rounded up to a power of two.
+ *
+ * Binary log, little endian:
+ *   "AGPM", AgU32 version, AgU64 ticks per second
+ *   AgU32 event count, per event: AgU16 name length, name
+ *   AgU32 thread count, per thread: AgU32 thread id, AgU32 record count,
+ *   per record: AgU64 time since the connection opened, AgU32 data0,
+ *   AgU32 data1, AgU16 event id, AgU8 type (AG_PERFMON_EV_xxx)
+ */
+
+#if !defined(WIN32)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include "AgPerfMonEventSrcAPI.h"
+
+#define AG_PM_MAX_EVENTS        1024
+#define AG_PM_RING_RECORDS      (64 * 1024)
+#define AG_PM_LOG_VERSION       1
+#define AG_PM_TICKS_PER_SECOND  1000000000ULL
+#define AG_PM_PREFIX_LEN        256
+
+typedef struct AgPmRecord
+{
+    AgU64   time;
+    AgU32   data0;
+    AgU32   data1;
+    AgU16   id;
+    AgU8    type;
+} AgPmRecord;
+
+typedef struct AgPmThreadRing
+{
+    struct AgPmThreadRing  *next;
+    AgU32                   threadId;
+    AgU32                   mask;
+    AgU64                   head;       /** records ever written, stored by the owner only */
+    AgPmRecord             *records;
+} AgPmThreadRing;
+
+typedef struct AgPmConnection
+{
+    AgU32                   generation;
+    AgU32                   ringRecords;
+    AgU64                   startTime;
+    AgPmThreadRing         *rings;      /** pushed lock-free, freed with the connection */
+    pthread_mutex_t         nameLock;
+    AgU32                   numEvents;
+    char                    names[AG_PM_MAX_EVENTS][AG_EVENT_NAME_LEN];
+    char                    prefix[AG_PM_PREFIX_LEN];
+} AgPmConnection;
+
+/** a snapshot of one ring, taken while its owner may keep writing */
+typedef struct AgPmThreadLog
+{
+    AgU32                   threadId;
+    AgU32                   count;
+    AgPmRecord             *records;
+} AgPmThreadLog;
+
+static AgU32                    gAgPmGeneration = 0;
+static __thread AgPmThreadRing *tAgPmRing = 0;
+static __thread AgU32           tAgPmGeneration = 0;
+
+
+static AgU64 AgPmNow()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (AgU64)ts.tv_sec * AG_PM_TICKS_PER_SECOND + (AgU64)ts.tv_nsec;
+}
+
+/** slow path of AgPmSubmitEvent, once per thread and connection */
+static AgPmThreadRing *AgPmCreateRing(AgPmConnection *conn)
+{
+    AgPmThreadRing *ring = (AgPmThreadRing *)malloc(sizeof(AgPmThreadRing));
+    if (!ring)
+        return 0;
+    ring->records = (AgPmRecord *)malloc(conn->ringRecords * sizeof(AgPmRecord));
+    if (!ring->records)
+    {
+        free(ring);
+        return 0;
+    }
+    ring->threadId = (AgU32)syscall(SYS_gettid);
+    ring->mask = conn->ringRecords - 1;
+    ring->head = 0;
+
+    AgPmThreadRing *head;
+    do
+    {
+        head = __atomic_load_n(&conn->rings, __ATOMIC_ACQUIRE);
+        ring->next = head;
+    }
+    while (!__atomic_compare_exchange_n(&conn->rings, &head, ring, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    tAgPmRing = ring;
+    tAgPmGeneration = conn->generation;
+    return ring;
+}
+
+/** copies the records of a ring that are complete, oldest first */
+static void AgPmSnapshotRing(AgPmThreadRing *ring, AgPmThreadLog &log)
+{
+    AgU64 capacity = (AgU64)ring->mask + 1;
+    AgU64 last = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    AgU64 first = last > capacity ? last - capacity : 0;
+
+    log.threadId = ring->threadId;
+    log.count = 0;
+    log.records = (AgPmRecord *)malloc((size_t)(last - first) * sizeof(AgPmRecord) + 1);
+    if (!log.records)
+        return;
+    for (AgU64 i = first; i < last; i++)
+        log.records[i - first] = ring->records[i & ring->mask];
+
+    /** the owner may have lapped us meanwhile: the record it is writing
+        now, and everything it published since, replaced old slots */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    AgU64 now = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    AgU64 valid = now >= capacity ? now - capacity + 1 : 0;
+    AgU64 skip = valid > first ? valid - first : 0;
+    if (skip >= last - first)
+        return;
+    memmove(log.records, log.records + skip, (size_t)(last - first - skip) * sizeof(AgPmRecord));
+    log.count = (AgU32)(last - first - skip);
+}
+
+static AgU32 AgPmSnapshot(AgPmConnection *conn, AgPmThreadLog *&logs)
+{
+    AgU32 numRings = 0;
+    AgPmThreadRing *rings = __atomic_load_n(&conn->rings, __ATOMIC_ACQUIRE);
+    for (AgPmThreadRing *r = rings; r; r = r->next)
+        numRings++;
+
+    logs = (AgPmThreadLog *)malloc(numRings * sizeof(AgPmThreadLog) + 1);
+    if (!logs)
+        return 0;
+    AgU32 i = 0;
+    for (AgPmThreadRing *r = rings; r; r = r->next)
+        AgPmSnapshotRing(r, logs[i++]);
+    return numRings;
+}
+
+static void AgPmFreeSnapshot(AgPmThreadLog *logs, AgU32 numLogs)
+{
+    for (AgU32 i = 0; i < numLogs; i++)
+        free(logs[i].records);
+    free(logs);
+}
+
+static void AgPmWriteJsonString(FILE *fp, const char *str)
+{
+    fputc('"', fp);
+    for (; *str; str++)
+    {
+        unsigned char c = (unsigned char)*str;
+        if (c == '"' || c == '\\')
+            fprintf(fp, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(fp, "\\u%04x", c);
+        else
+            fputc(c, fp);
+    }
+    fputc('"', fp);
+}
+
+static void AgPmWrite(FILE *fp, AgU64 value, int numBytes)
+{
+    for (int i = 0; i < numBytes; i++)
+        fputc((int)((value >> (i * 8)) & 0xff), fp);
+}
+
+/** Event Source API */
+
+AgPmHANDLE AgPmCreateSourceConnection()
+{
+    const char *prefix = getenv("AG_PERFMON_TRACE");
+    if (!prefix || !*prefix)
+        return 0;
+
+    AgPmConnection *conn = (AgPmConnection *)malloc(sizeof(AgPmConnection));
+    if (!conn)
+        return 0;
+
+    AgU32 ringRecords = AG_PM_RING_RECORDS;
+    const char *ring = getenv("AG_PERFMON_RING");
+    if (ring && atoi(ring) > 0)
+    {
+        ringRecords = 64;
+        while (ringRecords < (AgU32)atoi(ring) && ringRecords < 0x10000000)
+            ringRecords <<= 1;
+    }
+
+    conn->generation = __atomic_add_fetch(&gAgPmGeneration, 1, __ATOMIC_RELAXED);
+    conn->ringRecords = ringRecords;
+    conn->startTime = AgPmNow();
+    conn->rings = 0;
+    pthread_mutex_init(&conn->nameLock, 0);
+    conn->numEvents = 0;
+    snprintf(conn->prefix, AG_PM_PREFIX_LEN, "%s", prefix);
+    return conn;
+}
+
+bool AgPmDestroySourceConnection(AgPmHANDLE hconn)
+{
+    AgPmConnection *conn = (AgPmConnection *)hconn;
+    if (!conn)
+        return false;
+
+    char fileName[AG_PM_PREFIX_LEN + 8];
+    snprintf(fileName, sizeof(fileName), "%s.json", conn->prefix);
+    bool retVal = AgPmWriteChromeTrace(conn, fileName);
+    snprintf(fileName, sizeof(fileName), "%s.agpm", conn->prefix);
+    retVal = AgPmWriteBinaryLog(conn, fileName) && retVal;
+
+    /** threads still holding a ring see a new generation on their next event */
+    AgPmThreadRing *ring = conn->rings;
+    while (ring)
+    {
+        AgPmThreadRing *next = ring->next;
+        free(ring->records);
+        free(ring);
+        ring = next;
+    }
+    pthread_mutex_destroy(&conn->nameLock);
+    free(conn);
+    return retVal;
+}
+
+AgEventID AgPmRegisterEvent(AgPmHANDLE hconn, const char *name)
+{
+    AgPmConnection *conn = (AgPmConnection *)hconn;
+    if (!conn || !name)
+        return AG_INVALID_EVENT_ID;
+
+    /** the same name always maps to the same id, so the SDK's own
+        registrations (gPerfMonSimulate, ...) match AgPerfUtils' ids */
+    AgEventID id = AG_INVALID_EVENT_ID;
+    pthread_mutex_lock(&conn->nameLock);
+    for (AgU32 i = 0; i < conn->numEvents; i++)
+    {
+        if (!strncmp(conn->names[i], name, AG_EVENT_NAME_LEN - 1))
+        {
+            id = (AgEventID)i;
+            break;
+        }
+    }
+    if (id == AG_INVALID_EVENT_ID && conn->numEvents < AG_PM_MAX_EVENTS)
+    {
+        snprintf(conn->names[conn->numEvents], AG_EVENT_NAME_LEN, "%s", name);
+        id = (AgEventID)conn->numEvents;
+        __atomic_store_n(&conn->numEvents, conn->numEvents + 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&conn->nameLock);
+    return id;
+}
+
+bool AgPmSubmitEvent(AgPmHANDLE hconn, AgEventID id, unsigned int data0, unsigned int data1, unsigned char data2)
+{
+    AgPmConnection *conn = (AgPmConnection *)hconn;
+    if (!conn || id >= __atomic_load_n(&conn->numEvents, __ATOMIC_RELAXED))
+        return false;
+
+    AgPmThreadRing *ring = tAgPmRing;
+    if (!ring || tAgPmGeneration != conn->generation)
+    {
+        ring = AgPmCreateRing(conn);
+        if (!ring)
+            return false;
+    }
+
+    AgU64 head = ring->head;
+    AgPmRecord &record = ring->records[head & ring->mask];
+    record.time  = AgPmNow();
+    record.data0 = data0;
+    record.data1 = data1;
+    record.id    = id;
+    record.type  = data2;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool AgPmEventEnabled(AgPmHANDLE hconn, AgEventID id)
+{
+    AgPmConnection *conn = (AgPmConnection *)hconn;
+    return conn && id < __atomic_load_n(&conn->numEvents, __ATOMIC_RELAXED);
+}
+
+bool AgPmEventLoggingEnabled(AgPmHANDLE hconn)
+{
+    return 0 != hconn;
+}
+
+bool AgPmWriteChromeTrace(AgPmHANDLE hconn, const char *fileName)
+{
+    AgPmConnection *conn = (AgPmConnection *)hconn;
+    if (!conn || !fileName)
+        return false;
+
+    FILE *fp = fopen(fileName, "w");
+    if (!fp)
+        return false;
+
+    AgPmThreadLog *logs;
+    AgU32 numLogs = AgPmSnapshot(conn, logs);
+    AgU32 numEvents = __atomic_load_n(&conn->numEvents, __ATOMIC_ACQUIRE);
+    int pid = (int)getpid();
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"PhysX\"}}", pid);
+    for (AgU32 t = 0; t < numLogs; t++)
+    {
+        const AgPmThreadLog &log = logs[t];
+        fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+            pid, log.threadId, log.threadId);
+
+        for (AgU32 i = 0; i < log.count; i++)
+        {
+            const AgPmRecord &r = log.records[i];
+            if (r.id >= numEvents)
+                continue;
+
+            /** Chrome wants microseconds, keep the nanoseconds as decimals */
+            AgU64 ns = r.time > conn->startTime ? r.time - conn->startTime : 0;
+            fprintf(fp, ",\n{\"name\":");
+            AgPmWriteJsonString(fp, conn->names[r.id]);
+            fprintf(fp, ",\"cat\":\"PhysX\",\"pid\":%d,\"tid\":%u,\"ts\":%llu.%03u,",
+                pid, log.threadId, (unsigned long long)(ns / 1000), (unsigned)(ns % 1000));
+
+            switch (r.type)
+            {
+            case AG_PERFMON_EV_START:
+            case AG_PERFMON_EV_STOP:
+                /** data1 as packed by AgPerfUtils: priority, cpu, user data */
+                fprintf(fp, "\"ph\":\"%c\",\"args\":{\"data\":%u,\"cpu\":%u,\"priority\":%u}}",
+                    r.type == AG_PERFMON_EV_START ? 'B' : 'E',
+                    r.data1 >> 16, (r.data1 >> 8) & 0xff, r.data1 & 0xff);
+                break;
+            case AG_PERFMON_EV_STAT:
+                /** one counter series per identifier (the thread id by default) */
+                fprintf(fp, "\"ph\":\"C\",\"id\":%u,\"args\":{\"value\":%u}}", r.data1, r.data0);
+                break;
+            default:
+                fprintf(fp, "\"ph\":\"i\",\"s\":\"t\",\"args\":{\"data0\":%u,\"data1\":%u}}", r.data0, r.data1);
+                break;
+            }
+        }
+    }
+    fprintf(fp, "\n]}\n");
+
+    AgPmFreeSnapshot(logs, numLogs);
+    bool ok = !ferror(fp);
+    return fclose(fp) == 0 && ok;
+}
+
+bool AgPmWriteBinaryLog(AgPmHANDLE hconn, const char *fileName)
+{
+    AgPmConnection *conn = (AgPmConnection *)hconn;
+    if (!conn || !fileName)
+        return false;
+
+    FILE *fp = fopen(fileName, "wb");
+    if (!fp)
+        return false;
+
+    AgPmThreadLog *logs;
+    AgU32 numLogs = AgPmSnapshot(conn, logs);
+    AgU32 numEvents = __atomic_load_n(&conn->numEvents, __ATOMIC_ACQUIRE);
+
+    fwrite("AGPM", 1, 4, fp);
+    AgPmWrite(fp, AG_PM_LOG_VERSION, 4);
+    AgPmWrite(fp, AG_PM_TICKS_PER_SECOND, 8);
+
+    AgPmWrite(fp, numEvents, 4);
+    for (AgU32 i = 0; i < numEvents; i++)
+    {
+        size_t len = strlen(conn->names[i]);
+        AgPmWrite(fp, len, 2);
+        fwrite(conn->names[i], 1, len, fp);
+    }
+
+    AgPmWrite(fp, numLogs, 4);
+    for (AgU32 t = 0; t < numLogs; t++)
+    {
+        const AgPmThreadLog &log = logs[t];
+        AgPmWrite(fp, log.threadId, 4);
+        AgPmWrite(fp, log.count, 4);
+        for (AgU32 i = 0; i < log.count; i++)
+        {
+            const AgPmRecord &r = log.records[i];
+            AgPmWrite(fp, r.time - conn->startTime, 8);
+            AgPmWrite(fp, r.data0, 4);
+            AgPmWrite(fp, r.data1, 4);
+            AgPmWrite(fp, r.id, 2);
+            AgPmWrite(fp, r.type, 1);
+        }
+    }
+
+    AgPmFreeSnapshot(logs, numLogs);
+    bool ok = !ferror(fp);
+    return fclose(fp) == 0 && ok;
+}
+
+#endif // !WIN32
@@ -4,34 +4,113 @@
 #include <float.h>
 #include <assert.h>
 #include <limits.h>
+#include <math.h>
 
+#include <locale.h>
+
+#include "NxSimpleTypes.h"
 #include "NXU_Asc2Bin.h"
 #include "NXU_string.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define	NXU_ASC2BIN_SSE2
+#endif
+
+#if (defined(WIN32) || defined(_WIN32)) && !defined(_XBOX)
+#define	WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define	NXU_ASC2BIN_THREADS
+#elif defined(LINUX) || defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#include <unistd.h>
+#define	NXU_ASC2BIN_THREADS
+#endif
+
 
 
 namespace	NXU
 {
 
+// Whitespace is ' ', tab, CR, LF and ','.
+static const unsigned char gWhitespace[256] =
+{
+	0,0,0,0,0,0,0,0,0,1,1,0,0,1,0,0,	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	1,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,	0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+};
+
 static inline	bool IsWhitespace(char c)
 {
-	if (c	== ' ' ||	c	== 9 ||	c	== 13	|| c ==	10 ||	c	== ',')
+	return gWhitespace[(unsigned char)c] != 0;
+}
+
+#ifdef NXU_ASC2BIN_SSE2
+
+// Returns a mask with one bit set per whitespace byte among the 16 at 'p'.
+static inline	unsigned int WhitespaceMask(const char *p)
+{
+	__m128i	v	=	_mm_load_si128((const __m128i*)p);
+	__m128i	ws	=	_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))),
+					_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(9)), _mm_cmpeq_epi8(v, _mm_set1_epi8(10))),
+					_mm_cmpeq_epi8(v, _mm_set1_epi8(13))));
+	return (unsigned int)_mm_movemask_epi8(ws);
+}
+
+static inline	unsigned int FirstBit(unsigned int mask)
+{
+	unsigned int i = 0;
+	while	((mask & 1) == 0)
 	{
-		return true;
+		mask >>= 1;
+		i++;
 	}
-	return false;
+	return i;
 }
 
+// Skips long whitespace runs (indentation, line breaks) 16 bytes at a time. Loads are aligned, so they never
+// cross into an unmapped page past the terminating zero, which is not whitespace and ends the scan.
+static const	char *SkipWhitespaceSSE2(const char *str)
+{
+	const	char *p	=	(const char*)((size_t)str & ~(size_t)15);
+	unsigned int skip = (unsigned int)(str - p);
+	unsigned int mask = ~(WhitespaceMask(p) | ((1u << skip) - 1)) & 0xFFFF;
+	while	(mask == 0)
+	{
+		p	+= 16;
+		mask = ~WhitespaceMask(p) & 0xFFFF;
+	}
+	return p + FirstBit(mask);
+}
 
+#endif
 
 static inline	const	char *SkipWhitespace(const char	*str)
 {
 	if ( str )
 	{
-		while	(*str	&& IsWhitespace(*str))
+		// Single separators are the common case between array values
+		for	(int i = 0; i < 4; i++)
 		{
+			if (!IsWhitespace(*str))
+			{
+				return str;
+			}
 			str++;
 		}
+#ifdef NXU_ASC2BIN_SSE2
+		str	=	SkipWhitespaceSSE2(str);
+#else
+		while	(IsWhitespace(*str))
+		{
+			str++;
+		}
+#endif
 	}
 	return str;
 }
@@ -162,7 +241,8 @@ static inline	unsigned int GetHEX(const	char *foo, const char	**endptr)
 
 #define	MAXNUM 128
 
-static inline float	GetFloatValue(const	char *str, const char	**next)
+// Tokens that aren't plain decimal numbers: the '$' hex notation, the fltmax / fltmin spellings and 'true'.
+static float	GetSpecialFloatValue(const	char *str, const char	**next)
 {
 	float	ret	=	0;
 
@@ -230,6 +310,179 @@ static inline float	GetFloatValue(const	char *str, const char	**next)
 	return ret;
 }
 
+// Exactly representable powers of ten
+static const double gPow10[] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Converts [sign] digits [. digits] [e [sign] digits], the whole of [str,end). Returns false for anything else,
+// or when the result can't be computed exactly here. Otherwise the double is correctly rounded: the mantissa fits
+// in 53 bits and the power of ten is exact, so a single multiply or divide does the only rounding (Clinger's fast path).
+static inline	bool ParseDecimal(const char *str, const char *end, double &result)
+{
+	bool negative = false;
+	if (str < end && (*str == '-' || *str == '+'))
+	{
+		negative = *str == '-';
+		str++;
+	}
+
+	NxU64 mantissa = 0;
+	int digits = 0;			// significant digits in the mantissa
+	int exponent = 0;
+	bool anyDigit = false;
+
+	while	(str < end && *str >= '0' && *str <= '9')
+	{
+		anyDigit = true;
+		if (mantissa || *str != '0')
+		{
+			if (++digits > 19)
+			{
+				return false;
+			}
+			mantissa = mantissa * 10 + (*str - '0');
+		}
+		str++;
+	}
+	if (str < end && *str == '.')
+	{
+		str++;
+		while	(str < end && *str >= '0' && *str <= '9')
+		{
+			anyDigit = true;
+			if (mantissa || *str != '0')
+			{
+				if (++digits > 19)
+				{
+					return false;
+				}
+				mantissa = mantissa * 10 + (*str - '0');
+			}
+			exponent--;
+			str++;
+		}
+	}
+	if (!anyDigit)
+	{
+		return false;
+	}
+	if (str < end && (*str == 'e' || *str == 'E'))
+	{
+		str++;
+		bool negativeExponent = false;
+		if (str < end && (*str == '-' || *str == '+'))
+		{
+			negativeExponent = *str == '-';
+			str++;
+		}
+		if (str == end)
+		{
+			return false;
+		}
+		int e = 0;
+		while	(str < end && *str >= '0' && *str <= '9')
+		{
+			if (e < 10000)
+			{
+				e = e * 10 + (*str - '0');
+			}
+			str++;
+		}
+		exponent += negativeExponent ? -e : e;
+	}
+	if (str != end)
+	{
+		return false;
+	}
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+	// Extended precision intermediates would round twice
+	return false;
+#endif
+
+	double value;
+	if (mantissa == 0)
+	{
+		value = 0.0;
+	}
+	else
+	{
+		if (mantissa > ((NxU64)1 << 53) || exponent < -22 || exponent > 22)
+		{
+			return false;
+		}
+		value = (double)(NxI64)mantissa;
+		if (exponent < 0)
+		{
+			value /= gPow10[-exponent];
+		}
+		else
+		{
+			value *= gPow10[exponent];
+		}
+	}
+	result = negative ? -value : value;
+	return true;
+}
+
+// strtod() reading '.' as the decimal point whatever the current locale.
+static double	LocaleFreeStrtod(const char *str, const char *end)
+{
+	char buffer[MAXNUM];
+	int len = (int)(end - str);
+	if (len > MAXNUM - 1)
+	{
+		len = MAXNUM - 1;
+	}
+	const	char point = localeconv()->decimal_point[0];
+	for	(int i = 0; i < len; i++)
+	{
+		buffer[i] = (str[i] == '.') ? point : str[i];
+	}
+	buffer[len] = 0;
+	return strtod(buffer, 0);
+}
+
+static inline	float	GetFloatValue(const	char *str, const char	**next)
+{
+	if ( !str )
+	{
+		return 0;
+	}
+
+	str	=	SkipWhitespace(str);
+
+	const	char *end	=	str;
+	bool special = (*str == 'f' || *str == 'F' || *str == 't' || *str == 'T');
+	while	(*end && !IsWhitespace(*end))
+	{
+		special |= (*end == '$');
+		end++;
+	}
+
+	// Same results as before for everything the old path handled differently: hex, named values and over-long tokens
+	if (special || (end - str) >= (MAXNUM - 1))
+	{
+		return GetSpecialFloatValue(str, next);
+	}
+
+	if (next)
+	{
+		*next	=	end;
+	}
+
+	// (float) of the correctly rounded double, as (float)atof() did
+	double value;
+	if (!ParseDecimal(str, end, value))
+	{
+		value	=	LocaleFreeStrtod(str, end);
+	}
+	return (float)value;
+}
+
 /* flag values */
 #define FL_UNSIGNED   1       /* strtoul called */
 #define FL_NEG        2       /* negative sign found */
@@ -336,6 +589,22 @@ static inline	int	GetIntValue(const	char *str, const char	**next)
 
 		str	=	SkipWhitespace(str);
 
+		const	char *end	=	str;
+		while	(*end && !IsWhitespace(*end))
+		{
+			end++;
+		}
+
+		if ((end - str) < (MAXNUM - 1))
+		{
+			// strtol() stops at the end of the token anyway, no need to copy it
+			if (next)
+			{
+				*next	=	end;
+			}
+			return strtol(str, FL_UNSIGNED);
+		}
+
 		char dest[MAXNUM];
 		char *dst	=	dest;
 
@@ -382,6 +651,314 @@ void TestAsc2bin(void)
 }
 #endif
 
+// Large arrays of numbers (mesh vertices, heightfield samples) are split into chunks at whitespace and converted
+// on several threads. The first pass counts the tokens of each chunk, the second converts them straight into
+// their final slots, so the result is the same as the serial loop.
+#define	PARALLEL_MIN_SOURCE		(64*1024)
+#define	PARALLEL_CHUNK_SIZE		(32*1024)
+#define	PARALLEL_MAX_THREADS	8
+
+struct ParallelChunk
+{
+	const	char *begin;
+	const	char *end;
+	int	firstToken;
+	int	tokens;
+	bool failed;
+
+	const	Atype	*types;
+	const	int	*offsets;
+	int	cnt;
+	int	size;
+	int	maxTokens;
+	char *dest;
+	bool convert;
+};
+
+static void	RunChunk(ParallelChunk &chunk)
+{
+	const	char *source = chunk.begin;
+	int	token	=	chunk.firstToken;
+
+	while	(1)
+	{
+		source = SkipWhitespace(source);
+		if (source >= chunk.end || *source == 0)
+		{
+			break;
+		}
+
+		if (!chunk.convert)
+		{
+			const	char *start	=	source;
+			while	(*source &&	!IsWhitespace(*source))
+			{
+				source++;
+			}
+			if ((source - start) >= (MAXNUM - 1))
+			{
+				// the converters would not report where such a token ends
+				chunk.failed = true;
+				return;
+			}
+			token++;
+			continue;
+		}
+
+		if (token >= chunk.maxTokens)
+		{
+			break;
+		}
+
+		int	field	=	token	%	chunk.cnt;
+		char *dst	=	chunk.dest + (token / chunk.cnt) * chunk.size + chunk.offsets[field];
+		switch (chunk.types[field])
+		{
+			case AT_FLOAT:
+				*(float*)dst = GetFloatValue(source, &source);
+				break;
+			case AT_INT:
+				*(int*)dst = GetIntValue(source, &source);
+				break;
+			case AT_BYTE:
+				*dst = (char)GetIntValue(source, &source);
+				break;
+			case AT_SHORT:
+				*(short*)dst = (short)GetIntValue(source, &source);
+				break;
+			default:
+				break;
+		}
+		token++;
+	}
+	chunk.tokens = token - chunk.firstToken;
+}
+
+#ifdef NXU_ASC2BIN_THREADS
+
+struct ParallelTask
+{
+	void (*run)(void *data);
+	void *data;
+};
+
+#if (defined(WIN32) || defined(_WIN32)) && !defined(_XBOX)
+
+static DWORD WINAPI	TaskThread(void *userData)
+{
+	ParallelTask *task = (ParallelTask*)userData;
+	task->run(task->data);
+	return 0;
+}
+
+static int	GetHardwareThreadCount(void)
+{
+	SYSTEM_INFO	info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+}
+
+// Runs tasks 1..n-1 on their own threads and task 0 on the caller's
+static void	RunTasks(ParallelTask *tasks, int n)
+{
+	HANDLE threads[PARALLEL_MAX_THREADS];
+	for	(int i = 1; i < n; i++)
+	{
+		threads[i] = CreateThread(0, 0, TaskThread, &tasks[i], 0, 0);
+		if (threads[i] == 0)
+		{
+			tasks[i].run(tasks[i].data);
+		}
+	}
+	tasks[0].run(tasks[0].data);
+	for	(int i = 1; i < n; i++)
+	{
+		if (threads[i])
+		{
+			WaitForSingleObject(threads[i], INFINITE);
+			CloseHandle(threads[i]);
+		}
+	}
+}
+
+#else
+
+static void	*TaskThread(void *userData)
+{
+	ParallelTask *task = (ParallelTask*)userData;
+	task->run(task->data);
+	return 0;
+}
+
+static int	GetHardwareThreadCount(void)
+{
+	return (int)sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+// Runs tasks 1..n-1 on their own threads and task 0 on the caller's
+static void	RunTasks(ParallelTask *tasks, int n)
+{
+	pthread_t	threads[PARALLEL_MAX_THREADS];
+	bool started[PARALLEL_MAX_THREADS];
+	for	(int i = 1; i < n; i++)
+	{
+		started[i] = pthread_create(&threads[i], 0, TaskThread, &tasks[i]) == 0;
+		if (!started[i])
+		{
+			tasks[i].run(tasks[i].data);
+		}
+	}
+	tasks[0].run(tasks[0].data);
+	for	(int i = 1; i < n; i++)
+	{
+		if (started[i])
+		{
+			pthread_join(threads[i], 0);
+		}
+	}
+}
+
+#endif
+
+static void	RunChunkTask(void *data)
+{
+	RunChunk(*(ParallelChunk*)data);
+}
+
+static void	RunChunks(ParallelChunk *chunks, int n)
+{
+	ParallelTask tasks[PARALLEL_MAX_THREADS];
+	for	(int i = 0; i < n; i++)
+	{
+		tasks[i].run = RunChunkTask;
+		tasks[i].data	=	&chunks[i];
+	}
+	RunTasks(tasks, n);
+}
+
+// Converts 'count' records of 'size' bytes matching 'types' into dest. With dest null, converts every complete
+// record and allocates dest for them. Returns false when the source must be converted serially instead.
+static bool	ConvertParallel(const char *source, const Atype *types, int cnt, int size, int &count, char *&dest)
+{
+	if (cnt	<	1)
+	{
+		return false;
+	}
+	for	(int j = 0; j < cnt; j++)
+	{
+		if (types[j] != AT_FLOAT && types[j] != AT_INT && types[j] != AT_BYTE && types[j] != AT_SHORT)
+		{
+			return false;
+		}
+	}
+
+	size_t len = strlen(source);
+	if (len < PARALLEL_MIN_SOURCE)
+	{
+		return false;
+	}
+
+	int	n	=	GetHardwareThreadCount();
+	if ((size_t)n > len / PARALLEL_CHUNK_SIZE)
+	{
+		n	=	(int)(len / PARALLEL_CHUNK_SIZE);
+	}
+	if (n	>	PARALLEL_MAX_THREADS)
+	{
+		n	=	PARALLEL_MAX_THREADS;
+	}
+	if (n	<	2)
+	{
+		return false;
+	}
+
+	int	offsets[MAXARG];
+	int	offset = 0;
+	for	(int j = 0; j < cnt; j++)
+	{
+		offsets[j] = offset;
+		offset += (types[j] == AT_FLOAT || types[j] == AT_INT) ? 4 : (types[j] == AT_SHORT ? 2 : 1);
+	}
+
+	// Chunk boundaries are moved forward to the next whitespace so no token is split
+	ParallelChunk	chunks[PARALLEL_MAX_THREADS];
+	const	char *sourceEnd	=	source + len;
+	const	char *begin	=	source;
+	for	(int i = 0; i < n; i++)
+	{
+		const	char *end	=	(i == n - 1) ? sourceEnd : source + (len * (i + 1)) / n;
+		if (end < begin)
+		{
+			end	=	begin;
+		}
+		while	(*end && !IsWhitespace(*end))
+		{
+			end++;
+		}
+
+		ParallelChunk	&chunk = chunks[i];
+		chunk.begin	=	begin;
+		chunk.end	=	end;
+		chunk.firstToken = 0;
+		chunk.tokens = 0;
+		chunk.failed = false;
+		chunk.types	=	types;
+		chunk.offsets	=	offsets;
+		chunk.cnt	=	cnt;
+		chunk.size = size;
+		chunk.maxTokens	=	0;
+		chunk.dest = 0;
+		chunk.convert	=	false;
+		begin	=	end;
+	}
+
+	RunChunks(chunks, n);
+
+	int	total	=	0;
+	for	(int i = 0; i < n; i++)
+	{
+		if (chunks[i].failed)
+		{
+			return false;
+		}
+		chunks[i].firstToken = total;
+		chunks[i].convert	=	true;
+		total	+= chunks[i].tokens;
+	}
+
+	if (dest)
+	{
+		if (total	<	count	*	cnt)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		count	=	total	/	cnt;
+		int	reserve_count	=	count	<	16 ? 16 :	count;
+		dest = new char[reserve_count	*size];
+		memset(dest, 0,	reserve_count	*size);	// zero	out	memory
+	}
+
+	for	(int i = 0; i < n; i++)
+	{
+		chunks[i].maxTokens	=	count	*	cnt;
+		chunks[i].dest = dest;
+	}
+	RunChunks(chunks, n);
+	return true;
+}
+
+#else
+
+static bool	ConvertParallel(const char *, const Atype *, int, int, int &, char *&)
+{
+	return false;
+}
+
+#endif
+
 void *Asc2Bin(const	char *source,	const	int	count, const char	*spec, void	*dest)
 {
   if ( !source || !spec ) 
@@ -476,6 +1053,12 @@ void *Asc2Bin(const	char *source,	const	int	count, const char	*spec, void	*dest)
 	memset(dest, 0,	count	*size);	// zero	out	memory
 
 	char *dst	=	(char*)dest; //	where	we are storing the results
+	int	parallelCount	=	count;
+	if (ConvertParallel(source, types, cnt, size, parallelCount, dst))
+	{
+		return dest;
+	}
+
 	for	(int i = 0;	i	<	count && source; i++)
 	{
 		for	(int j = 0;	j	<	cnt && source; j++)
@@ -666,6 +1249,11 @@ void *Asc2Bin(const	char *source,	int	&count,	const	char *spec)
 		ctype++;
 	}
 
+	if (ConvertParallel(source, types, cnt, size, count, dest))
+	{
+		return dest;
+	}
+
 	int	reserve_count	=	16;
 
 	dest = new char[reserve_count	*size];
@@ -790,4 +1378,264 @@ void *Asc2Bin(const	char *source,	int	&count,	const	char *spec)
 	// return dest;
 }
 
+// Writes the digits of m times 10^-k, in plain notation for moderate magnitudes and scientific notation otherwise.
+static int	WriteDecimal(char *dest, NxU64 m, int k)
+{
+	while	(m && (m % 10) == 0)
+	{
+		m	/= 10;
+		k--;
+	}
+
+	char digits[24];
+	int	nd = 0;
+	do
+	{
+		digits[nd++] = (char)('0' + (int)(m % 10));
+		m	/= 10;
+	} while	(m);
+
+	char *p	=	dest;
+	int	e	=	nd - 1 - k;		// decimal exponent of the first digit
+	if (e >= -5 && e <= 8)
+	{
+		if (k <= 0)
+		{
+			for	(int i = nd - 1; i >= 0; i--)
+			{
+				*p++ = digits[i];
+			}
+			for	(int i = 0; i < -k; i++)
+			{
+				*p++ = '0';
+			}
+		}
+		else if	(k < nd)
+		{
+			for	(int i = nd - 1; i >= k; i--)
+			{
+				*p++ = digits[i];
+			}
+			*p++ = '.';
+			for	(int i = k - 1; i >= 0; i--)
+			{
+				*p++ = digits[i];
+			}
+		}
+		else
+		{
+			*p++ = '0';
+			*p++ = '.';
+			for	(int i = 0; i < k - nd; i++)
+			{
+				*p++ = '0';
+			}
+			for	(int i = nd - 1; i >= 0; i--)
+			{
+				*p++ = digits[i];
+			}
+		}
+	}
+	else
+	{
+		*p++ = digits[nd - 1];
+		if (nd > 1)
+		{
+			*p++ = '.';
+			for	(int i = nd - 2; i >= 0; i--)
+			{
+				*p++ = digits[i];
+			}
+		}
+		*p++ = 'e';
+		if (e < 0)
+		{
+			*p++ = '-';
+			e	=	-e;
+		}
+		if (e >= 10)
+		{
+			*p++ = (char)('0' + e / 10);
+		}
+		*p++ = (char)('0' + e % 10);
+	}
+	*p = 0;
+	return (int)(p - dest);
+}
+
+int	FloatToAsc(float v, char *dest)
+{
+	// nan, infinities and platforms that evaluate floats in extended precision use sprintf below
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+	if (v == v && v <= FLT_MAX && v >= -FLT_MAX)
+	{
+		char *p	=	dest;
+		double a = v;
+		if (a < 0 || (a == 0 && 1 / v < 0))
+		{
+			*p++ = '-';
+			a	=	-a;
+		}
+		if (a == 0)
+		{
+			*p++ = '0';
+			*p = 0;
+			return (int)(p - dest);
+		}
+
+		// The fewest digits that convert back to v the way ParseDecimal() does: one exactly rounded
+		// multiply or divide by an exact power of ten.
+		int	e10	=	(int)floor(log10(a));
+		for	(int digits = 1; digits <= 9; digits++)
+		{
+			int	k	=	digits - 1 - e10;
+			if (k > 22 || k < -22)
+			{
+				break;
+			}
+			double m = floor((k >= 0 ? a * gPow10[k] : a / gPow10[-k]) + 0.5);
+			double back	=	k >= 0 ? m / gPow10[k] : m * gPow10[-k];
+			if ((float)back == (float)a)
+			{
+				return (int)(p - dest) + WriteDecimal(p, (NxU64)m, k);
+			}
+		}
+	}
+#endif
+	// nine significant digits always round-trip a float
+	sprintf(dest, "%.9g", v);
+	return (int)strlen(dest);
+}
+
+#define	BIN2ASC_CHUNK_VALUES	(16*1024)
+
+struct FormatChunk
+{
+	const	void *source;
+	char type;
+	int	first;
+	int	count;
+	int	perLine;
+	const	char *indent;
+	int	indentLength;
+	char *text;
+	int	length;
+};
+
+static void	RunFormatChunk(void *data)
+{
+	FormatChunk	&chunk = *(FormatChunk*)data;
+	chunk.text = new char[chunk.count * 25 + (chunk.count / chunk.perLine + 1) * (chunk.indentLength + 2) + 1];
+	char *p	=	chunk.text;
+	for	(int i = chunk.first; i < chunk.first + chunk.count; i++)
+	{
+		if (i)
+		{
+			if ((i % chunk.perLine) == 0)
+			{
+				*p++ = '\r';
+				*p++ = '\n';
+				memcpy(p, chunk.indent, chunk.indentLength);
+				p	+= chunk.indentLength;
+			}
+			else
+			{
+				*p++ = ' ';
+			}
+		}
+		if (chunk.type == 'f')
+		{
+			p	+= FloatToAsc(((const float*)chunk.source)[i], p);
+		}
+		else
+		{
+			p	+= sprintf(p, "%d", ((const int*)chunk.source)[i]);
+		}
+	}
+	*p = 0;
+	chunk.length = (int)(p - chunk.text);
+}
+
+char *Bin2Asc(const void *source, int count, char type, int perLine, const char *indent, int &len)
+{
+	FormatChunk	chunks[PARALLEL_MAX_THREADS];
+	int	n	=	1;
+
+	if (perLine	<	1)
+	{
+		perLine	=	count	>	0	?	count	:	1;
+	}
+
+#ifdef NXU_ASC2BIN_THREADS
+	n	=	GetHardwareThreadCount();
+	if (n	>	count	/	BIN2ASC_CHUNK_VALUES)
+	{
+		n	=	count	/	BIN2ASC_CHUNK_VALUES;
+	}
+	if (n	>	PARALLEL_MAX_THREADS)
+	{
+		n	=	PARALLEL_MAX_THREADS;
+	}
+	if (n	<	1)
+	{
+		n	=	1;
+	}
+#endif
+
+	// Chunks start on line boundaries so the layout doesn't depend on the number of threads
+	int	lines	=	(count + perLine - 1) / perLine;
+	int	first	=	0;
+	for	(int i = 0; i < n; i++)
+	{
+		int	end	=	(i == n - 1) ? count : (int)(((NxI64)lines * (i + 1)) / n) * perLine;
+		if (end	>	count)
+		{
+			end	=	count;
+		}
+		chunks[i].source = source;
+		chunks[i].type = type;
+		chunks[i].first	=	first;
+		chunks[i].count	=	end	-	first;
+		chunks[i].perLine	=	perLine;
+		chunks[i].indent = indent	?	indent : "";
+		chunks[i].indentLength = (int)strlen(chunks[i].indent);
+		chunks[i].text = 0;
+		chunks[i].length = 0;
+		first	=	end;
+	}
+
+#ifdef NXU_ASC2BIN_THREADS
+	if (n	>	1)
+	{
+		ParallelTask tasks[PARALLEL_MAX_THREADS];
+		for	(int i = 0; i < n; i++)
+		{
+			tasks[i].run = RunFormatChunk;
+			tasks[i].data	=	&chunks[i];
+		}
+		RunTasks(tasks, n);
+	}
+	else
+#endif
+	{
+		RunFormatChunk(&chunks[0]);
+	}
+
+	len	=	0;
+	for	(int i = 0; i < n; i++)
+	{
+		len	+= chunks[i].length;
+	}
+	char *ret	=	new char[len + 1];
+	char *dst	=	ret;
+	for	(int i = 0; i < n; i++)
+	{
+		memcpy(dst, chunks[i].text, chunks[i].length);
+		dst	+= chunks[i].length;
+		delete [] chunks[i].text;
+	}
+	*dst = 0;
+	return ret;
+}
+
 };
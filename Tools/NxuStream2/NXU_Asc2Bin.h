@@ -28,6 +28,13 @@ void *Asc2Bin(const	char *source,	const	int	count, const char	*ctype,	void *dest
 // sufficient	memory to	store	it.
 void *Asc2Bin(const	char *source,	int	&count,	const	char *ctype);
 
+// writes the shortest decimal text that Asc2Bin reads back as exactly 'v'.  'dest' needs 32 bytes, returns the length.
+int FloatToAsc(float v, char *dest);
+
+// converts 'count' floats (type 'f') or integers (type 'd') to text, 'perLine' values to a line and each line after
+// the first starting with 'indent'.  Large arrays are formatted on several threads.  Free the result with delete [].
+char *Bin2Asc(const void *source, int count, char type, int perLine, const char *indent, int &len);
+
 
 /* flag values */
 #define FL_UNSIGNED   1       /* strtoul called */
@@ -9,6 +9,7 @@
 #include "NXU_schema.h"
 #include "NXU_Geometry.h"
 #include "NXU_SchemaStream.h"
+#include "NXU_Asc2Bin.h"
 
 #ifdef _MSC_VER
 #pragma warning(disable:4996) // Disabling stupid .NET deprecated warning.
@@ -266,25 +267,8 @@ public:
   	}
   	else
   	{
-  		sprintf(ret, "%.9f", v);
-  		const	char *dot	=	strstr(ret,	".");
-  		if (dot)
-  		{
-  			int	len	=	(int)strlen(ret);
-  			char *foo	=	&ret[len - 1];
-  			while	(*foo	== '0')
-  			{
-  				foo--;
-  			}
-  			if (*foo ==	'.')
-  			{
-  				*foo = 0;
-  			}
-  			else
-  			{
-  				foo[1] = 0;
-  			}
-  		}
+  		// shortest text that reads back as exactly v
+  		FloatToAsc(v, ret);
   	}
 
   	return ret;
@@ -1044,17 +1028,11 @@ public:
     	nxu_fprintf(fph, "					<float_array count=\"%d\"	id=\"%s-Position-array\">\r\n",	vcount *3, name);
     	nxu_fprintf(fph, "						");
 
-    	for	(unsigned	int	i	=	0; i < vcount; i++)
-    	{
-    		const	float	*p = &vertices[i *3];
-    		nxu_fprintf(fph, "%s %s	%s	", fstring(p[0]),	fstring(p[1]), fstring(p[2]));
-
-    		if (((i	+	1) &3) ==	0	&& (i	+	1) < vcount)
-    		{
-    			nxu_fprintf(fph, "\r\n");
-    			nxu_fprintf(fph, "						");
-    		}
-    	}
+    	// formatted in one buffer, on several threads for large meshes
+    	int	len	=	0;
+    	char *text = Bin2Asc(vertices, vcount *3, 'f', 12, "						", len);
+    	nxu_fwrite(text, 1, len, fph);
+    	delete [] text;
 
     	nxu_fprintf(fph, "\r\n");
     	nxu_fprintf(fph, "					</float_array>\r\n");
@@ -1075,19 +1053,9 @@ public:
     	nxu_fprintf(fph, "					<input offset=\"0\"	semantic=\"VERTEX\"	source=\"#%s-Vertex\"/>\r\n",	name);
     	nxu_fprintf(fph, "				 <p>");
 
-    	if ( 1 )
-    	{
-      	for	(unsigned	int	i	=	0; i < tcount; i++)
-      	{
-      		const	unsigned int *idx	=	&indices[i *3];
-      		nxu_fprintf(fph, "%d %d	%d	", idx[0], idx[1], idx[2]);
-      		if (((i	+	1) &3) ==	0)
-      		{
-      			nxu_fprintf(fph, "\r\n");
-      			nxu_fprintf(fph, "				 ");
-      		}
-      	}
-      }
+    	text = Bin2Asc(indices, tcount *3, 'd', 12, "				 ", len);
+    	nxu_fwrite(text, 1, len, fph);
+    	delete [] text;
     	nxu_fprintf(fph, "</p>\r\n");
     	nxu_fprintf(fph, "				</triangles>\r\n");
 
@@ -0,0 +1,1334 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "NXU_DebugRecorder.h"
+#include "NXU_string.h"
+
+#include <NxPhysics.h>
+
+#if (defined(WIN32) || defined(_WIN32)) && !defined(_XBOX)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define NXU_DEBUG_RECORDER_THREADS
+#elif defined(LINUX) || defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sys/types.h>
+#define NXU_DEBUG_RECORDER_THREADS
+#endif
+
+namespace NXU
+{
+
+//==================================================================================
+// The file is a header, the events, and an index written when recording stops:
+//
+//   "NXUDBGREC\0" version reserved
+//   events, each an opcode byte and its fields; ids, indices and lengths are varints, everything else is little endian
+//   OP_END
+//   frame count, the offset of every frame, string count, every string as a length and its bytes
+//   the offset of OP_END, "NXUDBGIX"
+//==================================================================================
+
+#define RECORDER_MAGIC          "NXUDBGREC"
+#define RECORDER_VERSION        1
+#define RECORDER_HEADER_SIZE    12
+#define RECORDER_INDEX_MAGIC    "NXUDBGIX"
+#define RECORDER_FOOTER_SIZE    16
+
+#define OP_FRAME_BREAK          0x00
+#define OP_CREATE_OBJECT        0x01  // id, pointer, type byte, class name
+#define OP_REMOVE_OBJECT        0x02  // id
+#define OP_ADD_CHILD            0x03  // id, child id
+#define OP_REMOVE_CHILD         0x04  // id, child id
+#define OP_STRING               0x05  // index, length, bytes
+#define OP_END                  0x0F
+#define OP_PARAMETER            0x20  // | parameter type, | OP_CREATE when created: id, name, value
+#define OP_CREATE               0x80
+
+#define BLOCK_SIZE              (256*1024)  // blocks are handed to the writer when a frame ends or they fill up
+#define MAX_QUEUED_BLOCKS       64          // the simulation waits for the disk beyond this
+#define READ_BUFFER_SIZE        (64*1024)
+
+static NxU32 hashPointer(const void *p)
+{
+  NxU64 v = (NxU64)(size_t)p;
+  NxU32 h = (NxU32)(v^(v>>32))*2654435761u;
+  return h^(h>>15);
+}
+
+static NxU32 hashString(const char *str)
+{
+  NxU32 h = 2166136261u;
+  while ( *str )
+  {
+    h = (h^(unsigned char)*str++)*16777619u;
+  }
+  return h;
+}
+
+static bool fileSeek(FILE *fph,NxU64 loc,int mode)
+{
+#if defined(WIN32) || defined(_WIN32)
+  return _fseeki64(fph,(__int64)loc,mode) == 0;
+#elif defined(LINUX) || defined(__linux__) || defined(__APPLE__)
+  return fseeko(fph,(off_t)loc,mode) == 0;
+#else
+  return fseek(fph,(long)loc,mode) == 0;
+#endif
+}
+
+static NxU64 fileTell(FILE *fph)
+{
+#if defined(WIN32) || defined(_WIN32)
+  return (NxU64)_ftelli64(fph);
+#elif defined(LINUX) || defined(__linux__) || defined(__APPLE__)
+  return (NxU64)ftello(fph);
+#else
+  return (NxU64)ftell(fph);
+#endif
+}
+
+//==================================================================================
+// The writer thread and the lock and signals it shares with the recorder.
+//==================================================================================
+
+#define SIGNAL_WORK   0  // a block was queued, or the writer should stop
+#define SIGNAL_SPACE  1  // a block was written
+
+#ifdef NXU_DEBUG_RECORDER_THREADS
+
+#if (defined(WIN32) || defined(_WIN32)) && !defined(_XBOX)
+
+class RecorderSync
+{
+public:
+  RecorderSync(void)
+  {
+    InitializeCriticalSection(&mLock);
+    mSignals[SIGNAL_WORK]  = CreateEvent(0,FALSE,FALSE,0);
+    mSignals[SIGNAL_SPACE] = CreateEvent(0,FALSE,FALSE,0);
+    mThread = 0;
+  }
+
+  ~RecorderSync(void)
+  {
+    CloseHandle(mSignals[SIGNAL_WORK]);
+    CloseHandle(mSignals[SIGNAL_SPACE]);
+    DeleteCriticalSection(&mLock);
+  }
+
+  bool start(void (*run)(void *data),void *data)
+  {
+    mRun  = run;
+    mData = data;
+    if ( mSignals[SIGNAL_WORK] && mSignals[SIGNAL_SPACE] )
+      mThread = CreateThread(0,0,threadMain,this,0,0);
+    return mThread != 0;
+  }
+
+  void join(void)
+  {
+    WaitForSingleObject(mThread,INFINITE);
+    CloseHandle(mThread);
+    mThread = 0;
+  }
+
+  void lock(void)   { EnterCriticalSection(&mLock); };
+  void unlock(void) { LeaveCriticalSection(&mLock); };
+
+  // Called with the lock held. The events stay set until waited on, so a signal given before the wait isn't lost.
+  void wait(NxU32 signal)
+  {
+    LeaveCriticalSection(&mLock);
+    WaitForSingleObject(mSignals[signal],INFINITE);
+    EnterCriticalSection(&mLock);
+  }
+
+  void signal(NxU32 signal) { SetEvent(mSignals[signal]); };
+
+private:
+  static DWORD WINAPI threadMain(void *userData)
+  {
+    RecorderSync *sync = (RecorderSync *)userData;
+    sync->mRun(sync->mData);
+    return 0;
+  }
+
+  CRITICAL_SECTION  mLock;
+  HANDLE            mSignals[2];
+  HANDLE            mThread;
+  void            (*mRun)(void *data);
+  void             *mData;
+};
+
+#else
+
+class RecorderSync
+{
+public:
+  RecorderSync(void)
+  {
+    pthread_mutex_init(&mLock,0);
+    pthread_cond_init(&mSignals[SIGNAL_WORK],0);
+    pthread_cond_init(&mSignals[SIGNAL_SPACE],0);
+  }
+
+  ~RecorderSync(void)
+  {
+    pthread_cond_destroy(&mSignals[SIGNAL_WORK]);
+    pthread_cond_destroy(&mSignals[SIGNAL_SPACE]);
+    pthread_mutex_destroy(&mLock);
+  }
+
+  bool start(void (*run)(void *data),void *data)
+  {
+    mRun  = run;
+    mData = data;
+    return pthread_create(&mThread,0,threadMain,this) == 0;
+  }
+
+  void join(void) { pthread_join(mThread,0); };
+
+  void lock(void)   { pthread_mutex_lock(&mLock); };
+  void unlock(void) { pthread_mutex_unlock(&mLock); };
+
+  // Called with the lock held, and always in a loop testing what was waited for.
+  void wait(NxU32 signal) { pthread_cond_wait(&mSignals[signal],&mLock); };
+
+  void signal(NxU32 signal) { pthread_cond_signal(&mSignals[signal]); };
+
+private:
+  static void *threadMain(void *userData)
+  {
+    RecorderSync *sync = (RecorderSync *)userData;
+    sync->mRun(sync->mData);
+    return 0;
+  }
+
+  pthread_mutex_t   mLock;
+  pthread_cond_t    mSignals[2];
+  pthread_t         mThread;
+  void            (*mRun)(void *data);
+  void             *mData;
+};
+
+#endif
+
+#else
+
+class RecorderSync
+{
+};
+
+#endif
+
+//==================================================================================
+// NxuDebugRecorder
+//==================================================================================
+
+NxuDebugRecorder::NxuDebugRecorder(void)
+{
+  mFile           = 0;
+  mMask           = NX_DBG_EVENTMASK_EVERYTHING;
+  mFrame          = 0;
+  mSubmitted      = 0;
+  mBlock          = 0;
+  mWriteFailed    = false;
+  mObjects        = 0;
+  mObjectCapacity = 0;
+  mObjectCount    = 0;
+  mNextObjectId   = 1;
+  mStamp          = 0;
+  mStrings        = 0;
+  mStringCapacity = 0;
+  mSync           = 0;
+  mWriting        = false;
+  mStop           = false;
+}
+
+NxuDebugRecorder::~NxuDebugRecorder(void)
+{
+  close();
+  if ( mBlock ) freeBlock(mBlock);
+  for (NxU32 i=0; i<mFreeBlocks.size(); i++)
+  {
+    delete []mFreeBlocks[i]->mData;
+    delete mFreeBlocks[i];
+  }
+}
+
+bool NxuDebugRecorder::open(const char *fname,NxU32 eventMask)
+{
+  close();
+
+  mFile = fname ? fopen(fname,"wb") : 0;
+  if ( !mFile )
+  {
+    reportError("Unable to open debug recording '%s' for writing", fname ? fname : "");
+    return false;
+  }
+
+  mFrame        = 0;
+  mSubmitted    = 0;
+  mWriteFailed  = false;
+  mNextObjectId = 1;
+  mStop         = false;
+  mWriting      = false;
+  if ( !mBlock ) mBlock = getBlock();
+
+  reserve(RECORDER_HEADER_SIZE);
+  putBytes(RECORDER_MAGIC,10);
+  putByte(RECORDER_VERSION);
+  putByte(0);
+  mFrameOffsets.push_back(RECORDER_HEADER_SIZE);
+
+#ifdef NXU_DEBUG_RECORDER_THREADS
+  mSync = new RecorderSync;
+  if ( !mSync->start(writerThread,this) )
+  {
+    delete mSync;  // record without the thread
+    mSync = 0;
+  }
+#endif
+
+  setMask(eventMask);
+  for (NxU32 i=0; i<mListeners.size(); i++)
+  {
+    mListeners[i]->onConnect();
+  }
+  return true;
+}
+
+void NxuDebugRecorder::close(void)
+{
+  if ( !mFile ) return;
+
+  for (NxU32 i=0; i<mListeners.size(); i++)
+  {
+    mListeners[i]->onDisconnect();
+  }
+
+  reserve(1);
+  NxU64 end = mSubmitted+mBlock->mSize;
+  putByte(OP_END);
+
+  reserve(8+mFrameOffsets.size()*8);
+  putU32(mFrameOffsets.size());
+  for (NxU32 i=0; i<mFrameOffsets.size(); i++)
+  {
+    putU32((NxU32)mFrameOffsets[i]);
+    putU32((NxU32)(mFrameOffsets[i]>>32));
+  }
+  putU32(mStringTable.size());
+  for (NxU32 i=0; i<mStringTable.size(); i++)
+  {
+    NxU32 len = (NxU32)strlen(mStringTable[i]);
+    reserve(4+len);
+    putU32(len);
+    putBytes(mStringTable[i],len);
+  }
+  reserve(RECORDER_FOOTER_SIZE);
+  putU32((NxU32)end);
+  putU32((NxU32)(end>>32));
+  putBytes(RECORDER_INDEX_MAGIC,8);
+  submit();
+
+#ifdef NXU_DEBUG_RECORDER_THREADS
+  if ( mSync )
+  {
+    mSync->lock();
+    mStop = true;
+    mSync->signal(SIGNAL_WORK);
+    mSync->unlock();
+    mSync->join();
+    delete mSync;
+    mSync = 0;
+  }
+#endif
+
+  if ( fclose(mFile) != 0 ) mWriteFailed = true;
+  mFile = 0;
+  if ( mWriteFailed )
+  {
+    reportError("Failed to write the debug recording, it is incomplete");
+  }
+
+  delete []mObjects;
+  mObjects        = 0;
+  mObjectCapacity = 0;
+  mObjectCount    = 0;
+  for (NxU32 i=0; i<mStringTable.size(); i++)
+  {
+    delete []mStringTable[i];
+  }
+  mStringTable.clear();
+  delete []mStrings;
+  mStrings        = 0;
+  mStringCapacity = 0;
+  mFrameOffsets.clear();
+  mSceneActors.clear();
+  mSceneScratch.clear();
+}
+
+void NxuDebugRecorder::connect(const char *fname,unsigned int /*port*/,NxU32 eventMask)
+{
+  open(fname,eventMask);
+}
+
+void NxuDebugRecorder::disconnect(void)
+{
+  close();
+}
+
+bool NxuDebugRecorder::isConnected(void)
+{
+  return mFile != 0;
+}
+
+// Returns once everything recorded so far is on disk.
+void NxuDebugRecorder::flush(void)
+{
+  if ( !mFile ) return;
+  submit();
+#ifdef NXU_DEBUG_RECORDER_THREADS
+  if ( mSync )
+  {
+    mSync->lock();
+    while ( mQueue.size() || mWriting )
+    {
+      mSync->wait(SIGNAL_SPACE);
+    }
+    mSync->unlock();
+    return;
+  }
+#endif
+  fflush(mFile);
+}
+
+void NxuDebugRecorder::setMask(NxU32 mask)
+{
+  NxU32 oldMask = mMask;
+  for (NxU32 i=0; i<mListeners.size(); i++)
+  {
+    mListeners[i]->beforeMaskChange(oldMask,mask);
+  }
+  mMask = mask;
+  for (NxU32 i=0; i<mListeners.size(); i++)
+  {
+    mListeners[i]->afterMaskChange(oldMask,mask);
+  }
+}
+
+NxU32 NxuDebugRecorder::getMask(void)
+{
+  return mMask;
+}
+
+void NxuDebugRecorder::registerEventListener(NxRemoteDebuggerEventListener *eventListener)
+{
+  for (NxU32 i=0; i<mListeners.size(); i++)
+  {
+    if ( mListeners[i] == eventListener ) return;
+  }
+  mListeners.push_back(eventListener);
+}
+
+void NxuDebugRecorder::unregisterEventListener(NxRemoteDebuggerEventListener *eventListener)
+{
+  for (NxU32 i=0; i<mListeners.size(); i++)
+  {
+    if ( mListeners[i] == eventListener )
+    {
+      mListeners.erase(&mListeners[i],&mListeners[i]+1);
+      break;
+    }
+  }
+}
+
+void NxuDebugRecorder::frameBreak(void)
+{
+  if ( !mFile ) return;
+  reserve(1);
+  putByte(OP_FRAME_BREAK);
+  mFrame++;
+  mFrameOffsets.push_back(mSubmitted+mBlock->mSize);
+  submit();
+}
+
+void NxuDebugRecorder::createObject(void *object,NxRemoteDebuggerObjectType type,const char *className,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  NxU32 name = stringIndex(className);
+  NxU32 id   = newObjectId(object);
+  reserve(1+5+10+1+5);
+  putByte(OP_CREATE_OBJECT);
+  putVarint(id);
+  putVarint((NxU64)(size_t)object);
+  putByte((NxU8)type);
+  putVarint(name);
+}
+
+void NxuDebugRecorder::removeObject(void *object,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  NxU32 id = objectId(object);
+  reserve(1+5);
+  putByte(OP_REMOVE_OBJECT);
+  putVarint(id);
+  forgetObject(object);
+}
+
+void NxuDebugRecorder::addChild(void *object,void *child,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  NxU32 id      = objectId(object);
+  NxU32 childId = objectId(child);
+  reserve(1+5+5);
+  putByte(OP_ADD_CHILD);
+  putVarint(id);
+  putVarint(childId);
+}
+
+void NxuDebugRecorder::removeChild(void *object,void *child,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  NxU32 id      = objectId(object);
+  NxU32 childId = objectId(child);
+  reserve(1+5+5);
+  putByte(OP_REMOVE_CHILD);
+  putVarint(id);
+  putVarint(childId);
+}
+
+// Writes the opcode, object and name of a parameter and makes room for 'extra' bytes of value.
+void NxuDebugRecorder::beginParameter(NxU8 type,void *object,bool create,const char *name,NxU32 extra)
+{
+  NxU32 nameIndex = stringIndex(name);
+  NxU32 id        = objectId(object);
+  reserve(1+5+5+extra);
+  putByte((NxU8)(OP_PARAMETER | type | (create ? OP_CREATE : 0)));
+  putVarint(id);
+  putVarint(nameIndex);
+}
+
+void NxuDebugRecorder::writeParameter(const NxReal &parameter,void *object,bool create,const char *name,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  beginParameter(NXU_DBG_PARAM_REAL,object,create,name,4);
+  putFloat(parameter);
+}
+
+void NxuDebugRecorder::writeParameter(const NxU32 &parameter,void *object,bool create,const char *name,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  beginParameter(NXU_DBG_PARAM_U32,object,create,name,5);
+  putVarint(parameter);
+}
+
+void NxuDebugRecorder::writeParameter(const NxVec3 &parameter,void *object,bool create,const char *name,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  beginParameter(NXU_DBG_PARAM_VEC3,object,create,name,12);
+  putFloat(parameter.x);
+  putFloat(parameter.y);
+  putFloat(parameter.z);
+}
+
+void NxuDebugRecorder::writeParameter(const NxPlane &parameter,void *object,bool create,const char *name,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  beginParameter(NXU_DBG_PARAM_PLANE,object,create,name,16);
+  putFloat(parameter.normal.x);
+  putFloat(parameter.normal.y);
+  putFloat(parameter.normal.z);
+  putFloat(parameter.d);
+}
+
+void NxuDebugRecorder::writeParameter(const NxMat34 &parameter,void *object,bool create,const char *name,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  NxF32 m[9];
+  parameter.M.getRowMajor(m);
+  beginParameter(NXU_DBG_PARAM_MAT34,object,create,name,48);
+  putFloats(m,9);
+  putFloat(parameter.t.x);
+  putFloat(parameter.t.y);
+  putFloat(parameter.t.z);
+}
+
+void NxuDebugRecorder::writeParameter(const NxMat33 &parameter,void *object,bool create,const char *name,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  NxF32 m[9];
+  parameter.getRowMajor(m);
+  beginParameter(NXU_DBG_PARAM_MAT33,object,create,name,36);
+  putFloats(m,9);
+}
+
+void NxuDebugRecorder::writeParameter(const NxU8 *parameter,void *object,bool create,const char *name,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  NxU32 len = 0;
+  if ( parameter )
+  {
+    memcpy(&len,parameter,sizeof(NxU32));
+    if ( len < sizeof(NxU32) ) len = sizeof(NxU32);
+  }
+  beginParameter(NXU_DBG_PARAM_BINARY,object,create,name,5+len);
+  putVarint(len);
+  putBytes(parameter,len);
+}
+
+void NxuDebugRecorder::writeParameter(const char *parameter,void *object,bool create,const char *name,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  NxU32 len = parameter ? (NxU32)strlen(parameter) : 0;
+  beginParameter(NXU_DBG_PARAM_STRING,object,create,name,5+len);
+  putVarint(len);
+  putBytes(parameter,len);
+}
+
+void NxuDebugRecorder::writeParameter(const bool &parameter,void *object,bool create,const char *name,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  beginParameter(NXU_DBG_PARAM_BOOL,object,create,name,1);
+  putByte(parameter ? 1 : 0);
+}
+
+void NxuDebugRecorder::writeParameter(const void *parameter,void *object,bool create,const char *name,NxU32 mask)
+{
+  if ( !wants(mask) ) return;
+  NxU32 value = objectId(parameter);
+  beginParameter(NXU_DBG_PARAM_OBJECT,object,create,name,5);
+  putVarint(value);
+}
+
+void NxuDebugRecorder::recordScene(NxScene &scene)
+{
+  if ( !wants(NX_DBG_EVENTGROUP_BASIC_OBJECTS) ) return;
+
+  mStamp++;
+  if ( mStamp == 0 ) mStamp = 1;
+
+  mSceneScratch.clear();
+  NxU32 count    = scene.getNbActors();
+  NxActor **list = scene.getActors();
+  for (NxU32 i=0; i<count; i++)
+  {
+    NxActor *a = list[i];
+    if ( !a->isDynamic() ) continue;
+
+    bool create = findObject(a) == 0;
+    if ( create ) createObject(a,NX_DBG_OBJECTTYPE_ACTOR,"NxActor",NX_DBG_EVENTGROUP_BASIC_OBJECTS);
+    findObject(a)->mStamp = mStamp;
+    mSceneScratch.push_back(a);
+
+    writeParameter(a->getGlobalPose(),a,create,"GlobalPose",NX_DBG_EVENTGROUP_BASIC_OBJECTS_DYNAMIC_DATA);
+    writeParameter(a->getLinearVelocity(),a,create,"LinearVelocity",NX_DBG_EVENTGROUP_BASIC_OBJECTS_DYNAMIC_DATA);
+    writeParameter(a->getAngularVelocity(),a,create,"AngularVelocity",NX_DBG_EVENTGROUP_BASIC_OBJECTS_DYNAMIC_DATA);
+    bool sleeping = a->isSleeping();
+    writeParameter(sleeping,a,create,"Sleeping",NX_DBG_EVENTGROUP_BASIC_OBJECTS_DYNAMIC_DATA);
+  }
+
+  for (NxU32 i=0; i<mSceneActors.size(); i++)
+  {
+    ObjectSlot *s = findObject(mSceneActors[i]);
+    if ( s && s->mStamp != mStamp ) removeObject(mSceneActors[i],NX_DBG_EVENTGROUP_BASIC_OBJECTS);
+  }
+
+  mSceneActors.clear();
+  for (NxU32 i=0; i<mSceneScratch.size(); i++)
+  {
+    mSceneActors.push_back(mSceneScratch[i]);
+  }
+}
+
+//==================================================================================
+// Encoding into the current block
+//==================================================================================
+
+void NxuDebugRecorder::reserve(NxU32 bytes)
+{
+  if ( mBlock->mSize+bytes > mBlock->mCapacity )
+  {
+    submit();
+    if ( bytes > mBlock->mCapacity )
+    {
+      delete []mBlock->mData;
+      mBlock->mData     = new NxU8[bytes];
+      mBlock->mCapacity = bytes;
+    }
+  }
+}
+
+void NxuDebugRecorder::putU32(NxU32 v)
+{
+  NxU8 *dest = &mBlock->mData[mBlock->mSize];
+  dest[0] = (NxU8)v;
+  dest[1] = (NxU8)(v>>8);
+  dest[2] = (NxU8)(v>>16);
+  dest[3] = (NxU8)(v>>24);
+  mBlock->mSize+=4;
+}
+
+void NxuDebugRecorder::putFloat(NxF32 v)
+{
+  NxU32 bits;
+  memcpy(&bits,&v,sizeof(bits));
+  putU32(bits);
+}
+
+void NxuDebugRecorder::putFloats(const NxF32 *v,NxU32 count)
+{
+  for (NxU32 i=0; i<count; i++)
+  {
+    putFloat(v[i]);
+  }
+}
+
+void NxuDebugRecorder::putVarint(NxU64 v)
+{
+  while ( v >= 0x80 )
+  {
+    putByte((NxU8)(v|0x80));
+    v>>=7;
+  }
+  putByte((NxU8)v);
+}
+
+void NxuDebugRecorder::putBytes(const void *data,NxU32 len)
+{
+  if ( len )
+  {
+    memcpy(&mBlock->mData[mBlock->mSize],data,len);
+    mBlock->mSize+=len;
+  }
+}
+
+//==================================================================================
+// Interning of object pointers and strings, in open addressed tables kept at most half full
+//==================================================================================
+
+NxuDebugRecorder::ObjectSlot * NxuDebugRecorder::findObject(const void *object)
+{
+  if ( mObjectCount && object )
+  {
+    NxU32 s = hashPointer(object) & (mObjectCapacity-1);
+    while ( mObjects[s].mKey )
+    {
+      if ( mObjects[s].mKey == object ) return &mObjects[s];
+      s = (s+1)&(mObjectCapacity-1);
+    }
+  }
+  return 0;
+}
+
+NxU32 NxuDebugRecorder::objectId(const void *object)
+{
+  if ( !object ) return 0;
+  ObjectSlot *slot = findObject(object);
+  return slot ? slot->mId : newObjectId(object);
+}
+
+NxU32 NxuDebugRecorder::newObjectId(const void *object)
+{
+  if ( !object ) return 0;
+  NxU32 id = mNextObjectId++;
+  ObjectSlot *slot = findObject(object);
+  if ( slot )
+  {
+    slot->mId    = id;
+    slot->mStamp = 0;
+    return id;
+  }
+
+  if ( (mObjectCount+1)*2 > mObjectCapacity )
+  {
+    ObjectSlot *old = mObjects;
+    NxU32 oldCapacity = mObjectCapacity;
+    mObjectCapacity = mObjectCapacity ? mObjectCapacity*2 : 256;
+    mObjects = new ObjectSlot[mObjectCapacity];
+    memset(mObjects,0,sizeof(ObjectSlot)*mObjectCapacity);
+    for (NxU32 i=0; i<oldCapacity; i++)
+    {
+      if ( old[i].mKey )
+      {
+        NxU32 s = hashPointer(old[i].mKey) & (mObjectCapacity-1);
+        while ( mObjects[s].mKey ) s = (s+1)&(mObjectCapacity-1);
+        mObjects[s] = old[i];
+      }
+    }
+    delete []old;
+  }
+
+  NxU32 s = hashPointer(object) & (mObjectCapacity-1);
+  while ( mObjects[s].mKey ) s = (s+1)&(mObjectCapacity-1);
+  mObjects[s].mKey   = object;
+  mObjects[s].mId    = id;
+  mObjects[s].mStamp = 0;
+  mObjectCount++;
+  return id;
+}
+
+// Removed objects are dropped from the table so it doesn't grow with every object ever created. The entries
+// after the hole are shifted back so lookups never stop early.
+void NxuDebugRecorder::forgetObject(const void *object)
+{
+  ObjectSlot *slot = findObject(object);
+  if ( !slot ) return;
+
+  NxU32 mask = mObjectCapacity-1;
+  NxU32 hole = (NxU32)(slot-mObjects);
+  NxU32 next = hole;
+  for (;;)
+  {
+    next = (next+1)&mask;
+    if ( !mObjects[next].mKey ) break;
+    NxU32 home = hashPointer(mObjects[next].mKey) & mask;
+    bool inPlace = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+    if ( !inPlace )
+    {
+      mObjects[hole] = mObjects[next];
+      hole = next;
+    }
+  }
+  mObjects[hole].mKey = 0;
+  mObjectCount--;
+}
+
+NxU32 NxuDebugRecorder::stringIndex(const char *str)
+{
+  if ( !str ) str = "";
+  NxU32 hash = hashString(str);
+  if ( mStringCapacity )
+  {
+    NxU32 s = hash & (mStringCapacity-1);
+    while ( mStrings[s].mKey )
+    {
+      if ( mStrings[s].mHash == hash && strcmp(mStrings[s].mKey,str) == 0 ) return mStrings[s].mIndex;
+      s = (s+1)&(mStringCapacity-1);
+    }
+  }
+
+  if ( (mStringTable.size()+1)*2 > mStringCapacity )
+  {
+    StringSlot *old = mStrings;
+    NxU32 oldCapacity = mStringCapacity;
+    mStringCapacity = mStringCapacity ? mStringCapacity*2 : 64;
+    mStrings = new StringSlot[mStringCapacity];
+    memset(mStrings,0,sizeof(StringSlot)*mStringCapacity);
+    for (NxU32 i=0; i<oldCapacity; i++)
+    {
+      if ( old[i].mKey )
+      {
+        NxU32 s = old[i].mHash & (mStringCapacity-1);
+        while ( mStrings[s].mKey ) s = (s+1)&(mStringCapacity-1);
+        mStrings[s] = old[i];
+      }
+    }
+    delete []old;
+  }
+
+  NxU32 len   = (NxU32)strlen(str);
+  NxU32 index = mStringTable.size();
+  char *copy  = new char[len+1];
+  memcpy(copy,str,len+1);
+  mStringTable.push_back(copy);
+
+  NxU32 s = hash & (mStringCapacity-1);
+  while ( mStrings[s].mKey ) s = (s+1)&(mStringCapacity-1);
+  mStrings[s].mKey   = copy;
+  mStrings[s].mHash  = hash;
+  mStrings[s].mIndex = index;
+
+  reserve(1+5+5+len);
+  putByte(OP_STRING);
+  putVarint(index);
+  putVarint(len);
+  putBytes(str,len);
+  return index;
+}
+
+//==================================================================================
+// Handing blocks to the writer
+//==================================================================================
+
+NxuDebugRecorder::Block * NxuDebugRecorder::getBlock(void)
+{
+  Block *b;
+  if ( mFreeBlocks.size() )
+  {
+    b = mFreeBlocks.back();
+    mFreeBlocks.popBack();
+  }
+  else
+  {
+    b = new Block;
+    b->mData     = new NxU8[BLOCK_SIZE];
+    b->mCapacity = BLOCK_SIZE;
+  }
+  b->mSize = 0;
+  return b;
+}
+
+void NxuDebugRecorder::freeBlock(Block *b)
+{
+  if ( b->mCapacity > BLOCK_SIZE ) // grown for one large parameter, don't keep it around
+  {
+    delete []b->mData;
+    b->mData     = new NxU8[BLOCK_SIZE];
+    b->mCapacity = BLOCK_SIZE;
+  }
+  mFreeBlocks.push_back(b);
+}
+
+void NxuDebugRecorder::writeBlock(Block *b)
+{
+  if ( !mWriteFailed && fwrite(b->mData,1,b->mSize,mFile) != b->mSize )
+  {
+    mWriteFailed = true;
+  }
+}
+
+void NxuDebugRecorder::submit(void)
+{
+  if ( !mBlock->mSize ) return;
+  mSubmitted+=mBlock->mSize;
+#ifdef NXU_DEBUG_RECORDER_THREADS
+  if ( mSync )
+  {
+    mSync->lock();
+    while ( mQueue.size() >= MAX_QUEUED_BLOCKS )
+    {
+      mSync->wait(SIGNAL_SPACE);
+    }
+    mQueue.push_back(mBlock);
+    mSync->signal(SIGNAL_WORK);
+    mBlock = getBlock();
+    mSync->unlock();
+    return;
+  }
+#endif
+  writeBlock(mBlock);
+  mBlock->mSize = 0;
+}
+
+#ifdef NXU_DEBUG_RECORDER_THREADS
+
+void NxuDebugRecorder::writerThread(void *data)
+{
+  ((NxuDebugRecorder *)data)->writerLoop();
+}
+
+// Writes the queued blocks in order, and flushes the file whenever the queue runs dry so a crash loses at most
+// the frames still queued.
+void NxuDebugRecorder::writerLoop(void)
+{
+  mSync->lock();
+  for (;;)
+  {
+    while ( !mQueue.size() && !mStop )
+    {
+      mSync->wait(SIGNAL_WORK);
+    }
+    if ( !mQueue.size() ) break;
+
+    Block *b = mQueue[0];
+    mQueue.erase(&mQueue[0],&mQueue[0]+1);
+    mWriting = true;
+    mSync->unlock();
+
+    writeBlock(b);
+
+    mSync->lock();
+    if ( !mQueue.size() )
+    {
+      mSync->unlock();
+      fflush(mFile);
+      mSync->lock();
+    }
+    freeBlock(b);
+    mWriting = false;
+    mSync->signal(SIGNAL_SPACE);
+  }
+  mSync->unlock();
+}
+
+#else
+
+void NxuDebugRecorder::writerThread(void * /*data*/)
+{
+}
+
+void NxuDebugRecorder::writerLoop(void)
+{
+}
+
+#endif
+
+//==================================================================================
+// NxuDebugReader
+//==================================================================================
+
+NxuDebugReader::NxuDebugReader(void)
+{
+  mFile         = 0;
+  mEnd          = 0;
+  mBufferOffset = 0;
+  mBuffer       = 0;
+  mBufferPos    = 0;
+  mBufferLen    = 0;
+  mFrame        = 0;
+}
+
+NxuDebugReader::~NxuDebugReader(void)
+{
+  close();
+}
+
+bool NxuDebugReader::open(const char *fname)
+{
+  close();
+
+  mFile = fname ? fopen(fname,"rb") : 0;
+  if ( !mFile )
+  {
+    reportError("Unable to open debug recording '%s'", fname ? fname : "");
+    return false;
+  }
+
+  NxU64 size = 0;
+  if ( fileSeek(mFile,0,SEEK_END) ) size = fileTell(mFile);
+
+  mBuffer = new NxU8[READ_BUFFER_SIZE];
+  mEnd    = size;
+
+  char header[RECORDER_HEADER_SIZE];
+  bool ok = size >= RECORDER_HEADER_SIZE && seek(0);
+  for (NxU32 i=0; ok && i<RECORDER_HEADER_SIZE; i++)
+  {
+    NxU8 c;
+    ok = getByte(c);
+    header[i] = (char)c;
+  }
+  if ( !ok || memcmp(header,RECORDER_MAGIC,10) != 0 || header[10] != RECORDER_VERSION )
+  {
+    reportError("'%s' is not a debug recording", fname);
+    close();
+    return false;
+  }
+
+  if ( !readIndex(size) ) scan();
+
+  return seekFrame(0);
+}
+
+void NxuDebugReader::close(void)
+{
+  if ( mFile )
+  {
+    fclose(mFile);
+    mFile = 0;
+  }
+  delete []mBuffer;
+  mBuffer    = 0;
+  mBufferPos = 0;
+  mBufferLen = 0;
+  mEnd       = 0;
+  mFrame     = 0;
+  for (NxU32 i=0; i<mStrings.size(); i++)
+  {
+    delete []mStrings[i];
+  }
+  mStrings.clear();
+  mFrameOffsets.clear();
+  mScratch.clear();
+}
+
+bool NxuDebugReader::seekFrame(NxU32 frame)
+{
+  if ( !mFile || frame >= mFrameOffsets.size() ) return false;
+  mFrame = frame;
+  return seek(mFrameOffsets[frame]);
+}
+
+bool NxuDebugReader::readEvent(NxuDebugEvent &event)
+{
+  return mFile && decode(event);
+}
+
+// Loads the frame offsets and strings written by NxuDebugRecorder::close. Fails on a recording that was never
+// closed.
+bool NxuDebugReader::readIndex(NxU64 fileSize)
+{
+  if ( fileSize < RECORDER_HEADER_SIZE+1+RECORDER_FOOTER_SIZE ) return false;
+
+  NxU32 lo,hi;
+  char magic[8];
+  bool ok = seek(fileSize-RECORDER_FOOTER_SIZE) && getU32(lo) && getU32(hi);
+  for (NxU32 i=0; ok && i<8; i++)
+  {
+    NxU8 c;
+    ok = getByte(c);
+    magic[i] = (char)c;
+  }
+  if ( !ok || memcmp(magic,RECORDER_INDEX_MAGIC,8) != 0 ) return false;
+
+  NxU64 end = (NxU64)lo | ((NxU64)hi<<32);
+  if ( end < RECORDER_HEADER_SIZE || end >= fileSize-RECORDER_FOOTER_SIZE ) return false;
+
+  NxU8 op;
+  NxU32 frames = 0;
+  ok = seek(end) && getByte(op) && op == OP_END && getU32(frames) && frames && (NxU64)frames*8 <= fileSize-end;
+  NxU64 last = RECORDER_HEADER_SIZE;
+  for (NxU32 i=0; ok && i<frames; i++)
+  {
+    ok = getU32(lo) && getU32(hi);
+    NxU64 offset = (NxU64)lo | ((NxU64)hi<<32);
+    ok = ok && offset >= last && offset <= end;
+    last = offset;
+    mFrameOffsets.push_back(offset);
+  }
+  ok = ok && mFrameOffsets[0] == RECORDER_HEADER_SIZE;
+
+  NxU32 strings = 0;
+  ok = ok && getU32(strings) && (NxU64)strings*4 <= fileSize-end;
+  for (NxU32 i=0; ok && i<strings; i++)
+  {
+    NxU32 len;
+    ok = getU32(len) && len <= fileSize-end && getBytes(mScratch,len);
+    if ( ok )
+    {
+      char *str = new char[len+1];
+      if ( len ) memcpy(str,&mScratch[0],len);
+      str[len] = 0;
+      mStrings.push_back(str);
+    }
+  }
+
+  if ( !ok )
+  {
+    for (NxU32 i=0; i<mStrings.size(); i++)
+    {
+      delete []mStrings[i];
+    }
+    mStrings.clear();
+    mFrameOffsets.clear();
+    return false;
+  }
+
+  mEnd = end;
+  return true;
+}
+
+// Rebuilds the index of a recording that was cut short by reading it through. The events end at the first one
+// that didn't make it to disk whole.
+void NxuDebugReader::scan(void)
+{
+  mFrameOffsets.clear();
+  mFrameOffsets.push_back(RECORDER_HEADER_SIZE);
+  mFrame = 0;
+  seek(RECORDER_HEADER_SIZE);
+  for (;;)
+  {
+    NxU64 at = mBufferOffset+mBufferPos;
+    NxuDebugEvent event;
+    if ( !decode(event) )
+    {
+      mEnd = at;
+      break;
+    }
+    if ( event.mType == NXU_DBG_FRAME_BREAK )
+    {
+      mFrameOffsets.push_back(mBufferOffset+mBufferPos);
+    }
+  }
+}
+
+bool NxuDebugReader::seek(NxU64 offset)
+{
+  mBufferOffset = offset;
+  mBufferPos    = 0;
+  mBufferLen    = 0;
+  return fileSeek(mFile,offset,SEEK_SET);
+}
+
+bool NxuDebugReader::fill(void)
+{
+  mBufferOffset+=mBufferLen;
+  mBufferPos = 0;
+  mBufferLen = 0;
+  if ( mBufferOffset >= mEnd ) return false;
+  NxU64 want = mEnd-mBufferOffset;
+  if ( want > READ_BUFFER_SIZE ) want = READ_BUFFER_SIZE;
+  mBufferLen = (NxU32)fread(mBuffer,1,(size_t)want,mFile);
+  return mBufferLen != 0;
+}
+
+bool NxuDebugReader::getByte(NxU8 &v)
+{
+  if ( mBufferPos == mBufferLen && !fill() ) return false;
+  v = mBuffer[mBufferPos++];
+  return true;
+}
+
+bool NxuDebugReader::getU32(NxU32 &v)
+{
+  NxU8 b[4];
+  if ( !getByte(b[0]) || !getByte(b[1]) || !getByte(b[2]) || !getByte(b[3]) ) return false;
+  v = (NxU32)b[0] | ((NxU32)b[1]<<8) | ((NxU32)b[2]<<16) | ((NxU32)b[3]<<24);
+  return true;
+}
+
+bool NxuDebugReader::getFloat(NxF32 &v)
+{
+  NxU32 bits;
+  if ( !getU32(bits) ) return false;
+  memcpy(&v,&bits,sizeof(v));
+  return true;
+}
+
+bool NxuDebugReader::getVarint(NxU64 &v)
+{
+  v = 0;
+  for (NxU32 shift=0; shift<64; shift+=7)
+  {
+    NxU8 b;
+    if ( !getByte(b) ) return false;
+    v|=(NxU64)(b&0x7F)<<shift;
+    if ( !(b&0x80) ) return true;
+  }
+  return false;
+}
+
+bool NxuDebugReader::getVarint32(NxU32 &v)
+{
+  NxU64 v64;
+  if ( !getVarint(v64) || v64 > 0xFFFFFFFF ) return false;
+  v = (NxU32)v64;
+  return true;
+}
+
+bool NxuDebugReader::getBytes(NxArray< NxU8 > &dest,NxU32 len)
+{
+  if ( len > mEnd-(mBufferOffset+mBufferPos) ) return false;
+  dest.resize(len);
+  NxU32 done = 0;
+  while ( done < len )
+  {
+    if ( mBufferPos == mBufferLen && !fill() ) return false;
+    NxU32 n = mBufferLen-mBufferPos;
+    if ( n > len-done ) n = len-done;
+    memcpy(&dest[done],&mBuffer[mBufferPos],n);
+    mBufferPos+=n;
+    done+=n;
+  }
+  return true;
+}
+
+bool NxuDebugReader::getString(NxU32 &index)
+{
+  return getVarint32(index) && index < mStrings.size();
+}
+
+bool NxuDebugReader::decode(NxuDebugEvent &event)
+{
+  memset(&event,0,sizeof(event));
+  for (;;)
+  {
+    NxU8 op;
+    if ( !getByte(op) ) return false;
+    event.mFrame = mFrame;
+
+    NxU32 name;
+    switch ( op )
+    {
+      case OP_STRING:
+        {
+          NxU32 index,len;
+          if ( !getVarint32(index) || !getVarint32(len) || index > mStrings.size() || !getBytes(mScratch,len) ) return false;
+          if ( index == mStrings.size() )
+          {
+            char *str = new char[len+1];
+            if ( len ) memcpy(str,&mScratch[0],len);
+            str[len] = 0;
+            mStrings.push_back(str);
+          }
+        }
+        continue;
+      case OP_FRAME_BREAK:
+        event.mType = NXU_DBG_FRAME_BREAK;
+        mFrame++;
+        return true;
+      case OP_CREATE_OBJECT:
+        {
+          NxU8 type;
+          event.mType = NXU_DBG_CREATE_OBJECT;
+          if ( !getVarint32(event.mObject) || !getVarint(event.mPointer) || !getByte(type) || !getString(name) ) return false;
+          event.mObjectType = (NxRemoteDebuggerObjectType)type;
+          event.mName       = mStrings[name];
+        }
+        return true;
+      case OP_REMOVE_OBJECT:
+        event.mType = NXU_DBG_REMOVE_OBJECT;
+        return getVarint32(event.mObject);
+      case OP_ADD_CHILD:
+        event.mType = NXU_DBG_ADD_CHILD;
+        return getVarint32(event.mObject) && getVarint32(event.mChild);
+      case OP_REMOVE_CHILD:
+        event.mType = NXU_DBG_REMOVE_CHILD;
+        return getVarint32(event.mObject) && getVarint32(event.mChild);
+    }
+
+    if ( (op & ~(OP_CREATE|0x0F)) != OP_PARAMETER || (op & 0x0F) > NXU_DBG_PARAM_OBJECT ) return false;
+
+    event.mType          = NXU_DBG_PARAMETER;
+    event.mParameterType = (NxuDebugParameterType)(op & 0x0F);
+    event.mCreate        = (op & OP_CREATE) != 0;
+    if ( !getVarint32(event.mObject) || !getString(name) ) return false;
+    event.mName = mStrings[name];
+
+    NxU32 floats = 0;
+    switch ( event.mParameterType )
+    {
+      case NXU_DBG_PARAM_REAL:  floats = 1;  break;
+      case NXU_DBG_PARAM_VEC3:  floats = 3;  break;
+      case NXU_DBG_PARAM_PLANE: floats = 4;  break;
+      case NXU_DBG_PARAM_MAT34: floats = 12; break;
+      case NXU_DBG_PARAM_MAT33: floats = 9;  break;
+      case NXU_DBG_PARAM_U32:
+        return getVarint32(event.mU32);
+      case NXU_DBG_PARAM_BOOL:
+        {
+          NxU8 v;
+          if ( !getByte(v) ) return false;
+          event.mU32 = v;
+        }
+        return true;
+      case NXU_DBG_PARAM_OBJECT:
+        return getVarint32(event.mChild);
+      case NXU_DBG_PARAM_BINARY:
+      case NXU_DBG_PARAM_STRING:
+        {
+          NxU32 len;
+          if ( !getVarint32(len) || !getBytes(mScratch,len) ) return false;
+          mScratch.pushBack(0);
+          event.mData       = &mScratch[0];
+          event.mDataLength = len;
+          if ( event.mParameterType == NXU_DBG_PARAM_STRING )
+          {
+            event.mString = (const char *)&mScratch[0];
+            event.mData   = 0;
+          }
+        }
+        return true;
+    }
+    for (NxU32 i=0; i<floats; i++)
+    {
+      if ( !getFloat(event.mFloats[i]) ) return false;
+    }
+    return true;
+  }
+}
+
+}
@@ -0,0 +1,241 @@
+#ifndef NXU_DEBUG_RECORDER_H
+
+#define NXU_DEBUG_RECORDER_H
+
+#include <stdio.h>
+
+#include "NxSimpleTypes.h"
+#include "NxArray.h"
+#include "NxMat34.h"
+#include "NxRemoteDebugger.h"
+
+class NxScene;
+
+namespace NXU
+{
+
+class RecorderSync;
+
+// Records remote debugger events to a local file instead of sending them to the Visual Remote Debugger, so a
+// headless server can keep a flight recording of its physics. connect() takes a file name in place of the host.
+//
+// The calls only append to an in-memory block, which a background thread writes out at frame breaks. Events
+// outside the mask cost a single test. Object pointers are recorded as small ids and every class and parameter
+// name is written once, then referred to by index. The file ends with an index of the frame offsets; if the
+// process dies before disconnect() the reader rebuilds it by scanning what made it to disk.
+//
+// The SDK doesn't route its own events to a debugger of the application's, so they come from the application:
+// recordScene() writes the actors of a scene, and anything else can be sent with the NxRemoteDebugger calls.
+// The calls must all come from one thread.
+class NxuDebugRecorder : public ::NxRemoteDebugger
+{
+public:
+  NxuDebugRecorder(void);
+  virtual ~NxuDebugRecorder(void);
+
+  bool  open(const char *fname,NxU32 eventMask=NX_DBG_EVENTMASK_EVERYTHING);
+  void  close(void);
+
+  // Creates the dynamic actors of the scene not seen before, removes the ones released since the last call and
+  // writes the pose, velocities and sleep state of the rest.
+  void  recordScene(NxScene &scene);
+
+  NxU32 getFrame(void) const { return mFrame; };
+
+  virtual void connect(const char *fname,unsigned int port=NX_DBG_DEFAULT_PORT,NxU32 eventMask=NX_DBG_EVENTMASK_EVERYTHING);
+  virtual void disconnect(void);
+  virtual void flush(void);
+  virtual bool isConnected(void);
+  virtual void frameBreak(void);
+  virtual void createObject(void *object,NxRemoteDebuggerObjectType type,const char *className,NxU32 mask);
+  virtual void removeObject(void *object,NxU32 mask);
+  virtual void addChild(void *object,void *child,NxU32 mask);
+  virtual void removeChild(void *object,void *child,NxU32 mask);
+  virtual void writeParameter(const NxReal &parameter,void *object,bool create,const char *name,NxU32 mask);
+  virtual void writeParameter(const NxU32 &parameter,void *object,bool create,const char *name,NxU32 mask);
+  virtual void writeParameter(const NxVec3 &parameter,void *object,bool create,const char *name,NxU32 mask);
+  virtual void writeParameter(const NxPlane &parameter,void *object,bool create,const char *name,NxU32 mask);
+  virtual void writeParameter(const NxMat34 &parameter,void *object,bool create,const char *name,NxU32 mask);
+  virtual void writeParameter(const NxMat33 &parameter,void *object,bool create,const char *name,NxU32 mask);
+  virtual void writeParameter(const NxU8 *parameter,void *object,bool create,const char *name,NxU32 mask);
+  virtual void writeParameter(const char *parameter,void *object,bool create,const char *name,NxU32 mask);
+  virtual void writeParameter(const bool &parameter,void *object,bool create,const char *name,NxU32 mask);
+  virtual void writeParameter(const void *parameter,void *object,bool create,const char *name,NxU32 mask);
+  virtual void setMask(NxU32 mask);
+  virtual NxU32 getMask(void);
+  virtual void *getPickedObject(void) { return 0; };
+  virtual NxVec3 getPickPoint(void) { return NxVec3(0,0,0); };
+  virtual void registerEventListener(NxRemoteDebuggerEventListener *eventListener);
+  virtual void unregisterEventListener(NxRemoteDebuggerEventListener *eventListener);
+
+private:
+  NxuDebugRecorder(const NxuDebugRecorder &);
+  NxuDebugRecorder & operator=(const NxuDebugRecorder &);
+
+  struct Block
+  {
+    NxU8  *mData;
+    NxU32  mSize;
+    NxU32  mCapacity;
+  };
+
+  struct ObjectSlot
+  {
+    const void *mKey;
+    NxU32       mId;
+    NxU32       mStamp;  // the recordScene call that last saw it
+  };
+
+  struct StringSlot
+  {
+    char  *mKey;
+    NxU32  mHash;
+    NxU32  mIndex;
+  };
+
+  bool   wants(NxU32 mask) const { return mFile && (mask & mMask); };
+  void   reserve(NxU32 bytes);
+  void   putByte(NxU8 v) { mBlock->mData[mBlock->mSize++] = v; };
+  void   putU32(NxU32 v);
+  void   putFloat(NxF32 v);
+  void   putFloats(const NxF32 *v,NxU32 count);
+  void   putVarint(NxU64 v);
+  void   putBytes(const void *data,NxU32 len);
+  void   beginParameter(NxU8 type,void *object,bool create,const char *name,NxU32 extra);
+
+  ObjectSlot * findObject(const void *object);
+  NxU32  objectId(const void *object);     // the object's id, assigning one on first use
+  NxU32  newObjectId(const void *object);  // a fresh id, also when the pointer was used by an object before
+  void   forgetObject(const void *object);
+  NxU32  stringIndex(const char *str);     // writes the string the first time it's seen
+
+  void   submit(void);                      // hands the current block to the writer
+  Block *getBlock(void);
+  void   freeBlock(Block *b);
+  void   writeBlock(Block *b);
+
+  static void writerThread(void *data);   // the background thread, when there is one
+  void   writerLoop(void);
+
+  FILE                  *mFile;
+  NxU32                  mMask;
+  NxU32                  mFrame;
+  NxU64                  mSubmitted;        // bytes handed to the writer so far
+  Block                 *mBlock;
+  NxArray< NxU64 >       mFrameOffsets;
+  bool                   mWriteFailed;
+
+  ObjectSlot            *mObjects;
+  NxU32                  mObjectCapacity;
+  NxU32                  mObjectCount;
+  NxU32                  mNextObjectId;
+  NxU32                  mStamp;
+  NxArray< void * >      mSceneActors;     // the actors written by the last recordScene
+  NxArray< void * >      mSceneScratch;
+
+  StringSlot            *mStrings;
+  NxU32                  mStringCapacity;
+  NxArray< char * >      mStringTable;
+
+  NxArray< NxRemoteDebuggerEventListener * > mListeners;
+
+  // shared with the writer thread, under mSync
+  RecorderSync          *mSync;
+  NxArray< Block * >     mQueue;
+  NxArray< Block * >     mFreeBlocks;
+  bool                   mWriting;
+  bool                   mStop;
+};
+
+enum NxuDebugEventType
+{
+  NXU_DBG_FRAME_BREAK,
+  NXU_DBG_CREATE_OBJECT,
+  NXU_DBG_REMOVE_OBJECT,
+  NXU_DBG_ADD_CHILD,
+  NXU_DBG_REMOVE_CHILD,
+  NXU_DBG_PARAMETER,
+};
+
+enum NxuDebugParameterType
+{
+  NXU_DBG_PARAM_REAL,
+  NXU_DBG_PARAM_U32,
+  NXU_DBG_PARAM_VEC3,
+  NXU_DBG_PARAM_PLANE,     // normal, d
+  NXU_DBG_PARAM_MAT34,     // rotation row major, translation
+  NXU_DBG_PARAM_MAT33,     // row major
+  NXU_DBG_PARAM_BINARY,
+  NXU_DBG_PARAM_STRING,
+  NXU_DBG_PARAM_BOOL,
+  NXU_DBG_PARAM_OBJECT,
+};
+
+// One recorded event. Objects are the ids the recorder gave them, and 0 stands for a null pointer. The strings
+// and binary data stay valid until the reader is closed or reads the next event.
+struct NxuDebugEvent
+{
+  NxuDebugEventType           mType;
+  NxU32                       mFrame;
+  NxU32                       mObject;
+  NxU32                       mChild;         // the child of add and remove child, the value of an object parameter
+  NxU64                       mPointer;       // the object's address when it was created, for matching up with logs
+  NxRemoteDebuggerObjectType  mObjectType;
+  const char                 *mName;          // the class name of a created object or the parameter name
+  NxuDebugParameterType       mParameterType;
+  bool                        mCreate;
+  NxF32                       mFloats[12];    // real, vector, plane and matrix parameters
+  NxU32                       mU32;           // NxU32 and bool parameters
+  const char                 *mString;
+  const NxU8                 *mData;          // binary parameters, including the leading size
+  NxU32                       mDataLength;
+};
+
+class NxuDebugReader
+{
+public:
+  NxuDebugReader(void);
+  ~NxuDebugReader(void);
+
+  bool  open(const char *fname);
+  void  close(void);
+
+  // Frames hold the events up to and including their frame break. The last one may be unfinished.
+  NxU32 getFrameCount(void) const { return mFrameOffsets.size(); };
+  bool  seekFrame(NxU32 frame);
+
+  // Reads the next event, continuing into the following frames. Returns false at the end of the recording.
+  bool  readEvent(NxuDebugEvent &event);
+
+private:
+  NxuDebugReader(const NxuDebugReader &);
+  NxuDebugReader & operator=(const NxuDebugReader &);
+
+  bool  seek(NxU64 offset);
+  bool  fill(void);
+  bool  getByte(NxU8 &v);
+  bool  getU32(NxU32 &v);
+  bool  getFloat(NxF32 &v);
+  bool  getVarint(NxU64 &v);
+  bool  getVarint32(NxU32 &v);
+  bool  getBytes(NxArray< NxU8 > &dest,NxU32 len);
+  bool  getString(NxU32 &index);
+  bool  decode(NxuDebugEvent &event);
+  bool  readIndex(NxU64 fileSize);
+  void  scan(void);
+
+  FILE               *mFile;
+  NxU64               mEnd;           // where the events stop
+  NxU64               mBufferOffset;  // file offset of mBuffer[0]
+  NxU8               *mBuffer;
+  NxU32               mBufferPos;
+  NxU32               mBufferLen;
+  NxU32               mFrame;
+  NxArray< NxU64 >    mFrameOffsets;
+  NxArray< char * >   mStrings;
+  NxArray< NxU8 >     mScratch;
+};
+
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include <math.h>
 
 #include "NXU_tinyxml.h"
+#include "NXU_File.h"
 #include "NXU_Asc2Bin.h"
 #include "NXU_GraphicsMesh.h"
 #include "NXU_string.h"
@@ -56,6 +57,70 @@ enum AttributeType
 	AT_LAST
 };
 
+// Element and attribute names are found with one hash and one compare. The multiplier and shift were searched
+// for so that each table holds its known names without collisions; search again when adding a name.
+#define NAME_TABLE_SIZE        16
+#define NAME_HASH_MULTIPLIER   7451
+#define NAME_HASH_SHIFT        16
+
+static unsigned int hashName(const char *str)
+{
+	unsigned int h = 0;
+	while ( *str )
+	{
+		unsigned char c = (unsigned char)*str++;
+		if ( c >= 'A' && c <= 'Z' ) c = (unsigned char)(c+('a'-'A'));
+		h = h*NAME_HASH_MULTIPLIER + c;
+	}
+	return h>>NAME_HASH_SHIFT;
+}
+
+struct NameEntry
+{
+	const char *mName;
+	int         mType;
+};
+
+static const NameEntry gElementNames[NAME_TABLE_SIZE] =
+{
+	{ 0,              NT_NONE },
+	{ "AnimTrack",    NT_ANIM_TRACK },
+	{ "Bone",         NT_BONE },
+	{ "MeshSection",  NT_MESH_SECTION },
+	{ 0,              NT_NONE },
+	{ "NodeInstance", NT_NODE_INSTANCE },
+	{ 0,              NT_NONE },
+	{ "Mesh",         NT_MESH },
+	{ "IndexBuffer",  NT_INDEX_BUFFER },
+	{ "VertexBuffer", NT_VERTEX_BUFFER },
+	{ "SceneGraph",   NT_SCENE_GRAPH },
+	{ "Skeleton",     NT_SKELETON },
+	{ "TetraMesh",    NT_NODE_TETRA_MESH },
+	{ 0,              NT_NONE },
+	{ "NodeTriangle", NT_NODE_TRIANGLE },
+	{ "Animation",    NT_ANIMATION },
+};
+
+static const NameEntry gAttributeNames[NAME_TABLE_SIZE] =
+{
+	{ "parent",       AT_PARENT },
+	{ "position",     AT_POSITION },
+	{ 0,              AT_NONE },
+	{ 0,              AT_NONE },
+	{ "orientation",  AT_ORIENTATION },
+	{ "framecount",   AT_FRAME_COUNT },
+	{ "count",        AT_COUNT },
+	{ "material",     AT_MATERIAL },
+	{ "ctype",        AT_CTYPE },
+	{ 0,              AT_NONE },
+	{ "name",         AT_NAME },
+	{ "dtime",        AT_DTIME },
+	{ "trackcount",   AT_TRACK_COUNT },
+	{ "semantic",     AT_SEMANTIC },
+	{ "duration",     AT_DURATION },
+	{ 0,              AT_NONE },
+};
+
 class MaxVertex
 {
 public:
@@ -102,50 +167,22 @@ public:
 
   NodeType getElementType(const char *str)
   {
-  	NodeType ret = NT_NONE;
-
-		if ( strcasecmp(str,"SceneGraph") == 0 )  ret = NT_SCENE_GRAPH;
-		else if ( strcasecmp(str,"Mesh") == 0 )  ret = NT_MESH;
-		else if ( strcasecmp(str,"Animation") == 0 )  ret = NT_ANIMATION;
-		else if ( strcasecmp(str,"Skeleton") == 0 )  ret = NT_SKELETON;
-		else if ( strcasecmp(str,"Bone") == 0 )  ret = NT_BONE;
-		else if ( strcasecmp(str,"MeshSection") == 0 )  ret = NT_MESH_SECTION;
-		else if ( strcasecmp(str,"VertexBuffer") == 0 )  ret = NT_VERTEX_BUFFER;
-		else if ( strcasecmp(str,"TetraMesh") == 0 )  ret = NT_NODE_TETRA_MESH;
-		else if ( strcasecmp(str,"IndexBuffer") == 0 )  ret = NT_INDEX_BUFFER;
-		else if ( strcasecmp(str,"NodeTriangle") == 0 )  ret = NT_NODE_TRIANGLE;
-		else if ( strcasecmp(str,"NodeInstance") == 0 )  ret = NT_NODE_INSTANCE;
-		else if ( strcasecmp(str,"AnimTrack") == 0 )  ret = NT_ANIM_TRACK;
-
-  	return ret;
+  	const NameEntry &e = gElementNames[ hashName(str) & (NAME_TABLE_SIZE-1) ];
+  	return ( e.mName && strcasecmp(str,e.mName) == 0 ) ? (NodeType)e.mType : NT_NONE;
   }
 
 	AttributeType getAttributeType(const char *str)
 	{
-		AttributeType ret = AT_NONE;
-
-		if ( strcasecmp(str,"name") == 0 ) ret = AT_NAME;
-		else if ( strcasecmp(str,"count") == 0 ) ret = AT_COUNT;
-		else if ( strcasecmp(str,"parent") == 0 ) ret = AT_PARENT;
-		else if ( strcasecmp(str,"material") == 0 ) ret = AT_MATERIAL;
-		else if ( strcasecmp(str,"ctype") == 0 ) ret = AT_CTYPE;
-		else if ( strcasecmp(str,"semantic") == 0 ) ret = AT_SEMANTIC;
-		else if ( strcasecmp(str,"position") == 0 ) ret = AT_POSITION;
-		else if ( strcasecmp(str,"orientation") == 0 ) ret = AT_ORIENTATION;
-		else if ( strcasecmp(str,"duration") == 0 ) ret = AT_DURATION;
-		else if ( strcasecmp(str,"dtime") == 0 ) ret = AT_DTIME;
-		else if ( strcasecmp(str,"trackcount") == 0 ) ret = AT_TRACK_COUNT;
-		else if ( strcasecmp(str,"framecount") == 0 ) ret = AT_FRAME_COUNT;
-
-    return ret;
+		const NameEntry &e = gAttributeNames[ hashName(str) & (NAME_TABLE_SIZE-1) ];
+		return ( e.mName && strcasecmp(str,e.mName) == 0 ) ? (AttributeType)e.mType : AT_NONE;
 	}
 
-  bool LoadMesh(const char *fname,NxuGraphicsInterface *callback)
+  bool LoadMesh(const char *fname,NxuGraphicsInterface *callback,void *mem=0,int len=0)
 	{
 		bool ret = false;
 		mCallback = callback;
 		TiXmlDocument *doc = new TiXmlDocument;
-		bool ok = doc->LoadFile(fname);
+		bool ok = doc->LoadFile(fname,mem,len);
 		if ( ok )
 		{
 			Traverse(doc,0);
@@ -299,20 +336,8 @@ public:
 							int count = atoi( mCount );
 							if ( count == mAnimTrack->GetFrameCount() )
 							{
-								float *buff = (float *) malloc(sizeof(float)*7*count);
-								Asc2Bin(svalue, count, "fff ffff", buff );
-								for (int i=0; i<count; i++)
-								{
-									NxuAnimPose *p = mAnimTrack->GetPose(i);
-									const float *src = &buff[i*7];
-									p->mPos[0]  = src[0];
-									p->mPos[1]  = src[1];
-									p->mPos[2]  = src[2];
-									p->mQuat[0] = src[3];
-									p->mQuat[1] = src[4];
-									p->mQuat[2] = src[5];
-									p->mQuat[3] = src[6];
-								}
+								// NxuAnimPose is the seven floats of a key, so the keys are converted straight into the track
+								Asc2Bin(svalue, count, "fff ffff", mAnimTrack->GetPose(0) );
 
 							}
 						}
@@ -362,7 +387,7 @@ public:
                     tmesh+=12;
                   }
                 }
-                delete (char*)tetraMesh;
+                delete [](char*)tetraMesh;
 							}
 							mCtype = 0;
 							mCount = 0;
@@ -439,7 +464,7 @@ public:
 
 								unsigned short *idx = (unsigned short *) mIndexBuffer;
 								mCallback->NodeTriangleList(mVertexCount, vtx, mIndexCount*3, idx );
-
+								delete []vtx;
 							}
 							else if ( strcasecmp(mSemantic,"position normal texcoord texcoord") == 0 )
 							{
@@ -449,8 +474,8 @@ public:
 							}
 						}
 
-						free( mIndexBuffer);
-			      free( mVertexBuffer);
+						delete [](char*)mIndexBuffer;
+						delete [](char*)mVertexBuffer;
 						mIndexBuffer = 0;
 						mVertexBuffer = 0;
 						mIndexCount = 0;
@@ -661,6 +686,490 @@ private:
 };
 
 
+//==================================================================================
+// Binary cache of the callbacks a mesh file makes
+//
+//   "NXUGMESH" version byte-order-probe vertex-sizes source-length source-hash
+//   records, each a 4 byte code and its fields
+//   RC_END
+//
+// Every field is 4 byte aligned, so replayed vertices and indices are handed out straight from the loaded cache.
+// Strings are a length including the terminator, 0 for null, and their bytes padded to 4.
+//==================================================================================
+
+#define CACHE_MAGIC    "NXUGMESH"
+#define CACHE_VERSION  1
+#define CACHE_PROBE    0x01020304 // the cache is in the byte order of the machine that wrote it
+
+enum CacheRecord
+{
+	RC_END,
+	RC_MATERIAL,               // name, info
+	RC_MESH,                   // name, info
+	RC_TRIANGLE_LIST,          // vertex count, index count, vertices, indices
+	RC_DEFORM_TRIANGLE_LIST,
+	RC_TRIANGLE,               // three vertices
+	RC_DEFORM_TRIANGLE,
+	RC_SKELETON,               // name, bone count, bones as name, parent, position, orientation and transform
+	RC_ANIMATION,              // name, track count, frame count, duration, dtime, tracks as name and frame poses
+	RC_INSTANCE,               // name, transform
+	RC_TETRAHEDRON,            // four points
+	RC_LAST
+};
+
+static unsigned int hashBytes(const char *data,unsigned int len)
+{
+	unsigned int h = 2166136261u;
+	for (unsigned int i=0; i<len; i++)
+	{
+		h = (h^(unsigned char)data[i])*16777619u;
+	}
+	return h;
+}
+
+static char * readWholeFile(const char *fname,unsigned int &len)
+{
+	char *ret = 0;
+	len = 0;
+	NXU_FILE *fph = fname ? nxu_fopen(fname,"rb") : 0;
+	if ( fph )
+	{
+		nxu_fseek(fph,0,SEEK_END);
+		len = (unsigned int)nxu_ftell(fph);
+		nxu_fseek(fph,0,SEEK_SET);
+		ret = new char[len+1];
+		if ( len && nxu_fread(ret,len,1,fph) != 1 )
+		{
+			delete []ret;
+			ret = 0;
+			len = 0;
+		}
+		else
+		{
+			ret[len] = 0;
+		}
+		nxu_fclose(fph);
+	}
+	return ret;
+}
+
+// Passes every callback on and records it.
+class GraphicsCacheWriter : public NxuGraphicsInterface
+{
+public:
+	GraphicsCacheWriter(NxuGraphicsInterface *iface,unsigned int sourceLen,unsigned int sourceHash)
+	{
+		mInterface = iface;
+		mData      = 0;
+		mLen       = 0;
+		mCapacity  = 0;
+		put(CACHE_MAGIC,8);
+		putInt(CACHE_VERSION);
+		putInt(CACHE_PROBE);
+		putInt((sizeof(NxuVertex)<<16) | sizeof(NxuDeformVertex));
+		putInt(sourceLen);
+		putInt(sourceHash);
+	}
+
+	~GraphicsCacheWriter(void)
+	{
+		delete []mData;
+	}
+
+	bool save(const char *fname)
+	{
+		putInt(RC_END);
+		bool ret = false;
+		NXU_FILE *fph = nxu_fopen(fname,"wb");
+		if ( fph )
+		{
+			ret = nxu_fwrite(mData,mLen,1,fph) == 1;
+			nxu_fclose(fph);
+		}
+		return ret;
+	}
+
+	virtual void NodeMaterial(const char *name,const char *info)
+	{
+		putInt(RC_MATERIAL);
+		putString(name);
+		putString(info);
+		if ( mInterface ) mInterface->NodeMaterial(name,info);
+	}
+
+	virtual void NodeMesh(const char *name,const char *info)
+	{
+		putInt(RC_MESH);
+		putString(name);
+		putString(info);
+		if ( mInterface ) mInterface->NodeMesh(name,info);
+	}
+
+	virtual void NodeTriangleList(int vcount,const NxuVertex *vertex,int icount,const unsigned short *indices)
+	{
+		putInt(RC_TRIANGLE_LIST);
+		putInt(vcount);
+		putInt(icount);
+		put(vertex,sizeof(NxuVertex)*vcount);
+		put(indices,sizeof(unsigned short)*icount);
+		if ( mInterface ) mInterface->NodeTriangleList(vcount,vertex,icount,indices);
+	}
+
+	virtual void NodeTriangleList(int vcount,const NxuDeformVertex *vertex,int icount,const unsigned short *indices)
+	{
+		putInt(RC_DEFORM_TRIANGLE_LIST);
+		putInt(vcount);
+		putInt(icount);
+		put(vertex,sizeof(NxuDeformVertex)*vcount);
+		put(indices,sizeof(unsigned short)*icount);
+		if ( mInterface ) mInterface->NodeTriangleList(vcount,vertex,icount,indices);
+	}
+
+	virtual void NodeTriangle(const NxuVertex *v1,const NxuVertex *v2,const NxuVertex *v3)
+	{
+		putInt(RC_TRIANGLE);
+		put(v1,sizeof(NxuVertex));
+		put(v2,sizeof(NxuVertex));
+		put(v3,sizeof(NxuVertex));
+		if ( mInterface ) mInterface->NodeTriangle(v1,v2,v3);
+	}
+
+	virtual void NodeTriangle(const NxuDeformVertex *v1,const NxuDeformVertex *v2,const NxuDeformVertex *v3)
+	{
+		putInt(RC_DEFORM_TRIANGLE);
+		put(v1,sizeof(NxuDeformVertex));
+		put(v2,sizeof(NxuDeformVertex));
+		put(v3,sizeof(NxuDeformVertex));
+		if ( mInterface ) mInterface->NodeTriangle(v1,v2,v3);
+	}
+
+	virtual void NodeSkeleton(const NxuSkeleton *skeleton)
+	{
+		putInt(RC_SKELETON);
+		putString(skeleton->GetName());
+		putInt(skeleton->GetNxuBoneCount());
+		for (int i=0; i<skeleton->GetNxuBoneCount(); i++)
+		{
+			const NxuBone &b = skeleton->GetNxuBone(i);
+			putString(b.mName);
+			putInt(b.mParentIndex);
+			put(b.mPosition,sizeof(b.mPosition));
+			put(b.mOrientation,sizeof(b.mOrientation));
+			put(b.mElement,sizeof(b.mElement));
+		}
+		if ( mInterface ) mInterface->NodeSkeleton(skeleton);
+	}
+
+	virtual void NodeAnimation(const NxuAnimation *animation)
+	{
+		putInt(RC_ANIMATION);
+		putString(animation->GetName());
+		putInt(animation->GetTrackCount());
+		putInt(animation->GetFrameCount());
+		putFloat(animation->GetDuration());
+		putFloat(animation->GetDtime());
+		for (int i=0; i<animation->GetTrackCount(); i++)
+		{
+			const NxuAnimTrack *t = animation->GetTrack(i);
+			putString(t->GetName());
+			for (int j=0; j<animation->GetFrameCount(); j++)
+			{
+				NxuAnimPose pose;
+				t->SampleNxuAnimation(j,pose.mPos,pose.mQuat);
+				put(&pose,sizeof(pose));
+			}
+		}
+		if ( mInterface ) mInterface->NodeAnimation(animation);
+	}
+
+	virtual void NodeInstance(const char *name,const float *transform)
+	{
+		putInt(RC_INSTANCE);
+		putString(name);
+		put(transform,sizeof(float)*16);
+		if ( mInterface ) mInterface->NodeInstance(name,transform);
+	}
+
+	virtual void NodeTetrahedron(const float *p1,const float *p2,const float *p3,const float *p4)
+	{
+		putInt(RC_TETRAHEDRON);
+		put(p1,sizeof(float)*3);
+		put(p2,sizeof(float)*3);
+		put(p3,sizeof(float)*3);
+		put(p4,sizeof(float)*3);
+		if ( mInterface ) mInterface->NodeTetrahedron(p1,p2,p3,p4);
+	}
+
+private:
+	void put(const void *data,unsigned int len)
+	{
+		unsigned int padded = (len+3)&~3;
+		if ( mLen+padded > mCapacity )
+		{
+			unsigned int capacity = mCapacity ? mCapacity*2 : 65536;
+			while ( capacity < mLen+padded ) capacity*=2;
+			char *grown = new char[capacity];
+			if ( mLen ) memcpy(grown,mData,mLen);
+			delete []mData;
+			mData     = grown;
+			mCapacity = capacity;
+		}
+		if ( len ) memcpy(&mData[mLen],data,len);
+		memset(&mData[mLen+len],0,padded-len);
+		mLen+=padded;
+	}
+
+	void putInt(int v)     { put(&v,sizeof(v)); };
+	void putFloat(float v) { put(&v,sizeof(v)); };
+
+	void putString(const char *str)
+	{
+		unsigned int len = str ? (unsigned int)strlen(str)+1 : 0;
+		putInt((int)len);
+		put(str,len);
+	}
+
+	NxuGraphicsInterface *mInterface;
+	char                 *mData;
+	unsigned int          mLen;
+	unsigned int          mCapacity;
+};
+
+// Walks a loaded cache. The first pass only checks it, so a damaged cache is reparsed from the text before any
+// callback has been made; the second makes the callbacks.
+class GraphicsCacheReader
+{
+public:
+	GraphicsCacheReader(const char *data,unsigned int len)
+	{
+		mData = data;
+		mLen  = len;
+		mLoc  = 0;
+	}
+
+	// A cache without its source is used as is.
+	bool matches(bool haveSource,unsigned int sourceLen,unsigned int sourceHash)
+	{
+		int version,probe,sizes,len,hash;
+		mLoc = 0;
+		bool ok = mLen >= 8 && memcmp(mData,CACHE_MAGIC,8) == 0;
+		mLoc = 8;
+		ok = ok && getInt(version) && version == CACHE_VERSION;
+		ok = ok && getInt(probe) && probe == CACHE_PROBE;
+		ok = ok && getInt(sizes) && (unsigned int)sizes == ((sizeof(NxuVertex)<<16) | sizeof(NxuDeformVertex));
+		ok = ok && getInt(len) && getInt(hash);
+		if ( ok && haveSource )
+		{
+			ok = (unsigned int)len == sourceLen && (unsigned int)hash == sourceHash;
+		}
+		return ok;
+	}
+
+	bool walk(NxuGraphicsInterface *iface) // no callbacks without an interface
+	{
+		bool ok = matches(false,0,0);
+		while ( ok )
+		{
+			int record;
+			if ( !getInt(record) ) return false;
+			switch ( record )
+			{
+				case RC_END:
+					return mLoc == mLen;
+				case RC_MATERIAL:
+				case RC_MESH:
+					{
+						const char *name,*info;
+						ok = getString(name) && getString(info);
+						if ( ok && iface )
+						{
+							if ( record == RC_MATERIAL )
+								iface->NodeMaterial(name,info);
+							else
+								iface->NodeMesh(name,info);
+						}
+					}
+					break;
+				case RC_TRIANGLE_LIST:
+				case RC_DEFORM_TRIANGLE_LIST:
+					{
+						int vcount,icount;
+						const void *vertices,*indices;
+						unsigned int vsize = record == RC_TRIANGLE_LIST ? sizeof(NxuVertex) : sizeof(NxuDeformVertex);
+						ok = getInt(vcount) && getInt(icount) && vcount >= 0 && icount >= 0 &&
+						     get(vertices,vsize,vcount) && get(indices,sizeof(unsigned short),icount);
+						if ( ok && iface )
+						{
+							if ( record == RC_TRIANGLE_LIST )
+								iface->NodeTriangleList(vcount,(const NxuVertex *)vertices,icount,(const unsigned short *)indices);
+							else
+								iface->NodeTriangleList(vcount,(const NxuDeformVertex *)vertices,icount,(const unsigned short *)indices);
+						}
+					}
+					break;
+				case RC_TRIANGLE:
+					{
+						const void *v;
+						ok = get(v,sizeof(NxuVertex),3);
+						if ( ok && iface )
+						{
+							const NxuVertex *vtx = (const NxuVertex *)v;
+							iface->NodeTriangle(&vtx[0],&vtx[1],&vtx[2]);
+						}
+					}
+					break;
+				case RC_DEFORM_TRIANGLE:
+					{
+						const void *v;
+						ok = get(v,sizeof(NxuDeformVertex),3);
+						if ( ok && iface )
+						{
+							const NxuDeformVertex *vtx = (const NxuDeformVertex *)v;
+							iface->NodeTriangle(&vtx[0],&vtx[1],&vtx[2]);
+						}
+					}
+					break;
+				case RC_SKELETON:
+					ok = skeleton(iface);
+					break;
+				case RC_ANIMATION:
+					ok = animation(iface);
+					break;
+				case RC_INSTANCE:
+					{
+						const char *name;
+						const void *transform;
+						ok = getString(name) && get(transform,sizeof(float),16);
+						if ( ok && iface ) iface->NodeInstance(name,(const float *)transform);
+					}
+					break;
+				case RC_TETRAHEDRON:
+					{
+						const void *p;
+						ok = get(p,sizeof(float),12);
+						if ( ok && iface )
+						{
+							const float *tmesh = (const float *)p;
+							iface->NodeTetrahedron(tmesh,tmesh+3,tmesh+6,tmesh+9);
+						}
+					}
+					break;
+				default:
+					ok = false;
+					break;
+			}
+		}
+		return false;
+	}
+
+private:
+	bool skeleton(NxuGraphicsInterface *iface)
+	{
+		const char *name;
+		int count;
+		if ( !getString(name) || !getInt(count) || count < 0 ) return false;
+		if ( name && strlen(name) >= MAXSTRLEN ) return false;
+
+		NxuSkeleton *sk = 0;
+		if ( iface )
+		{
+			sk = new NxuSkeleton(name ? name : "");
+			if ( count ) sk->SetNxuBones(count,new NxuBone[count]);
+		}
+
+		bool ok = true;
+		for (int i=0; i<count && ok; i++)
+		{
+			const char *bname;
+			int parent;
+			const void *position,*orientation,*element;
+			ok = getString(bname) && (!bname || strlen(bname) < MAXSTRLEN) && getInt(parent) &&
+			     get(position,sizeof(float),3) && get(orientation,sizeof(float),4) && get(element,sizeof(float),16);
+			if ( ok && sk )
+			{
+				NxuBone *b = sk->GetNxuBonePtr(i);
+				b->SetName(bname ? bname : "");
+				b->mParentIndex = parent;
+				memcpy(b->mPosition,position,sizeof(b->mPosition));
+				memcpy(b->mOrientation,orientation,sizeof(b->mOrientation));
+				memcpy(b->mElement,element,sizeof(b->mElement));
+			}
+		}
+
+		if ( ok && sk ) iface->NodeSkeleton(sk);
+		delete sk;
+		return ok;
+	}
+
+	bool animation(NxuGraphicsInterface *iface)
+	{
+		const char *name;
+		int tracks,frames;
+		float duration,dtime;
+		if ( !getString(name) || !getInt(tracks) || !getInt(frames) || !getFloat(duration) || !getFloat(dtime) ) return false;
+		if ( tracks < 1 || frames < 1 || (name && strlen(name) >= 256) ) return false;
+		if ( (unsigned int)tracks > (mLen-mLoc)/4 || (unsigned int)frames > (mLen-mLoc)/sizeof(NxuAnimPose) ) return false;
+
+		NxuAnimation *anim = iface ? new NxuAnimation(name ? name : "",tracks,frames,duration,dtime) : 0;
+
+		bool ok = true;
+		for (int i=0; i<tracks && ok; i++)
+		{
+			const char *tname;
+			const void *poses;
+			ok = getString(tname) && (!tname || strlen(tname) < 256) && get(poses,sizeof(NxuAnimPose),frames);
+			if ( ok && anim )
+			{
+				anim->SetTrackName(i,tname ? tname : "");
+				memcpy(anim->GetTrack(i)->GetPose(0),poses,sizeof(NxuAnimPose)*frames);
+			}
+		}
+
+		if ( ok && anim ) iface->NodeAnimation(anim);
+		delete anim;
+		return ok;
+	}
+
+	bool get(const void *&data,unsigned int size,int count)
+	{
+		if ( count && size > (mLen-mLoc)/(unsigned int)count ) return false;
+		unsigned int len = (size*count+3)&~3;
+		if ( len > mLen-mLoc ) return false;
+		data = &mData[mLoc];
+		mLoc+=len;
+		return true;
+	}
+
+	bool getInt(int &v)
+	{
+		const void *data;
+		if ( !get(data,sizeof(int),1) ) return false;
+		v = *(const int *)data;
+		return true;
+	}
+
+	bool getFloat(float &v)
+	{
+		const void *data;
+		if ( !get(data,sizeof(float),1) ) return false;
+		v = *(const float *)data;
+		return true;
+	}
+
+	bool getString(const char *&str)
+	{
+		int len;
+		const void *data;
+		if ( !getInt(len) || len < 0 || !get(data,1,len) ) return false;
+		str = len ? (const char *)data : 0;
+		return !len || str[len-1] == 0;
+	}
+
+	const char   *mData;
+	unsigned int  mLen;
+	unsigned int  mLoc;
+};
+
 bool NxuLoadGraphicsMesh(const char *meshName,NxuGraphicsInterface *iface)
 {
 	bool ret = false;
@@ -673,5 +1182,47 @@ bool NxuLoadGraphicsMesh(const char *meshName,NxuGraphicsInterface *iface)
 }
 
 
+bool NxuLoadGraphicsMesh(const char *meshName,NxuGraphicsInterface *iface,const char *cacheName)
+{
+	if ( !cacheName )
+	{
+		return NxuLoadGraphicsMesh(meshName,iface);
+	}
+
+	bool ret = false;
+
+	unsigned int sourceLen;
+	char *source = readWholeFile(meshName,sourceLen);
+	unsigned int sourceHash = source ? hashBytes(source,sourceLen) : 0;
+
+	unsigned int cacheLen;
+	char *cache = readWholeFile(cacheName,cacheLen);
+	if ( cache )
+	{
+		GraphicsCacheReader reader(cache,cacheLen);
+		if ( reader.matches(source != 0,sourceLen,sourceHash) && reader.walk(0) )
+		{
+			ret = reader.walk(iface);
+		}
+	}
+
+	if ( !ret && source )
+	{
+		GraphicsCacheWriter writer(iface,sourceLen,sourceHash);
+		ParsePxl pp;
+		ret = pp.LoadMesh(meshName,&writer,source,(int)sourceLen);
+		if ( ret )
+		{
+			writer.save(cacheName);
+		}
+	}
+
+	delete []cache;
+	delete []source;
+
+	return ret;
+}
+
+
 }; // END OF NXU NAMESPACE
 
@@ -197,6 +197,11 @@ inline void NxuDeformVertex::Lerp(const NxuVertex &a,const NxuVertex &b,float d)
 
 bool NxuLoadGraphicsMesh(const char *meshName,NxuGraphicsInterface *iface);
 
+// Same callbacks, but they're replayed from a binary cache when it was made from the same mesh file, skipping the
+// text parsing; otherwise the mesh is parsed and the cache written. A cache whose mesh file is missing is replayed
+// as is, so shipped builds can carry the caches alone.
+bool NxuLoadGraphicsMesh(const char *meshName,NxuGraphicsInterface *iface,const char *cacheName);
+
 //********************************************************
 //****************** NxuSkeleton
 //********************************************************
@@ -780,6 +785,16 @@ public:
 		return ret;
 	};
 
+	const NxuAnimTrack * GetTrack(int index) const
+	{
+		const NxuAnimTrack *ret = 0;
+		if ( index >= 0 && index < mTrackCount )
+		{
+			ret = mTracks[index];
+		}
+		return ret;
+	};
+
 	int GetFrameCount(void) const { return mFrameCount; };
 	float GetDtime(void) const { return mDtime; };
 
@@ -155,7 +155,7 @@ bool NxuPhysicsExport::Write(NxJoint *j,const char *userProperties,const char *i
 
 	NxSceneDesc *current = getCurrentScene();
 
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
 	NxJointDesc *joint = 0;
 
@@ -359,14 +359,10 @@ const char * NxuPhysicsExport::Write(NxClothMesh *clothMesh,const char *id)
 	if ( clothMesh )
 	{
 
-		for (NxU32 i=0; i<mCollection->mClothMeshes.size(); i++)
+		NxClothMeshDesc *c = mIndex.findInstance(mCollection->mClothMeshes,clothMesh);
+		if ( c )
 		{
-			NxClothMeshDesc *c = mCollection->mClothMeshes[i];
-			if ( c->mInstance == clothMesh )
-			{
-				ret = c->mId;
-				break;
-			}
+			ret = c->mId;
 		}
 
 		if ( !ret )
@@ -388,7 +384,7 @@ const char * NxuPhysicsExport::Write(NxClothMesh *clothMesh,const char *id)
       	cMesh->mId = getGlobalString(tempString);
       }
 
-    	CustomCopy cc(mCollection,0);
+    	CustomCopy cc(mCollection,0,&mIndex);
 
       cMesh->copyFrom(desc,cc);
 
@@ -408,17 +404,7 @@ bool NxuPhysicsExport::Write(NxTriangleMesh	*mesh,const char *userProperties,con
 {
 	bool ret = false;
 
-  bool found = false;
-
-	for (unsigned int i=0; i<mCollection->mTriangleMeshes.size(); i++)
-	{
-		NXU::NxTriangleMeshDesc *tm = mCollection->mTriangleMeshes[i];
-		if ( tm->mInstance == mesh )
-		{
-			found = true;
-			break;
-		}
-	}
+  bool found = mIndex.findInstance(mCollection->mTriangleMeshes,mesh) != 0;
 
   if ( !found )
   {
@@ -450,17 +436,7 @@ bool NxuPhysicsExport::Write(NxConvexMesh	*mesh,const char *userProperties,const
 {
 	bool ret = false;
 
-  bool found = false;
-
-	for (unsigned int i=0; i<mCollection->mConvexMeshes.size(); i++)
-	{
-		NXU::NxConvexMeshDesc *tm = mCollection->mConvexMeshes[i];
-		if ( tm->mInstance == mesh )
-		{
-			found = true;
-			break;
-		}
-	}
+  bool found = mIndex.findInstance(mCollection->mConvexMeshes,mesh) != 0;
 
   if ( !found )
   {
@@ -487,20 +463,10 @@ bool NxuPhysicsExport::Write(NxHeightField *heightfield,const char *userProperti
 	bool ret = false;
 
 
-	bool found = false;
-
-	int	num	=	mCollection->mHeightFields.size();
-	for	(int i = 0;	i	<	num; ++i)
-	{
-		if (heightfield	== mCollection->mHeightFields[i]->mInstance)
-		{
-			found = true;
-			break;
-		}
-	}
+	bool found = mIndex.findInstance(mCollection->mHeightFields,heightfield) != 0;
 	if ( !found )
 	{
-	  CustomCopy cc(mCollection,0);
+	  CustomCopy cc(mCollection,0,&mIndex);
   	NxHeightFieldDesc *hf = new NxHeightFieldDesc;
   	if ( id )
   	{
@@ -564,18 +530,13 @@ const char *NxuPhysicsExport::Write(NxCCDSkeleton *skeleton,const char *userProp
 {
   const char *ret = 0;
 
-	bool found = false;
-
 	NxU32	num	=	mCollection->mSkeletons.size();
-	for	(NxU32 i = 0;	i	<	num; ++i)
+
+	NxCCDSkeletonDesc *sd = mIndex.findInstance(mCollection->mSkeletons,skeleton);
+	bool found = sd != 0;
+	if ( found )
 	{
-    NxCCDSkeletonDesc *sd = mCollection->mSkeletons[i];
-		if (skeleton ==	(mCollection->mSkeletons[i])->mInstance)
-		{
-			found = true;
-      ret = sd->mId;
-			break;
-		}
+		ret = sd->mId;
 	}
 
   if ( !found )
@@ -598,7 +559,7 @@ const char *NxuPhysicsExport::Write(NxCCDSkeleton *skeleton,const char *userProp
     skel->mUserProperties   = getGlobalString(userProperties);
 
 #if NX_SDK_VERSION_NUMBER >= 262
-	  CustomCopy cc(mCollection,0);
+	  CustomCopy cc(mCollection,0,&mIndex);
 
 		::NxSimpleTriangleMesh mesh;
 		NxU32 tcount = skeleton->saveToDesc(mesh);
@@ -684,7 +645,7 @@ bool NxuPhysicsExport::Write(NxForceField *field, const char *userProperties, co
 
 
 	NxSceneDesc *current = getCurrentScene();
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
 	NxForceFieldDesc *desc = new NxForceFieldDesc;
 
@@ -797,7 +758,7 @@ bool NxuPhysicsExport::Write(NxForceFieldShapeGroup *group, const char *userProp
 
 
 	NxSceneDesc *current = getCurrentScene();
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
 	NxForceFieldShapeGroupDesc *desc = new NxForceFieldShapeGroupDesc;
 
@@ -837,7 +798,7 @@ bool NxuPhysicsExport::Write(NxForceFieldLinearKernel *kernel, const char *userP
 
 
 	NxSceneDesc *current = getCurrentScene();
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
 	NxForceFieldLinearKernelDesc *desc = new NxForceFieldLinearKernelDesc;
 
@@ -874,7 +835,7 @@ bool NxuPhysicsExport::Write(NxEffector	*e,const char *userProperties,const char
 	bool ret = false;
 
 	NxSceneDesc *current = getCurrentScene();
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
 	NxSpringAndDamperEffector	*sade	=	e->isSpringAndDamperEffector();
 
@@ -916,7 +877,7 @@ bool NxuPhysicsExport::Write(NxFluid *fluid,const char *userProperties,const cha
 {
 
 	NxSceneDesc *current = getCurrentScene();
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
 	NxFluidDesc *fdesc = new NxFluidDesc;
 
@@ -992,7 +953,7 @@ NxClothAttachDesc * NxuPhysicsExport::getClothShapeAttachment(NxShape *shape) //
 	NxClothAttachDesc *ret =0;
 
 	NxSceneDesc *current = getCurrentScene();
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
 	if ( shape )
 	{
@@ -1023,7 +984,7 @@ NxSoftBodyAttachDesc * NxuPhysicsExport::getSoftBodyShapeAttachment(NxShape *sha
 	NxSoftBodyAttachDesc *ret =0;
 
 	NxSceneDesc *current = getCurrentScene();
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
 	if ( shape )
 	{
@@ -1054,7 +1015,7 @@ bool NxuPhysicsExport::Write(NxCloth *cloth,const char *userProperties,const cha
 	bool ret = false;
 
 	NxSceneDesc *current = getCurrentScene();
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
 	NxClothDesc *desc = new NxClothDesc();
 	desc->mUserProperties = getGlobalString(userProperties);
@@ -1146,7 +1107,7 @@ const char * NxuPhysicsExport::Write(NxCompartment *c,const char *id)
 	const char *ret = 0;
 
 	NxSceneDesc *current = getCurrentScene();
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 	::NxCompartmentDesc desc;
 	//TODO there should be a saveToDesc method for NxCompartment!
 #if 0 // Not yet available
@@ -1184,7 +1145,7 @@ bool NxuPhysicsExport::Write(NxPairFlag	*a,const char *userProperties,const char
 {
 	NxSceneDesc *current = getCurrentScene();
 
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
 	NxPairFlagDesc *pf = new NxPairFlagDesc;
 
@@ -1316,7 +1277,7 @@ bool NxuPhysicsExport::Write(NxActor *a,const char *userProperties,const char *i
 
 		desc->mUserProperties = getGlobalString(userProperties);
 
-		CustomCopy cc(mCollection,scene);
+		CustomCopy cc(mCollection,scene,&mIndex);
 
 		desc->copyFrom(d,cc);
 
@@ -1533,7 +1494,7 @@ bool NxuPhysicsExport::setFilterOps(bool filter,::NxFilterOp op0,::NxFilterOp op
 
   if ( scene )
   {
-		CustomCopy cc(mCollection);
+		CustomCopy cc(mCollection,0,&mIndex);
   	scene->mFilterBool = filter;
   	scene->mFilterOp0  = (NxFilterOp) op0;
   	scene->mFilterOp1  = (NxFilterOp) op1;
@@ -1739,18 +1700,8 @@ bool NxuPhysicsExport::addActor(NxActor *a) // if this actor doesn't already exi
 
   if ( a )
   {
-  	bool found = false;
-
   	NxSceneDesc *scene = getCurrentScene();
-  	for (unsigned int i=0; i<scene->mActors.size(); i++)
-    {
-    	NxActorDesc *ad = scene->mActors[i];
-    	if ( ad->mInstance == a )
-    	{
-    		found = true;
-    		break;
-    	}
-    }
+  	bool found = mIndex.findInstance(scene->mActors,a) != 0;
     if ( !found )
     {
     	ret = true;
@@ -1768,7 +1719,7 @@ bool NxuPhysicsExport::Write(NxSoftBody *softBody,const char *userProperties,con
 	bool ret = false;
 
 	NxSceneDesc *current = getCurrentScene();
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
 	NxSoftBodyDesc *desc = new NxSoftBodyDesc();
 	desc->mUserProperties = getGlobalString(userProperties);
@@ -1837,14 +1788,10 @@ const char * NxuPhysicsExport::Write(NxSoftBodyMesh *softBodyMesh,const char *id
 	if ( softBodyMesh )
 	{
 
-		for (NxU32 i=0; i<mCollection->mSoftBodyMeshes.size(); i++)
+		NxSoftBodyMeshDesc *c = mIndex.findInstance(mCollection->mSoftBodyMeshes,softBodyMesh);
+		if ( c )
 		{
-			NxSoftBodyMeshDesc *c = mCollection->mSoftBodyMeshes[i];
-			if ( c->mInstance == softBodyMesh )
-			{
-				ret = c->mId;
-				break;
-			}
+			ret = c->mId;
 		}
 
 		if ( !ret )
@@ -1866,7 +1813,7 @@ const char * NxuPhysicsExport::Write(NxSoftBodyMesh *softBodyMesh,const char *id
       	cMesh->mId = getGlobalString(tempString);
       }
 
-    	CustomCopy cc(mCollection,0);
+    	CustomCopy cc(mCollection,0,&mIndex);
 
       cMesh->copyFrom(desc,cc);
 
@@ -1904,7 +1851,7 @@ bool NxuPhysicsExport::Write(const ::NxSoftBodyDesc &softBody,const ::NxSoftBody
   cMesh->mUserProperties = getGlobalString(userProperties);
 
 	NxSceneDesc *current = getCurrentScene();
-	CustomCopy cc(mCollection,current);
+	CustomCopy cc(mCollection,current,&mIndex);
 
   cMesh->copyFrom(softBodyMesh,cc);
 
@@ -1950,7 +1897,7 @@ bool  NxuPhysicsExport::exportConvexMesh(NxConvexMesh	*mesh,const char *userProp
 
   ret = true;
   NxConvexMeshDesc *tmesh = &cdesc;
- 	CustomCopy cc(mCollection,0);
+ 	CustomCopy cc(mCollection,0,&mIndex);
   ::NxConvexMeshDesc desc;
  	mesh->saveToDesc(desc);
 	tmesh->mId = getGlobalString(id);
@@ -1970,7 +1917,7 @@ bool  NxuPhysicsExport::exportTriangleMesh(NxTriangleMesh	*mesh,const char *user
 
   NXU::NxTriangleMeshDesc *tmesh = &tdesc;
 
- 	CustomCopy cc(mCollection,0);
+ 	CustomCopy cc(mCollection,0,&mIndex);
  	::NxTriangleMeshDesc desc;
  	mesh->saveToDesc(desc);
 
@@ -98,6 +98,7 @@ private:
   NxSceneDesc * getCurrentScene(void);
 
   NxuPhysicsCollection	*mCollection;
+  NxuExportIndex        mIndex;       // instance and id lookups into the arrays of mCollection
 };
 
 } // end of namespace
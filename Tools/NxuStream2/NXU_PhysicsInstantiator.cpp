@@ -58,10 +58,6 @@ NxuPhysicsInstantiator::NxuPhysicsInstantiator(void)
 	mCurrentScene = 0;
 }
 
-NxuPhysicsInstantiator::~NxuPhysicsInstantiator()
-{
-}
-
 void NxuPhysicsInstantiator::instanceSkeletons(NxPhysicsSDK	&sdk,NXU_userNotify *callback)
 {
   CustomCopy cc(mCollection,0);
@@ -481,6 +477,411 @@ bool sameCompartment(NxCompartmentDesc &c1,::NxCompartmentDesc &c2)
 }
 #endif
 
+// Converts the shapes of an actor into its SDK descriptor. The shape descriptors are allocated and also added
+// to 'slist', for the caller to delete. Returns true if the actor has a plane.
+static bool copyShapeDescs(::NxActorDesc &desc,NxActorDesc *actor,CustomCopy &cc,NxArray< ::NxShapeDesc * > &slist)
+{
+	bool hasPlane	=	false;
+	bool isOk = false;
+
+	for	(NxU32 j = 0;	j	<	actor->mShapes.size();	j++)
+	{
+      ::NxShapeDesc *shapeDesc=0;
+
+		NxShapeDesc	*shape = actor->mShapes[j];
+
+		switch (shape->mType )
+		{
+			case SC_NxPlaneShapeDesc:
+				{
+					::NxPlaneShapeDesc *d1 = new ::NxPlaneShapeDesc;
+					NxPlaneShapeDesc *s	=	static_cast<NxPlaneShapeDesc*>(shape);
+            s->copyTo(*d1,cc);
+            shapeDesc = d1;
+					isOk = d1->isValid();
+					hasPlane = true;
+				}
+				break;
+			case SC_NxSphereShapeDesc:
+				{
+					::NxSphereShapeDesc *d2 = new ::NxSphereShapeDesc;
+					NxSphereShapeDesc *s	=	static_cast<NxSphereShapeDesc*>(shape);
+            s->copyTo(*d2,cc);
+            shapeDesc = d2;
+					isOk = d2->isValid();
+				}
+				break;
+			case SC_NxBoxShapeDesc:
+				{
+					::NxBoxShapeDesc *d3 = new ::NxBoxShapeDesc;
+					NxBoxShapeDesc *s	=	static_cast<NxBoxShapeDesc*>(shape);
+            s->copyTo(*d3,cc);
+            shapeDesc = d3;
+					isOk = d3->isValid();
+				}
+				break;
+			case SC_NxCapsuleShapeDesc:
+				{
+					::NxCapsuleShapeDesc *d4 = new ::NxCapsuleShapeDesc;
+					NxCapsuleShapeDesc *s	=	static_cast<NxCapsuleShapeDesc*>(shape);
+            s->copyTo(*d4,cc);
+            shapeDesc = d4;
+					isOk = d4->isValid();
+				}
+				break;
+			case SC_NxWheelShapeDesc:
+				{
+					::NxWheelShapeDesc *d5 = new ::NxWheelShapeDesc;
+					NxWheelShapeDesc *s	=	static_cast<NxWheelShapeDesc*>(shape);
+            s->copyTo(*d5,cc);
+            shapeDesc = d5;
+					isOk = d5->isValid();
+				}
+				break;
+			case SC_NxConvexShapeDesc:
+				{
+					::NxConvexShapeDesc *d6 = new ::NxConvexShapeDesc;
+					NxConvexShapeDesc *s = static_cast<NxConvexShapeDesc*>(shape);
+					s->copyTo(*d6,cc);
+            shapeDesc = d6;
+					isOk = d6->isValid();
+				}
+				break;
+			case SC_NxTriangleMeshShapeDesc:
+				{
+					::NxTriangleMeshShapeDesc *d7 = new ::NxTriangleMeshShapeDesc;
+					NxTriangleMeshShapeDesc *s = static_cast<NxTriangleMeshShapeDesc*>(shape);
+					s->copyTo(*d7,cc);
+            shapeDesc = d7;
+					isOk = d7->isValid();
+				}
+				break;
+			case SC_NxHeightFieldShapeDesc:
+				{
+					::NxHeightFieldShapeDesc *d8 = new ::NxHeightFieldShapeDesc;
+					NxHeightFieldShapeDesc *s = static_cast<NxHeightFieldShapeDesc*>(shape);
+					s->copyTo(*d8,cc);
+            shapeDesc = d8;
+					isOk = d8->isValid();
+				}
+				break;
+			default:
+				NX_ASSERT(false);	//Unknown	shape	type
+		}
+
+      if ( shapeDesc )
+      {
+			if ( isOk )
+			{
+				shapeDesc->ccdSkeleton = cc.getSkeletonFromName(shape->mCCDSkeleton);
+  			  shapeDesc->userData = (void *)shape->mUserProperties;
+          desc.shapes.push_back(shapeDesc);
+          slist.push_back(shapeDesc);
+			}
+			else
+			{
+				reportWarning("Failed to construct valid shape descriptor type(%s) for Actor (%s)", EnumToString( shape->mType) , actor->mId );
+			}
+      }
+		else
+		{
+			reportWarning("Unable to construct valid shape descriptor type(%s) for Actor (%s)", EnumToString( shape->mType) , actor->mId );
+		}
+
+		
+	}
+
+	return hasPlane;
+}
+
+// Binds the shape descriptors of an actor to the shapes of the actor created from it.
+static void bindShapes(NxActor *a,NxActorDesc *actor)
+{
+	NxU32 nbShapes = a->getNbShapes();
+	if ( nbShapes && actor->mShapes.size() == nbShapes )
+	{
+		NxShape *const* shapes = a->getShapes();
+		for (NxU32 i=0; i<nbShapes; i++)
+		{
+			NxShapeDesc *sd = actor->mShapes[i];
+			sd->mInstance = shapes[i];
+		}
+	}
+}
+
+// Room for one SDK joint descriptor of any type.
+struct JointDescs
+{
+  ::NxD6JointDesc 					j1;
+  ::NxCylindricalJointDesc  j2;
+  ::NxDistanceJointDesc 		j3;
+  ::NxFixedJointDesc    		j4;
+  ::NxPointInPlaneJointDesc j5;
+  ::NxPointOnLineJointDesc 	j6;
+  ::NxPrismaticJointDesc 		j7;
+  ::NxRevoluteJointDesc 		j8;
+  ::NxSphericalJointDesc 		j9;
+  ::NxPulleyJointDesc 			j10;
+
+  // Converts a joint descriptor. Returns null for an unknown type.
+  ::NxJointDesc * copy(NxJointDesc *v,CustomCopy &cc)
+  {
+      ::NxJointDesc *jdesc = 0;
+
+      switch ( v->mType )
+      {
+        case SC_NxD6JointDesc:
+          if ( 1 )
+          {
+            NxD6JointDesc *p = static_cast<NxD6JointDesc *>(v);
+            p->copyTo(j1,cc);
+            jdesc = static_cast< ::NxJointDesc *>(&j1);
+          }
+          break;
+        case SC_NxCylindricalJointDesc:
+          if ( 1 )
+          {
+            NxCylindricalJointDesc *p = static_cast<NxCylindricalJointDesc *>(v);
+            p->copyTo(j2,cc);
+            jdesc = static_cast< ::NxJointDesc *>(&j2);
+          }
+          break;
+        case SC_NxDistanceJointDesc:
+          if ( 1 )
+          {
+            NxDistanceJointDesc *p = static_cast<NxDistanceJointDesc *>(v);
+            p->copyTo(j3,cc);
+            jdesc = static_cast< ::NxJointDesc *>(&j3);
+          }
+          break;
+        case SC_NxFixedJointDesc:
+          if ( 1 )
+          {
+            NxFixedJointDesc *p = static_cast<NxFixedJointDesc *>(v);
+            p->copyTo(j4,cc);
+            jdesc = static_cast< ::NxJointDesc *>(&j4);
+          }
+          break;
+        case SC_NxPointInPlaneJointDesc:
+          if ( 1 )
+          {
+            NxPointInPlaneJointDesc *p = static_cast<NxPointInPlaneJointDesc *>(v);
+            p->copyTo(j5,cc);
+            jdesc = static_cast< ::NxJointDesc *>(&j5);
+          }
+          break;
+        case SC_NxPointOnLineJointDesc:
+          if ( 1 )
+          {
+            NxPointOnLineJointDesc *p = static_cast<NxPointOnLineJointDesc *>(v);
+            p->copyTo(j6,cc);
+            jdesc = static_cast< ::NxJointDesc *>(&j6);
+          }
+          break;
+        case SC_NxPrismaticJointDesc:
+          if ( 1 )
+          {
+            NxPrismaticJointDesc *p = static_cast<NxPrismaticJointDesc *>(v);
+            p->copyTo(j7,cc);
+            jdesc = static_cast< ::NxJointDesc *>(&j7);
+          }
+          break;
+        case SC_NxRevoluteJointDesc:
+          if ( 1 )
+          {
+            NxRevoluteJointDesc *p = static_cast<NxRevoluteJointDesc *>(v);
+            p->copyTo(j8,cc);
+            jdesc = static_cast< ::NxJointDesc *>(&j8);
+          }
+          break;
+        case SC_NxSphericalJointDesc:
+          if ( 1 )
+          {
+            NxSphericalJointDesc *p = static_cast<NxSphericalJointDesc *>(v);
+            p->copyTo(j9,cc);
+            jdesc = static_cast< ::NxJointDesc *>(&j9);
+          }
+          break;
+        case SC_NxPulleyJointDesc:
+          if ( 1 )
+          {
+            NxPulleyJointDesc *p = static_cast<NxPulleyJointDesc *>(v);
+            p->copyTo(j10,cc);
+            jdesc = static_cast< ::NxJointDesc *>(&j10);
+          }
+          break;
+        default:
+  	break;
+      }
+    return jdesc;
+  }
+
+  // Copies an SDK joint descriptor of any type.
+  ::NxJointDesc * copy(const ::NxJointDesc &desc)
+  {
+    ::NxJointDesc *jdesc = 0;
+    switch ( desc.getType() )
+    {
+      case NX_JOINT_D6:
+        j1 = static_cast< const ::NxD6JointDesc &>(desc);
+        jdesc = &j1;
+        break;
+      case NX_JOINT_CYLINDRICAL:
+        j2 = static_cast< const ::NxCylindricalJointDesc &>(desc);
+        jdesc = &j2;
+        break;
+      case NX_JOINT_DISTANCE:
+        j3 = static_cast< const ::NxDistanceJointDesc &>(desc);
+        jdesc = &j3;
+        break;
+      case NX_JOINT_FIXED:
+        j4 = static_cast< const ::NxFixedJointDesc &>(desc);
+        jdesc = &j4;
+        break;
+      case NX_JOINT_POINT_IN_PLANE:
+        j5 = static_cast< const ::NxPointInPlaneJointDesc &>(desc);
+        jdesc = &j5;
+        break;
+      case NX_JOINT_POINT_ON_LINE:
+        j6 = static_cast< const ::NxPointOnLineJointDesc &>(desc);
+        jdesc = &j6;
+        break;
+      case NX_JOINT_PRISMATIC:
+        j7 = static_cast< const ::NxPrismaticJointDesc &>(desc);
+        jdesc = &j7;
+        break;
+      case NX_JOINT_REVOLUTE:
+        j8 = static_cast< const ::NxRevoluteJointDesc &>(desc);
+        jdesc = &j8;
+        break;
+      case NX_JOINT_SPHERICAL:
+        j9 = static_cast< const ::NxSphericalJointDesc &>(desc);
+        jdesc = &j9;
+        break;
+      case NX_JOINT_PULLEY:
+        j10 = static_cast< const ::NxPulleyJointDesc &>(desc);
+        jdesc = &j10;
+        break;
+      default:
+        break;
+    }
+    return jdesc;
+  }
+};
+
+// Allocates a copy of an SDK joint descriptor of any type. Returns null for an unknown type.
+static ::NxJointDesc * cloneJointDesc(const ::NxJointDesc &desc)
+{
+  ::NxJointDesc *ret = 0;
+  switch ( desc.getType() )
+  {
+    case NX_JOINT_D6:
+      ret = new ::NxD6JointDesc(static_cast< const ::NxD6JointDesc &>(desc));
+      break;
+    case NX_JOINT_CYLINDRICAL:
+      ret = new ::NxCylindricalJointDesc(static_cast< const ::NxCylindricalJointDesc &>(desc));
+      break;
+    case NX_JOINT_DISTANCE:
+      ret = new ::NxDistanceJointDesc(static_cast< const ::NxDistanceJointDesc &>(desc));
+      break;
+    case NX_JOINT_FIXED:
+      ret = new ::NxFixedJointDesc(static_cast< const ::NxFixedJointDesc &>(desc));
+      break;
+    case NX_JOINT_POINT_IN_PLANE:
+      ret = new ::NxPointInPlaneJointDesc(static_cast< const ::NxPointInPlaneJointDesc &>(desc));
+      break;
+    case NX_JOINT_POINT_ON_LINE:
+      ret = new ::NxPointOnLineJointDesc(static_cast< const ::NxPointOnLineJointDesc &>(desc));
+      break;
+    case NX_JOINT_PRISMATIC:
+      ret = new ::NxPrismaticJointDesc(static_cast< const ::NxPrismaticJointDesc &>(desc));
+      break;
+    case NX_JOINT_REVOLUTE:
+      ret = new ::NxRevoluteJointDesc(static_cast< const ::NxRevoluteJointDesc &>(desc));
+      break;
+    case NX_JOINT_SPHERICAL:
+      ret = new ::NxSphericalJointDesc(static_cast< const ::NxSphericalJointDesc &>(desc));
+      break;
+    case NX_JOINT_PULLEY:
+      ret = new ::NxPulleyJointDesc(static_cast< const ::NxPulleyJointDesc &>(desc));
+      break;
+    default:
+      break;
+  }
+  return ret;
+}
+
+// Creates the joint of 'v' from its converted descriptor. Attachments to the world frame are moved by 'pose'.
+static void createJoint(NxScene &scene,::NxJointDesc *jdesc,NxJointDesc *v,const NxMat34 &pose,NXU_userNotify *callback)
+{
+	// If one attachment is the world frame, it must be adjusted by the scene transform.
+	if (jdesc->actor[0] == 0)
+	{
+		pose.multiply(jdesc->localAnchor[0], jdesc->localAnchor[0]);
+		pose.M.multiply(jdesc->localAxis[0], jdesc->localAxis[0]);
+		pose.M.multiply(jdesc->localNormal[0], jdesc->localNormal[0]);
+	}
+	if (jdesc->actor[1] == 0)
+	{
+		pose.multiply(jdesc->localAnchor[1], jdesc->localAnchor[1]);
+		pose.M.multiply(jdesc->localAxis[1], jdesc->localAxis[1]);
+		pose.M.multiply(jdesc->localNormal[1], jdesc->localNormal[1]);
+	}
+  	bool ok	=	true;
+
+	jdesc->isValid();
+
+  	if (callback)
+  	{
+  		ok = callback->NXU_preNotifyJoint(*jdesc,	v->mUserProperties);
+  	}
+  	if (ok)
+  	{
+  		NxJoint *jt = scene.createJoint(*jdesc);
+  		if ( jt)
+  		{
+
+		NxU32	planes = v->mPlaneInfo.size();
+		if (planes)
+		{
+			jt->setLimitPoint(v->mPlaneLimitPoint, v->mOnActor2	?	true : false);
+		}
+		for	(NxU32 p = 0;	p	<	planes;	++p)
+		{
+			NxPlaneInfoDesc *pInfo = v->mPlaneInfo[p];
+
+			// determine a point on the limit plane
+			// planeD = -(planeNormal) DOT (pointOnPlane)
+			// for pointOnPlane[i] == pointOnPlane[j] == 0
+			// pointOnPlane[k] = -planeD / planeNormal[k]
+			NxVec3 pointOnPlane(0,0,0);
+			const NxU32 k = pInfo->mPlaneNormal.closestAxis();
+			assert(fabsf(pInfo->mPlaneNormal[k]) > 0.001f);
+			pointOnPlane[k] = -pInfo->mPlaneD / pInfo->mPlaneNormal[k];
+
+#if NX_SDK_VERSION_NUMBER >= 272
+			jt->addLimitPlane(pInfo->mPlaneNormal, pointOnPlane, pInfo->restitution);
+#else
+			jt->addLimitPlane(pInfo->mPlaneNormal, pointOnPlane);
+#endif
+		}
+
+
+  			jt->setName(jdesc->name);
+  			v->mInstance = jt;
+			if ( callback )
+  				callback->NXU_notifyJoint(jt,	v->mUserProperties);
+  		}
+  		else
+  		{
+			if ( callback )
+				callback->NXU_notifyJointFailed(*jdesc,v->mUserProperties);
+			reportWarning("Failed to create joint '%s'", v->name );
+  		}
+  	}
+}
+
+
 void NxuPhysicsInstantiator::instanceModel(NxScene &scene, NxSceneDesc	&model,	NxMat34	&pose, bool	isHSM, NXU_userNotify	*callback, NX_BOOL ignorePlane)
 {
 
@@ -580,8 +981,6 @@ void NxuPhysicsInstantiator::instanceModel(NxScene &scene, NxSceneDesc	&model,	N
     ::NxActorDesc desc;
     actor->copyTo(desc,cc);
 
-		bool isOk = false;
-
     ::NxBodyDesc body;
     if ( actor->mHasBody )
     {
@@ -589,116 +988,8 @@ void NxuPhysicsInstantiator::instanceModel(NxScene &scene, NxSceneDesc	&model,	N
       desc.body = &body;
     }
 
-		bool hasPlane	=	false;
-
 		NxArray< ::NxShapeDesc * > slist;
-
-		for	(NxU32 j = 0;	j	<	actor->mShapes.size();	j++)
-		{
-      ::NxShapeDesc *shapeDesc=0;
-
-			NxShapeDesc	*shape = actor->mShapes[j];
-
-			switch (shape->mType )
-			{
-				case SC_NxPlaneShapeDesc:
-					{
-						::NxPlaneShapeDesc *d1 = new ::NxPlaneShapeDesc;
-						NxPlaneShapeDesc *s	=	static_cast<NxPlaneShapeDesc*>(shape);
-            s->copyTo(*d1,cc);
-            shapeDesc = d1;
-						isOk = d1->isValid();
-						hasPlane = true;
-					}
-					break;
-				case SC_NxSphereShapeDesc:
-					{
-						::NxSphereShapeDesc *d2 = new ::NxSphereShapeDesc;
-						NxSphereShapeDesc *s	=	static_cast<NxSphereShapeDesc*>(shape);
-            s->copyTo(*d2,cc);
-            shapeDesc = d2;
-						isOk = d2->isValid();
-					}
-					break;
-				case SC_NxBoxShapeDesc:
-					{
-						::NxBoxShapeDesc *d3 = new ::NxBoxShapeDesc;
-						NxBoxShapeDesc *s	=	static_cast<NxBoxShapeDesc*>(shape);
-            s->copyTo(*d3,cc);
-            shapeDesc = d3;
-						isOk = d3->isValid();
-					}
-					break;
-				case SC_NxCapsuleShapeDesc:
-					{
-						::NxCapsuleShapeDesc *d4 = new ::NxCapsuleShapeDesc;
-						NxCapsuleShapeDesc *s	=	static_cast<NxCapsuleShapeDesc*>(shape);
-            s->copyTo(*d4,cc);
-            shapeDesc = d4;
-						isOk = d4->isValid();
-					}
-					break;
-				case SC_NxWheelShapeDesc:
-					{
-						::NxWheelShapeDesc *d5 = new ::NxWheelShapeDesc;
-						NxWheelShapeDesc *s	=	static_cast<NxWheelShapeDesc*>(shape);
-            s->copyTo(*d5,cc);
-            shapeDesc = d5;
-						isOk = d5->isValid();
-					}
-					break;
-				case SC_NxConvexShapeDesc:
-					{
-						::NxConvexShapeDesc *d6 = new ::NxConvexShapeDesc;
-						NxConvexShapeDesc *s = static_cast<NxConvexShapeDesc*>(shape);
-						s->copyTo(*d6,cc);
-            shapeDesc = d6;
-						isOk = d6->isValid();
-					}
-					break;
-				case SC_NxTriangleMeshShapeDesc:
-					{
-						::NxTriangleMeshShapeDesc *d7 = new ::NxTriangleMeshShapeDesc;
-						NxTriangleMeshShapeDesc *s = static_cast<NxTriangleMeshShapeDesc*>(shape);
-						s->copyTo(*d7,cc);
-            shapeDesc = d7;
-						isOk = d7->isValid();
-					}
-					break;
-				case SC_NxHeightFieldShapeDesc:
-					{
-						::NxHeightFieldShapeDesc *d8 = new ::NxHeightFieldShapeDesc;
-						NxHeightFieldShapeDesc *s = static_cast<NxHeightFieldShapeDesc*>(shape);
-						s->copyTo(*d8,cc);
-            shapeDesc = d8;
-						isOk = d8->isValid();
-					}
-					break;
-				default:
-					NX_ASSERT(false);	//Unknown	shape	type
-			}
-
-      if ( shapeDesc )
-      {
-				if ( isOk )
-				{
-					shapeDesc->ccdSkeleton = cc.getSkeletonFromName(shape->mCCDSkeleton);
-  			  shapeDesc->userData = (void *)shape->mUserProperties;
-          desc.shapes.push_back(shapeDesc);
-          slist.push_back(shapeDesc);
-				}
-				else
-				{
-					reportWarning("Failed to construct valid shape descriptor type(%s) for Actor (%s)", EnumToString( shape->mType) , actor->mId );
-				}
-      }
-			else
-			{
-				reportWarning("Unable to construct valid shape descriptor type(%s) for Actor (%s)", EnumToString( shape->mType) , actor->mId );
-			}
-
-			
-		}
+		bool hasPlane = copyShapeDescs(desc,actor,cc,slist);
 
 		if (hasPlane &&	ignorePlane)
 	  {
@@ -731,16 +1022,7 @@ void NxuPhysicsInstantiator::instanceModel(NxScene &scene, NxSceneDesc	&model,	N
 
 				if ( a )
 				{
-					NxU32 nbShapes = a->getNbShapes();
-					if ( nbShapes && actor->mShapes.size() == nbShapes )
-					{
-						NxShape *const* shapes = a->getShapes();
-						for (NxU32 i=0; i<nbShapes; i++)
-						{
-							NxShapeDesc *sd = actor->mShapes[i];
-              sd->mInstance = shapes[i];
-						}
-					}
+					bindShapes(a,actor);
 					if ( callback )
 					{
   					callback->NXU_notifyActor(a,	actor->mUserProperties);
@@ -801,175 +1083,14 @@ void NxuPhysicsInstantiator::instanceModel(NxScene &scene, NxSceneDesc	&model,	N
 	for	(NxU32 i = 0;	i	<	count; ++i)
 	{
 		NxJointDesc *v	=	model.mJoints[i];
-		::NxD6JointDesc 					j1;
-		::NxCylindricalJointDesc  j2;
-		::NxDistanceJointDesc 		j3;
-		::NxFixedJointDesc    		j4;
-		::NxPointInPlaneJointDesc j5;
-		::NxPointOnLineJointDesc 	j6;
-		::NxPrismaticJointDesc 		j7;
-		::NxRevoluteJointDesc 		j8;
-		::NxSphericalJointDesc 		j9;
-		::NxPulleyJointDesc 			j10;
-
-    ::NxJointDesc *jdesc = 0;
-
-    switch ( v->mType )
-    {
-      case SC_NxD6JointDesc:
-        if ( 1 )
-        {
-          NxD6JointDesc *p = static_cast<NxD6JointDesc *>(v);
-          p->copyTo(j1,cc);
-          jdesc = static_cast< ::NxJointDesc *>(&j1);
-        }
-        break;
-      case SC_NxCylindricalJointDesc:
-        if ( 1 )
-        {
-          NxCylindricalJointDesc *p = static_cast<NxCylindricalJointDesc *>(v);
-          p->copyTo(j2,cc);
-          jdesc = static_cast< ::NxJointDesc *>(&j2);
-        }
-        break;
-      case SC_NxDistanceJointDesc:
-        if ( 1 )
-        {
-          NxDistanceJointDesc *p = static_cast<NxDistanceJointDesc *>(v);
-          p->copyTo(j3,cc);
-          jdesc = static_cast< ::NxJointDesc *>(&j3);
-        }
-        break;
-      case SC_NxFixedJointDesc:
-        if ( 1 )
-        {
-          NxFixedJointDesc *p = static_cast<NxFixedJointDesc *>(v);
-          p->copyTo(j4,cc);
-          jdesc = static_cast< ::NxJointDesc *>(&j4);
-        }
-        break;
-      case SC_NxPointInPlaneJointDesc:
-        if ( 1 )
-        {
-          NxPointInPlaneJointDesc *p = static_cast<NxPointInPlaneJointDesc *>(v);
-          p->copyTo(j5,cc);
-          jdesc = static_cast< ::NxJointDesc *>(&j5);
-        }
-        break;
-      case SC_NxPointOnLineJointDesc:
-        if ( 1 )
-        {
-          NxPointOnLineJointDesc *p = static_cast<NxPointOnLineJointDesc *>(v);
-          p->copyTo(j6,cc);
-          jdesc = static_cast< ::NxJointDesc *>(&j6);
-        }
-        break;
-      case SC_NxPrismaticJointDesc:
-        if ( 1 )
-        {
-          NxPrismaticJointDesc *p = static_cast<NxPrismaticJointDesc *>(v);
-          p->copyTo(j7,cc);
-          jdesc = static_cast< ::NxJointDesc *>(&j7);
-        }
-        break;
-      case SC_NxRevoluteJointDesc:
-        if ( 1 )
-        {
-          NxRevoluteJointDesc *p = static_cast<NxRevoluteJointDesc *>(v);
-          p->copyTo(j8,cc);
-          jdesc = static_cast< ::NxJointDesc *>(&j8);
-        }
-        break;
-      case SC_NxSphericalJointDesc:
-        if ( 1 )
-        {
-          NxSphericalJointDesc *p = static_cast<NxSphericalJointDesc *>(v);
-          p->copyTo(j9,cc);
-          jdesc = static_cast< ::NxJointDesc *>(&j9);
-        }
-        break;
-      case SC_NxPulleyJointDesc:
-        if ( 1 )
-        {
-          NxPulleyJointDesc *p = static_cast<NxPulleyJointDesc *>(v);
-          p->copyTo(j10,cc);
-          jdesc = static_cast< ::NxJointDesc *>(&j10);
-        }
-        break;
-      default:
-	break;
-    }
-
+		JointDescs descs;
+		::NxJointDesc *jdesc = descs.copy(v,cc);
 
 		assert(jdesc);
 
 		if ( jdesc )
 		{
-			// If one attachment is the world frame, it must be adjusted by the scene transform.
-			if (jdesc->actor[0] == 0)
-			{
-				pose.multiply(jdesc->localAnchor[0], jdesc->localAnchor[0]);
-				pose.M.multiply(jdesc->localAxis[0], jdesc->localAxis[0]);
-				pose.M.multiply(jdesc->localNormal[0], jdesc->localNormal[0]);
-			}
-			if (jdesc->actor[1] == 0)
-			{
-				pose.multiply(jdesc->localAnchor[1], jdesc->localAnchor[1]);
-				pose.M.multiply(jdesc->localAxis[1], jdesc->localAxis[1]);
-				pose.M.multiply(jdesc->localNormal[1], jdesc->localNormal[1]);
-			}
-  		bool ok	=	true;
-
-			jdesc->isValid();
-
-  		if (callback)
-  		{
-  			ok = callback->NXU_preNotifyJoint(*jdesc,	v->mUserProperties);
-  		}
-  		if (ok)
-  		{
-  			NxJoint *jt = scene.createJoint(*jdesc);
-  			if ( jt)
-  			{
-
-				NxU32	planes = v->mPlaneInfo.size();
-				if (planes)
-				{
-					jt->setLimitPoint(v->mPlaneLimitPoint, v->mOnActor2	?	true : false);
-				}
-				for	(NxU32 p = 0;	p	<	planes;	++p)
-				{
-					NxPlaneInfoDesc *pInfo = v->mPlaneInfo[p];
-
-					// determine a point on the limit plane
-					// planeD = -(planeNormal) DOT (pointOnPlane)
-					// for pointOnPlane[i] == pointOnPlane[j] == 0
-					// pointOnPlane[k] = -planeD / planeNormal[k]
-					NxVec3 pointOnPlane(0,0,0);
-					const NxU32 k = pInfo->mPlaneNormal.closestAxis();
-					assert(fabsf(pInfo->mPlaneNormal[k]) > 0.001f);
-					pointOnPlane[k] = -pInfo->mPlaneD / pInfo->mPlaneNormal[k];
-
-#if NX_SDK_VERSION_NUMBER >= 272
-					jt->addLimitPlane(pInfo->mPlaneNormal, pointOnPlane, pInfo->restitution);
-#else
-					jt->addLimitPlane(pInfo->mPlaneNormal, pointOnPlane);
-#endif
-				}
-
-
-  				jt->setName(jdesc->name);
-  				v->mInstance = jt;
-					if ( callback )
-  					callback->NXU_notifyJoint(jt,	v->mUserProperties);
-  			}
-  			else
-  			{
-					if ( callback )
-						callback->NXU_notifyJointFailed(*jdesc,v->mUserProperties);
-					reportWarning("Failed to create joint '%s'", v->name );
-  			}
-  		}
+			createJoint(scene,jdesc,v,pose,callback);
 		}
 	}
 
@@ -1523,6 +1644,296 @@ void NxuPhysicsInstantiator::instanceModel(NxScene &scene, NxSceneDesc	&model,	N
 }
 
 
+// The actor of a scene template, converted with the shapes' meshes and skeletons already resolved.
+struct TemplateActor
+{
+	NxActorDesc                *mSource;
+	::NxActorDesc               mDesc;       // the pose is relative to the instance root
+	::NxBodyDesc                mBody;
+	NxArray< ::NxShapeDesc * >  mShapes;     // allocated by copyShapeDescs
+	bool                        mHasPlane;
+};
+
+struct TemplateJoint
+{
+	NxJointDesc   *mSource;
+	::NxJointDesc *mDesc;                    // allocated by cloneJointDesc
+	NxI32          mActor[2];                // the template actors it connects, -1 for the world frame
+};
+
+struct TemplatePair
+{
+	NxPairFlagDesc *mSource;
+	NxI32           mActor[2];
+};
+
+class SceneTemplate
+{
+public:
+	SceneTemplate(NxSceneDesc *model,NxScene *scene)
+	{
+		mModel = model;
+		mScene = scene;
+		mBatch = 0;
+	}
+
+	~SceneTemplate(void)
+	{
+		for (NxU32 i=0; i<mActors.size(); i++)
+		{
+			TemplateActor *a = mActors[i];
+			for (NxU32 j=0; j<a->mShapes.size(); j++)
+			{
+				delete a->mShapes[j];
+			}
+			delete a;
+		}
+		for (NxU32 i=0; i<mJoints.size(); i++)
+		{
+			delete mJoints[i].mDesc;
+		}
+		delete []mBatch;
+	}
+
+	NxSceneDesc                 *mModel;
+	NxScene                     *mScene;
+	NxArray< TemplateActor * >   mActors;
+	NxArray< TemplateJoint >     mJoints;
+	NxArray< TemplatePair >      mPairs;
+
+	// scratch space of instanceTemplate, kept to avoid allocating for every instance
+	::NxActorDesc               *mBatch;       // the posed descriptors of one instance, one per actor
+	NxArray< NxU32 >             mBatchActors; // the template actor of each
+	NxArray< NxActor * >         mCreated;     // the actors of the instance, by template actor
+};
+
+NxuPhysicsInstantiator::~NxuPhysicsInstantiator()
+{
+	for (NxU32 i=0; i<mTemplates.size(); i++)
+	{
+		delete mTemplates[i];
+	}
+}
+
+// True if the later instances of a scene can be created from a template: besides the scene wide settings the
+// scene holds only materials, actors, joints and pair flags.
+static bool isTemplateScene(NxSceneDesc &model)
+{
+	bool ret = model.mEffectors.size() == 0 && model.mCloths.size() == 0;
+#if NX_SDK_VERSION_NUMBER >= 270
+	if ( model.mForceFields.size() ) ret = false;
+#endif
+#if NX_SDK_VERSION_NUMBER >= 280
+	if ( model.mForceFieldShapeGroups.size() || model.mForceFieldLinearKernels.size() ) ret = false;
+#endif
+#if NX_USE_SOFTBODY_API
+	if ( model.mSoftBodies.size() ) ret = false;
+#endif
+#if NX_USE_FLUID_API
+	if ( model.mFluids.size() ) ret = false;
+#endif
+	return ret;
+}
+
+// The index of the first actor with this id, like CustomCopy::getActorFromName. -1 if there is none.
+static NxI32 findActorIndex(NxSceneDesc &model,const char *name)
+{
+	NxI32 ret = -1;
+	if ( name )
+	{
+		for (NxU32 i=0; i<model.mActors.size(); i++)
+		{
+			NxActorDesc *a = model.mActors[i];
+			if ( a->mId && strcmp(a->mId,name) == 0 )
+			{
+				ret = (NxI32) i;
+				break;
+			}
+		}
+	}
+	return ret;
+}
+
+SceneTemplate * NxuPhysicsInstantiator::findSceneTemplate(NxSceneDesc *model,NxScene *scene)
+{
+	SceneTemplate *ret = 0;
+	for (NxU32 i=0; i<mTemplates.size(); i++)
+	{
+		SceneTemplate *t = mTemplates[i];
+		if ( t->mModel == model && t->mScene == scene )
+		{
+			ret = t;
+			break;
+		}
+	}
+	return ret;
+}
+
+// Built right after the scene was instanced the usual way, so its meshes, skeletons and compartments exist.
+SceneTemplate * NxuPhysicsInstantiator::createSceneTemplate(NxSceneDesc &model,NxScene &scene)
+{
+	SceneTemplate *t = new SceneTemplate(&model,&scene);
+
+	CustomCopy cc(mCollection,&model);
+
+	NxU32 count = model.mActors.size();
+	for (NxU32 i=0; i<count; i++)
+	{
+		NxActorDesc *actor = model.mActors[i];
+		TemplateActor *ta = new TemplateActor;
+		ta->mSource = actor;
+		actor->copyTo(ta->mDesc,cc);
+		if ( actor->mHasBody )
+		{
+			actor->mBody.copyTo(ta->mBody,cc);
+			ta->mDesc.body = &ta->mBody;
+		}
+		ta->mHasPlane = copyShapeDescs(ta->mDesc,actor,cc,ta->mShapes);
+		t->mActors.push_back(ta);
+	}
+	t->mBatch = new ::NxActorDesc[count ? count : 1];
+
+	count = model.mJoints.size();
+	for (NxU32 i=0; i<count; i++)
+	{
+		NxJointDesc *v = model.mJoints[i];
+		JointDescs descs;
+		::NxJointDesc *jdesc = descs.copy(v,cc);
+		if ( jdesc )
+		{
+			TemplateJoint tj;
+			tj.mSource   = v;
+			tj.mDesc     = cloneJointDesc(*jdesc);
+			tj.mActor[0] = findActorIndex(model,v->mActor0);
+			tj.mActor[1] = findActorIndex(model,v->mActor1);
+			t->mJoints.push_back(tj);
+		}
+	}
+
+	count = model.mPairFlags.size();
+	for (NxU32 i=0; i<count; i++)
+	{
+		NxPairFlagDesc *d = model.mPairFlags[i];
+		TemplatePair tp;
+		tp.mSource   = d;
+		tp.mActor[0] = findActorIndex(model,d->mActor0);
+		tp.mActor[1] = findActorIndex(model,d->mActor1);
+		if ( tp.mActor[0] >= 0 && tp.mActor[1] >= 0 )
+		{
+			t->mPairs.push_back(tp);
+		}
+	}
+
+	mTemplates.push_back(t);
+
+	return t;
+}
+
+// Creates one more instance of a templated scene: only its actors, pair flags and joints, under 'pose'. The
+// actor descriptors are posed and checked first and then created in one run.
+void NxuPhysicsInstantiator::instanceTemplate(SceneTemplate &t,const NxMat34 &pose,NX_BOOL ignorePlane,NXU_userNotify *callback)
+{
+	NxScene &scene = *t.mScene;
+
+	NxU32 count = t.mActors.size();
+	NxU32 batchCount = 0;
+
+	t.mBatchActors.clear();
+	t.mCreated.clear();
+
+	for (NxU32 i=0; i<count; i++)
+	{
+		TemplateActor *ta = t.mActors[i];
+		ta->mSource->mInstance = 0;
+		t.mCreated.push_back(0);
+
+		if ( ta->mHasPlane && ignorePlane )
+			continue;
+
+		::NxActorDesc &desc = t.mBatch[batchCount];
+		desc = ta->mDesc;
+		desc.globalPose.multiply(pose, desc.globalPose);
+
+		bool ok = desc.isValid();
+
+		if (callback)
+		{
+			ok = callback->NXU_preNotifyActor(desc, ta->mSource->mUserProperties);
+		}
+
+		if ( ok )
+		{
+			t.mBatchActors.push_back(i);
+			batchCount++;
+		}
+	}
+
+	for (NxU32 i=0; i<batchCount; i++)
+	{
+		::NxActorDesc &desc = t.mBatch[i];
+		NxActorDesc *actor = t.mActors[ t.mBatchActors[i] ]->mSource;
+
+		NxActor *a = scene.createActor(desc);
+		actor->mInstance = a;
+		t.mCreated[ t.mBatchActors[i] ] = a;
+
+		if ( a )
+		{
+			bindShapes(a,actor);
+			if ( callback )
+			{
+				callback->NXU_notifyActor(a, actor->mUserProperties);
+			}
+		}
+		else
+		{
+			if ( callback )
+				callback->NXU_notifyActorFailed(desc, actor->mUserProperties);
+			reportWarning("Failed to create actor '%s'", desc.name );
+		}
+	}
+
+	for (NxU32 i=0; i<t.mPairs.size(); i++)
+	{
+		TemplatePair &tp = t.mPairs[i];
+		NxPairFlagDesc *d = tp.mSource;
+
+		NxActor *a0 = t.mCreated[ tp.mActor[0] ];
+		NxActor *a1 = t.mCreated[ tp.mActor[1] ];
+
+		if ( a0 && a1 )
+		{
+			if ( d->mIsActorPair )
+			{
+				scene.setActorPairFlags(*a0,*a1,d->mFlags );
+			}
+			else
+			{
+				NxShape *s0 = getShapeFromIndex(a0,d->mShapeIndex0);
+				NxShape *s1 = getShapeFromIndex(a1,d->mShapeIndex1);
+				if ( s0 && s1 )
+				{
+					scene.setShapePairFlags(*s0,*s1,d->mFlags );
+				}
+			}
+		}
+	}
+
+	for (NxU32 i=0; i<t.mJoints.size(); i++)
+	{
+		TemplateJoint &tj = t.mJoints[i];
+		tj.mSource->mInstance = 0;
+
+		JointDescs descs;
+		::NxJointDesc *jdesc = descs.copy(*tj.mDesc);
+		jdesc->actor[0] = tj.mActor[0] >= 0 ? t.mCreated[ tj.mActor[0] ] : 0;
+		jdesc->actor[1] = tj.mActor[1] >= 0 ? t.mCreated[ tj.mActor[1] ] : 0;
+
+		createJoint(scene,jdesc,tj.mSource,pose,callback);
+	}
+}
+
+
 void NxuPhysicsInstantiator::instantiateSceneInstance(NxSceneInstanceDesc *nsi,
 																											NxPhysicsSDK	&sdk,	 //	SDK	to load	the	collection into.
 																											NXU_userNotify *callback,	 //	notification events	to the application as	the	scene	is loaded.
@@ -1552,7 +1963,19 @@ void NxuPhysicsInstantiator::instantiateSceneInstance(NxSceneInstanceDesc *nsi,
   {
   	if (sdesc)
   	{
-  		instanceDefaultScene = instantiateScene(nsi->mSceneName,	nsi->mIgnorePlane, sdk,	callback, instanceDefaultScene,	&mat);
+  		SceneTemplate *t = instanceDefaultScene ? findSceneTemplate(sdesc,instanceDefaultScene) : 0;
+  		if ( t )
+  		{
+  			instanceTemplate(*t,mat,nsi->mIgnorePlane,callback);
+  		}
+  		else
+  		{
+  			instanceDefaultScene = instantiateScene(nsi->mSceneName,	nsi->mIgnorePlane, sdk,	callback, instanceDefaultScene,	&mat);
+  			if ( instanceDefaultScene && isTemplateScene(*sdesc) )
+  			{
+  				createSceneTemplate(*sdesc,*instanceDefaultScene);
+  			}
+  		}
   	}
   	else
   	{
@@ -1721,8 +2144,6 @@ NxScene * NxuPhysicsInstantiator::instantiateScene(const	char *sceneName,	// nul
 																							NxScene *defaultScene,
 																							const NxMat34	*defaultSceneOffset)
 {
-	bool ret = false;
-
 	NxScene	*newScene	=	0;
 
 	if (mCollection)
@@ -1820,8 +2241,6 @@ NxScene * NxuPhysicsInstantiator::instantiateScene(const	char *sceneName,	// nul
 
 				instanceModel(*newScene, *p, xform,	false, callback, ignore_plane);
 
-				ret	=	true;
-
 			}
 			else
 			{
@@ -21,6 +21,7 @@ Changelist
 namespace	NXU
 {
 
+class SceneTemplate;
 
 /**
 \brief Format	independant	importer.
@@ -90,10 +91,20 @@ private:
 
 		void instanceModel(NxScene &scene,NxSceneDesc	&model,	NxMat34	&pose, bool	isHSM, NXU_userNotify	*callback, NX_BOOL ignorePlane);
 
+		// A scene instanced again into the scene it was first instanced into is created from a template: its
+		// actor, joint and pair flag descriptors converted once, with the meshes, skeletons and compartments
+		// resolved. The materials and the other scene wide state stay as the first instance set them up. The
+		// instances share the shape descriptors NXU_preNotifyActor is handed.
+		SceneTemplate * findSceneTemplate(NxSceneDesc *model,NxScene *scene);
+		SceneTemplate * createSceneTemplate(NxSceneDesc &model,NxScene &scene);
+		void instanceTemplate(SceneTemplate &t,const NxMat34 &pose,NX_BOOL ignorePlane,NXU_userNotify *callback);
+
 	NxScene	*instanceDefaultScene;
 
 	NxSceneDesc	*mCurrentScene; // the current scene we are instancing
 
+	NxArray< SceneTemplate * > mTemplates;
+
 };
 
 }
@@ -1,3 +1,6 @@
+#include <stdio.h>
+#include <math.h>
+
 #include "NXU_helper.h"
 
 #include "NXU_PhysicsExport.h"
@@ -610,6 +613,268 @@ void copyConvexMeshScaled(NxConvexMeshDesc *dest,NxConvexMeshDesc *source,const
 }
 
 
+//****************************************************************
+//** Scaled mesh cache.
+//**
+//** Spawning the same collection at a few scales over and over used to scale, re-cook and re-create every mesh
+//** each time. Scaled mesh descriptors are kept here keyed on the content of the source descriptor (a hash of
+//** its points, triangles and cooked data, checked against the sizes), its id and the quantized scale. A source
+//** which was released and whose memory got reused for another mesh can't pick up a stale entry.
+//** Collections own and delete their descriptors, so each new collection still receives its own copy of the
+//** cached one, which is never modified. What is shared is the expensive part: the scaling and cooking, and the
+//** SDK mesh itself, which a later collection picks up through the instance table once an earlier collection
+//** holding the same scaled mesh has been instantiated.
+//****************************************************************
+
+#define SCALE_QUANTUM        0.0001f                // scales closer than this share their meshes
+#define SCALED_MESH_BUCKETS  256
+
+enum ScaledMeshKind
+{
+  SMK_CONVEX,
+  SMK_TRIANGLE
+};
+
+struct ScaledMeshEntry
+{
+  ScaledMeshEntry    *mNext;             // in the hash bucket
+  ScaledMeshKind      mKind;
+  NxU64               mSourceHash;       // content of the source descriptor
+  const char         *mSourceId;
+  NxU32               mSourcePoints;
+  NxU32               mSourceTriangles;
+  NxU32               mSourceCookedSize;
+  NxI32               mScale[3];
+  void               *mDesc;             // the scaled descriptor, NxConvexMeshDesc or NxTriangleMeshDesc
+  NxU32               mBytes;
+  NxU32               mLastUse;
+  const char         *mInstanceName;     // instance table name of the newest collection holding this mesh
+};
+
+static ScaledMeshEntry *gScaledMeshes[SCALED_MESH_BUCKETS];
+static NxU32            gScaledMeshBytes  = 0;
+static NxU32            gScaledMeshBudget = 32*1024*1024;
+static NxU32            gScaledMeshClock  = 0;
+
+static NxI32 quantizeScale(NxF32 s)
+{
+  return (NxI32) floorf(s/SCALE_QUANTUM+0.5f);
+}
+
+static NxU64 hashMeshData(NxU64 h,const void *data,NxU32 len)
+{
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (NxU32 i=0; i<len; i++)
+  {
+    h = (h^bytes[i])*1099511628211ULL;
+  }
+  return h;
+}
+
+template <class T> static NxU64 hashMeshArray(NxU64 h,const NxArray< T > &a)
+{
+  return a.size() ? hashMeshData(h,&a[0],a.size()*sizeof(T)) : h;
+}
+
+static NxU64 hashScaledMeshSource(const NxConvexMeshDesc &d)
+{
+  NxU64 h = 14695981039346656037ULL;
+  h = hashMeshData(h,&d.flags,sizeof(d.flags));
+  h = hashMeshArray(h,d.mPoints);
+  h = hashMeshArray(h,d.mTriangles);
+  h = hashMeshArray(h,d.mCookedData);
+  return h;
+}
+
+static NxU64 hashScaledMeshSource(const NxTriangleMeshDesc &d)
+{
+  NxU64 h = 14695981039346656037ULL;
+  h = hashMeshData(h,&d.flags,sizeof(d.flags));
+  h = hashMeshArray(h,d.mPoints);
+  h = hashMeshArray(h,d.mTriangles);
+  h = hashMeshArray(h,d.mMaterialIndices);
+  h = hashMeshArray(h,d.mCookedData);
+  return h;
+}
+
+static NxU32 scaledMeshBucket(NxU64 sourceHash,const NxI32 *scale)
+{
+  NxU32 h = (NxU32)(sourceHash^(sourceHash>>32));
+  h = (h^(NxU32)scale[0])*16777619u;
+  h = (h^(NxU32)scale[1])*16777619u;
+  h = (h^(NxU32)scale[2])*16777619u;
+  return (h^(h>>16)) & (SCALED_MESH_BUCKETS-1);
+}
+
+static NxU32 scaledMeshBytes(const NxConvexMeshDesc &d)
+{
+  return sizeof(d) + d.mPoints.size()*sizeof(NxVec3) + d.mTriangles.size()*sizeof(NxTri) + d.mCookedData.size();
+}
+
+static NxU32 scaledMeshBytes(const NxTriangleMeshDesc &d)
+{
+  return sizeof(d) + d.mPoints.size()*sizeof(NxVec3) + d.mTriangles.size()*sizeof(NxTri) + d.mCookedData.size() +
+         d.mMaterialIndices.size()*sizeof(NxU32) + d.mPmapData.size();
+}
+
+static void releaseScaledMesh(ScaledMeshEntry *e)
+{
+  if ( e->mKind == SMK_CONVEX )
+    delete (NxConvexMeshDesc *)e->mDesc;
+  else
+    delete (NxTriangleMeshDesc *)e->mDesc;
+  gScaledMeshBytes-=e->mBytes;
+  delete e;
+}
+
+// Drops least recently used meshes until the cache fits its budget.
+static void trimScaledMeshes(void)
+{
+  while ( gScaledMeshBytes > gScaledMeshBudget )
+  {
+    ScaledMeshEntry **oldest = 0;
+    for (NxU32 i=0; i<SCALED_MESH_BUCKETS; i++)
+    {
+      for (ScaledMeshEntry **e=&gScaledMeshes[i]; *e; e=&(*e)->mNext)
+      {
+        if ( oldest == 0 || (*e)->mLastUse < (*oldest)->mLastUse ) oldest = e;
+      }
+    }
+    if ( oldest == 0 ) break;
+    ScaledMeshEntry *e = *oldest;
+    *oldest = e->mNext;
+    releaseScaledMesh(e);
+  }
+}
+
+template <class Desc> static ScaledMeshEntry * findScaledMesh(ScaledMeshKind kind,const Desc *source,NxU64 sourceHash,const NxI32 *scale)
+{
+  ScaledMeshEntry *ret = 0;
+
+  for (ScaledMeshEntry *e=gScaledMeshes[scaledMeshBucket(sourceHash,scale)]; e; e=e->mNext)
+  {
+    if ( e->mKind == kind && e->mSourceHash == sourceHash &&
+         e->mScale[0] == scale[0] && e->mScale[1] == scale[1] && e->mScale[2] == scale[2] &&
+         e->mSourceId == source->mId && e->mSourcePoints == source->mPoints.size() &&
+         e->mSourceTriangles == source->mTriangles.size() && e->mSourceCookedSize == source->mCookedData.size() )
+    {
+      ret = e;
+      break;
+    }
+  }
+
+  return ret;
+}
+
+template <class Desc> static void addScaledMesh(ScaledMeshKind kind,const Desc *source,NxU64 sourceHash,const NxI32 *scale,const Desc &scaled,const char *instanceName)
+{
+  ScaledMeshEntry *e = new ScaledMeshEntry;
+  Desc *d = new Desc;
+  *d = scaled;
+  d->mInstance = 0;
+  e->mKind             = kind;
+  e->mSourceHash       = sourceHash;
+  e->mSourceId         = source->mId;
+  e->mSourcePoints     = source->mPoints.size();
+  e->mSourceTriangles  = source->mTriangles.size();
+  e->mSourceCookedSize = source->mCookedData.size();
+  e->mScale[0]         = scale[0];
+  e->mScale[1]         = scale[1];
+  e->mScale[2]         = scale[2];
+  e->mDesc             = d;
+  e->mBytes            = scaledMeshBytes(*d);
+  e->mLastUse          = ++gScaledMeshClock;
+  e->mInstanceName     = getGlobalString(instanceName);
+
+  NxU32 bucket = scaledMeshBucket(sourceHash,scale);
+  e->mNext = gScaledMeshes[bucket];
+  gScaledMeshes[bucket] = e;
+  gScaledMeshBytes+=e->mBytes;
+
+  trimScaledMeshes();
+}
+
+// Hands the SDK mesh created for an earlier collection to the new one, if there is one by now.
+static void shareScaledMeshInstance(ScaledMeshEntry *e,const char *instanceName)
+{
+  void *instance = e->mInstanceName ? findInstance(e->mInstanceName) : 0;
+  if ( instance )
+  {
+    if ( findInstance(instanceName) == 0 )
+      setInstance(instanceName,instance);
+  }
+  else
+  {
+    e->mInstanceName = getGlobalString(instanceName);
+  }
+}
+
+static ScaledMeshKind getScaledMeshKind(const NxConvexMeshDesc *)
+{
+  return SMK_CONVEX;
+}
+
+static ScaledMeshKind getScaledMeshKind(const NxTriangleMeshDesc *)
+{
+  return SMK_TRIANGLE;
+}
+
+static void copyMeshScaled(NxConvexMeshDesc *dest,NxConvexMeshDesc *source,const NxVec3 &scale,NxPhysicsSDK *sdk,const char *sourceId,const char *destId)
+{
+  copyConvexMeshScaled(dest,source,scale,sdk,sourceId,destId);
+}
+
+static void copyMeshScaled(NxTriangleMeshDesc *dest,NxTriangleMeshDesc *source,const NxVec3 &scale,NxPhysicsSDK *sdk,const char *sourceId,const char *destId)
+{
+  copyTriangleMeshScaled(dest,source,scale,sdk,sourceId,destId);
+}
+
+template <class Desc> static void copyMeshCached(Desc *dest,Desc *source,const NxVec3 &scale,NxPhysicsSDK *sdk,const char *sourceId,const char *destId)
+{
+  ScaledMeshKind kind = getScaledMeshKind(source);
+  NxI32 q[3] = { quantizeScale(scale.x), quantizeScale(scale.y), quantizeScale(scale.z) };
+
+  char instanceName[512];
+  sprintf(instanceName, "%s+%s", destId ? destId : "null", source->mId ? source->mId : "null" );
+
+  NxU64 sourceHash = hashScaledMeshSource(*source);
+  ScaledMeshEntry *e = findScaledMesh(kind,source,sourceHash,q);
+  if ( e )
+  {
+    *dest = *(const Desc *)e->mDesc;
+    e->mLastUse = ++gScaledMeshClock;
+    shareScaledMeshInstance(e,instanceName);
+  }
+  else
+  {
+    copyMeshScaled(dest,source,scale,sdk,sourceId,destId);
+    addScaledMesh(kind,source,sourceHash,q,*dest,instanceName);
+  }
+}
+
+void setScaledMeshCacheBudget(NxU32 bytes)
+{
+  gScaledMeshBudget = bytes;
+  trimScaledMeshes();
+}
+
+void releaseScaledMeshCache(void)
+{
+  for (NxU32 i=0; i<SCALED_MESH_BUCKETS; i++)
+  {
+    ScaledMeshEntry *e = gScaledMeshes[i];
+    while ( e )
+    {
+      ScaledMeshEntry *next = e->mNext;
+      releaseScaledMesh(e);
+      e = next;
+    }
+    gScaledMeshes[i] = 0;
+  }
+  gScaledMeshClock = 0;
+}
+
+
 NxuPhysicsCollection * scaleCopyCollection(const NxuPhysicsCollection *source,const char *newId,const NxVec3 &scale,NxPhysicsSDK *sdk)
 {
   NxuPhysicsCollection *ret = 0;
@@ -643,7 +908,7 @@ NxuPhysicsCollection * scaleCopyCollection(const NxuPhysicsCollection *source,co
   {
     NxConvexMeshDesc *desc = source->mConvexMeshes[i];
     NxConvexMeshDesc *d = new NxConvexMeshDesc;
-    copyConvexMeshScaled(d,desc,scale,sdk,source->mId,c->mId);
+    copyMeshCached(d,desc,scale,sdk,source->mId,c->mId);
     c->mConvexMeshes.push_back(d);
   }
 
@@ -656,7 +921,7 @@ NxuPhysicsCollection * scaleCopyCollection(const NxuPhysicsCollection *source,co
   {
     NxTriangleMeshDesc *desc = source->mTriangleMeshes[i];
     NxTriangleMeshDesc *d = new NxTriangleMeshDesc;
-    copyTriangleMeshScaled(d,desc,scale,sdk,source->mId,c->mId);
+    copyMeshCached(d,desc,scale,sdk,source->mId,c->mId);
     c->mTriangleMeshes.push_back(d);
   }
 
@@ -12,6 +12,12 @@ class NxuPhysicsCollection;
 // This is a helper function that will scale the assets in a physics collection to a new copy.  New id is *required* and must be unique.
 NxuPhysicsCollection * scaleCopyCollection(const NxuPhysicsCollection *source,const char *newId,const NxVec3 &scale,NxPhysicsSDK *sdk);
 
+// Scaled convex and triangle meshes are cached by source mesh and scale, so copying the same collection at the same scale
+// again doesn't scale and cook its meshes again. The least recently used meshes are dropped beyond this many bytes.
+void setScaledMeshCacheBudget(NxU32 bytes);
+// Frees the cached meshes. Also done by releasePersistentMemory.
+void releaseScaledMeshCache(void);
+
 }
 
 #endif
@@ -0,0 +1,752 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "NXU_Snapshot.h"
+
+#include <NxPhysics.h>
+
+namespace NXU
+{
+
+#define SNAPSHOT_KEYFRAME     'K'
+#define SNAPSHOT_DELTA        'D'
+
+#define ACTOR_FLOATS          13   // position, orientation, linear and angular velocity
+#define JOINT_FLOATS          14   // drive position, orientation, linear and angular velocity, motor velocity
+
+#define MAX_QUANTIZED_STEPS   (1<<30)
+
+//==================================================================================
+// Bit packing, most significant bit first so the stream doesn't depend on the processor's byte order.
+//==================================================================================
+
+class BitWriter
+{
+public:
+  BitWriter(NxArray< NxU8 > &out) : mOut(out)
+  {
+    mBits  = 0;
+    mCount = 0;
+  }
+
+  void write(NxU32 value,NxU32 bits) // up to 32 bits
+  {
+    if ( bits )
+    {
+      mBits = (mBits<<bits) | (value & (NxU32)(((NxU64)1<<bits)-1));
+      mCount+=bits;
+      while ( mCount >= 8 )
+      {
+        mCount-=8;
+        mOut.push_back( (NxU8)(mBits>>mCount) );
+      }
+    }
+  }
+
+  void flush(void)
+  {
+    if ( mCount )
+    {
+      write(0,8-mCount);
+    }
+  }
+
+private:
+  NxArray< NxU8 > &mOut;
+  NxU64            mBits;
+  NxU32            mCount;
+};
+
+class BitReader
+{
+public:
+  BitReader(const NxU8 *data,NxU32 len)
+  {
+    mData  = data;
+    mLen   = len;
+    mPos   = 0;
+    mBits  = 0;
+    mCount = 0;
+    mOk    = true;
+  }
+
+  NxU32 read(NxU32 bits) // up to 32 bits
+  {
+    NxU32 ret = 0;
+    if ( bits )
+    {
+      while ( mCount < bits )
+      {
+        if ( mPos == mLen )
+        {
+          mOk = false;
+          return 0;
+        }
+        mBits = (mBits<<8) | mData[mPos++];
+        mCount+=8;
+      }
+      mCount-=bits;
+      ret = (NxU32)((mBits>>mCount) & (((NxU64)1<<bits)-1));
+    }
+    return ret;
+  }
+
+  bool isOk(void) const { return mOk; };
+
+private:
+  const NxU8 *mData;
+  NxU32       mLen;
+  NxU32       mPos;
+  NxU64       mBits;
+  NxU32       mCount;
+  bool        mOk;
+};
+
+static NxU32 floatBits(NxF32 v)
+{
+  NxU32 ret;
+  memcpy(&ret,&v,sizeof(NxU32));
+  return ret;
+}
+
+static NxF32 bitsFloat(NxU32 v)
+{
+  NxF32 ret;
+  memcpy(&ret,&v,sizeof(NxF32));
+  return ret;
+}
+
+static NxU32 leadingZeros(NxU32 v)
+{
+  NxU32 ret = 0;
+  while ( ret < 32 && !(v & 0x80000000) )
+  {
+    v<<=1;
+    ret++;
+  }
+  return ret;
+}
+
+static NxU32 trailingZeros(NxU32 v)
+{
+  NxU32 ret = 0;
+  while ( ret < 32 && !(v & 1) )
+  {
+    v>>=1;
+    ret++;
+  }
+  return ret;
+}
+
+//==================================================================================
+// States as flat arrays of floats, in groups that change together.
+//==================================================================================
+
+static void packActor(const NxuActorState &a,NxF32 *f)
+{
+  f[0]  = a.mPosition.x;        f[1]  = a.mPosition.y;        f[2]  = a.mPosition.z;
+  f[3]  = a.mOrientation.x;     f[4]  = a.mOrientation.y;     f[5]  = a.mOrientation.z;     f[6] = a.mOrientation.w;
+  f[7]  = a.mLinearVelocity.x;  f[8]  = a.mLinearVelocity.y;  f[9]  = a.mLinearVelocity.z;
+  f[10] = a.mAngularVelocity.x; f[11] = a.mAngularVelocity.y; f[12] = a.mAngularVelocity.z;
+}
+
+static void unpackActor(const NxF32 *f,NxuActorState &a)
+{
+  a.mPosition.set(f[0],f[1],f[2]);
+  a.mOrientation.setXYZW(f[3],f[4],f[5],f[6]);
+  a.mLinearVelocity.set(f[7],f[8],f[9]);
+  a.mAngularVelocity.set(f[10],f[11],f[12]);
+}
+
+static void packJoint(const NxuJointState &j,NxF32 *f)
+{
+  f[0]  = j.mDrivePosition.x;        f[1]  = j.mDrivePosition.y;        f[2]  = j.mDrivePosition.z;
+  f[3]  = j.mDriveOrientation.x;     f[4]  = j.mDriveOrientation.y;     f[5]  = j.mDriveOrientation.z;     f[6] = j.mDriveOrientation.w;
+  f[7]  = j.mDriveLinearVelocity.x;  f[8]  = j.mDriveLinearVelocity.y;  f[9]  = j.mDriveLinearVelocity.z;
+  f[10] = j.mDriveAngularVelocity.x; f[11] = j.mDriveAngularVelocity.y; f[12] = j.mDriveAngularVelocity.z;
+  f[13] = j.mMotorVelocity;
+}
+
+static void unpackJoint(const NxF32 *f,NxuJointState &j)
+{
+  j.mDrivePosition.set(f[0],f[1],f[2]);
+  j.mDriveOrientation.setXYZW(f[3],f[4],f[5],f[6]);
+  j.mDriveLinearVelocity.set(f[7],f[8],f[9]);
+  j.mDriveAngularVelocity.set(f[10],f[11],f[12]);
+  j.mMotorVelocity = f[13];
+}
+
+struct FloatGroup
+{
+  NxU32 mFirst;
+  NxU32 mCount;
+  bool  mAngular;      // quantized with the angular quantum
+  bool  mOrientation;  // renormalized after quantized decoding
+};
+
+static const FloatGroup gActorGroups[] =
+{
+  { 0,  3, false, false },
+  { 3,  4, true,  true  },
+  { 7,  3, false, false },
+  { 10, 3, true,  false },
+};
+
+static const FloatGroup gJointGroups[] =
+{
+  { 0,  3, false, false },
+  { 3,  4, true,  true  },
+  { 7,  3, false, false },
+  { 10, 3, true,  false },
+  { 13, 1, true,  false },
+};
+
+#define ACTOR_GROUPS  (sizeof(gActorGroups)/sizeof(gActorGroups[0]))
+#define JOINT_GROUPS  (sizeof(gJointGroups)/sizeof(gJointGroups[0]))
+
+//==================================================================================
+// Delta coding of one group against the keyframe.  Lossless groups store the xor of the float bits as
+// leading zero count, length and the meaningful bits.  Quantized groups store the number of quantum steps
+// as a zigzag Exp-Golomb code.
+//==================================================================================
+
+struct GroupCode
+{
+  bool  mChanged;
+  bool  mQuantized;
+  NxI32 mSteps[4];
+};
+
+static void prepareGroup(const NxF32 *key,const NxF32 *value,NxU32 count,NxF32 quantum,GroupCode &gc)
+{
+  gc.mChanged   = false;
+  gc.mQuantized = quantum > 0;
+
+  for (NxU32 i=0; i<count && gc.mQuantized; i++)
+  {
+    double steps = ((double)value[i]-(double)key[i]) / quantum;
+    if ( steps > -MAX_QUANTIZED_STEPS && steps < MAX_QUANTIZED_STEPS ) // also false for nan
+    {
+      gc.mSteps[i] = (NxI32)floor(steps+0.5);
+    }
+    else
+    {
+      gc.mQuantized = false;
+    }
+  }
+
+  for (NxU32 i=0; i<count && !gc.mChanged; i++)
+  {
+    if ( gc.mQuantized )
+      gc.mChanged = gc.mSteps[i] != 0;
+    else
+      gc.mChanged = floatBits(key[i]) != floatBits(value[i]);
+  }
+}
+
+static void writeGroup(BitWriter &w,const NxF32 *key,const NxF32 *value,NxU32 count,NxF32 quantum,const GroupCode &gc)
+{
+  w.write(gc.mChanged,1);
+  if ( gc.mChanged )
+  {
+    if ( quantum > 0 )
+    {
+      w.write(gc.mQuantized,1);
+    }
+    for (NxU32 i=0; i<count; i++)
+    {
+      if ( gc.mQuantized )
+      {
+        NxU32 zigzag = ((NxU32)gc.mSteps[i]<<1) ^ (NxU32)(gc.mSteps[i]>>31);
+        NxU32 v      = zigzag+1;
+        NxU32 bits   = 32-leadingZeros(v);
+        w.write(0,bits-1);
+        w.write(v,bits);
+      }
+      else
+      {
+        NxU32 x = floatBits(key[i]) ^ floatBits(value[i]);
+        if ( x == 0 )
+        {
+          w.write(0,1);
+        }
+        else
+        {
+          NxU32 lead  = leadingZeros(x);
+          NxU32 trail = trailingZeros(x);
+          NxU32 len   = 32-lead-trail;
+          w.write(1,1);
+          w.write(lead,5);
+          w.write(len-1,5);
+          w.write(x>>trail,len);
+        }
+      }
+    }
+  }
+}
+
+static void readGroup(BitReader &r,const NxF32 *key,NxF32 *value,const FloatGroup &g,NxF32 quantum)
+{
+  key+=g.mFirst;
+  value+=g.mFirst;
+
+  if ( !r.read(1) )
+  {
+    for (NxU32 i=0; i<g.mCount; i++)
+    {
+      value[i] = key[i];
+    }
+    return;
+  }
+
+  bool quantized = quantum > 0 && r.read(1);
+  for (NxU32 i=0; i<g.mCount && r.isOk(); i++)
+  {
+    if ( quantized )
+    {
+      NxU32 bits = 1;
+      while ( !r.read(1) && bits < 32 && r.isOk() )
+      {
+        bits++;
+      }
+      NxU32 v      = (1u<<(bits-1)) | r.read(bits-1);
+      NxU32 zigzag = v-1;
+      NxI32 steps  = (NxI32)(zigzag>>1) ^ -(NxI32)(zigzag&1);
+      value[i] = (NxF32)((double)key[i] + (double)steps*quantum);
+    }
+    else if ( r.read(1) )
+    {
+      NxU32 lead  = r.read(5);
+      NxU32 len   = r.read(5)+1;
+      NxU32 x     = 0;
+      if ( lead+len <= 32 )
+      {
+        x = r.read(len) << (32-lead-len);
+      }
+      value[i] = bitsFloat(floatBits(key[i]) ^ x);
+    }
+    else
+    {
+      value[i] = key[i];
+    }
+  }
+
+  if ( quantized && g.mOrientation )
+  {
+    NxQuat q;
+    q.setXYZW(value[0],value[1],value[2],value[3]);
+    q.normalize();
+    value[0] = q.x;
+    value[1] = q.y;
+    value[2] = q.z;
+    value[3] = q.w;
+  }
+}
+
+//==================================================================================
+// NxuSnapshotPhysicsScene
+//==================================================================================
+
+NxuSnapshotPhysicsScene::NxuSnapshotPhysicsScene(NxScene &scene) : mScene(scene)
+{
+  refresh();
+}
+
+void NxuSnapshotPhysicsScene::refresh(void)
+{
+  mActors.clear();
+  NxU32 acount = mScene.getNbActors();
+  NxActor **actors = mScene.getActors();
+  for (NxU32 i=0; i<acount; i++)
+  {
+    if ( actors[i]->isDynamic() )
+    {
+      mActors.push_back(actors[i]);
+    }
+  }
+
+  mJoints.clear();
+  mScene.resetJointIterator();
+  while ( NxJoint *j = mScene.getNextJoint() )
+  {
+    mJoints.push_back(j);
+  }
+}
+
+NxU32 NxuSnapshotPhysicsScene::getActorCount(void)
+{
+  return mActors.size();
+}
+
+void NxuSnapshotPhysicsScene::getActorState(NxU32 index,NxuActorState &state)
+{
+  NxActor *a = mActors[index];
+  state.mPosition        = a->getGlobalPosition();
+  state.mOrientation     = a->getGlobalOrientationQuat();
+  state.mLinearVelocity  = a->getLinearVelocity();
+  state.mAngularVelocity = a->getAngularVelocity();
+  state.mSleeping        = a->isSleeping();
+}
+
+void NxuSnapshotPhysicsScene::setActorState(NxU32 index,const NxuActorState &state)
+{
+  NxActor *a = mActors[index];
+  a->setGlobalPosition(state.mPosition);
+  a->setGlobalOrientationQuat(state.mOrientation);
+  if ( !a->readBodyFlag(NX_BF_KINEMATIC) )
+  {
+    a->setLinearVelocity(state.mLinearVelocity);
+    a->setAngularVelocity(state.mAngularVelocity);
+    // last, setting the velocities wakes the actor up
+    if ( state.mSleeping )
+      a->putToSleep();
+    else
+      a->wakeUp();
+  }
+}
+
+NxU32 NxuSnapshotPhysicsScene::getJointCount(void)
+{
+  return mJoints.size();
+}
+
+void NxuSnapshotPhysicsScene::getJointState(NxU32 index,NxuJointState &state)
+{
+  NxJoint *j = mJoints[index];
+
+  state.mState = j->getState();
+  state.mDrivePosition.zero();
+  state.mDriveOrientation.id();
+  state.mDriveLinearVelocity.zero();
+  state.mDriveAngularVelocity.zero();
+  state.mMotorVelocity = 0;
+
+  NxD6Joint *d6 = j->isD6Joint();
+  if ( d6 )
+  {
+    NxD6JointDesc desc;
+    d6->saveToDesc(desc);
+    state.mDrivePosition        = desc.drivePosition;
+    state.mDriveOrientation     = desc.driveOrientation;
+    state.mDriveLinearVelocity  = desc.driveLinearVelocity;
+    state.mDriveAngularVelocity = desc.driveAngularVelocity;
+  }
+
+  NxRevoluteJoint *r = j->isRevoluteJoint();
+  NxMotorDesc motor;
+  if ( r && r->getMotor(motor) )
+  {
+    state.mMotorVelocity = motor.velTarget;
+  }
+}
+
+void NxuSnapshotPhysicsScene::setJointState(NxU32 index,const NxuJointState &state)
+{
+  NxJoint *j = mJoints[index];
+
+  NxD6Joint *d6 = j->isD6Joint();
+  if ( d6 )
+  {
+    d6->setDrivePosition(state.mDrivePosition);
+    d6->setDriveOrientation(state.mDriveOrientation);
+    d6->setDriveLinearVelocity(state.mDriveLinearVelocity);
+    d6->setDriveAngularVelocity(state.mDriveAngularVelocity);
+  }
+
+  NxRevoluteJoint *r = j->isRevoluteJoint();
+  NxMotorDesc motor;
+  if ( r && r->getMotor(motor) )
+  {
+    motor.velTarget = state.mMotorVelocity;
+    r->setMotor(motor);
+  }
+}
+
+//==================================================================================
+// NxuSnapshot
+//==================================================================================
+
+void NxuSnapshot::capture(NxuSnapshotScene &scene,NxU32 frame)
+{
+  mFrame = frame;
+
+  NxU32 acount = scene.getActorCount();
+  mActors.resize(acount);
+  for (NxU32 i=0; i<acount; i++)
+  {
+    scene.getActorState(i,mActors[i]);
+  }
+
+  NxU32 jcount = scene.getJointCount();
+  mJoints.resize(jcount);
+  for (NxU32 i=0; i<jcount; i++)
+  {
+    scene.getJointState(i,mJoints[i]);
+  }
+}
+
+void NxuSnapshot::restore(NxuSnapshotScene &scene) const
+{
+  NxU32 acount = scene.getActorCount();
+  for (NxU32 i=0; i<acount && i<mActors.size(); i++)
+  {
+    scene.setActorState(i,mActors[i]);
+  }
+
+  NxU32 jcount = scene.getJointCount();
+  for (NxU32 i=0; i<jcount && i<mJoints.size(); i++)
+  {
+    scene.setJointState(i,mJoints[i]);
+  }
+}
+
+//==================================================================================
+// NxuSnapshotEncoder
+//==================================================================================
+
+NxuSnapshotEncoder::NxuSnapshotEncoder(NxU32 keyframeInterval,NxF32 linearQuantum,NxF32 angularQuantum)
+{
+  mHaveKey          = false;
+  mSinceKey         = 0;
+  mKeyframeInterval = keyframeInterval ? keyframeInterval : 1;
+  mLinearQuantum    = linearQuantum > 0 ? linearQuantum : 0;
+  mAngularQuantum   = angularQuantum > 0 ? angularQuantum : 0;
+}
+
+bool NxuSnapshotEncoder::encode(const NxuSnapshot &frame,NxArray< NxU8 > &out)
+{
+  bool keyframe = !mHaveKey ||
+                  mSinceKey >= mKeyframeInterval ||
+                  frame.mActors.size() != mKey.mActors.size() ||
+                  frame.mJoints.size() != mKey.mJoints.size();
+
+  BitWriter w(out);
+  NxF32 f[JOINT_FLOATS];
+
+  if ( keyframe )
+  {
+    mKey      = frame;
+    mHaveKey  = true;
+    mSinceKey = 1;
+
+    w.write(SNAPSHOT_KEYFRAME,8);
+    w.write(frame.mFrame,32);
+    w.write(frame.mActors.size(),32);
+    w.write(frame.mJoints.size(),32);
+
+    for (NxU32 i=0; i<frame.mActors.size(); i++)
+    {
+      packActor(frame.mActors[i],f);
+      for (NxU32 k=0; k<ACTOR_FLOATS; k++)
+      {
+        w.write(floatBits(f[k]),32);
+      }
+      w.write(frame.mActors[i].mSleeping,1);
+    }
+
+    for (NxU32 i=0; i<frame.mJoints.size(); i++)
+    {
+      w.write(frame.mJoints[i].mState,8);
+      packJoint(frame.mJoints[i],f);
+      for (NxU32 k=0; k<JOINT_FLOATS; k++)
+      {
+        w.write(floatBits(f[k]),32);
+      }
+    }
+  }
+  else
+  {
+    mSinceKey++;
+
+    w.write(SNAPSHOT_DELTA,8);
+    w.write(frame.mFrame,32);
+    w.write(mKey.mFrame,32);
+    w.write(floatBits(mLinearQuantum),32);
+    w.write(floatBits(mAngularQuantum),32);
+
+    NxF32 kf[JOINT_FLOATS];
+    GroupCode codes[JOINT_GROUPS];
+
+    for (NxU32 i=0; i<frame.mActors.size(); i++)
+    {
+      const NxuActorState &a = frame.mActors[i];
+      const NxuActorState &k = mKey.mActors[i];
+      packActor(a,f);
+      packActor(k,kf);
+
+      bool changed = a.mSleeping != k.mSleeping;
+      for (NxU32 g=0; g<ACTOR_GROUPS; g++)
+      {
+        const FloatGroup &fg = gActorGroups[g];
+        prepareGroup(&kf[fg.mFirst],&f[fg.mFirst],fg.mCount,fg.mAngular ? mAngularQuantum : mLinearQuantum,codes[g]);
+        changed|=codes[g].mChanged;
+      }
+
+      w.write(changed,1);
+      if ( changed )
+      {
+        w.write(a.mSleeping,1);
+        for (NxU32 g=0; g<ACTOR_GROUPS; g++)
+        {
+          const FloatGroup &fg = gActorGroups[g];
+          writeGroup(w,&kf[fg.mFirst],&f[fg.mFirst],fg.mCount,fg.mAngular ? mAngularQuantum : mLinearQuantum,codes[g]);
+        }
+      }
+    }
+
+    for (NxU32 i=0; i<frame.mJoints.size(); i++)
+    {
+      const NxuJointState &j = frame.mJoints[i];
+      const NxuJointState &k = mKey.mJoints[i];
+      packJoint(j,f);
+      packJoint(k,kf);
+
+      bool changed = j.mState != k.mState;
+      for (NxU32 g=0; g<JOINT_GROUPS; g++)
+      {
+        const FloatGroup &fg = gJointGroups[g];
+        prepareGroup(&kf[fg.mFirst],&f[fg.mFirst],fg.mCount,fg.mAngular ? mAngularQuantum : mLinearQuantum,codes[g]);
+        changed|=codes[g].mChanged;
+      }
+
+      w.write(changed,1);
+      if ( changed )
+      {
+        w.write(j.mState,8);
+        for (NxU32 g=0; g<JOINT_GROUPS; g++)
+        {
+          const FloatGroup &fg = gJointGroups[g];
+          writeGroup(w,&kf[fg.mFirst],&f[fg.mFirst],fg.mCount,fg.mAngular ? mAngularQuantum : mLinearQuantum,codes[g]);
+        }
+      }
+    }
+  }
+
+  w.flush();
+
+  return keyframe;
+}
+
+//==================================================================================
+// NxuSnapshotDecoder
+//==================================================================================
+
+bool NxuSnapshotDecoder::decode(const NxU8 *data,NxU32 len,NxuSnapshot &frame)
+{
+  BitReader r(data,len);
+  NxF32 f[JOINT_FLOATS];
+
+  NxU32 type = r.read(8);
+  if ( type == SNAPSHOT_KEYFRAME )
+  {
+    NxuSnapshot key;
+    key.mFrame   = r.read(32);
+    NxU32 acount = r.read(32);
+    NxU32 jcount = r.read(32);
+
+    // don't trust counts the data can't hold
+    NxU64 bits = (NxU64)acount*(ACTOR_FLOATS*32+1) + (NxU64)jcount*(JOINT_FLOATS*32+8);
+    if ( !r.isOk() || bits > (NxU64)len*8 )
+    {
+      return false;
+    }
+
+    key.mActors.resize(acount);
+    for (NxU32 i=0; i<acount && r.isOk(); i++)
+    {
+      for (NxU32 k=0; k<ACTOR_FLOATS; k++)
+      {
+        f[k] = bitsFloat(r.read(32));
+      }
+      unpackActor(f,key.mActors[i]);
+      key.mActors[i].mSleeping = r.read(1) != 0;
+    }
+
+    key.mJoints.resize(jcount);
+    for (NxU32 i=0; i<jcount && r.isOk(); i++)
+    {
+      key.mJoints[i].mState = r.read(8);
+      for (NxU32 k=0; k<JOINT_FLOATS; k++)
+      {
+        f[k] = bitsFloat(r.read(32));
+      }
+      unpackJoint(f,key.mJoints[i]);
+    }
+
+    if ( !r.isOk() )
+    {
+      return false;
+    }
+
+    mKey     = key;
+    mHaveKey = true;
+    frame    = key;
+    return true;
+  }
+
+  if ( type != SNAPSHOT_DELTA || !mHaveKey )
+  {
+    return false;
+  }
+
+  NxU32 frameNo        = r.read(32);
+  NxU32 keyNo          = r.read(32);
+  NxF32 linearQuantum  = bitsFloat(r.read(32));
+  NxF32 angularQuantum = bitsFloat(r.read(32));
+  if ( !r.isOk() || keyNo != mKey.mFrame )
+  {
+    return false;
+  }
+
+  NxuSnapshot result;
+  result.mFrame = frameNo;
+  result.mActors.resize(mKey.mActors.size());
+  result.mJoints.resize(mKey.mJoints.size());
+
+  NxF32 kf[JOINT_FLOATS];
+
+  for (NxU32 i=0; i<mKey.mActors.size() && r.isOk(); i++)
+  {
+    const NxuActorState &k = mKey.mActors[i];
+    NxuActorState &a = result.mActors[i];
+    a = k;
+    if ( r.read(1) )
+    {
+      a.mSleeping = r.read(1) != 0;
+      packActor(k,kf);
+      for (NxU32 g=0; g<ACTOR_GROUPS; g++)
+      {
+        readGroup(r,kf,f,gActorGroups[g],gActorGroups[g].mAngular ? angularQuantum : linearQuantum);
+      }
+      unpackActor(f,a);
+    }
+  }
+
+  for (NxU32 i=0; i<mKey.mJoints.size() && r.isOk(); i++)
+  {
+    const NxuJointState &k = mKey.mJoints[i];
+    NxuJointState &j = result.mJoints[i];
+    j = k;
+    if ( r.read(1) )
+    {
+      j.mState = r.read(8);
+      packJoint(k,kf);
+      for (NxU32 g=0; g<JOINT_GROUPS; g++)
+      {
+        readGroup(r,kf,f,gJointGroups[g],gJointGroups[g].mAngular ? angularQuantum : linearQuantum);
+      }
+      unpackJoint(f,j);
+    }
+  }
+
+  if ( !r.isOk() )
+  {
+    return false;
+  }
+
+  frame = result;
+  return true;
+}
+
+};
@@ -0,0 +1,137 @@
+#ifndef NXU_SNAPSHOT_H
+
+#define NXU_SNAPSHOT_H
+
+#include "NxSimpleTypes.h"
+#include "NxArray.h"
+#include "NxVec3.h"
+#include "NxQuat.h"
+
+class NxScene;
+class NxActor;
+class NxJoint;
+
+namespace NXU
+{
+
+// The simulation state of one dynamic actor.
+struct NxuActorState
+{
+  NxVec3 mPosition;
+  NxQuat mOrientation;
+  NxVec3 mLinearVelocity;
+  NxVec3 mAngularVelocity;
+  bool   mSleeping;
+};
+
+// The run time state of one joint. The drive targets are only used by D6 joints and the motor velocity only by
+// revolute joints with a motor.
+struct NxuJointState
+{
+  NxU32  mState;                 // NxJointState
+  NxVec3 mDrivePosition;
+  NxQuat mDriveOrientation;
+  NxVec3 mDriveLinearVelocity;
+  NxVec3 mDriveAngularVelocity;
+  NxF32  mMotorVelocity;
+};
+
+// What snapshots are captured from and restored to. NxuSnapshotPhysicsScene wraps an NxScene, tests can hand
+// in a stand-in instead.
+class NxuSnapshotScene
+{
+public:
+  virtual ~NxuSnapshotScene(void) { }
+
+  virtual NxU32 getActorCount(void) = 0;
+  virtual void  getActorState(NxU32 index,NxuActorState &state) = 0;
+  virtual void  setActorState(NxU32 index,const NxuActorState &state) = 0;
+
+  virtual NxU32 getJointCount(void) = 0;
+  virtual void  getJointState(NxU32 index,NxuJointState &state) = 0;
+  virtual void  setJointState(NxU32 index,const NxuJointState &state) = 0;
+};
+
+// The dynamic actors and the joints of an NxScene, in creation order. A recording only replays onto a scene
+// whose actors and joints were created in the same order. Call refresh() after adding or releasing any.
+// Broken joints can't be restored to simulating.
+class NxuSnapshotPhysicsScene : public NxuSnapshotScene
+{
+public:
+  NxuSnapshotPhysicsScene(NxScene &scene);
+
+  void  refresh(void);
+
+  NxU32 getActorCount(void);
+  void  getActorState(NxU32 index,NxuActorState &state);
+  void  setActorState(NxU32 index,const NxuActorState &state);
+
+  NxU32 getJointCount(void);
+  void  getJointState(NxU32 index,NxuJointState &state);
+  void  setJointState(NxU32 index,const NxuJointState &state);
+
+private:
+  NxScene              &mScene;
+  NxArray< NxActor * >  mActors;
+  NxArray< NxJoint * >  mJoints;
+};
+
+class NxuSnapshot
+{
+public:
+  NxuSnapshot(void) { mFrame = 0; }
+
+  void capture(NxuSnapshotScene &scene,NxU32 frame);
+  void restore(NxuSnapshotScene &scene) const;
+
+  NxU32                     mFrame;
+  NxArray< NxuActorState >  mActors;
+  NxArray< NxuJointState >  mJoints;
+};
+
+// Encodes a stream of snapshots as a keyframe every 'keyframeInterval' frames and, in between, deltas holding
+// only what changed since the last keyframe. Every delta decodes on its own given that keyframe, so frames can
+// be dropped or skipped.
+//
+// With quanta of zero the deltas are lossless and the decoder reproduces the captured state bit for bit.
+// Otherwise positions and linear velocities are rounded to multiples of 'linearQuantum' and orientations and
+// angular velocities to multiples of 'angularQuantum' relative to the keyframe, so an error never accumulates
+// beyond half a quantum. Orientations are renormalized after decoding, which moves their components by up to
+// one more quantum. Keyframes are always lossless.
+class NxuSnapshotEncoder
+{
+public:
+  NxuSnapshotEncoder(NxU32 keyframeInterval=60,NxF32 linearQuantum=0,NxF32 angularQuantum=0);
+
+  // Appends the encoded frame to 'out'. Returns true if it was written as a keyframe.
+  bool encode(const NxuSnapshot &frame,NxArray< NxU8 > &out);
+
+  // The next frame is written as a keyframe, for example when a client joins.
+  void forceKeyframe(void) { mHaveKey = false; }
+
+private:
+  NxuSnapshot mKey;
+  bool        mHaveKey;
+  NxU32       mSinceKey;
+  NxU32       mKeyframeInterval;
+  NxF32       mLinearQuantum;
+  NxF32       mAngularQuantum;
+};
+
+class NxuSnapshotDecoder
+{
+public:
+  NxuSnapshotDecoder(void) { mHaveKey = false; }
+
+  // Decodes a keyframe, or a delta against the keyframe it names. Returns false for corrupt data or a delta
+  // whose keyframe hasn't been decoded.
+  bool decode(const NxU8 *data,NxU32 len,NxuSnapshot &frame);
+
+private:
+  NxuSnapshot mKey;
+  bool        mHaveKey;
+};
+
+}
+
+#endif
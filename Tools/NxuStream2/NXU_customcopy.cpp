@@ -580,14 +580,10 @@ NxActor    * CustomCopy::getActorFromName(const char *name)
 	NxActor *ret = 0;
 	if ( mCurrentScene && name )
 	{
-		for (unsigned int i=0; i<mCurrentScene->mActors.size(); i++)
+		NxActorDesc *a = findDescById(mCurrentScene->mActors,name);
+		if ( a )
 		{
-			NxActorDesc *a = mCurrentScene->mActors[i];
-			if ( a->mId && strcmp(a->mId,name) == 0 )
-			{
-				ret = (NxActor *)a->mInstance;
-				break;
-			}
+			ret = (NxActor *)a->mInstance;
 		}
 	}
 
@@ -599,19 +595,164 @@ const char * CustomCopy::getNameFromActor(NxActor *actor)
 	const char *ret = 0;
 	if ( mCurrentScene && actor )
 	{
-		for (unsigned int i=0; i<mCurrentScene->mActors.size(); i++)
+		NxActorDesc *a = findDescByInstance(mCurrentScene->mActors,actor);
+		if ( a )
 		{
-			NxActorDesc *a = mCurrentScene->mActors[i];
-			if ( a->mInstance == actor )
-			{
-				ret = a->mId;
-				break;
-			}
+			ret = a->mId;
 		}
 	}
 	return ret;
 }
 
+static NxU32 hashPointer(const void *p)
+{
+  NxU64 v = (NxU64)(size_t)p;
+  NxU32 h = (NxU32)(v^(v>>32))*2654435761u;
+  return h^(h>>15); // the low bits pick the slot, and aligned pointers have none of their own
+}
+
+static NxU32 hashString(const char *str)
+{
+  NxU32 h = 2166136261u;
+  while ( *str )
+  {
+    h = (h^(unsigned char)*str++)*16777619u;
+  }
+  return h;
+}
+
+NxuDescIndex::NxuDescIndex(const void *list)
+{
+  mList             = list;
+  mIndexed          = 0;
+  mLast             = 0;
+  mInstances        = 0;
+  mInstanceCapacity = 0;
+  mInstanceCount    = 0;
+  mIds              = 0;
+  mIdCapacity       = 0;
+  mIdCount          = 0;
+}
+
+NxuDescIndex::~NxuDescIndex(void)
+{
+  delete []mInstances;
+  delete []mIds;
+}
+
+void NxuDescIndex::reset(void)
+{
+  mIndexed = 0;
+  mLast    = 0;
+  if ( mInstances ) memset(mInstances,0,sizeof(Slot)*mInstanceCapacity);
+  if ( mIds ) memset(mIds,0,sizeof(Slot)*mIdCapacity);
+  mInstanceCount = 0;
+  mIdCount       = 0;
+}
+
+// Keeps the open addressed table at most half full.
+void NxuDescIndex::grow(Slot *&slots,NxU32 &capacity,NxU32 count)
+{
+  if ( (count+1)*2 > capacity )
+  {
+    Slot *old = slots;
+    NxU32 oldCapacity = capacity;
+    capacity = capacity ? capacity*2 : 64;
+    slots = new Slot[capacity];
+    memset(slots,0,sizeof(Slot)*capacity);
+    for (NxU32 i=0; i<oldCapacity; i++)
+    {
+      if ( old[i].mKey )
+      {
+        NxU32 s = old[i].mHash & (capacity-1);
+        while ( slots[s].mKey ) s = (s+1)&(capacity-1);
+        slots[s] = old[i];
+      }
+    }
+    delete []old;
+  }
+}
+
+void NxuDescIndex::insertInstance(const void *instance,NxU32 index)
+{
+  grow(mInstances,mInstanceCapacity,mInstanceCount);
+  NxU32 hash = hashPointer(instance);
+  NxU32 s = hash & (mInstanceCapacity-1);
+  while ( mInstances[s].mKey )
+  {
+    if ( mInstances[s].mKey == instance ) return; // keep the first one, as a linear scan would find
+    s = (s+1)&(mInstanceCapacity-1);
+  }
+  mInstances[s].mKey   = instance;
+  mInstances[s].mHash  = hash;
+  mInstances[s].mIndex = (NxI32)index;
+  mInstanceCount++;
+}
+
+void NxuDescIndex::insertId(const char *id,NxU32 index)
+{
+  grow(mIds,mIdCapacity,mIdCount);
+  NxU32 hash = hashString(id);
+  NxU32 s = hash & (mIdCapacity-1);
+  while ( mIds[s].mKey )
+  {
+    if ( mIds[s].mHash == hash && strcmp((const char *)mIds[s].mKey,id) == 0 ) return;
+    s = (s+1)&(mIdCapacity-1);
+  }
+  mIds[s].mKey   = id;
+  mIds[s].mHash  = hash;
+  mIds[s].mIndex = (NxI32)index;
+  mIdCount++;
+}
+
+NxI32 NxuDescIndex::lookupInstance(const void *instance) const
+{
+  if ( mInstanceCount )
+  {
+    NxU32 s = hashPointer(instance) & (mInstanceCapacity-1);
+    while ( mInstances[s].mKey )
+    {
+      if ( mInstances[s].mKey == instance ) return mInstances[s].mIndex;
+      s = (s+1)&(mInstanceCapacity-1);
+    }
+  }
+  return -1;
+}
+
+NxI32 NxuDescIndex::lookupId(const char *id) const
+{
+  if ( mIdCount )
+  {
+    NxU32 hash = hashString(id);
+    NxU32 s = hash & (mIdCapacity-1);
+    while ( mIds[s].mKey )
+    {
+      if ( mIds[s].mHash == hash && strcmp((const char *)mIds[s].mKey,id) == 0 ) return mIds[s].mIndex;
+      s = (s+1)&(mIdCapacity-1);
+    }
+  }
+  return -1;
+}
+
+NxuExportIndex::~NxuExportIndex(void)
+{
+  for (NxU32 i=0; i<mIndices.size(); i++)
+  {
+    delete mIndices[i];
+  }
+}
+
+NxuDescIndex & NxuExportIndex::getIndex(const void *list)
+{
+  for (NxU32 i=0; i<mIndices.size(); i++)
+  {
+    if ( mIndices[i]->getList() == list ) return *mIndices[i];
+  }
+  NxuDescIndex *index = new NxuDescIndex(list);
+  mIndices.push_back(index);
+  return *index;
+}
+
 NxSceneDesc *         CustomCopy::locateSceneDesc(NxuPhysicsCollection *pc,const char *id,NxU32 &index)
 {
   NxSceneDesc *ret = 0;
@@ -930,17 +1071,13 @@ NxConvexMesh * CustomCopy::getConvexMeshFromName(const char *name)
   assert(mCurrentCollection);
   if ( mCurrentCollection && name )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mConvexMeshes.size(); i++)
+  	NxConvexMeshDesc *sd = findDescById(mCurrentCollection->mConvexMeshes,name);
+  	if ( sd )
   	{
-  		NxConvexMeshDesc *sd = mCurrentCollection->mConvexMeshes[i];
-  		if ( strcmp(sd->mId,name) == 0 )
+  		ret = (NxConvexMesh *) sd->mInstance;
+  		if ( ret == 0 )
   		{
-  			ret = (NxConvexMesh *) sd->mInstance;
-				if ( ret == 0 )
-				{
-					reportWarning("ConvexMesh %s was not successfully created.", name );
-				}
-  			break;
+  			reportWarning("ConvexMesh %s was not successfully created.", name );
   		}
   	}
   }
@@ -955,14 +1092,10 @@ NxConvexMeshDesc * CustomCopy::getConvexMeshDescFromName(const char *name)
   assert(mCurrentCollection);
   if ( mCurrentCollection && name )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mConvexMeshes.size(); i++)
+  	NxConvexMeshDesc *sd = findDescById(mCurrentCollection->mConvexMeshes,name);
+  	if ( sd )
   	{
-  		NxConvexMeshDesc *sd = mCurrentCollection->mConvexMeshes[i];
-  		if ( strcmp(sd->mId,name) == 0 )
-  		{
-  			ret = sd;
-  			break;
-  		}
+  		ret = sd;
   	}
   }
 
@@ -976,15 +1109,11 @@ const char *   CustomCopy::getNameFromConvexMesh(NxConvexMesh *mesh)
   assert(mCurrentCollection);
   if ( mCurrentCollection && mesh )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mConvexMeshes.size(); i++)
+  	NxConvexMeshDesc *sd = findDescByInstance(mCurrentCollection->mConvexMeshes,mesh);
+  	if ( sd )
   	{
-  		NxConvexMeshDesc *sd = mCurrentCollection->mConvexMeshes[i];
-  		if ( sd->mInstance == mesh )
-  		{
-  			ret = sd->mId;
-  			assert(ret);
-  			break;
-  		}
+  		ret = sd->mId;
+  		assert(ret);
   	}
   }
 
@@ -999,15 +1128,11 @@ NxTriangleMesh * CustomCopy::getTriangleMeshFromName(const char *name)
   assert(mCurrentCollection);
   if ( mCurrentCollection && name )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mTriangleMeshes.size(); i++)
+  	NxTriangleMeshDesc *sd = findDescById(mCurrentCollection->mTriangleMeshes,name);
+  	if ( sd )
   	{
-  		NxTriangleMeshDesc *sd = mCurrentCollection->mTriangleMeshes[i];
-  		if ( strcmp(sd->mId,name) == 0 )
-  		{
-  			ret = (NxTriangleMesh *) sd->mInstance;
-  			assert(ret);
-  			break;
-  		}
+  		ret = (NxTriangleMesh *) sd->mInstance;
+  		assert(ret);
   	}
   }
 
@@ -1021,15 +1146,11 @@ const char *   CustomCopy::getNameFromTriangleMesh(NxTriangleMesh *mesh)
   assert(mCurrentCollection);
   if ( mCurrentCollection && mesh )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mTriangleMeshes.size(); i++)
+  	NxTriangleMeshDesc *sd = findDescByInstance(mCurrentCollection->mTriangleMeshes,mesh);
+  	if ( sd )
   	{
-  		NxTriangleMeshDesc *sd = mCurrentCollection->mTriangleMeshes[i];
-  		if ( sd->mInstance == mesh )
-  		{
-  			ret = sd->mId;
-  			assert(ret);
-  			break;
-  		}
+  		ret = sd->mId;
+  		assert(ret);
   	}
   }
 
@@ -1043,15 +1164,11 @@ NxHeightField * CustomCopy::getHeightFieldFromName(const char *name)
   assert(mCurrentCollection);
   if ( mCurrentCollection && name )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mHeightFields.size(); i++)
+  	NxHeightFieldDesc *sd = findDescById(mCurrentCollection->mHeightFields,name);
+  	if ( sd )
   	{
-  		NxHeightFieldDesc *sd = mCurrentCollection->mHeightFields[i];
-  		if ( strcmp(sd->mId,name) == 0 )
-  		{
-  			ret = (NxHeightField *) sd->mInstance;
-  			assert(ret);
-  			break;
-  		}
+  		ret = (NxHeightField *) sd->mInstance;
+  		assert(ret);
   	}
   }
 
@@ -1065,15 +1182,11 @@ const char *   CustomCopy::getNameFromHeightField(NxHeightField *mesh)
   assert(mCurrentCollection);
   if ( mCurrentCollection && mesh )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mHeightFields.size(); i++)
+  	NxHeightFieldDesc *sd = findDescByInstance(mCurrentCollection->mHeightFields,mesh);
+  	if ( sd )
   	{
-  		NxHeightFieldDesc *sd = mCurrentCollection->mHeightFields[i];
-  		if ( sd->mInstance == mesh )
-  		{
-  			ret = sd->mId;
-  			assert(ret);
-  			break;
-  		}
+  		ret = sd->mId;
+  		assert(ret);
   	}
   }
 
@@ -1087,15 +1200,11 @@ NxForceField * CustomCopy::getForceFieldFromName(const char *name)
 	assert(mCurrentScene);
 	if ( mCurrentScene && name )
 	{
-		for (unsigned int i=0; i<mCurrentScene->mForceFields.size(); i++)
+		NxForceFieldDesc *fd = findDescById(mCurrentScene->mForceFields,name);
+		if ( fd )
 		{
-			NxForceFieldDesc *fd = mCurrentScene->mForceFields[i];
-			if ( strcmp(fd->mId,name) == 0 )
-			{
-				ret = (NxForceField *) fd->mInstance;
-				assert(ret);
-				break;
-			}
+			ret = (NxForceField *) fd->mInstance;
+			assert(ret);
 		}
 	}
 
@@ -1109,15 +1218,11 @@ const char *  CustomCopy::getNameFromForceField(NxForceField *field)
 	assert(mCurrentScene);
 	if ( mCurrentScene && field )
 	{
-		for (unsigned int i=0; i<mCurrentScene->mForceFields.size(); i++)
+		NxForceFieldDesc *fd = findDescByInstance(mCurrentScene->mForceFields,field);
+		if ( fd )
 		{
-			NxForceFieldDesc *fd = mCurrentScene->mForceFields[i];
-			if ( fd->mInstance == field )
-			{
-				ret = fd->mId;
-				assert(ret);
-				break;
-			}
+			ret = fd->mId;
+			assert(ret);
 		}
 	}
 
@@ -1131,15 +1236,11 @@ NxForceFieldShapeGroup * CustomCopy::getForceFieldShapeGroupFromName(const char
 	assert(mCurrentScene);
 	if ( mCurrentScene && name )
 	{
-		for (unsigned int i=0; i<mCurrentScene->mForceFieldShapeGroups.size(); i++)
+		NxForceFieldShapeGroupDesc *sg = findDescById(mCurrentScene->mForceFieldShapeGroups,name);
+		if ( sg )
 		{
-			NxForceFieldShapeGroupDesc *sg = mCurrentScene->mForceFieldShapeGroups[i];
-			if ( strcmp(sg->mId,name) == 0 )
-			{
-				ret = (NxForceFieldShapeGroup *) sg->mInstance;
-				assert(ret);
-				break;
-			}
+			ret = (NxForceFieldShapeGroup *) sg->mInstance;
+			assert(ret);
 		}
 	}
 
@@ -1153,15 +1254,11 @@ const char *  CustomCopy::getNameFromForceFieldShapeGroup(NxForceFieldShapeGroup
 	assert(mCurrentScene);
 	if ( mCurrentScene && group )
 	{
-		for (unsigned int i=0; i<mCurrentScene->mForceFieldShapeGroups.size(); i++)
+		NxForceFieldShapeGroupDesc *sg = findDescByInstance(mCurrentScene->mForceFieldShapeGroups,group);
+		if ( sg )
 		{
-			NxForceFieldShapeGroupDesc *sg = mCurrentScene->mForceFieldShapeGroups[i];
-			if ( sg->mInstance == group )
-			{
-				ret = sg->mId;
-				assert(ret);
-				break;
-			}
+			ret = sg->mId;
+			assert(ret);
 		}
 	}
 
@@ -1175,15 +1272,11 @@ NxForceFieldLinearKernel * CustomCopy::getForceFieldLinearKernelFromName(const c
 	assert(mCurrentScene);
 	if ( mCurrentScene && name )
 	{
-		for (unsigned int i=0; i<mCurrentScene->mForceFieldLinearKernels.size(); i++)
+		NxForceFieldLinearKernelDesc *fd = findDescById(mCurrentScene->mForceFieldLinearKernels,name);
+		if ( fd )
 		{
-			NxForceFieldLinearKernelDesc *fd = mCurrentScene->mForceFieldLinearKernels[i];
-			if ( strcmp(fd->mId,name) == 0 )
-			{
-				ret = (NxForceFieldLinearKernel *) fd->mInstance;
-				assert(ret);
-				break;
-			}
+			ret = (NxForceFieldLinearKernel *) fd->mInstance;
+			assert(ret);
 		}
 	}
 
@@ -1197,15 +1290,11 @@ const char *  CustomCopy::getNameFromForceFieldLinearKernel(NxForceFieldLinearKe
 	assert(mCurrentScene);
 	if ( mCurrentScene && kernel )
 	{
-		for (unsigned int i=0; i<mCurrentScene->mForceFieldLinearKernels.size(); i++)
+		NxForceFieldLinearKernelDesc *fd = findDescByInstance(mCurrentScene->mForceFieldLinearKernels,kernel);
+		if ( fd )
 		{
-			NxForceFieldLinearKernelDesc *fd = mCurrentScene->mForceFieldLinearKernels[i];
-			if ( fd->mInstance == kernel )
-			{
-				ret = fd->mId;
-				assert(ret);
-				break;
-			}
+			ret = fd->mId;
+			assert(ret);
 		}
 	}
 
@@ -1220,15 +1309,11 @@ NxClothMesh * CustomCopy::getClothMeshFromName(const char *name)
   assert(mCurrentCollection);
   if ( mCurrentCollection && name )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mClothMeshes.size(); i++)
+  	NxClothMeshDesc *sd = findDescById(mCurrentCollection->mClothMeshes,name);
+  	if ( sd )
   	{
-  		NxClothMeshDesc *sd = mCurrentCollection->mClothMeshes[i];
-  		if ( strcmp(sd->mId,name) == 0 )
-  		{
-  			ret = (NxClothMesh *) sd->mInstance;
-  			assert(ret);
-  			break;
-  		}
+  		ret = (NxClothMesh *) sd->mInstance;
+  		assert(ret);
   	}
   }
 
@@ -1242,15 +1327,11 @@ const char *   CustomCopy::getNameFromClothMesh(NxClothMesh *mesh)
   assert(mCurrentCollection);
   if ( mCurrentCollection && mesh )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mClothMeshes.size(); i++)
+  	NxClothMeshDesc *sd = findDescByInstance(mCurrentCollection->mClothMeshes,mesh);
+  	if ( sd )
   	{
-  		NxClothMeshDesc *sd = mCurrentCollection->mClothMeshes[i];
-  		if ( sd->mInstance == mesh )
-  		{
-  			ret = sd->mId;
-  			assert(ret);
-  			break;
-  		}
+  		ret = sd->mId;
+  		assert(ret);
   	}
   }
 
@@ -1266,15 +1347,11 @@ NxCompartment * CustomCopy::getCompartmentFromName(const char *name)
 
   if ( mCurrentScene && name )
   {
-  	for (unsigned int i=0; i<mCurrentScene->mCompartments.size(); i++)
+  	NxCompartmentDesc *sd = findDescById(mCurrentScene->mCompartments,name);
+  	if ( sd )
   	{
-  		NxCompartmentDesc *sd = mCurrentScene->mCompartments[i];
-  		if ( strcmp(sd->mId,name) == 0 )
-  		{
-  			ret = (NxCompartment *) sd->mInstance;
-  			assert(ret);
-  			break;
-  		}
+  		ret = (NxCompartment *) sd->mInstance;
+  		assert(ret);
   	}
 
 		assert(ret);
@@ -1289,15 +1366,11 @@ const char *    CustomCopy::getNameFromCompartment(NxCompartment *nc)
   assert(mCurrentScene);
   if ( mCurrentScene && nc )
   {
-  	for (unsigned int i=0; i<mCurrentScene->mCompartments.size(); i++)
+  	NxCompartmentDesc *sd = findDescByInstance(mCurrentScene->mCompartments,nc);
+  	if ( sd )
   	{
-  		NxCompartmentDesc *sd = mCurrentScene->mCompartments[i];
-  		if ( sd->mInstance == nc )
-  		{
-  			ret = sd->mId;
-  			assert(ret);
-  			break;
-  		}
+  		ret = sd->mId;
+  		assert(ret);
   	}
     if ( ret == 0 ) // new compartment, we have to add it!
     {
@@ -1374,15 +1447,11 @@ NxCCDSkeleton * CustomCopy::getSkeletonFromName(const char *name)
   assert(mCurrentCollection);
   if ( mCurrentCollection && name )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mSkeletons.size(); i++)
+  	NxCCDSkeletonDesc *sd = findDescById(mCurrentCollection->mSkeletons,name);
+  	if ( sd )
   	{
-  		NxCCDSkeletonDesc *sd = mCurrentCollection->mSkeletons[i];
-  		if ( strcmp(sd->mId,name) == 0 )
-  		{
-  			ret = (NxCCDSkeleton *) sd->mInstance;
-  			assert(ret);
-  			break;
-  		}
+  		ret = (NxCCDSkeleton *) sd->mInstance;
+  		assert(ret);
   	}
   }
 
@@ -1396,15 +1465,11 @@ const char *    CustomCopy::getNameFromSkeleton(NxCCDSkeleton *mesh)
   assert(mCurrentCollection);
   if ( mCurrentCollection && mesh )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mSkeletons.size(); i++)
+  	NxCCDSkeletonDesc *sd = findDescByInstance(mCurrentCollection->mSkeletons,mesh);
+  	if ( sd )
   	{
-  		NxCCDSkeletonDesc *sd = mCurrentCollection->mSkeletons[i];
-  		if ( sd->mInstance == mesh )
-  		{
-  			ret = sd->mId;
-  			assert(ret);
-  			break;
-  		}
+  		ret = sd->mId;
+  		assert(ret);
   	}
   }
 
@@ -1493,15 +1558,11 @@ NxSoftBodyMesh * CustomCopy::getSoftBodyMeshFromName(const char *name)
   assert(mCurrentCollection);
   if ( mCurrentCollection && name )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mSoftBodyMeshes.size(); i++)
+  	NxSoftBodyMeshDesc *sd = findDescById(mCurrentCollection->mSoftBodyMeshes,name);
+  	if ( sd )
   	{
-  		NxSoftBodyMeshDesc *sd = mCurrentCollection->mSoftBodyMeshes[i];
-  		if ( strcmp(sd->mId,name) == 0 )
-  		{
-  			ret = (NxSoftBodyMesh *) sd->mInstance;
-  			assert(ret);
-  			break;
-  		}
+  		ret = (NxSoftBodyMesh *) sd->mInstance;
+  		assert(ret);
   	}
   }
 
@@ -1515,15 +1576,11 @@ const char *   CustomCopy::getNameFromSoftBodyMesh(NxSoftBodyMesh *mesh)
   assert(mCurrentCollection);
   if ( mCurrentCollection && mesh )
   {
-  	for (unsigned int i=0; i<mCurrentCollection->mSoftBodyMeshes.size(); i++)
+  	NxSoftBodyMeshDesc *sd = findDescByInstance(mCurrentCollection->mSoftBodyMeshes,mesh);
+  	if ( sd )
   	{
-  		NxSoftBodyMeshDesc *sd = mCurrentCollection->mSoftBodyMeshes[i];
-  		if ( sd->mInstance == mesh )
-  		{
-  			ret = sd->mId;
-  			assert(ret);
-  			break;
-  		}
+  		ret = sd->mId;
+  		assert(ret);
   	}
   }
 
@@ -45,13 +45,132 @@ class NxParticleData;
 class NxSoftBodyMeshDesc;
 class NxSoftBodyDesc;
 
+// Finds the descriptors of one collection array by instance pointer or by id without scanning the array.
+// Descriptors appended since the last lookup are indexed on the next one. A hit is checked against the array,
+// and the index starts over when the array was shrunk or reordered, so a stale entry is never returned.
+// Like the linear scans it replaces, a lookup returns the first descriptor with that instance or id.
+class NxuDescIndex
+{
+public:
+  NxuDescIndex(const void *list);
+  ~NxuDescIndex(void);
+
+  const void * getList(void) const { return mList; };
+
+  template <class Desc> Desc * findInstance(const NxArray< Desc * > &list,const void *instance)
+  {
+    Desc *ret = 0;
+    if ( instance )
+    {
+      for (NxU32 pass=0; pass<2 && !ret; pass++)
+      {
+        sync(list);
+        NxI32 index = lookupInstance(instance);
+        if ( index < 0 ) break;
+        if ( (NxU32)index < list.size() && list[(NxU32)index]->mInstance == instance )
+          ret = list[(NxU32)index];
+        else
+          reset();
+      }
+    }
+    return ret;
+  }
+
+  template <class Desc> Desc * findId(const NxArray< Desc * > &list,const char *id)
+  {
+    Desc *ret = 0;
+    if ( id )
+    {
+      for (NxU32 pass=0; pass<2 && !ret; pass++)
+      {
+        sync(list);
+        NxI32 index = lookupId(id);
+        if ( index < 0 ) break;
+        if ( (NxU32)index < list.size() && list[(NxU32)index]->mId && strcmp(list[(NxU32)index]->mId,id) == 0 )
+          ret = list[(NxU32)index];
+        else
+          reset();
+      }
+    }
+    return ret;
+  }
+
+private:
+  NxuDescIndex(const NxuDescIndex &);
+  NxuDescIndex & operator=(const NxuDescIndex &);
+
+  struct Slot
+  {
+    const void *mKey;
+    NxU32       mHash;
+    NxI32       mIndex;
+  };
+
+  template <class Desc> void sync(const NxArray< Desc * > &list)
+  {
+    NxU32 count = list.size();
+    if ( count < mIndexed || (mIndexed && list[mIndexed-1] != mLast) ) reset();
+    for (; mIndexed<count; mIndexed++)
+    {
+      Desc *d = list[mIndexed];
+      if ( d->mInstance ) insertInstance(d->mInstance,mIndexed);
+      if ( d->mId ) insertId(d->mId,mIndexed);
+    }
+    mLast = count ? list[count-1] : 0;
+  }
+
+  void  reset(void);
+  void  insertInstance(const void *instance,NxU32 index);
+  void  insertId(const char *id,NxU32 index);
+  NxI32 lookupInstance(const void *instance) const;
+  NxI32 lookupId(const char *id) const;
+  static void grow(Slot *&slots,NxU32 &capacity,NxU32 count);
+
+  const void *mList;
+  NxU32       mIndexed;    // array entries indexed so far
+  const void *mLast;       // the last of them, to notice arrays changed behind our back
+  Slot       *mInstances;
+  NxU32       mInstanceCapacity;
+  NxU32       mInstanceCount;
+  Slot       *mIds;
+  NxU32       mIdCapacity;
+  NxU32       mIdCount;
+};
+
+// The descriptor indices of every array an exporter looks things up in, created on first use.
+class NxuExportIndex
+{
+public:
+  NxuExportIndex(void) { };
+  ~NxuExportIndex(void);
+
+  template <class Desc> Desc * findInstance(const NxArray< Desc * > &list,const void *instance)
+  {
+    return getIndex(&list).findInstance(list,instance);
+  }
+
+  template <class Desc> Desc * findId(const NxArray< Desc * > &list,const char *id)
+  {
+    return getIndex(&list).findId(list,id);
+  }
+
+private:
+  NxuExportIndex(const NxuExportIndex &);
+  NxuExportIndex & operator=(const NxuExportIndex &);
+
+  NxuDescIndex & getIndex(const void *list);
+
+  NxArray< NxuDescIndex * > mIndices;
+};
+
 class CustomCopy
 {
 public:
-  CustomCopy(NxuPhysicsCollection *c=0,NxSceneDesc *s=0)
+  CustomCopy(NxuPhysicsCollection *c=0,NxSceneDesc *s=0,NxuExportIndex *index=0)
   {
   	mCurrentCollection = c;
   	mCurrentScene      = s;
+  	mIndex             = index;
   }
 
 #if NX_USE_SOFTBODY_API
@@ -185,8 +304,30 @@ public:
 
 
 private:
+  // Through mIndex while exporting, otherwise a linear scan. Both find the first match.
+  template <class Desc> Desc * findDescByInstance(const NxArray< Desc * > &list,const void *instance)
+  {
+    if ( mIndex ) return mIndex->findInstance(list,instance);
+    for (unsigned int i=0; i<list.size(); i++)
+    {
+      if ( list[i]->mInstance == instance ) return list[i];
+    }
+    return 0;
+  }
+
+  template <class Desc> Desc * findDescById(const NxArray< Desc * > &list,const char *id)
+  {
+    if ( mIndex ) return mIndex->findId(list,id);
+    for (unsigned int i=0; i<list.size(); i++)
+    {
+      if ( list[i]->mId && strcmp(list[i]->mId,id) == 0 ) return list[i];
+    }
+    return 0;
+  }
+
   NxuPhysicsCollection	*mCurrentCollection;
   NxSceneDesc           *mCurrentScene;
+  NxuExportIndex        *mIndex;            // optional, speeds up the instance to name lookups while exporting
 
 
 };
@@ -11,12 +11,14 @@
 #include "NXU_ColladaImport.h"
 #include "NXU_Geometry.h"
 #include "NXU_customcopy.h"
+#include "NXU_ScaledCopy.h"
 
 #include <NxVersionNumber.h>
 #include <NxPhysics.h>
 #include <NxPMap.h>
 #include <NxSceneStats.h>
 #include <NxStream.h>
+#include <limits.h>
 
 #ifdef WIN32
 #pragma warning(disable:4996) // Disabling stupid .NET deprecated warning.
@@ -105,7 +107,7 @@ static void saveParameters(NXU::NxuPhysicsCollection *c,NxPhysicsSDK *sdk)
 	}
 }
 
-static void addShapeMesh(NXU::NxuPhysicsCollection *c,NxShape *shape)
+static void addShapeMesh(NXU::NxuPhysicsCollection *c,NXU::NxuPhysicsExport &exporter,NxShape *shape)
 {
 	switch ( shape->getType() )
 	{
@@ -114,7 +116,7 @@ static void addShapeMesh(NXU::NxuPhysicsCollection *c,NxShape *shape)
 			{
 				NxConvexShape *s = (NxConvexShape *) shape;
 				NxConvexMesh &mesh = s->getConvexMesh();
-				NXU::addConvexMesh(*c,mesh);
+				exporter.Write(&mesh,0);
 			}
 			break;
 		case NX_SHAPE_MESH:
@@ -122,7 +124,7 @@ static void addShapeMesh(NXU::NxuPhysicsCollection *c,NxShape *shape)
 			{
 				NxTriangleMeshShape *s = (NxTriangleMeshShape *) shape;
 				NxTriangleMesh &mesh = s->getTriangleMesh();
-				NXU::addTriangleMesh(*c,mesh);
+				exporter.Write(&mesh,0);
 			}
 			break;
 		case NX_SHAPE_HEIGHTFIELD:
@@ -130,7 +132,7 @@ static void addShapeMesh(NXU::NxuPhysicsCollection *c,NxShape *shape)
 			{
 				NxHeightFieldShape *s = (NxHeightFieldShape *) shape;
 				NxHeightField &mesh = s->getHeightField();
-				NXU::addHeightField(*c,mesh);
+				exporter.Write(&mesh,0);
 			}
 			break;
 		default: /*nothing*/ break;
@@ -139,13 +141,13 @@ static void addShapeMesh(NXU::NxuPhysicsCollection *c,NxShape *shape)
 	NxCCDSkeleton *skeleton = shape->getCCDSkeleton();
 	if ( skeleton )
 	{
-		NXU::addCCDSkeleton(*c,*skeleton,0);
+		exporter.Write(skeleton,0);
 	}
 
 
 }
 
-static void saveMeshes(NXU::NxuPhysicsCollection *c,NxScene *scene)
+static void saveMeshes(NXU::NxuPhysicsCollection *c,NXU::NxuPhysicsExport &exporter,NxScene *scene)
 {
 
   NxU32 nbActors = scene->getNbActors();
@@ -160,7 +162,7 @@ static void saveMeshes(NXU::NxuPhysicsCollection *c,NxScene *scene)
    		for (NxU32 j=0; j<nbShapes; j++)
    		{
    			NxShape *s = slist[j];
-   			addShapeMesh(c,s);
+   			addShapeMesh(c,exporter,s);
     	}
     }
   }
@@ -199,7 +201,7 @@ static void saveSceneDesc(NXU::NxuPhysicsCollection *c,NxScene *scene)
 	NXU::addScene(*c,*scene); // save out the scene descriptor and sets this as the 'current' scene we are adding to.
 }
 
-static void	saveActors(NXU::NxuPhysicsCollection *c,NxScene *scene, NXU_userNotify *un = 0)
+static void	saveActors(NXU::NxuPhysicsCollection *c,NXU::NxuPhysicsExport &exporter,NxScene *scene, NXU_userNotify *un = 0)
 {
 	NxU32 nbActors = scene->getNbActors();
 	if ( nbActors )
@@ -212,12 +214,12 @@ static void	saveActors(NXU::NxuPhysicsCollection *c,NxScene *scene, NXU_userNoti
 			if (un)
 				un->NXU_notifySaveActor(alist[i], &pUserProperties);
 
-			NXU::addActor(*c,*alist[i], pUserProperties);
+			exporter.Write(alist[i], NXU::getGlobalString(pUserProperties));
 		}
 	}
 }
 
-static void			saveJoints(NXU::NxuPhysicsCollection *c,NxScene *scene)
+static void			saveJoints(NXU::NxuPhysicsCollection *c,NXU::NxuPhysicsExport &exporter,NxScene *scene)
 {
 	NxU32	jointCount = scene->getNbJoints();
 	if (jointCount)
@@ -234,7 +236,7 @@ static void			saveJoints(NXU::NxuPhysicsCollection *c,NxScene *scene)
 		{
 			NxU32 index = (jointCount-1)-i;
 			NxJoint *j = joints[index];
-			NXU::addJoint(*c,*j);
+			exporter.Write(j,0);
 		}
 	}
 }
@@ -690,6 +692,7 @@ bool coreDump(NxPhysicsSDK *sdk, const char	*fname,	NXU_FileType type, bool	save
 void releasePersistentMemory(void) //	do this	when you exit	the	application	or do	a	reset	of the Physics SDK
 {
 	NX_DELETE_SINGLE(gSkeletons);
+	releaseScaledMeshCache();
 	NXU::releaseGlobalStrings();
 	NXU::releaseGlobalInstances();
 }
@@ -789,9 +792,11 @@ bool addEntireScene(NxuPhysicsCollection &c,                  NxScene &scene,con
 {
 	bool ret = false;
 
+	// One exporter for the whole scene, so its lookup index is built once rather than for every object
+	NxuPhysicsExport exporter(&c);
 
 	#if NXU_SAVE_MESHES
-	saveMeshes(&c,&scene);
+	saveMeshes(&c,exporter,&scene);
 	#endif
 
 	#if NXU_SAVE_SCENE_DESC
@@ -811,11 +816,11 @@ bool addEntireScene(NxuPhysicsCollection &c,                  NxScene &scene,con
 	#endif
 
 	#if NXU_SAVE_ACTORS
-	saveActors(&c,&scene, un);            // save the actors
+	saveActors(&c,exporter,&scene, un);            // save the actors
 	#endif
 
 	#if NXU_SAVE_JOINTS
-	saveJoints(&c,&scene);             // save the joints
+	saveJoints(&c,exporter,&scene);             // save the joints
 	#endif
 
 	#if NXU_SAVE_PAIR_FLAGS	// save body pair flags, collision filters, etc. etc.
@@ -1097,6 +1102,786 @@ void releaseCollectionMemory(void *mem)
 	delete (char *) mem;
 }
 
+//==================================================================================
+// Chunked binary collections.  Layout:
+//
+//   "NXUCHUNKS\0", endian byte, sdk version, NxuStream version, directory offset
+//   one binary NxuStream per section, each a collection holding a single mesh, scene or scene instance
+//   directory: section count, then type, offset, length, id length and id for every section
+//==================================================================================
+
+#define CHUNK_FILE_ID        "NXUCHUNKS"
+#define CHUNK_DIRECTORY_LOC  (10+1+sizeof(NxU32)*2)
+
+struct NxuChunk
+{
+	NXU_ChunkType mType;
+	const char   *mId;
+	NxU32         mOffset;
+	NxU32         mLength;
+	bool          mLoaded;
+};
+
+class NxuChunkedCollection
+{
+public:
+	NxuChunkedCollection(void)
+	{
+		mFph        = 0;
+		mMem        = 0;
+		mLen        = 0;
+		mFlipEndian = false;
+		mCollection = new NxuPhysicsCollection;
+	}
+
+	~NxuChunkedCollection(void)
+	{
+		if ( mFph )
+		{
+			nxu_fclose(mFph);
+		}
+		releaseCollection(mCollection);
+	}
+
+	NXU_FILE             *mFph;
+	const char           *mMem;        // the application's buffer when opened from memory
+	NxU32                 mLen;
+	bool                  mFlipEndian;
+	NxArray< NxuChunk >   mChunks;
+	NxuPhysicsCollection *mCollection; // the sections loaded so far
+};
+
+// Offsets and lengths are stored as NxU32, and offsets are read back through nxu_fseek(), which takes a long.
+static bool chunkOffsetFits(size_t v)
+{
+	return v <= 0xFFFFFFFF && v <= (size_t)LONG_MAX;
+}
+
+static void writeChunkU32(NXU_FILE *fph,NxU32 v,bool flipEndian)
+{
+	if ( flipEndian )
+	{
+		v = (v>>24) | ((v>>8)&0xFF00) | ((v<<8)&0xFF0000) | (v<<24);
+	}
+	nxu_fwrite(&v,sizeof(NxU32),1,fph);
+}
+
+static bool readChunkU32(NXU_FILE *fph,NxU32 &v,bool flipEndian)
+{
+	v = 0;
+	bool ret = nxu_fread(&v,sizeof(NxU32),1,fph) == 1;
+	if ( flipEndian )
+	{
+		v = (v>>24) | ((v>>8)&0xFF00) | ((v<<8)&0xFF0000) | (v<<24);
+	}
+	return ret;
+}
+
+// A collection that borrows descriptors from 'c' just long enough to store them.
+static void beginChunk(NxuPhysicsCollection &chunk,const NxuPhysicsCollection &c)
+{
+	chunk.mId            = c.mId;
+	chunk.mUserProperties = c.mUserProperties;
+	chunk.mSdkVersion    = c.mSdkVersion;
+	chunk.mNxuVersion    = c.mNxuVersion;
+}
+
+static bool writeChunk(NXU_FILE *fph,NxArray< NxuChunk > &chunks,NxuPhysicsCollection &chunk,NXU_ChunkType type,const char *id)
+{
+	bool ret = false;
+
+	void *mem = 0;
+	size_t len = 0;
+
+	{
+		SchemaStream ss(id ? id : "chunk",true,"wmem",0,0);
+		if ( ss.isValid() )
+		{
+			chunk.store(ss);
+			if ( ss.isValid() )
+			{
+				mem = ss.getMemBuffer(len);
+			}
+		}
+	} // the stream still writes into its buffer when it is destroyed
+
+	if ( mem )
+	{
+		size_t offset = nxu_ftell(fph);
+		if ( chunkOffsetFits(offset) && chunkOffsetFits(offset+len) )
+		{
+			NxuChunk c;
+			c.mType   = type;
+			c.mId     = id;
+			c.mOffset = (NxU32)offset;
+			c.mLength = (NxU32)len;
+			c.mLoaded = false;
+			ret = nxu_fwrite(mem,len,1,fph) == 1;
+			chunks.push_back(c);
+		}
+		else
+		{
+			reportError("Section '%s' lies beyond the offsets a chunked collection can store", id ? id : "" );
+		}
+		releaseCollectionMemory(mem);
+	}
+
+	return ret;
+}
+
+template <class Type> static bool writeChunks(NXU_FILE *fph,NxArray< NxuChunk > &chunks,NxuPhysicsCollection &c,NxArray< Type * > NxuPhysicsCollection::*list,NXU_ChunkType type)
+{
+	bool ret = true;
+
+	NxArray< Type * > &source = c.*list;
+	for (NxU32 i=0; i<source.size() && ret; i++)
+	{
+		NxuPhysicsCollection chunk;
+		beginChunk(chunk,c);
+		(chunk.*list).push_back(source[i]);
+		ret = writeChunk(fph,chunks,chunk,type,source[i]->mId);
+		(chunk.*list).clear();
+	}
+
+	return ret;
+}
+
+static bool writeChunkedCollection(NxuPhysicsCollection *c,NXU_FILE *fph,bool cook)
+{
+	bool ret = true;
+
+	gSaveDefaults = true;
+	gSaveCooked   = cook;
+
+	bool flipEndian = gSaveBigEndian != gProcessorBigEndian;
+	NxU8 endian = gSaveBigEndian;
+
+	nxu_fwrite(CHUNK_FILE_ID,10,1,fph);
+	nxu_fwrite(&endian,1,1,fph);
+	writeChunkU32(fph,NX_SDK_VERSION_NUMBER,flipEndian);
+	writeChunkU32(fph,NXUSTREAM_VERSION,flipEndian);
+	writeChunkU32(fph,0,flipEndian); // patched with the directory location below
+
+	NxArray< NxuChunk > chunks;
+
+	{
+		NxuPhysicsCollection chunk;
+		beginChunk(chunk,*c);
+		chunk.mSDK        = c->mSDK;
+		chunk.mParameters = c->mParameters;
+		ret = writeChunk(fph,chunks,chunk,CT_COLLECTION,c->mId);
+		chunk.mParameters.clear();
+	}
+
+	if ( ret ) ret = writeChunks(fph,chunks,*c,&NxuPhysicsCollection::mConvexMeshes,CT_CONVEX_MESH);
+	if ( ret ) ret = writeChunks(fph,chunks,*c,&NxuPhysicsCollection::mTriangleMeshes,CT_TRIANGLE_MESH);
+	if ( ret ) ret = writeChunks(fph,chunks,*c,&NxuPhysicsCollection::mHeightFields,CT_HEIGHTFIELD);
+	if ( ret ) ret = writeChunks(fph,chunks,*c,&NxuPhysicsCollection::mSkeletons,CT_SKELETON);
+	if ( ret ) ret = writeChunks(fph,chunks,*c,&NxuPhysicsCollection::mClothMeshes,CT_CLOTH_MESH);
+#if NX_USE_SOFTBODY_API
+	if ( ret ) ret = writeChunks(fph,chunks,*c,&NxuPhysicsCollection::mSoftBodyMeshes,CT_SOFTBODY_MESH);
+#endif
+	if ( ret ) ret = writeChunks(fph,chunks,*c,&NxuPhysicsCollection::mScenes,CT_SCENE);
+	if ( ret ) ret = writeChunks(fph,chunks,*c,&NxuPhysicsCollection::mSceneInstances,CT_SCENE_INSTANCE);
+
+	size_t directory = ret ? nxu_ftell(fph) : 0;
+	if ( ret && !chunkOffsetFits(directory) )
+	{
+		reportError("The directory lies beyond the offsets a chunked collection can store" );
+		ret = false;
+	}
+
+	if ( ret )
+	{
+		writeChunkU32(fph,chunks.size(),flipEndian);
+		for (NxU32 i=0; i<chunks.size(); i++)
+		{
+			const NxuChunk &ch = chunks[i];
+			NxU32 len = ch.mId ? (NxU32)strlen(ch.mId) : 0;
+			writeChunkU32(fph,ch.mType,flipEndian);
+			writeChunkU32(fph,ch.mOffset,flipEndian);
+			writeChunkU32(fph,ch.mLength,flipEndian);
+			writeChunkU32(fph,len,flipEndian);
+			if ( len )
+			{
+				nxu_fwrite(ch.mId,len,1,fph);
+			}
+		}
+		size_t end = nxu_ftell(fph);
+		if ( chunkOffsetFits(end) )
+		{
+			nxu_fseek(fph,CHUNK_DIRECTORY_LOC,SEEK_SET);
+			writeChunkU32(fph,(NxU32)directory,flipEndian);
+			nxu_fseek(fph,(long)end,SEEK_SET);
+			ret = nxu_ferror(fph) == 0;
+		}
+		else
+		{
+			reportError("The directory lies beyond the offsets a chunked collection can store" );
+			ret = false;
+		}
+	}
+
+	return ret;
+}
+
+bool saveChunkedCollection(NxuPhysicsCollection *c,const char *fname,bool cook)
+{
+	bool ret = false;
+
+	if ( c )
+	{
+		setId(c,fname,0,false);
+
+		if ( gAutoGenerateSkeletons )
+		{
+			createCCDSkeletons(*c,gShrinkRatio,gMaxSkeletonVertices);
+		}
+
+		NXU_FILE *fph = nxu_fopen(fname,"wb");
+		if ( fph )
+		{
+			ret = writeChunkedCollection(c,fph,cook);
+			nxu_fclose(fph);
+		}
+		else
+		{
+			reportError("Failed to open file '%s' for write access.", fname );
+		}
+	}
+
+	return ret;
+}
+
+void * saveChunkedCollectionToMemory(NxuPhysicsCollection *c,const char *collectionId,bool cook,size_t &outputLength)
+{
+	void *ret = 0;
+	outputLength = 0;
+
+	if ( c )
+	{
+		setId(c,collectionId,0,true);
+
+		if ( gAutoGenerateSkeletons )
+		{
+			createCCDSkeletons(*c,gShrinkRatio,gMaxSkeletonVertices);
+		}
+
+		NXU_FILE *fph = nxu_fopen(c->mId ? c->mId : "chunked","wmem",0,0);
+		if ( fph )
+		{
+			if ( writeChunkedCollection(c,fph,cook) )
+			{
+				ret = nxu_getMemBuffer(fph,outputLength);
+			}
+			nxu_fclose(fph);
+		}
+	}
+
+	return ret;
+}
+
+template <class Type> static void moveDescriptors(NxArray< Type * > &dest,NxArray< Type * > &source)
+{
+	for (NxU32 i=0; i<source.size(); i++)
+	{
+		dest.push_back(source[i]);
+	}
+	source.clear();
+}
+
+// Reads one section and moves its descriptors into the resident collection.
+static bool readChunk(NxuChunkedCollection *cc,NxuChunk &ch)
+{
+	bool ret = false;
+
+	char *data = 0;
+	if ( cc->mMem )
+	{
+		if ( ch.mOffset <= cc->mLen && ch.mLength <= cc->mLen-ch.mOffset )
+		{
+			data = (char *)&cc->mMem[ch.mOffset];
+		}
+	}
+	else
+	{
+		data = new char[ch.mLength];
+		nxu_fseek(cc->mFph,(long)ch.mOffset,SEEK_SET);
+		if ( nxu_fread(data,ch.mLength,1,cc->mFph) != 1 )
+		{
+			delete []data;
+			data = 0;
+		}
+	}
+
+	if ( data )
+	{
+		NxuPhysicsCollection *c = new NxuPhysicsCollection;
+		SchemaStream ss(ch.mId ? ch.mId : "chunk",true,"rb",data,ch.mLength);
+		if ( ss.isValid() )
+		{
+			c->load(ss);
+			ret = ss.isValid();
+		}
+
+		if ( ret )
+		{
+			NxuPhysicsCollection *dest = cc->mCollection;
+			if ( ch.mType == CT_COLLECTION )
+			{
+				dest->mId             = c->mId;
+				dest->mUserProperties = c->mUserProperties;
+				dest->mSdkVersion     = c->mSdkVersion;
+				dest->mNxuVersion     = c->mNxuVersion;
+				dest->mSDK            = c->mSDK;
+			}
+			moveDescriptors(dest->mParameters,c->mParameters);
+			moveDescriptors(dest->mConvexMeshes,c->mConvexMeshes);
+			moveDescriptors(dest->mTriangleMeshes,c->mTriangleMeshes);
+			moveDescriptors(dest->mHeightFields,c->mHeightFields);
+			moveDescriptors(dest->mSkeletons,c->mSkeletons);
+			moveDescriptors(dest->mClothMeshes,c->mClothMeshes);
+#if NX_USE_SOFTBODY_API
+			moveDescriptors(dest->mSoftBodyMeshes,c->mSoftBodyMeshes);
+#endif
+			moveDescriptors(dest->mScenes,c->mScenes);
+			moveDescriptors(dest->mSceneInstances,c->mSceneInstances);
+		}
+		else
+		{
+			reportError("Failed to load section '%s' of chunked collection", ch.mId ? ch.mId : "" );
+		}
+
+		delete c;
+		if ( !cc->mMem )
+		{
+			delete []data;
+		}
+	}
+	else
+	{
+		reportError("Section '%s' lies outside of the chunked collection", ch.mId ? ch.mId : "" );
+	}
+
+	return ret;
+}
+
+NxuChunkedCollection * openChunkedCollection(const char *fname,void *mem,int len)
+{
+	NxuChunkedCollection *ret = 0;
+
+	NXU_FILE *fph = nxu_fopen(fname,"rb",mem,len);
+	if ( fph )
+	{
+		char stream[11] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+		NxU8 loadEndian = 0;
+		NxU32 sdk = 0;
+		NxU32 uv  = 0;
+		NxU32 directory = 0;
+		NxU32 count = 0;
+
+		nxu_fread(stream,10,1,fph);
+		nxu_fread(&loadEndian,1,1,fph);
+		bool flipEndian = loadEndian != (NxU8)gProcessorBigEndian;
+		readChunkU32(fph,sdk,flipEndian);
+		readChunkU32(fph,uv,flipEndian);
+		bool ok = readChunkU32(fph,directory,flipEndian);
+
+		if ( !ok || strcmp(stream,CHUNK_FILE_ID) != 0 )
+		{
+			ok = false;
+			reportError("File %s is not a valid chunked NxuStream file, missing header", fname );
+		}
+		if ( ok && sdk != NX_SDK_VERSION_NUMBER )
+		{
+			ok = false;
+			reportError("This chunked file %s was saved out with a different version of the SDK. Saved with SDK%d but running SDK%d", fname, sdk, NX_SDK_VERSION_NUMBER );
+		}
+		if ( ok && uv != NXUSTREAM_VERSION )
+		{
+			ok = false;
+			reportError("Even though the file %s was saved with the same SDK version, the version format has changed from %d to %d",fname,uv,NXUSTREAM_VERSION);
+		}
+
+		if ( ok )
+		{
+			nxu_fseek(fph,(long)directory,SEEK_SET);
+			ok = readChunkU32(fph,count,flipEndian);
+		}
+
+		if ( ok )
+		{
+			ret = new NxuChunkedCollection;
+			ret->mFph        = fph;
+			ret->mMem        = (const char *)mem;
+			ret->mLen        = mem ? (NxU32)len : 0;
+			ret->mFlipEndian = flipEndian;
+
+			for (NxU32 i=0; i<count && ok; i++)
+			{
+				NxuChunk ch;
+				NxU32 type = 0;
+				NxU32 idLen = 0;
+				ok = readChunkU32(fph,type,flipEndian) &&
+				     readChunkU32(fph,ch.mOffset,flipEndian) &&
+				     readChunkU32(fph,ch.mLength,flipEndian) &&
+				     readChunkU32(fph,idLen,flipEndian) &&
+				     idLen < 1024;
+				if ( ok )
+				{
+					char scratch[1024];
+					scratch[idLen] = 0;
+					if ( idLen )
+					{
+						ok = nxu_fread(scratch,idLen,1,fph) == 1;
+					}
+					ch.mType   = (NXU_ChunkType)type;
+					ch.mId     = idLen ? getGlobalString(scratch) : 0;
+					ch.mLoaded = false;
+					ret->mChunks.push_back(ch);
+				}
+			}
+
+			if ( !ok )
+			{
+				reportError("The directory of chunked collection '%s' is corrupted", fname );
+			}
+
+			for (NxU32 i=0; i<ret->mChunks.size() && ok; i++)
+			{
+				NxuChunk &ch = ret->mChunks[i];
+				if ( ch.mType == CT_COLLECTION )
+				{
+					ok = readChunk(ret,ch);
+					ch.mLoaded = ok;
+				}
+			}
+
+			if ( !ok )
+			{
+				delete ret;
+				ret = 0;
+				fph = 0; // closed by the chunked collection
+			}
+		}
+
+		if ( !ret && fph )
+		{
+			nxu_fclose(fph);
+		}
+	}
+	else
+	{
+		reportError("Failed to open physics data file '%s' for read access", fname );
+	}
+
+	return ret;
+}
+
+NxuPhysicsCollection * getChunkedPhysicsCollection(NxuChunkedCollection *cc)
+{
+	return cc ? cc->mCollection : 0;
+}
+
+NxU32 getChunkCount(NxuChunkedCollection *cc)
+{
+	return cc ? cc->mChunks.size() : 0;
+}
+
+const char * getChunkInfo(NxuChunkedCollection *cc,NxU32 index,NXU_ChunkType &type,bool &loaded)
+{
+	const char *ret = 0;
+
+	if ( cc && index < cc->mChunks.size() )
+	{
+		const NxuChunk &ch = cc->mChunks[index];
+		type   = ch.mType;
+		loaded = ch.mLoaded;
+		ret    = ch.mId;
+	}
+
+	return ret;
+}
+
+static bool isMeshChunk(NXU_ChunkType type)
+{
+	return type != CT_COLLECTION && type != CT_SCENE && type != CT_SCENE_INSTANCE;
+}
+
+static bool sameId(const char *a,const char *b)
+{
+	return a && b && strcmp(a,b) == 0;
+}
+
+// Calls 'reference' for every mesh or skeleton id the scene refers to.
+template <class Callback> static void forEachMeshReference(NxSceneDesc *s,Callback &reference)
+{
+	for (NxU32 i=0; i<s->mActors.size(); i++)
+	{
+		NxActorDesc *a = s->mActors[i];
+		for (NxU32 j=0; j<a->mShapes.size(); j++)
+		{
+			NxShapeDesc *shape = a->mShapes[j];
+			reference(shape->mCCDSkeleton);
+			switch ( shape->mType )
+			{
+				case SC_NxConvexShapeDesc:
+					reference(static_cast<NxConvexShapeDesc*>(shape)->mMeshData);
+					break;
+				case SC_NxTriangleMeshShapeDesc:
+					reference(static_cast<NxTriangleMeshShapeDesc*>(shape)->mMeshData);
+					break;
+				case SC_NxHeightFieldShapeDesc:
+					reference(static_cast<NxHeightFieldShapeDesc*>(shape)->mHeightField);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	for (NxU32 i=0; i<s->mCloths.size(); i++)
+	{
+		reference(s->mCloths[i]->mClothMesh);
+	}
+
+#if NX_USE_SOFTBODY_API
+	for (NxU32 i=0; i<s->mSoftBodies.size(); i++)
+	{
+		reference(s->mSoftBodies[i]->mSoftBodyMesh);
+	}
+#endif
+
+#if NX_SDK_VERSION_NUMBER >= 280
+	for (NxU32 i=0; i<s->mForceFieldShapeGroups.size(); i++)
+	{
+		NxForceFieldShapeGroupDesc *g = s->mForceFieldShapeGroups[i];
+		for (NxU32 j=0; j<g->mShapes.size(); j++)
+		{
+			if ( g->mShapes[j]->mType == SC_NxConvexForceFieldShapeDesc )
+			{
+				reference(static_cast<NxConvexForceFieldShapeDesc*>(g->mShapes[j])->mMeshData);
+			}
+		}
+	}
+#endif
+}
+
+static bool loadChunks(NxuChunkedCollection *cc,const char *id,bool meshesOnly,bool &found);
+
+struct LoadMeshReference
+{
+	LoadMeshReference(NxuChunkedCollection *cc) : mChunks(cc), mOk(true) { }
+
+	void operator()(const char *id)
+	{
+		bool found = false;
+		if ( id && *id && !loadChunks(mChunks,id,true,found) )
+		{
+			mOk = false;
+		}
+	}
+
+	NxuChunkedCollection *mChunks;
+	bool                  mOk;
+};
+
+static bool loadSceneInstanceReferences(NxuChunkedCollection *cc,NxSceneInstanceDesc *si)
+{
+	bool found = false;
+	bool ret = loadChunks(cc,si->mSceneName,false,found);
+	for (NxU32 i=0; i<si->mSceneInstances.size(); i++)
+	{
+		if ( !loadSceneInstanceReferences(cc,si->mSceneInstances[i]) )
+		{
+			ret = false;
+		}
+	}
+	return ret;
+}
+
+static bool loadChunks(NxuChunkedCollection *cc,const char *id,bool meshesOnly,bool &found)
+{
+	bool ret = true;
+
+	for (NxU32 i=0; i<cc->mChunks.size(); i++)
+	{
+		NxuChunk &ch = cc->mChunks[i];
+		if ( ch.mType == CT_COLLECTION || !sameId(ch.mId,id) || (meshesOnly && !isMeshChunk(ch.mType)) )
+		{
+			continue;
+		}
+
+		found = true;
+		if ( ch.mLoaded )
+		{
+			continue;
+		}
+
+		// marked first so scene instances referring back to each other terminate
+		ch.mLoaded = readChunk(cc,ch);
+		if ( !ch.mLoaded )
+		{
+			ret = false;
+		}
+		else if ( ch.mType == CT_SCENE )
+		{
+			NxU32 index;
+			NxSceneDesc *s = locateSceneDesc(cc->mCollection,ch.mId,index);
+			if ( s )
+			{
+				LoadMeshReference reference(cc);
+				forEachMeshReference(s,reference);
+				ret = ret && reference.mOk;
+			}
+		}
+		else if ( ch.mType == CT_SCENE_INSTANCE )
+		{
+			NxuPhysicsCollection *c = cc->mCollection;
+			for (NxU32 j=0; j<c->mSceneInstances.size(); j++)
+			{
+				if ( sameId(c->mSceneInstances[j]->mId,ch.mId) && !loadSceneInstanceReferences(cc,c->mSceneInstances[j]) )
+				{
+					ret = false;
+				}
+			}
+		}
+	}
+
+	return ret;
+}
+
+bool loadChunk(NxuChunkedCollection *cc,const char *id)
+{
+	bool ret = false;
+
+	if ( cc && id )
+	{
+		bool found = false;
+		ret = loadChunks(cc,id,false,found);
+		if ( !found )
+		{
+			reportError("No section named '%s' in chunked collection '%s'", id, cc->mCollection->mId ? cc->mCollection->mId : "" );
+			ret = false;
+		}
+	}
+
+	return ret;
+}
+
+template <class Type> static bool releaseDescriptor(NxArray< Type * > &list,const char *id)
+{
+	bool ret = false;
+	for (NxU32 i=0; i<list.size(); i++)
+	{
+		if ( sameId(list[i]->mId,id) )
+		{
+			delete list[i];
+			list.erase(&list[i],&list[i]+1);
+			ret = true;
+			break;
+		}
+	}
+	return ret;
+}
+
+static void releaseChunk(NxuPhysicsCollection *c,const NxuChunk &ch)
+{
+	switch ( ch.mType )
+	{
+		case CT_CONVEX_MESH:    releaseDescriptor(c->mConvexMeshes,ch.mId);   break;
+		case CT_TRIANGLE_MESH:  releaseDescriptor(c->mTriangleMeshes,ch.mId); break;
+		case CT_HEIGHTFIELD:    releaseDescriptor(c->mHeightFields,ch.mId);   break;
+		case CT_SKELETON:       releaseDescriptor(c->mSkeletons,ch.mId);      break;
+		case CT_CLOTH_MESH:     releaseDescriptor(c->mClothMeshes,ch.mId);    break;
+#if NX_USE_SOFTBODY_API
+		case CT_SOFTBODY_MESH:  releaseDescriptor(c->mSoftBodyMeshes,ch.mId); break;
+#endif
+		case CT_SCENE:          releaseDescriptor(c->mScenes,ch.mId);         break;
+		case CT_SCENE_INSTANCE: releaseDescriptor(c->mSceneInstances,ch.mId); break;
+		default:
+			break;
+	}
+}
+
+bool unloadChunk(NxuChunkedCollection *cc,const char *id)
+{
+	bool ret = false;
+
+	if ( cc && id )
+	{
+		for (NxU32 i=0; i<cc->mChunks.size(); i++)
+		{
+			NxuChunk &ch = cc->mChunks[i];
+			if ( ch.mLoaded && ch.mType != CT_COLLECTION && sameId(ch.mId,id) )
+			{
+				releaseChunk(cc->mCollection,ch);
+				ch.mLoaded = false;
+				ret = true;
+			}
+		}
+	}
+
+	return ret;
+}
+
+struct MarkMeshReference
+{
+	MarkMeshReference(NxArray< const char * > &ids) : mIds(ids) { }
+
+	void operator()(const char *id)
+	{
+		if ( id && *id )
+		{
+			mIds.push_back(id);
+		}
+	}
+
+	NxArray< const char * > &mIds;
+};
+
+NxU32 unloadUnreferencedChunks(NxuChunkedCollection *cc)
+{
+	NxU32 ret = 0;
+
+	if ( cc )
+	{
+		NxArray< const char * > referenced;
+		MarkMeshReference mark(referenced);
+		NxuPhysicsCollection *c = cc->mCollection;
+		for (NxU32 i=0; i<c->mScenes.size(); i++)
+		{
+			forEachMeshReference(c->mScenes[i],mark);
+		}
+
+		for (NxU32 i=0; i<cc->mChunks.size(); i++)
+		{
+			NxuChunk &ch = cc->mChunks[i];
+			if ( ch.mLoaded && isMeshChunk(ch.mType) )
+			{
+				bool used = false;
+				for (NxU32 j=0; j<referenced.size() && !used; j++)
+				{
+					used = sameId(referenced[j],ch.mId);
+				}
+				if ( !used )
+				{
+					releaseChunk(c,ch);
+					ch.mLoaded = false;
+					ret++;
+				}
+			}
+		}
+	}
+
+	return ret;
+}
+
+void closeChunkedCollection(NxuChunkedCollection *cc)
+{
+	delete cc;
+}
+
 bool addGroupCollisionFlag(NxuPhysicsCollection &c,NxU32 group1,NxU32 group2,bool enable)
 {
 	bool ret = false;
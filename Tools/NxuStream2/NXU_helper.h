@@ -656,6 +656,103 @@ void * 									saveCollectionToMemory(NxuPhysicsCollection *c,const char	*colle
 */
 void   									releaseCollectionMemory(void *mem);
 
+/**
+\brief The kinds of section in a chunked binary collection.
+*/
+enum NXU_ChunkType
+{
+	CT_COLLECTION,       //!< The collection id, the SDK descriptor and the parameters.  Always loaded.
+	CT_CONVEX_MESH,
+	CT_TRIANGLE_MESH,
+	CT_HEIGHTFIELD,
+	CT_SKELETON,
+	CT_CLOTH_MESH,
+	CT_SOFTBODY_MESH,
+	CT_SCENE,
+	CT_SCENE_INSTANCE
+};
+
+class NxuChunkedCollection;
+
+/**
+\brief Save a physics collection as a chunked binary file, with a directory of sections that can be loaded on demand.
+
+Each mesh, scene and root level scene instance is written as its own small binary NxuStream, so the file keeps the
+endian and version handling of FT_BINARY.  The directory at the end of the file lists every section by type and id.
+
+\param c A pointer to a valid NXU::NxuPhysicsCollection
+\param fname The name of the file to save it to.
+\param cook  True to export fully cooked meshes rather than the raw source geometry.
+\return true if the collection was successfully saved.
+*/
+bool 										saveChunkedCollection(NxuPhysicsCollection *c,const char *fname,bool cook=false);
+
+/**
+\brief Save a physics collection as a chunked binary buffer in memory.
+
+\param c  A pointer to the physics collection to save.
+\param collectionId The ID of the collection.
+\param cook  True to export fully cooked meshes rather than the raw source geometry.
+\param outputLength A reference that will receive the exact output length of the save data.
+\return The allocated buffer, to be freed with 'releaseCollectionMemory', or NULL if the save failed.
+*/
+void *									saveChunkedCollectionToMemory(NxuPhysicsCollection *c,const char *collectionId,bool cook,size_t &outputLength);
+
+/**
+\brief Open a chunked binary collection, reading only its directory and the CT_COLLECTION section.
+
+\param fname The name of the file or asset name for this collection.
+\param mem   Optional pointer to a buffer in memory to load from.  It must stay valid until the collection is closed.
+\param len   If providing a buffer in memory then this represents the length of the available source data.
+\return The opened collection or NULL if it is not a valid chunked collection.
+*/
+NxuChunkedCollection *	openChunkedCollection(const char *fname,void *mem=0,int len=0);
+
+/**
+\brief Returns the resident collection, holding whatever sections are currently loaded.  Owned by the chunked collection.
+*/
+NxuPhysicsCollection *	getChunkedPhysicsCollection(NxuChunkedCollection *cc);
+
+/**
+\brief Returns the number of sections in the directory.
+*/
+NxU32                   getChunkCount(NxuChunkedCollection *cc);
+
+/**
+\brief Returns the id of a section in the directory, along with its type and whether it is loaded.
+*/
+const char *            getChunkInfo(NxuChunkedCollection *cc,NxU32 index,NXU_ChunkType &type,bool &loaded);
+
+/**
+\brief Load every section with this id into the resident collection.
+
+A scene also loads the meshes and skeletons its actors, cloths, soft bodies and force fields refer to.  A scene instance
+also loads the scenes and scene instances it refers to.  Sections already loaded are not read again.
+
+\return true if at least one section has this id and everything it needed loaded successfully.
+*/
+bool                    loadChunk(NxuChunkedCollection *cc,const char *id);
+
+/**
+\brief Remove every section with this id from the resident collection and free its descriptors.
+
+Meshes loaded on behalf of a scene stay resident; use 'unloadUnreferencedChunks' to drop those nothing refers to anymore.
+Objects already instantiated into the SDK are not affected.
+*/
+bool                    unloadChunk(NxuChunkedCollection *cc,const char *id);
+
+/**
+\brief Remove the loaded mesh and skeleton sections that no resident scene refers to.
+
+\return The number of sections unloaded.
+*/
+NxU32                   unloadUnreferencedChunks(NxuChunkedCollection *cc);
+
+/**
+\brief Close a chunked collection, releasing the resident collection and the file.
+*/
+void                    closeChunkedCollection(NxuChunkedCollection *cc);
+
 /**
 \brief Instantiates a physics collection into the PhysX SDK
 
@@ -1062,6 +1159,10 @@ bool                    addSoftBodyMesh(NxuPhysicsCollection &c,NxSoftBodyMesh &
 /**
 \brief Adds a scene instantiation to the current scene or scene instance.
 
+When instantiateCollection creates a scene several times into the same NxScene, only the first instance sets up its
+materials and scene wide state. The later ones create just its actors, pair flags and joints, from descriptors
+converted once. Scenes with effectors, force fields, cloth, soft bodies or fluids are always instantiated in full.
+
 \param c The NxuPhysicsCollection to add data to.
 \param instanceId  The id of the instance created.  Pass in NULL if you do not want this instantiated by default.
 \param sceneName  The name of the scene to be instantiated.
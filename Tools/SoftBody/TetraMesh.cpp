@@ -120,21 +120,7 @@ TetraModel::TetraModel(const char *obj,const char *tet)
 	mTetraPool  = 0;
 
   // build the mean unit normals.
-  if ( mVertices.size() )
-  {
-    TetraVertex *vlist = &mVertices[0];
-   	for (NxU32 i=0; i<mSections.size(); i++)
-   	{
-   		TetraModelSection *ms = mSections[i];
-       ms->applyNormals(vlist);
-   	}
-    NxU32 vcount = mVertices.size();
-    for (NxU32 i=0; i<vcount; i++)
-    {
-      vlist->mNormal.normalize();
-      vlist++;
-    }
-  }
+  buildNormals();
 
 
   createLinks(); // optimize the links in memory
@@ -233,11 +219,8 @@ void TetraModel::render(const NxVec3 *vertices,const NxU32 *indices)
 
        	mTetraMesh->applyLinks(tverts,mVertices.size(),vertices,indices,gverts);
 
-      	for (NxU32 i=0; i<mSections.size(); i++)
-      	{
-      		TetraModelSection *ms = mSections[i];
-          ms->applyNormals(gverts);
-      	}
+        // the renderer normalizes, only the weighted sums are written
+        mNormalBuilder.compute(gverts[0].mPos,sizeof(TetraGraphicsVertex),gverts[0].mNormal,sizeof(TetraGraphicsVertex),NX_VNF_NO_NORMALIZE);
 
         gGraphicsInterface->unlockVertexBuffer(mVertexBuffer);
       }
@@ -297,10 +280,6 @@ void TetraMesh::applyLinks(TetraVertex        *tverts,        // source vertices
     gv->mTexel[0] = tv->mTexel[0];
     gv->mTexel[1] = tv->mTexel[1];
 
-		gv->mNormal[0] = 0;
-		gv->mNormal[1] = 0;
-		gv->mNormal[2] = 0;
-
     tv++;
     gv++;
   }
@@ -930,63 +909,24 @@ void TetraModel::createLinks(void)
 }
 
 
-void TetraModelSection::applyNormals(TetraGraphicsVertex *verts)
+void TetraModel::buildNormals(void)
 {
-  NxU32 tcount = mIndices.size()/3;
-  if ( tcount )
-  {
-    NxU32 *idx = &mIndices[0];
-    for (NxU32 i=0; i<tcount; i++)
-    {
-      NxU32 i1 = *idx++;
-      NxU32 i2 = *idx++;
-      NxU32 i3 = *idx++;
-
-      NxVec3 &p1 = *(NxVec3 *) verts[i1].mPos;
-      NxVec3 &p2 = *(NxVec3 *) verts[i2].mPos;
-      NxVec3 &p3 = *(NxVec3 *) verts[i3].mPos;
-      NxVec3 &n1 = *(NxVec3 *) verts[i1].mNormal;
-      NxVec3 &n2 = *(NxVec3 *) verts[i2].mNormal;
-      NxVec3 &n3 = *(NxVec3 *) verts[i3].mNormal;
-
-      NxVec3 normal;
-
-      normal.cross( p2 - p1, p3-p1 ); // compute the facenormal
-      n1+=normal;
-      n2+=normal;
-      n3+=normal;
+  // one adjacency over all sections, the sections share the vertex array
+  NxArray< NxU32 > indices;
+ 	for (NxU32 i=0; i<mSections.size(); i++)
+ 	{
+ 		TetraModelSection *ms = mSections[i];
+    for (NxU32 j=0; j<ms->mIndices.size(); j++)
+      indices.push_back(ms->mIndices[j]);
+ 	}
 
-    }
-  }
-}
+  NxU32 tcount = indices.size()/3;
+  mNormalBuilder.init(tcount,mVertices.size(),tcount ? &indices[0] : 0,0);
 
-void TetraModelSection::applyNormals(TetraVertex *verts)
-{
-  NxU32 tcount = mIndices.size()/3;
-  if ( tcount )
+  if ( mVertices.size() )
   {
-    NxU32 *idx = &mIndices[0];
-    for (NxU32 i=0; i<tcount; i++)
-    {
-      NxU32 i1 = *idx++;
-      NxU32 i2 = *idx++;
-      NxU32 i3 = *idx++;
-
-      NxVec3 &p1 = verts[i1].mPos;
-      NxVec3 &p2 = verts[i2].mPos;
-      NxVec3 &p3 = verts[i3].mPos;
-      NxVec3 &n1 = verts[i1].mNormal;
-      NxVec3 &n2 = verts[i2].mNormal;
-      NxVec3 &n3 = verts[i3].mNormal;
-
-      NxVec3 normal;
-
-      normal.cross( p2 - p1, p3-p1 ); // compute the facenormal
-      n1+=normal;
-      n2+=normal;
-      n3+=normal;
-
-    }
+    TetraVertex *vlist = &mVertices[0];
+    mNormalBuilder.compute(&vlist->mPos,sizeof(TetraVertex),&vlist->mNormal,sizeof(TetraVertex));
   }
 }
 
@@ -1196,21 +1136,7 @@ TetraModel::TetraModel(NxSoftBodyMesh *mesh,const char *userProperties)
 	mTetraPool  = 0;
 
   // build the mean unit normals.
-  if ( mVertices.size() )
-  {
-    TetraVertex *vlist = &mVertices[0];
-   	for (NxU32 i=0; i<mSections.size(); i++)
-   	{
-   		TetraModelSection *ms = mSections[i];
-       ms->applyNormals(vlist);
-   	}
-    NxU32 vcount = mVertices.size();
-    for (NxU32 i=0; i<vcount; i++)
-    {
-      vlist->mNormal.normalize();
-      vlist++;
-    }
-  }
+  buildNormals();
 
 
   createLinks(); // optimize the links in memory
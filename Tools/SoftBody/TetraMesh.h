@@ -130,9 +130,6 @@ public:
 
   void onDeviceReset(void);
 
-  void applyNormals(TetraGraphicsVertex *verts);
-  void applyNormals(TetraVertex *verts);
-
   TetraMaterial         *mMaterial;
   NxArray< NxU32       > mIndices;
   void                  *mIndexBuffer;
@@ -198,6 +195,8 @@ public:
 
   void createLinks(void);
 
+  void buildNormals(void);
+
 	void softMeshMaterial(const TetraMaterial &tm);
 	void softMeshTriangle(const TetraGraphicsVertex &v1,const TetraGraphicsVertex &v2,const TetraGraphicsVertex &v3);
 	void softMeshTetrahedron(const float *p1,const float *p2,const float *p3,const float *p4);
@@ -211,6 +210,8 @@ public:
   NxArray< TetraModelSection *>mSections;  // the model sections (one for each material)
   NxArray< TetraMaterial * >   mMaterials; // materials in this model.
 
+  NxVertexNormalBuilder        mNormalBuilder; // vertex to triangle adjacency over all sections
+
   NxSoftBodyMesh              *mNxSoftBodyMesh;	 // instance of the soft body mesh on the SDK
 
   void *                       mVertexBuffer;   // the vertex buffer.